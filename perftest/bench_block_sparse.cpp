@@ -0,0 +1,149 @@
+/** \file bench_block_sparse.cpp
+ * \brief Compares matrix-vector products and block triangular sweeps of the in-tree block sparse
+ *  matrix with those of PETSc BAIJ matrices
+ *
+ * Usage: [mpirun -n <p>] bench_block_sparse <control file>
+ *   [-options_file <PETSc options file>] [-bench_num_evals <n>]
+ * The Jacobian of the case described by the control file is assembled at the initial state into a
+ * MATSEQBAIJ (one rank) or MATMPIBAIJ matrix and copied into \ref BlockSparseMatrix objects with
+ * double- and single-precision block storage. Each of the following is then timed n times
+ * (100 by default):
+ *  - the product with a vector: MatMult vs. \ref BlockSparseMatrix::apply
+ *  - a forward block Gauss-Seidel sweep from zero, which is a block lower triangular solve:
+ *    MatSOR with SOR_LOCAL_FORWARD_SWEEP vs. \ref BlockSparseMatrix::lower_solve
+ *  - a symmetric block Gauss-Seidel sweep from zero: MatSOR with SOR_LOCAL_SYMMETRIC_SWEEP vs.
+ *    \ref BlockSparseMatrix::apply_sgs
+ * The average time per operation (max over all ranks) and the speedup over BAIJ are reported.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscmat.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/blocksparsematrix.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Times the operations of one block sparse matrix
+template <typename scalar>
+static std::vector<double> benchmarkBlockSparse(const BlockSparseMatrix<scalar,NVARS>& bsm,
+                                                const freal *const x, freal *const y,
+                                                freal *const work, const int nevals)
+{
+	return {
+		timeOperation([&]() { bsm.apply(x, y); }, nevals),
+		timeOperation([&]() { bsm.lower_solve(x, y); }, nevals),
+		timeOperation([&]() { bsm.apply_sgs(x, work, y); }, nevals)
+	};
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of block sparse matrix kernels against PETSc BAIJ.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of block sparse matrix kernels")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+	const BAIJJacobianLayout<NVARS> layout(m, A);
+	BlockSparseMatrix<double,NVARS> bsmd(m);
+	ierr = bsmd.copy_from(A, layout); CHKERRQ(ierr);
+	bsmd.invert_diagonal_blocks();
+	BlockSparseMatrix<float,NVARS> bsmf(m);
+	ierr = bsmf.copy_from(A, layout); CHKERRQ(ierr);
+	bsmf.invert_diagonal_blocks();
+
+	Vec x, y;
+	ierr = MatCreateVecs(A, &x, &y); CHKERRQ(ierr);
+	ierr = VecSet(x, 1.0); CHKERRQ(ierr);
+
+	const int ne = static_cast<int>(nevals);
+	const std::vector<double> baijtimes = {
+		timeOperation([&]() { MatMult(A, x, y); }, ne),
+		timeOperation([&]() {
+				MatSOR(A, x, 1.0, (MatSORType)(SOR_LOCAL_FORWARD_SWEEP | SOR_ZERO_INITIAL_GUESS),
+				       0.0, 1, 1, y); }, ne),
+		timeOperation([&]() {
+				MatSOR(A, x, 1.0, (MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),
+				       0.0, 1, 1, y); }, ne)
+	};
+
+	std::vector<double> bsmdtimes, bsmftimes;
+	{
+		std::vector<freal> work(m.gnelem()*NVARS);
+		ConstVecHandler<freal> xh(x);
+		MutableVecHandler<freal> yh(y);
+		bsmdtimes = benchmarkBlockSparse(bsmd, xh.getArray(), yh.getArray(), work.data(), ne);
+		bsmftimes = benchmarkBlockSparse(bsmf, xh.getArray(), yh.getArray(), work.data(), ne);
+	}
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << mpisize << " ranks, "
+			<< nevals << " evaluations\n";
+		std::cout << "Storage on rank 0 (bytes): BSR double " << bsmd.storage_bytes()
+			<< ", BSR float " << bsmf.storage_bytes() << '\n';
+		std::cout << std::setw(16) << "Operation" << std::setw(16) << "BAIJ (s)"
+			<< std::setw(16) << "BSR double (s)" << std::setw(10) << "Speedup"
+			<< std::setw(16) << "BSR float (s)" << std::setw(10) << "Speedup" << '\n';
+		const std::string opnames[] = {"Mult", "Lower solve", "SGS sweep"};
+		for(int iop = 0; iop < 3; iop++)
+			std::cout << std::setw(16) << opnames[iop] << std::setprecision(5)
+				<< std::setw(16) << baijtimes[iop]
+				<< std::setw(16) << bsmdtimes[iop]
+				<< std::setw(10) << std::setprecision(4) << baijtimes[iop]/bsmdtimes[iop]
+				<< std::setprecision(5) << std::setw(16) << bsmftimes[iop]
+				<< std::setw(10) << std::setprecision(4) << baijtimes[iop]/bsmftimes[iop] << '\n';
+		std::cout << std::flush;
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,141 @@
+/** \file bench_comm_overlap.cpp
+ * \brief Measures how much halo communication is hidden behind flux computation in the residual
+ *
+ * Usage: [mpirun -n <p>] bench_comm_overlap <control file> [-options_file <PETSc options file>]
+ *   [-bench_num_evals <n>]
+ * The case described by the control file is set up once. With overlapped communication (see
+ * \ref FlowNumericsConfig::overlap_communication) off and on, the residual and local time steps are
+ * computed n times (100 by default) at the initial state, using the multi-pass and the fused
+ * residual computations. The average time per evaluation (max over all ranks) is reported for each.
+ *
+ * As a reference for the communication cost, the time of an exchange of cell-centred gradients
+ * at connectivity ghost cells, as done in each second-order residual evaluation, is also measured
+ * in isolation. The communication time hidden by overlapping is estimated as the difference between
+ * the evaluation times without and with overlap. Run with increasing numbers of ranks, e.g. 64 to
+ * 512, on a fixed mesh to see how the hidden fraction evolves as the subdomains shrink.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <petscvec.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Times residual evaluations with overlapped communication and fused residual on or off
+/** \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ */
+static StatusCode benchmarkResidual(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                                    const bool fused, const bool overlap, const int nevals,
+                                    const Vec u, Vec res, Vec dtm, double& evaltime)
+{
+	FlowParserOptions aopts = opts;
+	aopts.fused_residual = fused;
+	aopts.overlap_communication = overlap;
+	return timeResidual(aopts, m, nevals, u, res, dtm, evaltime);
+}
+
+/// Times the exchange of gradients at connectivity ghost cells
+/** \param[out] exchtime Average wall-clock time of one exchange, max over all ranks
+ */
+static StatusCode benchmarkExchange(const UMesh<freal,NDIM>& m, const int nevals, double& exchtime)
+{
+	StatusCode ierr = 0;
+	Vec gradvec;
+	ierr = createGhostedSystemVector(&m, NVARS*NDIM, &gradvec); CHKERRQ(ierr);
+	ierr = VecSet(gradvec, 1.0); CHKERRQ(ierr);
+
+	MPI_Barrier(PETSC_COMM_WORLD);
+	const double starttime = MPI_Wtime();
+	for(int i = 0; i < nevals; i++) {
+		ierr = VecGhostUpdateBegin(gradvec, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		ierr = VecGhostUpdateEnd(gradvec, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	}
+	const double loctime = (MPI_Wtime() - starttime)/nevals;
+	MPI_Allreduce(&loctime, &exchtime, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+
+	ierr = VecDestroy(&gradvec); CHKERRQ(ierr);
+	return ierr;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of overlapping communication with residual computation.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of communication overlap in residual computation")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	Vec u, res, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	double exchtime;
+	ierr = benchmarkExchange(m, static_cast<int>(nevals), exchtime); CHKERRQ(ierr);
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << mpisize << " ranks, "
+			<< nevals << " evaluations\n";
+		std::cout << "Gradient exchange alone (s): " << std::setprecision(5) << exchtime << '\n';
+		std::cout << std::setw(12) << "Residual" << std::setw(20) << "No overlap (s)"
+			<< std::setw(20) << "Overlap (s)" << std::setw(16) << "Hidden (s)"
+			<< std::setw(14) << "Speedup" << '\n';
+	}
+
+	for(const bool fused : {false, true})
+	{
+		double times[2];
+		for(const bool overlap : {false, true}) {
+			ierr = benchmarkResidual(opts, m, fused, overlap, static_cast<int>(nevals), u, res, dtm,
+			                         times[overlap]);
+			CHKERRQ(ierr);
+		}
+
+		if(mpirank == 0)
+			std::cout << std::setw(12) << (fused ? "FUSED" : "MULTIPASS")
+				<< std::setw(20) << std::setprecision(5) << times[0]
+				<< std::setw(20) << std::setprecision(5) << times[1]
+				<< std::setw(16) << std::setprecision(4) << times[0]-times[1]
+				<< std::setw(14) << std::setprecision(4) << times[0]/times[1] << '\n';
+	}
+	if(mpirank == 0)
+		std::cout << std::flush;
+
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,139 @@
+/** \file bench_face_jacobian.cpp
+ * \brief Compares the memory use, assembly and product times of the face-based Jacobian with those
+ *  of the BAIJ Jacobian
+ *
+ * Usage: [mpirun -n <p>] bench_face_jacobian <control file>
+ *   [-options_file <PETSc options file>] [-bench_num_evals <n>]
+ * The Jacobian of the case described by the control file at the initial state is assembled into
+ * the BAIJ matrix given by setupSystemMatrix and into a \ref FaceJacobian. Each of the following is
+ * then timed n times (100 by default):
+ *  - assembly: Spatial::assemble_jacobian directly into BAIJ storage vs. into face storage
+ *  - the product with a vector: MatMult vs. \ref FaceJacobian::apply
+ *  - a block SGS preconditioner application: MatSOR with SOR_LOCAL_SYMMETRIC_SWEEP, which is
+ *    sequential in the natural ordering, vs. \ref FaceJacobian::apply_sgs, which is thread-parallel
+ *    in a multicolour ordering
+ * The memory used by the matrices on rank 0 and the average time per operation (max over all
+ * ranks) are reported.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscmat.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/facejacobian.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of the face-based Jacobian against PETSc BAIJ.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of the face-based Jacobian")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	const BAIJJacobianLayout<NVARS> layout(m, A);
+
+	FaceJacobian<NVARS> facejac(m);
+	ierr = spatial->assemble_jacobian(u, facejac); CHKERRQ(ierr);
+	facejac.invert_diagonal_blocks();
+
+	MatInfo info;
+	ierr = MatGetInfo(A, MAT_LOCAL, &info); CHKERRQ(ierr);
+
+	Vec x, y;
+	ierr = MatCreateVecs(A, &x, &y); CHKERRQ(ierr);
+	ierr = VecSet(x, 1.0); CHKERRQ(ierr);
+
+	const int ne = static_cast<int>(nevals);
+	const std::vector<double> baijtimes = {
+		timeOperation([&]() {
+				MatZeroEntries(A);
+				spatial->assemble_jacobian(u, layout, A); }, ne),
+		timeOperation([&]() { MatMult(A, x, y); }, ne),
+		timeOperation([&]() {
+				MatSOR(A, x, 1.0, (MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),
+				       0.0, 1, 1, y); }, ne)
+	};
+
+	std::vector<double> facetimes;
+	facetimes.push_back(timeOperation([&]() {
+				facejac.set_zero();
+				spatial->assemble_jacobian(u, facejac); }, ne));
+	{
+		std::vector<freal> work(m.gnelem()*NVARS);
+		ConstVecHandler<freal> xh(x);
+		MutableVecHandler<freal> yh(y);
+		facetimes.push_back(timeOperation([&]() { facejac.apply(xh.getArray(), yh.getArray()); },
+		                                  ne));
+		facetimes.push_back(timeOperation([&]() {
+					facejac.apply_sgs(xh.getArray(), work.data(), yh.getArray()); }, ne));
+	}
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << mpisize << " ranks, "
+			<< nevals << " evaluations\n";
+		std::cout << "Storage on rank 0 (bytes): BAIJ " << static_cast<size_t>(info.memory)
+			<< ", face-based " << facejac.storage_bytes()
+			<< " (including inverse diagonal blocks)\n";
+		std::cout << std::setw(16) << "Operation" << std::setw(16) << "BAIJ (s)"
+			<< std::setw(16) << "Face-based (s)" << std::setw(10) << "Speedup" << '\n';
+		const std::string opnames[] = {"Assembly", "Mult", "SGS sweep"};
+		for(int iop = 0; iop < 3; iop++)
+			std::cout << std::setw(16) << opnames[iop] << std::setprecision(5)
+				<< std::setw(16) << baijtimes[iop]
+				<< std::setw(16) << facetimes[iop]
+				<< std::setw(10) << std::setprecision(4) << baijtimes[iop]/facetimes[iop] << '\n';
+		std::cout << std::flush;
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
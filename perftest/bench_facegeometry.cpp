@@ -0,0 +1,277 @@
+/** \file bench_facegeometry.cpp
+ * \brief Compares face loops that gather geometric data from the mesh with ones that read the
+ *   packed per-face records of \ref FaceGeometry
+ *
+ * Usage: bench_facegeometry <mesh file> [<cell ordering>] [<number of repetitions>]
+ * The cell ordering can be natural (the default), hilbert or morton.
+ *
+ * The two face loops of a second-order viscous residual evaluation are timed:
+ *  - reconstruction: the left and right states at each face are extrapolated from the cell-centred
+ *    states and gradients,
+ *  - flux: an upwind convective flux of the face states plus a diffusive flux computed from the
+ *    modified-average face gradient is scattered to the residuals of the two cells.
+ * In the "gathered" version, the face normal and length are read from the face metric, the face
+ * centre from the array of face centres and the centres of the two adjacent cells are gathered
+ * (in both loops) through the face's cell indices; the distance between the cell centres is
+ * recomputed in the flux loop. The "packed" version reads everything from one stream of
+ * FaceGeometry records. The number of bytes of geometric data read per face, and the average time
+ * of the two loops, are reported for each.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+#include "mesh/mesh.hpp"
+#include "mesh/meshordering.hpp"
+#include "spatial/facegeometry.hpp"
+
+using namespace fvens;
+
+/// Geometric data as it is stored in the mesh and spatial discretization without packing
+struct GatheredGeometry
+{
+	const UMesh<freal,NDIM> *m;
+	std::vector<freal> rc;            ///< Centres of all cells, followed by those of ghost cells
+	amat::Array2d<freal> gr;          ///< Face centres
+};
+
+/// Cell-centred data and face states shared by both versions
+struct FlowData
+{
+	std::vector<freal> u;             ///< Cell-centred states
+	std::vector<freal> grad;          ///< Cell-centred gradients, NDIM x NVARS per cell
+	std::vector<freal> uleft;         ///< Left state at each face
+	std::vector<freal> uright;        ///< Right state at each face
+	std::vector<freal> res;           ///< Residuals
+};
+
+static constexpr freal diffcoeff = 1e-2;
+
+/// Convective and diffusive flux from the face states and the face gradient
+static inline void faceFlux(const freal *const n, const freal len,
+                            const freal *const ul, const freal *const ur,
+                            const freal gradf[NDIM][NVARS], freal *const flux)
+{
+	const freal vn = 0.5*(n[0]*(ul[1]+ur[1]) + n[1]*(ul[2]+ur[2]));
+	for(int ivar = 0; ivar < NVARS; ivar++) {
+		freal gn = 0;
+		for(int idim = 0; idim < NDIM; idim++)
+			gn += gradf[idim][ivar]*n[idim];
+		flux[ivar] = len*((vn >= 0 ? vn*ul[ivar] : vn*ur[ivar]) - diffcoeff*gn);
+	}
+}
+
+/// Modified-average face gradient, as in Spatial::getFaceGradient_modifiedAverage
+static inline void faceGradient(const freal *const dr, const freal invdist,
+                                const freal *const ucl, const freal *const ucr,
+                                const freal *const gradl, const freal *const gradr,
+                                freal gradf[NDIM][NVARS])
+{
+	for(int ivar = 0; ivar < NVARS; ivar++) {
+		freal davg[NDIM], ddr = 0;
+		for(int idim = 0; idim < NDIM; idim++) {
+			davg[idim] = 0.5*(gradl[idim*NVARS+ivar] + gradr[idim*NVARS+ivar]);
+			ddr += davg[idim]*dr[idim];
+		}
+		const freal corr = (ucr[ivar]-ucl[ivar])*invdist;
+		for(int idim = 0; idim < NDIM; idim++)
+			gradf[idim][ivar] = davg[idim] - ddr*dr[idim] + corr*dr[idim];
+	}
+}
+
+static void faceLoopsGathered(const GatheredGeometry& g, FlowData& d)
+{
+	const UMesh<freal,NDIM>& m = *g.m;
+
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+	{
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			freal ul = d.u[lelem*NVARS+ivar], ur = d.u[relem*NVARS+ivar];
+			for(int idim = 0; idim < NDIM; idim++) {
+				ul += d.grad[(lelem*NDIM+idim)*NVARS+ivar]*(g.gr(iface,idim) - g.rc[lelem*NDIM+idim]);
+				ur += d.grad[(relem*NDIM+idim)*NVARS+ivar]*(g.gr(iface,idim) - g.rc[relem*NDIM+idim]);
+			}
+			d.uleft[iface*NVARS+ivar] = ul;
+			d.uright[iface*NVARS+ivar] = ur;
+		}
+	}
+
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+	{
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+		freal n[NDIM];
+		for(int idim = 0; idim < NDIM; idim++)
+			n[idim] = m.gfacemetric(iface,idim);
+		const freal len = m.gfacemetric(iface,NDIM);
+
+		freal dr[NDIM], dist = 0;
+		for(int idim = 0; idim < NDIM; idim++) {
+			dr[idim] = g.rc[relem*NDIM+idim] - g.rc[lelem*NDIM+idim];
+			dist += dr[idim]*dr[idim];
+		}
+		dist = std::sqrt(dist);
+		for(int idim = 0; idim < NDIM; idim++)
+			dr[idim] /= dist;
+
+		freal gradf[NDIM][NVARS], flux[NVARS];
+		faceGradient(dr, 1.0/dist, &d.u[lelem*NVARS], &d.u[relem*NVARS],
+		             &d.grad[lelem*NDIM*NVARS], &d.grad[relem*NDIM*NVARS], gradf);
+		faceFlux(n, len, &d.uleft[iface*NVARS], &d.uright[iface*NVARS], gradf, flux);
+
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			d.res[lelem*NVARS+ivar] -= flux[ivar];
+			d.res[relem*NVARS+ivar] += flux[ivar];
+		}
+	}
+}
+
+static void faceLoopsPacked(const UMesh<freal,NDIM>& m, const std::vector<FaceGeometry<freal>>& fg,
+                            FlowData& d)
+{
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+	{
+		const FaceGeometry<freal>& f = fg[iface];
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			freal ul = d.u[lelem*NVARS+ivar], ur = d.u[relem*NVARS+ivar];
+			for(int idim = 0; idim < NDIM; idim++) {
+				ul += d.grad[(lelem*NDIM+idim)*NVARS+ivar]*f.drl[idim];
+				ur += d.grad[(relem*NDIM+idim)*NVARS+ivar]*f.drr[idim];
+			}
+			d.uleft[iface*NVARS+ivar] = ul;
+			d.uright[iface*NVARS+ivar] = ur;
+		}
+	}
+
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+	{
+		const FaceGeometry<freal>& f = fg[iface];
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+
+		freal gradf[NDIM][NVARS], flux[NVARS];
+		faceGradient(f.dr, f.invdist, &d.u[lelem*NVARS], &d.u[relem*NVARS],
+		             &d.grad[lelem*NDIM*NVARS], &d.grad[relem*NDIM*NVARS], gradf);
+		faceFlux(f.normal, f.len, &d.uleft[iface*NVARS], &d.uright[iface*NVARS], gradf, flux);
+
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			d.res[lelem*NVARS+ivar] -= flux[ivar];
+			d.res[relem*NVARS+ivar] += flux[ivar];
+		}
+	}
+}
+
+static FlowData initFlowData(const fint ncells, const fint nfaces)
+{
+	FlowData d;
+	d.u.resize(ncells*NVARS);
+	d.grad.resize(ncells*NDIM*NVARS);
+	d.uleft.resize(nfaces*NVARS);
+	d.uright.resize(nfaces*NVARS);
+	d.res.assign(ncells*NVARS, 0);
+	for(size_t i = 0; i < d.u.size(); i++)
+		d.u[i] = 1.0 + 1e-3*static_cast<freal>(i % 17);
+	for(size_t i = 0; i < d.grad.size(); i++)
+		d.grad[i] = 1e-2*static_cast<freal>(i % 13) - 0.06;
+	return d;
+}
+
+/// Returns the average time in seconds of one pass of both face loops
+template <typename LoopFunc>
+static double timeLoops(LoopFunc loops, FlowData& d, const int nrepeat, double& checksum)
+{
+	loops(d);
+
+	const auto start = std::chrono::steady_clock::now();
+	for(int irep = 0; irep < nrepeat; irep++)
+		loops(d);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	checksum = 0;
+	for(size_t i = 0; i < d.res.size(); i++)
+		checksum += std::abs(d.res[i]);
+	return elapsed.count()/nrepeat;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "Usage: " << argv[0]
+			<< " <mesh file> [<cell ordering>] [<number of repetitions>]" << std::endl;
+		return -1;
+	}
+
+	const std::string meshfile = argv[1];
+	const std::string cellordering = argc > 2 ? argv[2] : "natural";
+	const int nrepeat = argc > 3 ? std::stoi(argv[3]) : 100;
+
+	UMesh<freal,NDIM> m(readMesh(meshfile));
+	if(cellordering == "hilbert" || cellordering == "morton")
+		spaceFillingCurveReorder(m, cellordering);
+	else if(cellordering != "natural") {
+		std::cout << "Unknown cell ordering " << cellordering << std::endl;
+		return -1;
+	}
+	m.compute_topological();
+	m.compute_areas();
+	m.compute_face_data();
+
+	// Ghost cells of physical boundary faces come after the connectivity ghost cells
+	const fint ncells = m.gnelem() + m.gnConnFace() + m.gnbface();
+
+	GatheredGeometry g;
+	g.m = &m;
+	g.rc.resize(ncells*NDIM);
+	m.compute_cell_centres(g.rc.data());
+	g.gr.resize(m.gnaface(), NDIM);
+	g.gr.zeros();
+	for(fint iface = 0; iface < m.gnaface(); iface++) {
+		for(int inode = 0; inode < m.gnnofa(iface); inode++)
+			for(int idim = 0; idim < NDIM; idim++)
+				g.gr(iface,idim) += m.gcoords(m.gintfac(iface,2+inode),idim)/m.gnnofa(iface);
+	}
+	// ghost cell centres are reflections of the interior cell centres about the face centres
+	freal *const rcbp = g.rc.data() + (m.gnelem()+m.gnConnFace())*NDIM;
+	for(fint iface = m.gPhyBFaceStart(); iface < m.gPhyBFaceEnd(); iface++)
+		for(int idim = 0; idim < NDIM; idim++)
+			rcbp[(iface-m.gPhyBFaceStart())*NDIM+idim]
+				= 2.0*g.gr(iface,idim) - g.rc[m.gintfac(iface,0)*NDIM+idim];
+
+	const std::vector<FaceGeometry<freal>> fg = computeFaceGeometry(m, g.rc.data(), rcbp, g.gr);
+
+	/* Geometric data read per face: in the gathered version, the face centre and the two cell
+	 * centres in the reconstruction loop and the face metric and the two cell centres again in
+	 * the flux loop; in the packed version, one record.
+	 */
+	const double gatheredbytes = (NDIM + 2*NDIM + (NDIM+1) + 2*NDIM)*sizeof(freal);
+	const double packedbytes = sizeof(FaceGeometry<freal>);
+
+	std::cout << "Mesh file: " << meshfile << ", " << cellordering << " cell ordering, "
+		<< m.gnaface() << " faces, " << nrepeat << " repetitions\n";
+	std::cout << std::setw(12) << "Geometry" << std::setw(18) << "Bytes/face"
+		<< std::setw(18) << "Time/pass (s)" << std::setw(18) << "Relative time" << '\n';
+
+	double checksum[2];
+	FlowData d1 = initFlowData(ncells, m.gnaface());
+	const double tgathered = timeLoops([&g](FlowData& d) { faceLoopsGathered(g, d); },
+	                                   d1, nrepeat, checksum[0]);
+	FlowData d2 = initFlowData(ncells, m.gnaface());
+	const double tpacked = timeLoops([&m,&fg](FlowData& d) { faceLoopsPacked(m, fg, d); },
+	                                 d2, nrepeat, checksum[1]);
+
+	std::cout << std::setw(12) << "gathered" << std::setw(18) << gatheredbytes
+		<< std::setw(18) << std::setprecision(5) << tgathered
+		<< std::setw(18) << std::setprecision(4) << 1.0
+		<< "    (checksum " << checksum[0] << ")\n";
+	std::cout << std::setw(12) << "packed" << std::setw(18) << packedbytes
+		<< std::setw(18) << std::setprecision(5) << tpacked
+		<< std::setw(18) << std::setprecision(4) << tpacked/tgathered
+		<< "    (checksum " << checksum[1] << ")\n";
+	std::cout << std::flush;
+
+	return 0;
+}
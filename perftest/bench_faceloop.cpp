@@ -0,0 +1,178 @@
+/** \file bench_faceloop.cpp
+ * \brief Measures the effect of the order of faces within each face block on face-loop bandwidth
+ *
+ * Usage: bench_faceloop <mesh file> [<cell ordering>] [<number of repetitions>]
+ * The cell ordering can be natural (the default), hilbert or morton.
+ *
+ * A face loop typical of the residual computation is timed: for each face, the states of the two
+ * adjacent cells are read, a flux is computed from them and the face normal and is scattered to
+ * the residuals of the two cells. The face data (cell indices and normals) is always stored in
+ * the order in which it is traversed, so only the access pattern into the cell arrays differs
+ * among the face orders compared:
+ *  - "sorted": the order of the mesh's faces, which are sorted by their cells in each block
+ *  - "unsorted": the interior faces in the order of their left cells but not their right cells,
+ *    and the boundary faces in the order of the mesh file, as generated before faces were sorted
+ *  - "shuffled": a random permutation of the faces within each block
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "mesh/mesh.hpp"
+#include "mesh/meshordering.hpp"
+
+using namespace fvens;
+
+/// Face data laid out in the order of traversal
+struct FaceLoopData
+{
+	std::vector<fint> lr;        ///< Left and right cell of each face
+	std::vector<freal> normal;   ///< Unit normal and length of each face
+};
+
+/// Gathers the face data of the mesh's faces in the given order
+static FaceLoopData gatherFaceData(const UMesh<freal,NDIM>& m, const std::vector<fint>& faces)
+{
+	FaceLoopData fd;
+	fd.lr.resize(2*faces.size());
+	fd.normal.resize((NDIM+1)*faces.size());
+	for(size_t i = 0; i < faces.size(); i++) {
+		fd.lr[2*i] = m.gintfac(faces[i],0);
+		fd.lr[2*i+1] = m.gintfac(faces[i],1);
+		for(int j = 0; j < NDIM+1; j++)
+			fd.normal[(NDIM+1)*i+j] = m.gfacemetric(faces[i],j);
+	}
+	return fd;
+}
+
+/// A simple upwinded flux of each face scattered to the residuals of its cells
+static void faceLoop(const FaceLoopData& fd, const std::vector<freal>& u, std::vector<freal>& res)
+{
+	const fint nface = static_cast<fint>(fd.lr.size()/2);
+	for(fint iface = 0; iface < nface; iface++)
+	{
+		const fint lelem = fd.lr[2*iface], relem = fd.lr[2*iface+1];
+		const freal *const n = &fd.normal[(NDIM+1)*iface];
+		const freal vn = 0.5*(n[0]*(u[lelem*NVARS+1]+u[relem*NVARS+1])
+		                      + n[1]*(u[lelem*NVARS+2]+u[relem*NVARS+2]));
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			const freal flux = n[2]*(vn >= 0 ? vn*u[lelem*NVARS+ivar] : vn*u[relem*NVARS+ivar]);
+			res[lelem*NVARS+ivar] -= flux;
+			res[relem*NVARS+ivar] += flux;
+		}
+	}
+}
+
+/// Returns the average time in seconds of one face loop
+static double timeFaceLoop(const FaceLoopData& fd, const fint ncells, const int nrepeat,
+                           double& checksum)
+{
+	std::vector<freal> u(ncells*NVARS), res(ncells*NVARS, 0);
+	for(fint i = 0; i < ncells*NVARS; i++)
+		u[i] = 1.0 + 1e-3*(i % 17);
+
+	faceLoop(fd, u, res);
+
+	const auto start = std::chrono::steady_clock::now();
+	for(int irep = 0; irep < nrepeat; irep++)
+		faceLoop(fd, u, res);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	checksum = 0;
+	for(fint i = 0; i < ncells*NVARS; i++)
+		checksum += res[i];
+	return elapsed.count()/nrepeat;
+}
+
+/// Face order generated by the face connectivity computation before faces were sorted
+static std::vector<fint> getUnsortedOrder(const UMesh<freal,NDIM>& m)
+{
+	std::vector<fint> faces;
+	for(fint ibface = 0; ibface < m.gnbface(); ibface++)
+		faces.push_back(m.gPhyBFaceIndex(ibface));
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(EIndex ifael = 0; ifael < m.gnfael(iel); ifael++) {
+			const fint iface = m.gelemface(iel,ifael);
+			if(iface >= m.gSubDomFaceStart() && iface < m.gSubDomFaceEnd()
+			   && m.gintfac(iface,0) == iel)
+				faces.push_back(iface);
+		}
+	for(fint iface = m.gConnBFaceStart(); iface < m.gConnBFaceEnd(); iface++)
+		faces.push_back(iface);
+	return faces;
+}
+
+/// Random permutation of the faces within each block
+static std::vector<fint> getShuffledOrder(const UMesh<freal,NDIM>& m)
+{
+	std::vector<fint> faces(m.gnaface());
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+		faces[iface] = iface;
+	std::mt19937 gen(42);
+	std::shuffle(faces.begin()+m.gPhyBFaceStart(), faces.begin()+m.gPhyBFaceEnd(), gen);
+	std::shuffle(faces.begin()+m.gSubDomFaceStart(), faces.begin()+m.gSubDomFaceEnd(), gen);
+	std::shuffle(faces.begin()+m.gConnBFaceStart(), faces.begin()+m.gConnBFaceEnd(), gen);
+	return faces;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "Usage: " << argv[0]
+			<< " <mesh file> [<cell ordering>] [<number of repetitions>]" << std::endl;
+		return -1;
+	}
+
+	const std::string meshfile = argv[1];
+	const std::string cellordering = argc > 2 ? argv[2] : "natural";
+	const int nrepeat = argc > 3 ? std::stoi(argv[3]) : 200;
+
+	UMesh<freal,NDIM> m(readMesh(meshfile));
+	if(cellordering == "hilbert" || cellordering == "morton")
+		spaceFillingCurveReorder(m, cellordering);
+	else if(cellordering != "natural") {
+		std::cout << "Unknown cell ordering " << cellordering << std::endl;
+		return -1;
+	}
+	m.compute_topological();
+	m.compute_areas();
+	m.compute_face_data();
+
+	// Ghost cells of physical boundary faces come after the connectivity ghost cells
+	const fint ncells = m.gnelem() + m.gnConnFace() + m.gnbface();
+
+	std::vector<fint> sorted(m.gnaface());
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+		sorted[iface] = iface;
+
+	const std::vector<std::string> names = {"sorted", "unsorted", "shuffled"};
+	const std::vector<std::vector<fint>> orders = {sorted, getUnsortedOrder(m), getShuffledOrder(m)};
+
+	// Bytes moved per face: cell indices, normal, two states and two residuals read and written
+	const double bytesperface = 2*sizeof(fint) + (NDIM+1)*sizeof(freal) + 6*NVARS*sizeof(freal);
+
+	std::cout << "Mesh file: " << meshfile << ", " << cellordering << " cell ordering, "
+		<< m.gnaface() << " faces, " << nrepeat << " repetitions\n";
+	std::cout << std::setw(12) << "Face order" << std::setw(18) << "Time/loop (s)"
+		<< std::setw(18) << "Bandwidth (GB/s)" << std::setw(18) << "Relative time" << '\n';
+
+	std::vector<double> times(orders.size());
+	for(size_t i = 0; i < orders.size(); i++)
+	{
+		double checksum;
+		times[i] = timeFaceLoop(gatherFaceData(m, orders[i]), ncells, nrepeat, checksum);
+		std::cout << std::setw(12) << names[i] << std::setw(18) << std::setprecision(5) << times[i]
+			<< std::setw(18) << std::setprecision(4)
+			<< bytesperface*m.gnaface()/times[i]*1e-9
+			<< std::setw(18) << std::setprecision(4) << times[i]/times[0]
+			<< "    (checksum " << checksum << ")\n";
+	}
+	std::cout << std::flush;
+
+	return 0;
+}
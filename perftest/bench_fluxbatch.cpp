@@ -0,0 +1,185 @@
+/** \file bench_fluxbatch.cpp
+ * \brief Compares the throughput of single-face and batched numerical flux computation
+ *
+ * Usage: bench_fluxbatch [<number of faces>] [<number of repetitions>]
+ * Random states and unit normals are generated for the faces. For each numerical flux, the fluxes
+ * of all faces are computed with one call to \ref InviscidFlux::get_flux per face and with one
+ * call to \ref InviscidFlux::get_flux_batch per batch of \ref FACE_BATCH faces. As in the residual
+ * computation, the batched version includes gathering the states and normals of each batch from
+ * face-by-face storage and scattering the fluxes back. The batched kernel is also timed alone, on
+ * states and normals already stored batch by batch. The number of faces processed per second in
+ * each case is reported, along with the maximum difference between the fluxes of the single-face
+ * and batched versions (relative to the magnitude of the flux, if larger than 1). Fluxes without a vectorized batched implementation
+ * (\ref InviscidFlux::vectorized_batch) are marked with an asterisk.
+ *
+ * Build with -DAVX_2=1 or -DSKYLAKE=1 (AVX-512) in a release build to compare instruction sets.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "spatial/anumericalflux.hpp"
+
+using namespace fvens;
+
+/// Computes the fluxes of all faces one face at a time
+static void fluxesSingle(const InviscidFlux<freal>& flux, const fint nfaces,
+                         const std::vector<freal>& ul, const std::vector<freal>& ur,
+                         const std::vector<freal>& n, std::vector<freal>& f)
+{
+	for(fint iface = 0; iface < nfaces; iface++)
+		flux.get_flux(&ul[iface*NVARS], &ur[iface*NVARS], &n[iface*NDIM], &f[iface*NVARS]);
+}
+
+/// Computes the fluxes of all faces batch by batch
+static void fluxesBatched(const InviscidFlux<freal>& flux, const fint nfaces,
+                          const std::vector<freal>& ul, const std::vector<freal>& ur,
+                          const std::vector<freal>& n, std::vector<freal>& f)
+{
+	alignas(64) freal bul[NVARS][FACE_BATCH], bur[NVARS][FACE_BATCH], bn[NDIM][FACE_BATCH],
+		bflux[NVARS][FACE_BATCH];
+
+	for(fint ibeg = 0; ibeg < nfaces; ibeg += FACE_BATCH)
+	{
+		const int nb = std::min(FACE_BATCH, nfaces-ibeg);
+		for(int i = 0; i < FACE_BATCH; i++) {
+			const fint iface = ibeg + std::min(i, nb-1);
+			for(int ivar = 0; ivar < NVARS; ivar++) {
+				bul[ivar][i] = ul[iface*NVARS+ivar];
+				bur[ivar][i] = ur[iface*NVARS+ivar];
+			}
+			for(int idim = 0; idim < NDIM; idim++)
+				bn[idim][i] = n[iface*NDIM+idim];
+		}
+
+		flux.get_flux_batch(bul, bur, bn, bflux);
+
+		for(int i = 0; i < nb; i++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				f[(ibeg+i)*NVARS+ivar] = bflux[ivar][i];
+	}
+}
+
+/// States, normals and fluxes of one batch of faces
+struct FaceBatchData
+{
+	freal ul[NVARS][FACE_BATCH];
+	freal ur[NVARS][FACE_BATCH];
+	freal n[NDIM][FACE_BATCH];
+	freal flux[NVARS][FACE_BATCH];
+};
+
+/// Returns the number of faces processed per second by a flux computation function
+template <typename Func>
+static double facesPerSecond(const Func& func, const fint nfaces, const int nrepeat)
+{
+	func();
+	const auto start = std::chrono::steady_clock::now();
+	for(int irep = 0; irep < nrepeat; irep++)
+		func();
+	const auto end = std::chrono::steady_clock::now();
+	return static_cast<double>(nfaces)*nrepeat / std::chrono::duration<double>(end-start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	const fint nfaces = argc > 1 ? std::stoi(argv[1]) : 1000000;
+	const int nrepeat = argc > 2 ? std::stoi(argv[2]) : 10;
+
+	const IdealGasPhysics<freal> phy(1.4, 0.5, 288.15, 5.0e6, 0.72);
+
+	// States with positive density and pressure and subsonic to supersonic velocities
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<freal> rhodist(0.5, 1.5), veldist(-1.5, 1.5),
+		pdist(1.0, 5.0), angledist(0, 2*PI);
+	std::vector<freal> ul(nfaces*NVARS), ur(nfaces*NVARS), n(nfaces*NDIM);
+	for(fint iface = 0; iface < nfaces; iface++)
+	{
+		for(freal *const u : {&ul[iface*NVARS], &ur[iface*NVARS]}) {
+			const freal rho = rhodist(gen), vx = veldist(gen), vy = veldist(gen), p = pdist(gen);
+			const freal prim[NVARS] = {rho, vx, vy, p};
+			phy.getConservedFromPrimitive(prim, u);
+		}
+		const freal angle = angledist(gen);
+		n[iface*NDIM] = std::cos(angle);
+		n[iface*NDIM+1] = std::sin(angle);
+	}
+
+	const std::vector<std::pair<std::string,const InviscidFlux<freal>*>> fluxes = {
+		{"ROE", new RoeFlux<freal>(&phy)},
+		{"HLLC", new HLLCFlux<freal>(&phy)},
+		{"HLL", new HLLFlux<freal>(&phy)},
+		{"LLF", new LocalLaxFriedrichsFlux<freal>(&phy)},
+		{"AUSMPLUS", new AUSMPlusFlux<freal>(&phy)},
+		{"VANLEER", new VanLeerFlux<freal>(&phy)}
+	};
+
+#if defined(__AVX512F__)
+	const std::string isa = "AVX-512";
+#elif defined(__AVX2__)
+	const std::string isa = "AVX2";
+#elif defined(__AVX__)
+	const std::string isa = "AVX";
+#else
+	const std::string isa = "default";
+#endif
+	std::cout << nfaces << " faces, " << nrepeat << " repetitions, " << isa
+		<< " instructions, batches of " << FACE_BATCH << " faces\n";
+	std::cout << std::setw(10) << "Flux" << std::setw(18) << "Single (face/s)"
+		<< std::setw(18) << "Batched (face/s)" << std::setw(18) << "Kernel (face/s)"
+		<< std::setw(12) << "Speedup"
+		<< std::setw(18) << "Max. diff." << '\n';
+
+	// pre-packed batches, the last one padded with copies of the last face
+	const fint nbatches = (nfaces + FACE_BATCH-1)/FACE_BATCH;
+	std::vector<FaceBatchData> batches(nbatches);
+	for(fint ib = 0; ib < nbatches; ib++)
+		for(int i = 0; i < FACE_BATCH; i++) {
+			const fint iface = std::min(ib*FACE_BATCH + i, nfaces-1);
+			for(int ivar = 0; ivar < NVARS; ivar++) {
+				batches[ib].ul[ivar][i] = ul[iface*NVARS+ivar];
+				batches[ib].ur[ivar][i] = ur[iface*NVARS+ivar];
+			}
+			for(int idim = 0; idim < NDIM; idim++)
+				batches[ib].n[idim][i] = n[iface*NDIM+idim];
+		}
+
+	std::vector<freal> fsingle(nfaces*NVARS), fbatched(nfaces*NVARS);
+	for(const auto& flux : fluxes)
+	{
+		const double single = facesPerSecond([&]() {
+				fluxesSingle(*flux.second, nfaces, ul, ur, n, fsingle);
+			}, nfaces, nrepeat);
+		const double batched = facesPerSecond([&]() {
+				fluxesBatched(*flux.second, nfaces, ul, ur, n, fbatched);
+			}, nfaces, nrepeat);
+		const double kernel = facesPerSecond([&]() {
+				for(FaceBatchData& b : batches)
+					flux.second->get_flux_batch(b.ul, b.ur, b.n, b.flux);
+			}, nfaces, nrepeat);
+
+		freal maxdiff = 0;
+		for(fint i = 0; i < nfaces*NVARS; i++)
+			maxdiff = std::max(maxdiff,
+			                   std::abs(fbatched[i]-fsingle[i])/std::max(std::abs(fsingle[i]),1.0));
+
+		std::cout << std::setw(10)
+			<< (flux.second->vectorized_batch() ? flux.first : flux.first+"*")
+			<< std::setw(18) << std::setprecision(4) << single
+			<< std::setw(18) << std::setprecision(4) << batched
+			<< std::setw(18) << std::setprecision(4) << kernel
+			<< std::setw(12) << std::setprecision(3) << batched/single
+			<< std::setw(18) << std::setprecision(3) << maxdiff << '\n';
+
+		delete flux.second;
+	}
+	std::cout << std::flush;
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+/** \file bench_fused_residual.cpp
+ * \brief Compares the fused single-pass residual computation with the multi-pass one
+ *
+ * Usage: bench_fused_residual <control file> [-options_file <PETSc options file>]
+ *   [-bench_num_evals <n>]
+ * The case described by the control file is set up once. With the fused residual (see
+ * \ref FlowNumericsConfig::fused_residual) off and on, the residual and local time steps are
+ * computed n times (100 by default) at the initial state. The average time per evaluation and the
+ * speedup over the multi-pass computation are reported, along with the relative difference of the
+ * residual from that of the multi-pass computation.
+ *
+ * A modeled amount of memory traffic through face state arrays per evaluation is also reported.
+ * The model counts each pass over the left and right states of faces as reading or writing
+ * 2 x NVARS reals per face: the multi-pass computation reconstructs the states (one write),
+ * converts them to conserved variables (one read and one write) and then reads them for the
+ * fluxes and for the time steps. The first-order multi-pass computation copies cell states into
+ * the face arrays instead of reconstructing and converting them. The fused computation only stores
+ * states at connectivity faces, but it reads a limiter value per variable for each face side
+ * and writes them once per cell; these are counted too. Cache effects are ignored.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscvec.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Returns the modeled number of bytes of face state (and limiter) arrays read and written in one
+///  residual evaluation on this rank
+static double modeledTraffic(const UMesh<freal,NDIM>& m, const bool order2, const bool fused)
+{
+	const double statebytes = 2.0*NVARS*sizeof(freal);
+	if(!fused)
+		return (order2 ? 5 : 3) * statebytes * m.gnaface();
+
+	// connectivity face states written and read once, plus the limiters
+	return order2 ?
+		2 * statebytes * m.gnConnFace() + NVARS*sizeof(freal)*(m.gnelem() + 2.0*m.gnaface())
+		: 0;
+}
+
+/// Times residual evaluations with the fused residual computation on or off
+/** \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ * \param[in,out] res On output, the residual at u
+ */
+static StatusCode benchmarkResidual(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                                    const bool fused, const int nevals, const Vec u, Vec res,
+                                    Vec dtm, double& evaltime)
+{
+	FlowParserOptions aopts = opts;
+	aopts.fused_residual = fused;
+	return timeResidual(aopts, m, nevals, u, res, dtm, evaltime);
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of fused and multi-pass residual computation.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of fused residual computation")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	Vec u, res, refres, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &refres); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	double reftime = 0;
+	PetscReal refnorm = 0;
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << nevals << " evaluations\n";
+		std::cout << std::setw(12) << "Residual" << std::setw(18) << "Time/eval (s)"
+			<< std::setw(12) << "Speedup" << std::setw(20) << "Face arrays (MB)"
+			<< std::setw(20) << "Rel. difference" << '\n';
+	}
+
+	for(const bool fused : {false, true})
+	{
+		double evaltime;
+		ierr = benchmarkResidual(opts, m, fused, static_cast<int>(nevals), u, res, dtm, evaltime);
+		CHKERRQ(ierr);
+
+		PetscReal diffnorm = 0;
+		if(!fused) {
+			reftime = evaltime;
+			ierr = VecCopy(res, refres); CHKERRQ(ierr);
+			ierr = VecNorm(refres, NORM_2, &refnorm); CHKERRQ(ierr);
+		}
+		else {
+			ierr = VecAXPY(res, -1.0, refres); CHKERRQ(ierr);
+			ierr = VecNorm(res, NORM_2, &diffnorm); CHKERRQ(ierr);
+		}
+
+		// other reconstructions fall back to the multi-pass computation
+		const bool fusedused = fused && (!opts.order2 || opts.limiter == "NONE"
+		                                 || opts.limiter == "BARTHJESPERSEN"
+		                                 || opts.limiter == "VENKATAKRISHNAN");
+		double traffic = modeledTraffic(m, opts.order2, fusedused);
+		MPI_Allreduce(MPI_IN_PLACE, &traffic, 1, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+
+		if(mpirank == 0)
+			std::cout << std::setw(12) << (fused ? "FUSED" : "MULTIPASS")
+				<< std::setw(18) << std::setprecision(5) << evaltime
+				<< std::setw(12) << std::setprecision(4) << reftime/evaltime
+				<< std::setw(20) << std::setprecision(4) << traffic/1.0e6
+				<< std::setw(20) << std::setprecision(4) << diffnorm/refnorm << '\n';
+	}
+	if(mpirank == 0)
+		std::cout << std::flush;
+
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&refres); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,129 @@
+/** \file bench_ghost_layer.cpp
+ * \brief Measures the cost of the halo communication of WENO reconstruction with and without the
+ *  second ghost layer
+ *
+ * Usage: mpirun -n <p> bench_ghost_layer <control file> [-options_file <PETSc options file>]
+ *   [-bench_num_evals <n>]
+ * The case described by the control file is set up once with WENO reconstruction. With
+ * \ref FlowNumericsConfig::second_ghost_layer off and on, the residual and local time steps are
+ * computed n times (100 by default) at the initial state. The average time per evaluation (max
+ * over all ranks) is reported for each.
+ *
+ * The number of messages and of values sent per residual evaluation, summed over all ranks, is also
+ * reported. Without the second layer, gradients at connectivity ghost cells and then face states
+ * at connectivity faces are exchanged with each neighbouring subdomain, one after the other. With
+ * it, gradients are sent in one step to each subdomain that needs them, which may include
+ * subdomains that touch this one only at a vertex.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <set>
+#include <petscvec.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "perftest_utils.hpp"
+#include "linalg/haloexchange.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Times residual evaluations with the second ghost layer on or off
+/** \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ */
+static StatusCode benchmarkResidual(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                                    const bool ghostlayer, const int nevals,
+                                    const Vec u, Vec res, Vec dtm, double& evaltime)
+{
+	FlowParserOptions aopts = opts;
+	aopts.second_ghost_layer = ghostlayer;
+	return timeResidual(aopts, m, nevals, u, res, dtm, evaltime);
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of the second ghost layer for WENO reconstruction.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of the second ghost layer for WENO reconstruction")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	opts.order2 = true;
+	opts.limiter = "WENO";
+	opts.fused_residual = false;
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	// Messages and values sent per residual evaluation, summed over ranks
+	double counts[4];
+	{
+		std::set<fint> nbds;
+		for(fint icface = 0; icface < m.gnConnFace(); icface++)
+			nbds.insert(m.gconnface(icface,2));
+		// gradients, then face states
+		counts[0] = 2.0*static_cast<double>(nbds.size());
+		counts[1] = static_cast<double>(m.gnConnFace())*(NDIM*NVARS + NVARS);
+
+		const SecondGhostLayer layer(m, PETSC_COMM_WORLD);
+		const GhostLayerExchange exch(layer, NDIM*NVARS);
+		counts[2] = exch.num_messages_sent();
+		counts[3] = static_cast<double>(exch.num_values_sent());
+		MPI_Allreduce(MPI_IN_PLACE, counts, 4, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+	}
+
+	Vec u, res, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	double times[2];
+	for(const bool ghostlayer : {false, true}) {
+		ierr = benchmarkResidual(opts, m, ghostlayer, static_cast<int>(nevals), u, res, dtm,
+		                         times[ghostlayer]);
+		CHKERRQ(ierr);
+	}
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << mpisize << " ranks, "
+			<< nevals << " evaluations\n";
+		std::cout << std::setw(14) << "Ghost layers" << std::setw(12) << "Messages"
+			<< std::setw(14) << "Values" << std::setw(16) << "Residual (s)" << '\n';
+		std::cout << std::setw(14) << 1 << std::setw(12) << counts[0] << std::setw(14) << counts[1]
+			<< std::setw(16) << std::setprecision(5) << times[0] << '\n';
+		std::cout << std::setw(14) << 2 << std::setw(12) << counts[2] << std::setw(14) << counts[3]
+			<< std::setw(16) << std::setprecision(5) << times[1] << '\n';
+		std::cout << "Time saved per evaluation (s): " << std::setprecision(4) << times[0]-times[1]
+			<< ", speedup " << times[0]/times[1] << std::endl;
+	}
+
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,131 @@
+/** \file bench_halo_exchange.cpp
+ * \brief Latency and bandwidth of halo exchanges through PETSc ghost updates and \ref HaloExchange
+ *
+ * Usage: mpirun -n <p> bench_halo_exchange <mesh file> [-bench_num_reps <n>]
+ * The mesh is partitioned among the ranks. For cell fields of increasing width, the average time of
+ * one exchange of ghost cell values (max over all ranks) is measured n times (1000 by default) with
+ * a PETSc ghosted vector and with a \ref HaloExchange. Small widths show the latency, large ones the
+ * bandwidth; the bandwidth is the total number of bytes sent by all ranks divided by the time.
+ *
+ * Then the exchange done by a second-order residual evaluation, states at connectivity faces and
+ * gradients at connectivity ghost cells, is timed as two separate exchanges (the trace vector and a
+ * PETSc ghost update) and as one combined exchange.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscvec.h>
+
+#include "utilities/mpiutils.hpp"
+#include "mesh/ameshutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/tracevector.hpp"
+#include "linalg/haloexchange.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+
+/// Returns the total number of bytes sent by all ranks in one exchange of a cell field
+static double exchangeBytes(const UMesh<freal,NDIM>& m, const int width)
+{
+	double bytes = static_cast<double>(m.gnConnFace())*width*sizeof(freal);
+	MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+	return bytes;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "A mesh file is required!" << std::endl;
+		return -1;
+	}
+	const std::string meshfile = argv[1];
+
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	PetscInt nreps = 1000;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_reps", &nreps, &set); CHKERRQ(ierr);
+	const int nr = static_cast<int>(nreps);
+
+	const UMesh<freal,NDIM> m = constructMesh(meshfile);
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << meshfile << ", " << mpisize << " ranks, " << nreps
+			<< " repetitions\n";
+		std::cout << std::setw(8) << "Width" << std::setw(16) << "PETSc (us)"
+			<< std::setw(16) << "Halo (us)" << std::setw(18) << "PETSc (MB/s)"
+			<< std::setw(18) << "Halo (MB/s)" << '\n';
+	}
+
+	for(const int width : {1, NVARS, NDIM*NVARS, 32, 128})
+	{
+		Vec v;
+		ierr = createGhostedSystemVector(&m, width, &v); CHKERRQ(ierr);
+		ierr = VecSet(v, 1.0); CHKERRQ(ierr);
+
+		const double petsctime = timeOperation([&]() {
+				VecGhostUpdateBegin(v, INSERT_VALUES, SCATTER_FORWARD);
+				VecGhostUpdateEnd(v, INSERT_VALUES, SCATTER_FORWARD);
+			}, nr);
+
+		HaloExchange halo(m, {{HALO_CELL, width}});
+		const double halotime = timeOperation([&]() {
+				MutableGhostedVecHandler<freal> vh(v);
+				const void *const sources[] = {vh.getArray()};
+				void *const targets[] = {vh.getArray()};
+				halo.begin(sources);
+				halo.end(targets);
+			}, nr);
+
+		const double bytes = exchangeBytes(m, width);
+		if(mpirank == 0)
+			std::cout << std::setw(8) << width
+				<< std::setw(16) << std::setprecision(4) << petsctime*1e6
+				<< std::setw(16) << std::setprecision(4) << halotime*1e6
+				<< std::setw(18) << std::setprecision(4) << bytes/petsctime/1e6
+				<< std::setw(18) << std::setprecision(4) << bytes/halotime/1e6 << '\n';
+
+		ierr = VecDestroy(&v); CHKERRQ(ierr);
+	}
+
+	// Face states and gradients, as in the residual computation
+	{
+		Vec gradvec;
+		ierr = createGhostedSystemVector(&m, NDIM*NVARS, &gradvec); CHKERRQ(ierr);
+		ierr = VecSet(gradvec, 1.0); CHKERRQ(ierr);
+		L2TraceVector<freal,NVARS> uface(m);
+
+		const double separatetime = timeOperation([&]() {
+				VecGhostUpdateBegin(gradvec, INSERT_VALUES, SCATTER_FORWARD);
+				uface.updateSharedFacesBegin();
+				uface.updateSharedFacesEnd();
+				VecGhostUpdateEnd(gradvec, INSERT_VALUES, SCATTER_FORWARD);
+			}, nr);
+
+		HaloExchange halo(m, {{HALO_TRACE, NVARS}, {HALO_CELL, NDIM*NVARS}});
+		const double combinedtime = timeOperation([&]() {
+				MutableGhostedVecHandler<freal> gh(gradvec);
+				const void *const sources[] = {uface.getLocalArrayLeft(), gh.getArray()};
+				halo.begin(sources);
+				void *const targets[] = {uface.getLocalArrayRight(), gh.getArray()};
+				halo.end(targets);
+			}, nr);
+
+		if(mpirank == 0)
+			std::cout << "\nStates and gradients: separate " << std::setprecision(4)
+				<< separatetime*1e6 << " us, combined " << combinedtime*1e6 << " us, speedup "
+				<< separatetime/combinedtime << std::endl;
+
+		ierr = VecDestroy(&gradvec); CHKERRQ(ierr);
+	}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,159 @@
+/** \file bench_jacobian_assembly.cpp
+ * \brief Compares the thread scaling of Jacobian assembly through MatSetValuesBlocked and directly
+ *  into BAIJ storage
+ *
+ * Usage: [mpirun -n <p>] bench_jacobian_assembly <control file>
+ *   [-options_file <PETSc options file>] [-bench_num_evals <n>] [-bench_max_threads <t>]
+ * The case described by the control file is set up once and its Jacobian matrix is assembled once
+ * to fix the non-zero structure. Then, for the generic assembly (with critical sections around
+ * MatSetValuesBlocked) and the direct assembly through a \ref BAIJJacobianLayout, and for 1, 2, 4..
+ * threads up to t (by default, the OpenMP maximum), the Jacobian is zeroed, computed and assembled
+ * n times (20 by default) at the initial state. The average time per assembly (max over all ranks)
+ * and the speedup over generic assembly on one thread are reported.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscmat.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/jacobianlayout.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Times Jacobian assemblies with or without a layout and with a given number of threads
+/** \param layout Block positions for direct assembly, or null for generic assembly
+ * \param[out] evaltime Average wall-clock time of one assembly, max over all ranks
+ */
+static StatusCode benchmarkAssembly(const Spatial<freal,NVARS> *const spatial,
+                                    const BAIJJacobianLayout<NVARS> *const layout,
+                                    const int nthreads, const int nevals, const Vec u, Mat A,
+                                    double& evaltime)
+{
+	StatusCode ierr = 0;
+#ifdef _OPENMP
+	omp_set_num_threads(nthreads);
+#endif
+
+	auto assemble = [&]() {
+		StatusCode jerr = MatZeroEntries(A);
+		if(layout)
+			jerr += spatial->assemble_jacobian(u, *layout, A);
+		else
+			jerr += spatial->assemble_jacobian(u, A);
+		jerr += MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+		jerr += MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
+		return jerr;
+	};
+
+	// warm-up
+	ierr = assemble(); CHKERRQ(ierr);
+
+	MPI_Barrier(PETSC_COMM_WORLD);
+	const double starttime = MPI_Wtime();
+	for(int i = 0; i < nevals; i++) {
+		ierr = assemble(); CHKERRQ(ierr);
+	}
+	const double loctime = (MPI_Wtime() - starttime)/nevals;
+	MPI_Allreduce(&loctime, &evaltime, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+
+	return ierr;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Thread scaling benchmark for generic and direct Jacobian assembly.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of Jacobian assembly")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 20;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+#ifdef _OPENMP
+	PetscInt maxthreads = omp_get_max_threads();
+#else
+	PetscInt maxthreads = 1;
+#endif
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_max_threads", &maxthreads, &set); CHKERRQ(ierr);
+
+	std::vector<int> threadcounts;
+	for(int nthreads = 1; nthreads < maxthreads; nthreads *= 2)
+		threadcounts.push_back(nthreads);
+	threadcounts.push_back(static_cast<int>(maxthreads));
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatSetOption(A, MAT_NEW_NONZERO_LOCATIONS, PETSC_FALSE); CHKERRQ(ierr);
+
+	const BAIJJacobianLayout<NVARS> layout(m, A);
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << mpisize << " ranks, "
+			<< nevals << " assemblies, " << layout.numColours() << " face colours on rank 0\n";
+		std::cout << std::setw(10) << "Assembly" << std::setw(10) << "Threads"
+			<< std::setw(22) << "Time/assembly (s)" << std::setw(12) << "Speedup" << '\n';
+	}
+
+	double reftime = 0;
+	for(const bool direct : {false, true})
+		for(const int nthreads : threadcounts)
+		{
+			double evaltime;
+			ierr = benchmarkAssembly(spatial, direct ? &layout : nullptr, nthreads,
+			                         static_cast<int>(nevals), u, A, evaltime);
+			CHKERRQ(ierr);
+			if(!direct && nthreads == 1)
+				reftime = evaltime;
+
+			if(mpirank == 0)
+				std::cout << std::setw(10) << (direct ? "DIRECT" : "GENERIC") << std::setw(10) << nthreads
+					<< std::setw(22) << std::setprecision(5) << evaltime
+					<< std::setw(12) << std::setprecision(4) << reftime/evaltime << '\n';
+		}
+	if(mpirank == 0)
+		std::cout << std::flush;
+
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,109 @@
+/** \file bench_line_preconditioner.cpp
+ * \brief Compares the line-implicit preconditioners with a point preconditioner on full steady
+ *  solves
+ *
+ * Usage: [mpirun -n <p>] bench_line_preconditioner <control file>
+ *   -options_file <PETSc options file> [-line_pc_anisotropy_threshold <t>]
+ * The steady case described by the control file is solved three times from the initial state:
+ *  - with the preconditioner given in the PETSc options file (for example, block Jacobi with SOR
+ *    or ILU(0) sub-domain solves, or another built-in preconditioner selected by `-fvens_pc_type`),
+ *  - with line Jacobi (`-fvens_pc_type line -line_pc_type jacobi`) and
+ *  - with multicolour line SGS (`-fvens_pc_type line -line_pc_type sgs`).
+ * The number of nonlinear steps, the total number of linear solver iterations and the linear and
+ * overall wall-clock times are reported for each.
+ *
+ * The line preconditioners pay off on stretched boundary-layer meshes, for example
+ *   bench_line_preconditioner testcases/visc-flatplate/flatplate.ctrl
+ *     -options_file testcases/visc-flatplate/opts.solverc
+ *   bench_line_preconditioner testcases/visc-cylinder/laminar-implicit.ctrl
+ *     -options_file testcases/visc-cylinder/opts.solverc
+ * run from the build directory.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscksp.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Solves the case from the initial state with the current PETSc options
+static TimingData solveCase(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                            const FlowFV_base<freal> *const spatial)
+{
+	Vec u;
+	StatusCode ierr = initializeSystemVector(opts, m, &u); petsc_throw(ierr, "Initialize");
+
+	SteadyFlowCase scase(opts);
+	const TimingData td = scase.execute_main(spatial, u);
+
+	ierr = VecDestroy(&u); petsc_throw(ierr, "Destroy");
+	return td;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of the line-implicit preconditioners on steady solves.\n\
+		Arguments needed: FVENS control file and PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of the line-implicit preconditioners")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	const std::vector<std::string> names = {"Options file PC", "Line Jacobi", "Line SGS"};
+	std::vector<TimingData> tds;
+
+	tds.push_back(solveCase(opts, m, spatial));
+
+	ierr = PetscOptionsSetValue(NULL, "-fvens_pc_type", "line"); CHKERRQ(ierr);
+	ierr = PetscOptionsSetValue(NULL, "-line_pc_type", "jacobi"); CHKERRQ(ierr);
+	tds.push_back(solveCase(opts, m, spatial));
+
+	ierr = PetscOptionsSetValue(NULL, "-line_pc_type", "sgs"); CHKERRQ(ierr);
+	tds.push_back(solveCase(opts, m, spatial));
+
+	ierr = PetscOptionsClearValue(NULL, "-fvens_pc_type"); CHKERRQ(ierr);
+	ierr = PetscOptionsClearValue(NULL, "-line_pc_type"); CHKERRQ(ierr);
+
+	delete spatial;
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << m.gnelem() << " cells on rank 0, "
+			<< tds[0].num_threads << " threads per rank\n";
+		std::cout << std::setw(18) << "Preconditioner" << std::setw(12) << "Converged"
+			<< std::setw(12) << "Steps" << std::setw(14) << "Lin. iters"
+			<< std::setw(16) << "Lin. wall (s)" << std::setw(16) << "ODE wall (s)" << '\n';
+		for(size_t i = 0; i < tds.size(); i++)
+			std::cout << std::setw(18) << names[i] << std::setw(12) << (tds[i].converged ? "yes" : "no")
+				<< std::setw(12) << tds[i].num_timesteps << std::setw(14) << tds[i].total_lin_iters
+				<< std::setw(16) << tds[i].lin_walltime << std::setw(16) << tds[i].ode_walltime << '\n';
+		std::cout << std::endl;
+	}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
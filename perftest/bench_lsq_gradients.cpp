@@ -0,0 +1,106 @@
+/** \file bench_lsq_gradients.cpp
+ * \brief Compares least-squares gradients with precomputed weights against the face-based version
+ *
+ * Usage: [OMP_NUM_THREADS=<t>] bench_lsq_gradients <mesh file> [<number of repetitions>]
+ * The gradients of NVARS smooth fields are computed repeatedly (200 times by default) by
+ * \ref WeightedLeastSquaresGradients, once with the least-squares right hand side re-computed face
+ * by face with atomic updates, and once as a gather of state differences with precomputed weights.
+ * The average time per computation and the largest difference between the two are reported. Run
+ * with increasing numbers of threads to see the effect of removing the atomic updates.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <omp.h>
+
+#include "mesh/mesh.hpp"
+#include "spatial/agradientschemes.hpp"
+
+using namespace fvens;
+
+/// Returns the average time in seconds of one gradient computation
+static double timeGradients(const GradientScheme<freal,NVARS>& gs, const amat::Array2dView<freal> u,
+                            const amat::Array2dView<freal> ug,
+                            std::vector<GradBlock_t<freal,NDIM,NVARS>>& grads, const int nrepeat)
+{
+	gs.compute_gradients(u, ug, &grads[0](0,0));
+
+	const auto start = std::chrono::steady_clock::now();
+	for(int irep = 0; irep < nrepeat; irep++)
+		gs.compute_gradients(u, ug, &grads[0](0,0));
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count()/nrepeat;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "Usage: " << argv[0] << " <mesh file> [<number of repetitions>]" << std::endl;
+		return -1;
+	}
+
+	const std::string meshfile = argv[1];
+	const int nrepeat = argc > 2 ? std::stoi(argv[2]) : 200;
+
+	UMesh<freal,NDIM> m(readMesh(meshfile));
+	m.compute_topological();
+	m.compute_areas();
+	m.compute_face_data();
+
+	// Cell centres as the average of nodes; ghost centres are reflections across boundary faces
+	std::vector<freal> rc((m.gnelem()+m.gnConnFace())*NDIM, 0), rcbp(m.gnbface()*NDIM);
+	for(fint iel = 0; iel < m.gnelem(); iel++) {
+		for(int inode = 0; inode < m.gnnode(iel); inode++)
+			for(int idim = 0; idim < NDIM; idim++)
+				rc[iel*NDIM+idim] += m.gcoords(m.ginpoel(iel,inode),idim);
+		for(int idim = 0; idim < NDIM; idim++)
+			rc[iel*NDIM+idim] /= m.gnnode(iel);
+	}
+	for(fint iface = m.gPhyBFaceStart(); iface < m.gPhyBFaceEnd(); iface++) {
+		const fint iel = m.gintfac(iface,0);
+		for(int idim = 0; idim < NDIM; idim++) {
+			const freal mid = 0.5*(m.gcoords(m.gintfac(iface,2),idim)
+			                       + m.gcoords(m.gintfac(iface,3),idim));
+			rcbp[(iface-m.gPhyBFaceStart())*NDIM+idim] = 2*mid - rc[iel*NDIM+idim];
+		}
+	}
+
+	std::vector<freal> u((m.gnelem()+m.gnConnFace())*NVARS), ug(m.gnbface()*NVARS);
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			u[iel*NVARS+ivar] = std::sin((ivar+1)*rc[iel*NDIM]) * std::cos(rc[iel*NDIM+1]);
+	for(fint ib = 0; ib < m.gnbface(); ib++)
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			ug[ib*NVARS+ivar] = std::sin((ivar+1)*rcbp[ib*NDIM]) * std::cos(rcbp[ib*NDIM+1]);
+
+	const amat::Array2dView<freal> uv(u.data(), m.gnelem()+m.gnConnFace(), NVARS);
+	const amat::Array2dView<freal> ugv(ug.data(), m.gnbface(), NVARS);
+
+	const WeightedLeastSquaresGradients<freal,NVARS> facewise(&m, rc.data(), rcbp.data(), false);
+	const WeightedLeastSquaresGradients<freal,NVARS> precomp(&m, rc.data(), rcbp.data(), true);
+
+	std::vector<GradBlock_t<freal,NDIM,NVARS>> grads1(m.gnelem()), grads2(m.gnelem());
+	const double time1 = timeGradients(facewise, uv, ugv, grads1, nrepeat);
+	const double time2 = timeGradients(precomp, uv, ugv, grads2, nrepeat);
+
+	freal maxdiff = 0;
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(int idim = 0; idim < NDIM; idim++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				maxdiff = std::max(maxdiff, std::abs(grads1[iel](idim,ivar)-grads2[iel](idim,ivar)));
+
+	std::cout << "Mesh file: " << meshfile << ", " << m.gnelem() << " cells, "
+		<< omp_get_max_threads() << " threads, " << nrepeat << " repetitions\n";
+	std::cout << std::setw(14) << "Face-based (s)" << std::setw(18) << "Precomputed (s)"
+		<< std::setw(12) << "Speedup" << std::setw(16) << "Max difference" << '\n';
+	std::cout << std::setw(14) << std::setprecision(5) << time1
+		<< std::setw(18) << std::setprecision(5) << time2
+		<< std::setw(12) << std::setprecision(4) << time1/time2
+		<< std::setw(16) << std::setprecision(3) << maxdiff << std::endl;
+
+	return 0;
+}
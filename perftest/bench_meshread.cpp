@@ -0,0 +1,143 @@
+/** \file bench_meshread.cpp
+ * \brief Compares load time and peak memory of the text mesh readers and the binary mesh format
+ *
+ * Usage: bench_meshread <mesh file> [<number of repetitions>]
+ * The mesh file can be in any format readable by \ref readMesh. It is converted to the binary
+ * format in a temporary file next to it, which is deleted at the end.
+ *
+ * Each measurement (and the conversion) is carried out in a separate child process so that the
+ * peak resident set size reported by the OS belongs to that reader alone. The following are
+ * measured:
+ *  - "text": readMesh on the original file followed by construction of a UMesh
+ *  - "binary": the same with the binary file
+ *  - "binary-mapped": mapping the binary file and touching all of its arrays in place
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "mesh/mesh.hpp"
+#include "mesh/binarymesh.hpp"
+
+using namespace fvens;
+
+/// Loads the mesh in the requested way and returns a checksum so the work is not optimized out
+static double loadMesh(const std::string& mode, const std::string& textfile,
+                       const std::string& binfile)
+{
+	if(mode == "convert") {
+		writeBinaryMesh(binfile, readMesh(textfile));
+		return 0;
+	}
+	else if(mode == "text") {
+		const UMesh<freal,NDIM> m(readMesh(textfile));
+		return m.gcoords(m.gnpoin()-1,0) + m.ginpoel(m.gnelem()-1,0);
+	}
+	else if(mode == "binary") {
+		const UMesh<freal,NDIM> m(readMesh(binfile));
+		return m.gcoords(m.gnpoin()-1,0) + m.ginpoel(m.gnelem()-1,0);
+	}
+	else {
+		const MappedMeshFile mf(binfile);
+		const amat::Array2dView<freal> coords = mf.coords();
+		const amat::Array2dView<fint> inpoel = mf.inpoel();
+		const amat::Array2dView<fint> bface = mf.bface();
+		double sum = 0;
+		for(fint i = 0; i < coords.rows(); i++)
+			sum += coords(i,0);
+		for(fint i = 0; i < inpoel.rows(); i++)
+			sum += inpoel(i,0);
+		for(fint i = 0; i < bface.rows(); i++)
+			sum += bface(i,0);
+		return sum;
+	}
+}
+
+/// Runs one load in a child process
+/** \param[out] walltime Wall-clock time taken by the load in seconds
+ * \param[out] maxrss Peak resident set size of the child in kilobytes
+ */
+static void measure(const std::string& mode, const std::string& textfile,
+                    const std::string& binfile, double& walltime, long& maxrss)
+{
+	std::cout.flush();
+
+	int fds[2];
+	if(pipe(fds) != 0) {
+		std::perror("pipe");
+		std::exit(-1);
+	}
+
+	const pid_t pid = fork();
+	if(pid == 0) {
+		close(fds[0]);
+		// Silence the readers' diagnostic output
+		if(!std::freopen("/dev/null", "w", stdout))
+			_exit(-1);
+		const auto start = std::chrono::steady_clock::now();
+		const volatile double checksum = loadMesh(mode, textfile, binfile);
+		(void)checksum;
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		const double time = elapsed.count();
+		if(write(fds[1], &time, sizeof(double)) != sizeof(double))
+			_exit(-1);
+		close(fds[1]);
+		_exit(0);
+	}
+
+	close(fds[1]);
+	if(read(fds[0], &walltime, sizeof(double)) != sizeof(double)) {
+		std::cout << "Child process for " << mode << " failed!" << std::endl;
+		std::exit(-1);
+	}
+	close(fds[0]);
+
+	int status;
+	struct rusage usage;
+	wait4(pid, &status, 0, &usage);
+	maxrss = usage.ru_maxrss;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "Usage: " << argv[0] << " <mesh file> [<number of repetitions>]" << std::endl;
+		return -1;
+	}
+
+	const std::string textfile = argv[1];
+	const int nrepeat = argc > 2 ? std::stoi(argv[2]) : 3;
+	const std::string binfile = textfile + ".bench.fvm";
+
+	{
+		double time; long rss;
+		measure("convert", textfile, binfile, time, rss);
+	}
+
+	std::cout << "Mesh file: " << textfile << '\n';
+	std::cout << std::setw(15) << "Reader" << std::setw(15) << "Time (s)"
+		<< std::setw(20) << "Peak RSS (MB)" << '\n';
+
+	for(const std::string mode : {"text", "binary", "binary-mapped"})
+	{
+		double avgtime = 0;
+		long maxrss = 0;
+		for(int irep = 0; irep < nrepeat; irep++) {
+			double time; long rss;
+			measure(mode, textfile, binfile, time, rss);
+			avgtime += time/nrepeat;
+			maxrss = std::max(maxrss, rss);
+		}
+		std::cout << std::setw(15) << mode << std::setw(15) << std::setprecision(5) << avgtime
+			<< std::setw(20) << std::setprecision(5) << static_cast<double>(maxrss)/1024.0 << '\n';
+	}
+
+	std::remove(binfile.c_str());
+	return 0;
+}
@@ -0,0 +1,167 @@
+/** \file bench_mixed_precision.cpp
+ * \brief Compares the solver with single- and double-precision storage of the preconditioner,
+ *  gradients and connectivity face states
+ *
+ * Usage: [mpirun -n <p>] bench_mixed_precision <control file> [-options_file <PETSc options file>]
+ *   [-bench_num_applies <n>]
+ * The Jacobian of the case described by the control file is assembled once at the initial state,
+ * and the average time of one application of \ref BlockSGSPreconditioner (max over all ranks) is
+ * measured n times (100 by default) with blocks stored in double and in single precision.
+ *
+ * Then the main solve of the case is run with either storage, using the block SGS preconditioner,
+ * and the numbers of nonlinear and linear iterations and the solve times are reported, so that
+ * convergence parity and speedup can be checked, for example on the inviscid cylinder and the
+ * laminar flat-plate test cases. In the single precision run, the residual is also computed with
+ * \ref FlowNumericsConfig::single_precision_storage when the discretization supports it (the fused
+ * residual with least-squares gradients); the solution, residuals and mesh geometry are stored in
+ * double precision in both runs.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <petscksp.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/blocksgs.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Times applications of the block SGS preconditioner with a given storage type
+/** \param[out] applytime Average wall-clock time of one application, max over all ranks
+ * \param[out] bytes Storage used by the preconditioner on this rank
+ */
+template <typename storage>
+static StatusCode benchmarkApply(const UMesh<freal,NDIM>& m, Mat M, const Vec x, Vec y,
+                                 const int napplies, double& applytime, size_t& bytes)
+{
+	StatusCode ierr = 0;
+	const BAIJJacobianLayout<NVARS> layout(m, M);
+	BlockSGSPreconditioner<storage,NVARS> prec(m, 1);
+	ierr = prec.setup(M, layout); CHKERRQ(ierr);
+	bytes = prec.storage_bytes();
+
+	ConstVecHandler<freal> xh(x);
+	MutableVecHandler<freal> yh(y);
+	applytime = timeOperation([&]() { prec.apply(xh.getArray(), yh.getArray()); }, napplies);
+	return ierr;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of single-precision storage in the solver.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of mixed-precision preconditioning")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt napplies = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_applies", &napplies, &set); CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u, x, y;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &x); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &y); CHKERRQ(ierr);
+	ierr = VecSet(x, 1.0); CHKERRQ(ierr);
+
+	{
+		Mat M;
+		ierr = setupSystemMatrix<NVARS>(&m, &M); CHKERRQ(ierr);
+		ierr = spatial->assemble_jacobian(u, M); CHKERRQ(ierr);
+		ierr = MatAssemblyBegin(M, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+		ierr = MatAssemblyEnd(M, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+		// Make the matrix diagonally dominant, as with a pseudo-time term
+		ierr = MatShift(M, 1.0); CHKERRQ(ierr);
+
+		double times[2];
+		size_t bytes[2];
+		ierr = benchmarkApply<double>(m, M, x, y, static_cast<int>(napplies), times[0], bytes[0]);
+		CHKERRQ(ierr);
+		ierr = benchmarkApply<float>(m, M, x, y, static_cast<int>(napplies), times[1], bytes[1]);
+		CHKERRQ(ierr);
+
+		if(mpirank == 0) {
+			std::cout << "\nMesh file: " << opts.meshfile << ", " << mpisize << " ranks, "
+				<< napplies << " applications\n";
+			std::cout << "Block SGS application, double storage (s): " << std::setprecision(5)
+				<< times[0] << ", " << bytes[0]/1e6 << " MB on rank 0\n";
+			std::cout << "Block SGS application, single storage (s): " << std::setprecision(5)
+				<< times[1] << ", " << bytes[1]/1e6 << " MB on rank 0\n";
+			std::cout << "Speedup: " << std::setprecision(4) << times[0]/times[1] << '\n';
+		}
+
+		ierr = MatDestroy(&M); CHKERRQ(ierr);
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	// Full solves
+	ierr = PetscOptionsSetValue(NULL, "-fvens_pc_type", "block_sgs"); CHKERRQ(ierr);
+	if(mpirank == 0)
+		std::cout << '\n' << std::setw(10) << "Storage" << std::setw(14) << "Nonlin iters"
+			<< std::setw(14) << "Lin iters" << std::setw(18) << "Lin solve (s)"
+			<< std::setw(18) << "Total (s)" << '\n';
+
+	for(const bool single : {false, true})
+	{
+		FlowParserOptions sopts = opts;
+		if(single) {
+			ierr = PetscOptionsSetValue(NULL, "-block_sgs_single_precision", ""); CHKERRQ(ierr);
+			if(opts.order2 && opts.limiter != "WENO" && opts.gradientmethod != "GREENGAUSS") {
+				sopts.fused_residual = true;
+				sopts.single_precision_storage = true;
+			}
+		}
+		const FlowFV_base<freal> *const sspatial
+			= single ? createFlowSpatial(sopts, m) : spatial;
+
+		ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+		SteadyFlowCase scase(sopts);
+		const TimingData td = scase.execute_main(sspatial, u);
+		ierr = VecDestroy(&u); CHKERRQ(ierr);
+		if(single)
+			delete sspatial;
+
+		if(mpirank == 0)
+			std::cout << std::setw(10) << (single ? "single" : "double")
+				<< std::setw(14) << td.num_timesteps << std::setw(14) << td.total_lin_iters
+				<< std::setw(18) << std::setprecision(5) << td.lin_walltime
+				<< std::setw(18) << std::setprecision(5) << td.ode_walltime
+				<< (td.converged ? "" : "  (not converged)") << '\n';
+	}
+	if(mpirank == 0)
+		std::cout << std::flush;
+
+	delete spatial;
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,117 @@
+/** \file bench_ordering.cpp
+ * \brief Compares the cost of residual evaluation for different orderings of the mesh cells
+ *
+ * Usage: bench_ordering <control file> [-options_file <PETSc options file>] [-bench_num_evals <n>]
+ * For each of the natural (as in the mesh file), RCM, Hilbert and Morton orderings, the mesh is
+ * set up as in a normal run of the solver described by the control file, and the residual and
+ * local time steps are computed n times (100 by default) at the free-stream state.
+ * The average time per evaluation and the average difference of the indices of the two cells
+ * adjacent to each interior face, which is a measure of the locality of the face loops, are
+ * reported for each ordering, along with the speedup over RCM.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <petscvec.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Average over interior faces of the difference between the indices of the two adjacent cells
+static double averageFaceIndexDistance(const UMesh<freal,NDIM>& m)
+{
+	double dist = 0;
+	for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++)
+		dist += std::abs(m.gintfac(iface,1) - m.gintfac(iface,0));
+	return m.gninface() > 0 ? dist/m.gninface() : 0;
+}
+
+/// Sets up the case with the requested ordering and times residual evaluations
+/** \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ * \param[out] facedist Average face index distance on rank 0 \sa averageFaceIndexDistance
+ */
+static StatusCode benchmarkOrdering(const FlowParserOptions& opts, const std::string ordering,
+                                    const int nevals, double& evaltime, double& facedist)
+{
+	StatusCode ierr = PetscOptionsSetValue(NULL, "-mesh_reorder", ordering.c_str());
+	CHKERRQ(ierr);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u, res, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	ierr = timeResidual(*spatial, nevals, u, res, dtm, evaltime); CHKERRQ(ierr);
+
+	facedist = averageFaceIndexDistance(m);
+
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+	return ierr;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Residual evaluation benchmark for mesh orderings.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of residual evaluation for different mesh orderings")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+
+	const std::vector<std::string> orderings = {"natural", "rcm", "hilbert", "morton"};
+	std::vector<double> times(orderings.size()), facedists(orderings.size());
+	for(size_t i = 0; i < orderings.size(); i++) {
+		ierr = benchmarkOrdering(opts, orderings[i], static_cast<int>(nevals), times[i],
+		                         facedists[i]);
+		CHKERRQ(ierr);
+	}
+
+	if(mpirank == 0) {
+		const double rcmtime = times[1];
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << nevals << " evaluations\n";
+		std::cout << std::setw(12) << "Ordering" << std::setw(18) << "Time/eval (s)"
+			<< std::setw(20) << "Face index dist." << std::setw(18) << "Speedup vs RCM" << '\n';
+		for(size_t i = 0; i < orderings.size(); i++)
+			std::cout << std::setw(12) << orderings[i] << std::setw(18) << std::setprecision(5)
+				<< times[i] << std::setw(20) << std::setprecision(5) << facedists[i]
+				<< std::setw(18) << std::setprecision(4) << rcmtime/times[i] << '\n';
+		std::cout << std::flush;
+	}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
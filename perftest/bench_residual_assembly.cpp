@@ -0,0 +1,144 @@
+/** \file bench_residual_assembly.cpp
+ * \brief Compares the thread scaling of face-based and cell-based residual assembly
+ *
+ * Usage: bench_residual_assembly <control file> [-options_file <PETSc options file>]
+ *   [-bench_num_evals <n>] [-bench_max_threads <t>]
+ * The case described by the control file is set up once. For each of the face-based and
+ * cell-based residual assembly modes (see \ref FlowNumericsConfig::residual_assembly) and for 1, 2,
+ * 4.. threads up to t (by default, the OpenMP maximum), the residual and local time steps are
+ * computed n times (100 by default) at the initial state. The average time per evaluation and the
+ * speedup over face-based assembly on one thread are reported, along with the relative difference
+ * of the residual from that of face-based assembly on one thread.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <petscvec.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Times residual evaluations with the given residual assembly mode and number of threads
+/** \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ * \param[in,out] res On output, the residual at u
+ */
+static StatusCode benchmarkAssembly(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                                    const std::string assembly, const int nthreads,
+                                    const int nevals, const Vec u, Vec res, Vec dtm,
+                                    double& evaltime)
+{
+#ifdef _OPENMP
+	omp_set_num_threads(nthreads);
+#endif
+
+	FlowParserOptions aopts = opts;
+	aopts.residual_assembly = assembly;
+	return timeResidual(aopts, m, nevals, u, res, dtm, evaltime);
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Thread scaling benchmark for face-based and cell-based residual assembly.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of residual assembly modes")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+#ifdef _OPENMP
+	PetscInt maxthreads = omp_get_max_threads();
+#else
+	PetscInt maxthreads = 1;
+#endif
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_max_threads", &maxthreads, &set); CHKERRQ(ierr);
+
+	std::vector<int> threadcounts;
+	for(int nthreads = 1; nthreads < maxthreads; nthreads *= 2)
+		threadcounts.push_back(nthreads);
+	threadcounts.push_back(static_cast<int>(maxthreads));
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	Vec u, res, refres, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &refres); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	const std::vector<std::string> modes = {"FACE", "CELL"};
+	double reftime = 0;
+	PetscReal refnorm = 0;
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << nevals << " evaluations\n";
+		std::cout << std::setw(10) << "Assembly" << std::setw(10) << "Threads"
+			<< std::setw(18) << "Time/eval (s)" << std::setw(12) << "Speedup"
+			<< std::setw(20) << "Rel. difference" << '\n';
+	}
+
+	for(const std::string& mode : modes)
+		for(const int nthreads : threadcounts)
+		{
+			double evaltime;
+			ierr = benchmarkAssembly(opts, m, mode, nthreads, static_cast<int>(nevals), u, res, dtm,
+			                         evaltime);
+			CHKERRQ(ierr);
+
+			PetscReal diffnorm = 0;
+			if(mode == modes[0] && nthreads == 1) {
+				reftime = evaltime;
+				ierr = VecCopy(res, refres); CHKERRQ(ierr);
+				ierr = VecNorm(refres, NORM_2, &refnorm); CHKERRQ(ierr);
+			}
+			else {
+				ierr = VecAXPY(res, -1.0, refres); CHKERRQ(ierr);
+				ierr = VecNorm(res, NORM_2, &diffnorm); CHKERRQ(ierr);
+			}
+
+			if(mpirank == 0)
+				std::cout << std::setw(10) << mode << std::setw(10) << nthreads
+					<< std::setw(18) << std::setprecision(5) << evaltime
+					<< std::setw(12) << std::setprecision(4) << reftime/evaltime
+					<< std::setw(20) << std::setprecision(4) << diffnorm/refnorm << '\n';
+		}
+	if(mpirank == 0)
+		std::cout << std::flush;
+
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&refres); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,131 @@
+/** \file bench_specialized_kernels.cpp
+ * \brief Compares residual computation with generic and compile-time specialized flux kernels
+ *
+ * Usage: bench_specialized_kernels <control file> [-options_file <PETSc options file>]
+ *   [-bench_num_evals <n>] [-bench_limiter <limiter>]
+ * The case described by the control file is set up once; the limiter can be replaced by the one
+ * given with -bench_limiter. With specialized kernels (see
+ * \ref FlowNumericsConfig::specialized_kernels) off and on, the residual and local time steps are
+ * computed n times (100 by default) at the initial state. The average time per evaluation and the
+ * speedup over generic kernels are reported, along with the relative difference of the residual.
+ *
+ * For the laminar Navier-Stokes configuration with Roe flux, least-squares gradients and
+ * Venkatakrishnan limiter, run for example
+ *   bench_specialized_kernels testcases/visc-naca0012/laminar-implicit.ctrl
+ *     -bench_limiter VENKATAKRISHNAN
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <petscvec.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "perftest_utils.hpp"
+
+using namespace fvens;
+using namespace perftest;
+namespace po = boost::program_options;
+
+/// Times residual evaluations with or without specialized kernels
+/** \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ * \param[in,out] res On output, the residual at u
+ */
+static StatusCode benchmarkKernels(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                                   const bool specialized, const int nevals, const Vec u, Vec res,
+                                   Vec dtm, double& evaltime)
+{
+	FlowParserOptions aopts = opts;
+	aopts.specialized_kernels = specialized;
+	return timeResidual(aopts, m, nevals, u, res, dtm, evaltime);
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Benchmark of generic and specialized residual kernels.\n\
+		Arguments needed: FVENS control file and optionally PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		(std::string("Benchmark of specialized residual kernels")
+		 + "\n The first argument must be the control file to use. Further options");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	PetscInt nevals = 100;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-bench_num_evals", &nevals, &set); CHKERRQ(ierr);
+	char limiter[100];
+	ierr = PetscOptionsGetString(NULL, NULL, "-bench_limiter", limiter, 100, &set); CHKERRQ(ierr);
+	if(set)
+		opts.limiter = boost::to_upper_copy<std::string>(limiter);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	Vec u, res, refres, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &refres); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	double reftime = 0;
+	PetscReal refnorm = 0;
+
+	if(mpirank == 0) {
+		std::cout << "\nMesh file: " << opts.meshfile << ", " << opts.invflux << " flux, "
+			<< opts.gradientmethod << " gradients, " << opts.limiter << " limiter, "
+			<< nevals << " evaluations\n";
+		std::cout << std::setw(14) << "Kernels" << std::setw(18) << "Time/eval (s)"
+			<< std::setw(12) << "Speedup" << std::setw(20) << "Rel. difference" << '\n';
+	}
+
+	for(const bool specialized : {false, true})
+	{
+		double evaltime;
+		ierr = benchmarkKernels(opts, m, specialized, static_cast<int>(nevals), u, res, dtm,
+		                        evaltime);
+		CHKERRQ(ierr);
+
+		PetscReal diffnorm = 0;
+		if(!specialized) {
+			reftime = evaltime;
+			ierr = VecCopy(res, refres); CHKERRQ(ierr);
+			ierr = VecNorm(refres, NORM_2, &refnorm); CHKERRQ(ierr);
+		}
+		else {
+			ierr = VecAXPY(res, -1.0, refres); CHKERRQ(ierr);
+			ierr = VecNorm(res, NORM_2, &diffnorm); CHKERRQ(ierr);
+		}
+
+		if(mpirank == 0)
+			std::cout << std::setw(14) << (specialized ? "SPECIALIZED" : "GENERIC")
+				<< std::setw(18) << std::setprecision(5) << evaltime
+				<< std::setw(12) << std::setprecision(4) << reftime/evaltime
+				<< std::setw(20) << std::setprecision(4) << diffnorm/refnorm << '\n';
+	}
+	if(mpirank == 0)
+		std::cout << std::flush;
+
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&refres); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return ierr;
+}
@@ -0,0 +1,127 @@
+/** \file bench_topology.cpp
+ * \brief Measures the thread scaling of the mesh topology computation
+ *
+ * Usage: bench_topology <mesh file> [<max. number of threads>] [<number of repetitions>]
+ * The topology of the mesh (\ref UMesh::compute_topological) and the adjacency lists of its cells
+ * used for graph partitioning (\ref getCellAdjLists) are computed with 1, 2, 4.. threads up to the
+ * maximum number of threads (by default, the OpenMP maximum). The average time of each is
+ * reported along with the speedup over one thread. The results of every thread count are checked
+ * against those of one thread.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "mesh/mesh.hpp"
+#include "mesh/meshpartitioning.hpp"
+
+using namespace fvens;
+
+/// Whether two meshes have the same topology and cell adjacency lists
+static bool sameTopology(const UMesh<freal,NDIM>& m1, const ListOfArrays<fint>& adj1,
+                         const UMesh<freal,NDIM>& m2, const ListOfArrays<fint>& adj2)
+{
+	if(m1.gnaface() != m2.gnaface() || adj1.ptrs != adj2.ptrs || adj1.store != adj2.store)
+		return false;
+	for(fint ipoin = 0; ipoin <= m1.gnpoin(); ipoin++)
+		if(m1.gesup_p(ipoin) != m2.gesup_p(ipoin))
+			return false;
+	for(fint i = 0; i < m1.gesup_p(m1.gnpoin()); i++)
+		if(m1.gesup(i) != m2.gesup(i))
+			return false;
+	for(fint iel = 0; iel < m1.gnelem(); iel++)
+		for(EIndex ifael = 0; ifael < m1.gnfael(iel); ifael++)
+			if(m1.gesuel(iel,ifael) != m2.gesuel(iel,ifael)
+			   || m1.gelemface(iel,ifael) != m2.gelemface(iel,ifael))
+				return false;
+	for(fint iface = 0; iface < m1.gnaface(); iface++)
+		for(int j = 0; j < m1.gnnofa(iface)+2; j++)
+			if(m1.gintfac(iface,j) != m2.gintfac(iface,j))
+				return false;
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "Usage: " << argv[0]
+			<< " <mesh file> [<max. number of threads>] [<number of repetitions>]" << std::endl;
+		return -1;
+	}
+
+	MPI_Init(&argc, &argv);
+
+	const std::string meshfile = argv[1];
+#ifdef _OPENMP
+	const int maxthreads = argc > 2 ? std::stoi(argv[2]) : omp_get_max_threads();
+#else
+	const int maxthreads = 1;
+#endif
+	const int nrepeat = argc > 3 ? std::stoi(argv[3]) : 3;
+
+	const MeshData md = readMesh(meshfile);
+
+	std::vector<int> threadcounts;
+	for(int nthreads = 1; nthreads < maxthreads; nthreads *= 2)
+		threadcounts.push_back(nthreads);
+	threadcounts.push_back(maxthreads);
+
+	std::cout << "Mesh file: " << meshfile << ", " << md.nelem << " cells, " << nrepeat
+		<< " repetitions\n";
+	std::cout << std::setw(10) << "Threads" << std::setw(18) << "Topology (s)"
+		<< std::setw(18) << "Adjacency (s)" << std::setw(12) << "Speedup" << std::setw(12)
+		<< "Identical" << '\n';
+
+	UMesh<freal,NDIM> refmesh(md);
+	ListOfArrays<fint> refadj;
+	double reftime = 0;
+
+	for(const int nthreads : threadcounts)
+	{
+#ifdef _OPENMP
+		omp_set_num_threads(nthreads);
+#endif
+		double topotime = 0, adjtime = 0;
+		for(int irep = 0; irep < nrepeat; irep++)
+		{
+			UMesh<freal,NDIM> m(md);
+
+			const auto start = std::chrono::steady_clock::now();
+			m.compute_topological();
+			const auto mid = std::chrono::steady_clock::now();
+			const ListOfArrays<fint> adj = getCellAdjLists(m);
+			const auto end = std::chrono::steady_clock::now();
+
+			topotime += std::chrono::duration<double>(mid-start).count()/nrepeat;
+			adjtime += std::chrono::duration<double>(end-mid).count()/nrepeat;
+
+			if(nthreads == 1 && irep == 0) {
+				refmesh = m;
+				refadj = adj;
+			}
+			else if(irep == 0 && !sameTopology(refmesh, refadj, m, adj)) {
+				std::cout << "Topology computed with " << nthreads
+					<< " threads differs from that with one thread!" << std::endl;
+				MPI_Finalize();
+				return -1;
+			}
+		}
+
+		if(nthreads == 1)
+			reftime = topotime + adjtime;
+		std::cout << std::setw(10) << nthreads << std::setw(18) << std::setprecision(5) << topotime
+			<< std::setw(18) << std::setprecision(5) << adjtime << std::setw(12)
+			<< std::setprecision(4) << reftime/(topotime+adjtime) << std::setw(12) << "yes" << '\n';
+	}
+	std::cout << std::flush;
+
+	MPI_Finalize();
+	return 0;
+}
@@ -0,0 +1,55 @@
+/** \file perftest_utils.cpp
+ * \brief Implementation of timing functions shared by the benchmark programs
+ */
+
+#include <mpi.h>
+#include "perftest_utils.hpp"
+#include "utilities/casesolvers.hpp"
+
+namespace perftest {
+
+double timeOperation(const std::function<void()>& op, const int nevals)
+{
+	// warm-up
+	op();
+
+	MPI_Barrier(PETSC_COMM_WORLD);
+	const double starttime = MPI_Wtime();
+	for(int i = 0; i < nevals; i++)
+		op();
+	const double loctime = (MPI_Wtime() - starttime)/nevals;
+	double evaltime;
+	MPI_Allreduce(&loctime, &evaltime, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+	return evaltime;
+}
+
+StatusCode timeResidual(const FlowFV_base<freal>& spatial, const int nevals,
+                        const Vec u, Vec res, Vec dtm, double& evaltime)
+{
+	StatusCode ierr = 0;
+
+	// warm-up
+	ierr = VecSet(res, 0.0); CHKERRQ(ierr);
+	ierr = spatial.compute_residual(u, res, true, dtm); CHKERRQ(ierr);
+
+	MPI_Barrier(PETSC_COMM_WORLD);
+	const double starttime = MPI_Wtime();
+	for(int i = 0; i < nevals; i++) {
+		ierr = VecSet(res, 0.0); CHKERRQ(ierr);
+		ierr = spatial.compute_residual(u, res, true, dtm); CHKERRQ(ierr);
+	}
+	const double loctime = (MPI_Wtime() - starttime)/nevals;
+	MPI_Allreduce(&loctime, &evaltime, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+	return ierr;
+}
+
+StatusCode timeResidual(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                        const int nevals, const Vec u, Vec res, Vec dtm, double& evaltime)
+{
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+	const StatusCode ierr = timeResidual(*spatial, nevals, u, res, dtm, evaltime);
+	delete spatial;
+	return ierr;
+}
+
+}
@@ -0,0 +1,41 @@
+/** \file perftest_utils.hpp
+ * \brief Timing functions shared by the benchmark programs
+ */
+
+#ifndef FVENS_PERFTEST_UTILS_H
+#define FVENS_PERFTEST_UTILS_H
+
+#include <functional>
+#include <petscvec.h>
+
+#include "utilities/controlparser.hpp"
+#include "spatial/flow_spatial.hpp"
+
+namespace perftest {
+
+using namespace fvens;
+
+/// Returns the average wall-clock time of an operation, max over all ranks
+/** The operation is called once to warm up, then all ranks synchronize and it is timed over
+ * nevals calls.
+ */
+double timeOperation(const std::function<void()>& op, const int nevals);
+
+/// Times residual evaluations of a given spatial discretization
+/** The residual and local time steps at u are computed once to warm up, then all ranks synchronize
+ * and nevals evaluations are timed.
+ * \param[out] evaltime Average wall-clock time of one residual evaluation, max over all ranks
+ * \param[in,out] res On output, the residual at u
+ */
+StatusCode timeResidual(const FlowFV_base<freal>& spatial, const int nevals,
+                        const Vec u, Vec res, Vec dtm, double& evaltime);
+
+/// Times residual evaluations of the spatial discretization set up from the given options
+/** \sa timeResidual(const FlowFV_base<freal>&, const int, const Vec, Vec, Vec, double&)
+ */
+StatusCode timeResidual(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                        const int nevals, const Vec u, Vec res, Vec dtm, double& evaltime);
+
+}
+
+#endif
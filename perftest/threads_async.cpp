@@ -1,6 +1,10 @@
 /** \file threads_async.cpp
  * \brief Carries out performance tests related to thread-parallel asynchronous preconditioning
  *
+ * The preconditioner is the built-in threaded one if -fvens_pc_type is threaded (with its operation
+ * and schedule given by -threaded_pc_type and -threaded_pc_schedule), or otherwise is chosen by
+ * -blasted_pc_type, if FVENS is built with BLASTed.
+ *
  * Command-line or PETSc options file parameters:
  * * -perftest_type ["speedup_sweeps": Study speed-up obtained from different numbers of async sweeps 
  *     with a fixed number of threads, "none"]
@@ -48,7 +52,7 @@ int main(int argc, char *argv[])
 	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
 	
 	po::options_description desc
-		("Utility for bencharking BLASTed asynchronous preconditioners.\n"s
+		("Utility for bencharking asynchronous preconditioners.\n"s
 		 + " The first argument is the input control file name.\n"
 		 + "Further options");
 
@@ -72,7 +76,12 @@ int main(int argc, char *argv[])
 
 	// write a message to stdout about which preconditioner is being used -
 	//  could be useful for reading the log file
-	std::string prec = parsePetscCmd_string("-blasted_pc_type", 10);
+	const bool builtin = parsePetscCmd_isDefined("-fvens_pc_type")
+		&& parsePetscCmd_string("-fvens_pc_type", 20) == "threaded";
+	const std::string prec = builtin
+		? (parsePetscCmd_isDefined("-threaded_pc_type") ?
+		   parsePetscCmd_string("-threaded_pc_type", 10) : std::string("sgs")) + " (built-in)"
+		: parsePetscCmd_string("-blasted_pc_type", 10);
 	std::cout << ">>> Perftest " << testtype << ", preconditioner " << prec << std::endl;
 
 	if(testtype == "speedup_sweeps")
@@ -21,8 +21,10 @@
 #include "mesh/ameshutils.hpp"
 #include "utilities/casesolvers.hpp"
 
+#ifdef USE_BLASTED
 #include <blasted_petsc.h>
 #include <preconditioner_diagnostics.hpp>
+#endif
 
 #include "threads_async_tests.hpp"
 
@@ -33,8 +35,11 @@ const int field_width = 11;
 
 using namespace fvens;
 
-/// Set -blasted_async_sweeps in the default Petsc options database and throw if not successful
-static void set_blasted_sweeps(const int nbswp, const int naswp);
+/// Set the numbers of async sweeps in the default Petsc options database and throw if not successful
+/** Both -threaded_pc_sweeps, for the built-in threaded preconditioners, and, if FVENS is built with
+ * BLASTed, -blasted_async_sweeps are set.
+ */
+static void set_async_sweeps(const int nbswp, const int naswp);
 
 static double std_deviation(const double *const vals, const double avg, const int N);
 
@@ -47,10 +52,12 @@ static void writeTimingToFile(std::ofstream& outf, const int w, const bool comme
                               const double precspeedup, const double precdeviate,
                               const double preccputime, const double fvens_wall_spdp);
 
+#ifdef USE_BLASTED
 static void writePrecInfoHistory(const FlowCase& flowcase, std::vector<SteadyStepMonitor>& convhis,
                                  const int numthreads, const int numrepeats,
                                  const std::string perflogprefix, const bool basecase,
                                  const int nbswps, const int naswps, const int irepeat);
+#endif
 
 /** Carries out a run of the 'main' solve for one factor- and apply-sweeps setting and one thread
  * setting.
@@ -75,8 +82,6 @@ runSweepThreads(const Vec u, const FlowCase& flowcase, const Spatial<freal,NVARS
 	std::vector<SteadyStepMonitor> cohis;           // convergence history
 	int monitortimesteps=0;                         // number of steps in the repeat that is written
 
-	blasted::PrecInfoList pinfol;                   // Preconditioner info history
-
 	std::ofstream convout, infoout;
 
 	if(conv_history_reqd && mpirank==0) {
@@ -89,7 +94,7 @@ runSweepThreads(const Vec u, const FlowCase& flowcase, const Spatial<freal,NVARS
 		if(!convout)
 			throw std::runtime_error("Could not open file to write convergence history!");
 
-		convout << "# Perftest: sweeps and threads for async preconditioner from BLASTed\n";
+		convout << "# Perftest: sweeps and threads for async preconditioner\n";
 		convout << "# Number of repeats per run = " << numrepeat << "\n";
 		if(basecase)
 			convout << "# Base case: ";
@@ -100,7 +105,7 @@ runSweepThreads(const Vec u, const FlowCase& flowcase, const Spatial<freal,NVARS
 	}
 
 	omp_set_num_threads(numthreads);
-	set_blasted_sweeps(nbswps,naswps);
+	set_async_sweeps(nbswps,naswps);
 	if(mpirank == 0) {
 		std::cout << "\n Sweeps=(" << nbswps << "," << naswps << "), threads=" << numthreads << "\n";
 	}
@@ -119,9 +124,11 @@ runSweepThreads(const Vec u, const FlowCase& flowcase, const Spatial<freal,NVARS
 		cohis = td.convhis;
 		monitortimesteps = td.num_timesteps;
 
+#ifdef USE_BLASTED
 		if(prec_info_reqd && mpirank == 0)
 			writePrecInfoHistory(flowcase, td.convhis, numthreads, numrepeat, perflogprefix, basecase,
 			                     nbswps, naswps, irpt);
+#endif
 
 		if(!td.converged) {
 			tdata.converged = false;
@@ -218,11 +225,15 @@ StatusCode test_speedup_sweeps(const FlowParserOptions& opts, const FlowCase& fl
 	// starting computation
 
 	omp_set_num_threads(1);
-	set_blasted_sweeps(1,1);
+	set_async_sweeps(1,1);
 
 	flowcase.execute_starter(prob, u);
 
+#ifdef USE_BLASTED
 	const bool write_precinfo = parseOptionalPetscCmd_bool("-blasted_compute_preconditioner_info");
+#else
+	const bool write_precinfo = false;
+#endif
 	if(write_precinfo)
 		std::cout << " test_speedup_sweeps: preconditioner info history will be computed and written."
 		          << std::endl;
@@ -248,7 +259,7 @@ StatusCode test_speedup_sweeps(const FlowParserOptions& opts, const FlowCase& fl
 
 	for (size_t i = 0; i < config.buildSwpSeq.size(); i++)
 	{
-		set_blasted_sweeps(config.buildSwpSeq[i], config.applySwpSeq[i]);
+		set_async_sweeps(config.buildSwpSeq[i], config.applySwpSeq[i]);
 
 		for(int numthreads : config.threadSeq)
 		{
@@ -264,23 +275,32 @@ StatusCode test_speedup_sweeps(const FlowParserOptions& opts, const FlowCase& fl
 	return ierr;
 }
 
-void set_blasted_sweeps(const int nbswp, const int naswp)
+/// Set an option for the numbers of build and apply sweeps and check it
+static void set_sweeps_option(const char *const optionname, const int nbswp, const int naswp)
 {
 	// add option
 	std::string value = std::to_string(nbswp) + "," + std::to_string(naswp);
-	int ierr = PetscOptionsSetValue(NULL, "-blasted_async_sweeps", value.c_str());
-	petsc_throw(ierr, "Couldn't set PETSc option for BLASTed async sweeps");
+	int ierr = PetscOptionsSetValue(NULL, optionname, value.c_str());
+	petsc_throw(ierr, "Couldn't set PETSc option for async sweeps");
 
 	// Check
 	int checksweeps[2];
 	int nmax = 2;
 	PetscBool set = PETSC_FALSE;
-	ierr = PetscOptionsGetIntArray(NULL,NULL,"-blasted_async_sweeps",checksweeps,&nmax,&set);
+	ierr = PetscOptionsGetIntArray(NULL,NULL,optionname,checksweeps,&nmax,&set);
 	petsc_throw(ierr, "Could not get int array!");
 	fvens_throw(checksweeps[0] != nbswp || checksweeps[1] != naswp, 
 			"Async sweeps not set properly!");
 }
 
+void set_async_sweeps(const int nbswp, const int naswp)
+{
+	set_sweeps_option("-threaded_pc_sweeps", nbswp, naswp);
+#ifdef USE_BLASTED
+	set_sweeps_option("-blasted_async_sweeps", nbswp, naswp);
+#endif
+}
+
 void writeHeaderToFile(std::ofstream& outf, const int width)
 {
 	outf << '#' << std::setw(width) << "threads"
@@ -321,6 +341,7 @@ double std_deviation(const double *const vals, const double avg, const int N) {
 	return deviate;
 }
 
+#ifdef USE_BLASTED
 static void writePrecInfoHeader(std::ofstream& outf);
 
 static void writeStepToPrecInfoHistory(const blasted::PrecInfo pinfo, const double cfl,
@@ -383,5 +404,6 @@ void writeStepToPrecInfoHistory(const blasted::PrecInfo pinfo, const double cfl,
 	outf << std::setw(blasted::PrecInfoList::field_width) << cfl << "\n";
 }
 
-}
+#endif
 
+}
@@ -35,6 +35,8 @@ struct SpeedupSweepsConfig {
 /** Only for implicit solves.
  * Runs a nonlinear solve first with 1 thread and 1 sweep (for reference). Then, for each number of
  * threads requested, there's one run for each number of sweeps requested.
+ * The preconditioner is either one of the built-in threaded block preconditioners (selected by
+ * -fvens_pc_type threaded and -threaded_pc_type) or, if FVENS is built with it, one from BLASTed.
  * Each `run' with one of the requested number of threads and one of the requested number of sweeps
  * consists of several repetitions, to account for the asynchronous chaos.
  * If one repetition of a run does not converge, that run is terminated but its details are written
@@ -52,6 +54,7 @@ StatusCode test_speedup_sweeps(const FlowParserOptions& opts, const FlowCase& fl
                                const SpeedupSweepsConfig config,
                                std::ofstream& outfile);
 
+#ifdef USE_BLASTED
 /// Run a timing test with a specific number of sweeps with a specific number of threads
 /** 
  * \param nbswps Number of build sweeps
@@ -66,6 +69,7 @@ TimingData run_sweeps(const Spatial<freal,NVARS> *const startprob,
                       KSP *ksp, Vec u, Mat A, Mat M,
                       MatrixFreeSpatialJacobian<NVARS>& mfjac, const PetscBool mf_flg,
                       Blasted_data_list& bctx);
+#endif
 
 }
 
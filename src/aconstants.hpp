@@ -37,6 +37,20 @@
 /// Number of quadrature points in each face
 #define NGAUSS 1
 
+/// Number of faces processed together by batched face kernels
+/** Batched kernels store quantities of the faces in a batch contiguously, so that the faces can be
+ * processed in SIMD lanes. The batch holds two SIMD registers' worth of doubles of the widest
+ * instruction set enabled at compile time.
+ * \sa InviscidFlux::get_flux_batch
+ */
+#if defined(__AVX512F__)
+#define FACE_BATCH 16
+#elif defined(__AVX__)
+#define FACE_BATCH 8
+#else
+#define FACE_BATCH 4
+#endif
+
 #ifndef MESHDATA_DOUBLE_PRECISION
 #define MESHDATA_DOUBLE_PRECISION 20
 #endif
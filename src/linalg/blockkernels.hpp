@@ -0,0 +1,52 @@
+/** \file
+ * \brief Fixed-size kernels for the column-major blocks of block sparse matrices
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_BLOCK_KERNELS_H
+#define FVENS_BLOCK_KERNELS_H
+
+#include <Eigen/Core>
+#include "aconstants.hpp"
+
+namespace fvens {
+
+/// One block of a vector, always in fvens::freal
+template <int bs>
+using BlockVector = Eigen::Matrix<freal,bs,1>;
+
+/// Adds the product of a column-major block and a vector to an accumulator
+/** The block is applied one column at a time, each column being scaled by one entry of x; with
+ * the block size fixed at compile time, every column operation is a packed SIMD operation.
+ * \tparam scalar Type in which the block is stored; it is converted to freal as it is used
+ */
+template <typename scalar, int bs>
+inline void block_gemv_add(const scalar *const blk, const freal *const x, BlockVector<bs>& y)
+{
+	for(int j = 0; j < bs; j++)
+		y += Eigen::Map<const Eigen::Matrix<scalar,bs,1>>(blk+j*bs).template cast<freal>() * x[j];
+}
+
+/// Subtracts the product of a column-major block and a vector from an accumulator
+template <typename scalar, int bs>
+inline void block_gemv_sub(const scalar *const blk, const freal *const x, BlockVector<bs>& y)
+{
+	for(int j = 0; j < bs; j++)
+		y -= Eigen::Map<const Eigen::Matrix<scalar,bs,1>>(blk+j*bs).template cast<freal>() * x[j];
+}
+
+}
+#endif
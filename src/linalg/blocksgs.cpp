@@ -0,0 +1,86 @@
+/** \file
+ * \brief Implementation of the block symmetric Gauss-Seidel preconditioner
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "blocksgs.hpp"
+
+namespace fvens {
+
+template <typename storage, int bs>
+BlockSGSPreconditioner<storage,bs>::BlockSGSPreconditioner(const UMesh<freal,NDIM>& mesh,
+                                                           const int num_sweeps)
+	: BlockSparseMatrix<storage,bs>(mesh), nsweeps{num_sweeps},
+	  work(static_cast<size_t>(mesh.gnelem())*bs)
+{ }
+
+template <typename storage, int bs>
+StatusCode BlockSGSPreconditioner<storage,bs>::setup(Mat P, const BAIJJacobianLayout<bs>& layout)
+{
+	StatusCode ierr = this->copy_from(P, layout); CHKERRQ(ierr);
+	this->invert_diagonal_blocks();
+	return ierr;
+}
+
+template <typename storage, int bs>
+void BlockSGSPreconditioner<storage,bs>::apply(const freal *const x, freal *const y) const
+{
+	if(nsweeps < 1) {
+		std::fill(y, y + this->nbrows*bs, 0);
+		return;
+	}
+
+	// From a zero initial guess, the first symmetric sweep only needs the triangular parts
+	this->apply_sgs(x, work.data(), y);
+	for(int isweep = 1; isweep < nsweeps; isweep++)
+		this->sgs_sweep(x, y);
+}
+
+template class BlockSGSPreconditioner<float,NVARS>;
+template class BlockSGSPreconditioner<double,NVARS>;
+template class BlockSGSPreconditioner<float,1>;
+template class BlockSGSPreconditioner<double,1>;
+
+template <int bs>
+StatusCode setup_block_sgs(PC pc, const UMesh<freal,NDIM>& mesh)
+{
+	StatusCode ierr = 0;
+
+	PetscBool single = PETSC_FALSE;
+	ierr = PetscOptionsHasName(NULL, NULL, "-block_sgs_single_precision", &single); CHKERRQ(ierr);
+	PetscInt nsweeps = 1;
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetInt(NULL, NULL, "-block_sgs_sweeps", &nsweeps, &set); CHKERRQ(ierr);
+
+	if(single)
+		ierr = setup_block_shell_pc<bs>(pc, mesh,
+		                                new BlockSGSPreconditioner<float,bs>(mesh,
+		                                                                     static_cast<int>(nsweeps)),
+		                                "block SGS, single-precision storage");
+	else
+		ierr = setup_block_shell_pc<bs>(pc, mesh,
+		                                new BlockSGSPreconditioner<double,bs>(mesh,
+		                                                                      static_cast<int>(nsweeps)),
+		                                "block SGS, double-precision storage");
+	CHKERRQ(ierr);
+	return ierr;
+}
+
+template StatusCode setup_block_sgs<NVARS>(PC pc, const UMesh<freal,NDIM>& mesh);
+template StatusCode setup_block_sgs<1>(PC pc, const UMesh<freal,NDIM>& mesh);
+
+}
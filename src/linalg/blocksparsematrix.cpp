@@ -0,0 +1,498 @@
+/** \file
+ * \brief Implementation of the mesh-structured block sparse row matrix and its PETSc wrappers
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <ctime>
+#include <Eigen/LU>
+#include "blocksparsematrix.hpp"
+#include "blockkernels.hpp"
+#include "petscutils.hpp"
+
+namespace fvens {
+
+template <typename scalar, int bs>
+BlockSparseMatrix<scalar,bs>::BlockSparseMatrix(const UMesh<freal,NDIM>& mesh)
+	: m{mesh}, nbrows{mesh.gnelem()}
+{
+	// Columns of each block row: the cell itself and its subdomain face neighbours
+	std::vector<std::vector<fint>> rowcols(nbrows);
+	for(fint iel = 0; iel < nbrows; iel++)
+		rowcols[iel].push_back(iel);
+	for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++)
+	{
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+		rowcols[lelem].push_back(relem);
+		rowcols[relem].push_back(lelem);
+	}
+
+	browptr.assign(nbrows+1, 0);
+	for(fint iel = 0; iel < nbrows; iel++)
+	{
+		std::sort(rowcols[iel].begin(), rowcols[iel].end());
+		rowcols[iel].erase(std::unique(rowcols[iel].begin(), rowcols[iel].end()), rowcols[iel].end());
+		browptr[iel+1] = browptr[iel] + static_cast<fint>(rowcols[iel].size());
+	}
+
+	bcolind.resize(browptr[nbrows]);
+	diagind.resize(nbrows);
+	for(fint iel = 0; iel < nbrows; iel++)
+	{
+		std::copy(rowcols[iel].begin(), rowcols[iel].end(), bcolind.begin()+browptr[iel]);
+		diagind[iel] = static_cast<fint>(std::lower_bound(bcolind.begin()+browptr[iel],
+		                                                  bcolind.begin()+browptr[iel+1], iel)
+		                                 - bcolind.begin());
+	}
+
+	// Position of the block at (row, col), which is known to exist
+	auto findBlock = [this](const fint row, const fint col) {
+		return static_cast<fint>(std::lower_bound(bcolind.begin()+browptr[row],
+		                                          bcolind.begin()+browptr[row+1], col)
+		                         - bcolind.begin());
+	};
+
+	const fint nsubdomfaces = m.gSubDomFaceEnd() - m.gSubDomFaceStart();
+	faceupper.resize(nsubdomfaces);
+	facelower.resize(nsubdomfaces);
+	for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++)
+	{
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+		faceupper[iface-m.gSubDomFaceStart()] = findBlock(lelem, relem);
+		facelower[iface-m.gSubDomFaceStart()] = findBlock(relem, lelem);
+	}
+
+	connrow.resize(m.gnConnFace());
+	conncol.resize(m.gnConnFace());
+	for(fint icface = 0; icface < m.gnConnFace(); icface++) {
+		connrow[icface] = m.gconnface(icface,0);
+		conncol[icface] = nbrows + icface;
+	}
+
+	vals.assign(static_cast<size_t>(bcolind.size())*bs*bs, 0);
+	connvals.assign(static_cast<size_t>(conncol.size())*bs*bs, 0);
+	dinv.assign(static_cast<size_t>(nbrows)*bs*bs, 0);
+
+	halo.reset(new HaloExchange(m, {{HALO_CELL, bs}}));
+	xghost.resize(static_cast<size_t>(nbrows + m.gnConnFace())*bs);
+}
+
+template <typename scalar, int bs>
+StatusCode BlockSparseMatrix<scalar,bs>::copy_from(Mat A, const BAIJJacobianLayout<bs>& layout)
+{
+	StatusCode ierr = 0;
+	PetscScalar *ad, *ao;
+	ierr = layout.getArrays(A, &ad, &ao); CHKERRQ(ierr);
+
+	// Both are column-major, so each block is copied as it is
+	auto copyBlock = [](const PetscScalar *const src, scalar *const dst) {
+		for(int k = 0; k < bs*bs; k++)
+			dst[k] = static_cast<scalar>(src[k]);
+	};
+
+#pragma omp parallel default(shared)
+	{
+#pragma omp for
+		for(fint iel = 0; iel < nbrows; iel++)
+			copyBlock(&ad[layout.diagonal(iel)*bs*bs], &vals[diagind[iel]*bs*bs]);
+
+#pragma omp for
+		for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++)
+		{
+			const fint isface = iface - m.gSubDomFaceStart();
+			copyBlock(&ad[layout.upper(iface)*bs*bs], &vals[faceupper[isface]*bs*bs]);
+			copyBlock(&ad[layout.lower(iface)*bs*bs], &vals[facelower[isface]*bs*bs]);
+		}
+
+#pragma omp for
+		for(fint icface = 0; icface < m.gnConnFace(); icface++)
+			copyBlock(&ao[layout.upper(m.gConnBFaceStart()+icface)*bs*bs], &connvals[icface*bs*bs]);
+	}
+
+	ierr = layout.restoreArrays(A, &ad, &ao, false); CHKERRQ(ierr);
+	return ierr;
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::set_zero()
+{
+	std::fill(vals.begin(), vals.end(), scalar(0));
+	std::fill(connvals.begin(), connvals.end(), scalar(0));
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::shift_diagonal(const freal shift)
+{
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < nbrows; iel++)
+		for(int i = 0; i < bs; i++)
+			vals[diagind[iel]*bs*bs + i*bs+i] += static_cast<scalar>(shift);
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::apply_subdomain(const freal *const x, freal *const y) const
+{
+#pragma omp parallel for default(shared)
+	for(fint irow = 0; irow < nbrows; irow++)
+	{
+		BlockVector<bs> yi = BlockVector<bs>::Zero();
+		for(fint jj = browptr[irow]; jj < browptr[irow+1]; jj++)
+			block_gemv_add<scalar,bs>(&vals[jj*bs*bs], &x[bcolind[jj]*bs], yi);
+		Eigen::Map<BlockVector<bs>>(y+irow*bs) = yi;
+	}
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::apply(const freal *const x, freal *const y) const
+{
+	const void *const sources[] = {x};
+	halo->begin(sources);
+
+	apply_subdomain(x, y);
+
+	void *const targets[] = {xghost.data()};
+	halo->end(targets);
+
+	// Few cells have more than one connectivity face, but they may; so this is done serially.
+	for(fint icface = 0; icface < static_cast<fint>(connrow.size()); icface++)
+	{
+		Eigen::Map<BlockVector<bs>> yi(y+connrow[icface]*bs);
+		BlockVector<bs> acc = yi;
+		block_gemv_add<scalar,bs>(&connvals[icface*bs*bs], &xghost[conncol[icface]*bs], acc);
+		yi = acc;
+	}
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::invert_diagonal_blocks()
+{
+#pragma omp parallel for default(shared)
+	for(fint irow = 0; irow < nbrows; irow++)
+	{
+		const Eigen::Matrix<freal,bs,bs> d
+			= Eigen::Map<const Eigen::Matrix<scalar,bs,bs>>(&vals[diagind[irow]*bs*bs])
+			.template cast<freal>();
+		Eigen::Map<Eigen::Matrix<scalar,bs,bs>> di(&dinv[irow*bs*bs]);
+		di = d.inverse().template cast<scalar>();
+	}
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::apply_block_diagonal_inverse(const freal *const x,
+                                                                freal *const y) const
+{
+#pragma omp parallel for default(shared)
+	for(fint irow = 0; irow < nbrows; irow++)
+	{
+		BlockVector<bs> yi = BlockVector<bs>::Zero();
+		block_gemv_add<scalar,bs>(&dinv[irow*bs*bs], &x[irow*bs], yi);
+		Eigen::Map<BlockVector<bs>>(y+irow*bs) = yi;
+	}
+}
+
+template <typename scalar, int bs>
+inline void BlockSparseMatrix<scalar,bs>::relax_row(const fint irow, const bool lower,
+                                                    const freal *const x, freal *const y) const
+{
+	BlockVector<bs> r = Eigen::Map<const BlockVector<bs>>(x+irow*bs);
+	const fint start = lower ? browptr[irow] : diagind[irow]+1;
+	const fint end = lower ? diagind[irow] : browptr[irow+1];
+	for(fint jj = start; jj < end; jj++)
+		block_gemv_sub<scalar,bs>(&vals[jj*bs*bs], &y[bcolind[jj]*bs], r);
+
+	BlockVector<bs> yi = BlockVector<bs>::Zero();
+	block_gemv_add<scalar,bs>(&dinv[irow*bs*bs], r.data(), yi);
+	Eigen::Map<BlockVector<bs>>(y+irow*bs) = yi;
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::lower_solve(const freal *const x, freal *const y) const
+{
+	for(fint irow = 0; irow < nbrows; irow++)
+		relax_row(irow, true, x, y);
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::upper_solve(const freal *const x, freal *const y) const
+{
+	for(fint irow = nbrows-1; irow >= 0; irow--)
+		relax_row(irow, false, x, y);
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::apply_sgs(const freal *const x, freal *const work,
+                                             freal *const y) const
+{
+	lower_solve(x, y);
+
+#pragma omp parallel for default(shared)
+	for(fint irow = 0; irow < nbrows; irow++)
+	{
+		BlockVector<bs> wi = BlockVector<bs>::Zero();
+		block_gemv_add<scalar,bs>(&vals[diagind[irow]*bs*bs], &y[irow*bs], wi);
+		Eigen::Map<BlockVector<bs>>(work+irow*bs) = wi;
+	}
+
+	upper_solve(work, y);
+}
+
+template <typename scalar, int bs>
+inline void BlockSparseMatrix<scalar,bs>::relax_row_full(const fint irow, const freal *const x,
+                                                         freal *const y) const
+{
+	BlockVector<bs> r = Eigen::Map<const BlockVector<bs>>(x+irow*bs);
+	for(fint jj = browptr[irow]; jj < browptr[irow+1]; jj++)
+		if(jj != diagind[irow])
+			block_gemv_sub<scalar,bs>(&vals[jj*bs*bs], &y[bcolind[jj]*bs], r);
+
+	BlockVector<bs> yi = BlockVector<bs>::Zero();
+	block_gemv_add<scalar,bs>(&dinv[irow*bs*bs], r.data(), yi);
+	Eigen::Map<BlockVector<bs>>(y+irow*bs) = yi;
+}
+
+template <typename scalar, int bs>
+void BlockSparseMatrix<scalar,bs>::sgs_sweep(const freal *const x, freal *const y) const
+{
+	for(fint irow = 0; irow < nbrows; irow++)
+		relax_row_full(irow, x, y);
+	for(fint irow = nbrows-1; irow >= 0; irow--)
+		relax_row_full(irow, x, y);
+}
+
+template <typename scalar, int bs>
+size_t BlockSparseMatrix<scalar,bs>::storage_bytes() const
+{
+	return (vals.size() + connvals.size() + dinv.size())*sizeof(scalar)
+		+ (browptr.size() + bcolind.size() + diagind.size() + faceupper.size() + facelower.size()
+		   + connrow.size() + conncol.size())*sizeof(fint);
+}
+
+template class BlockSparseMatrix<float,NVARS>;
+template class BlockSparseMatrix<double,NVARS>;
+template class BlockSparseMatrix<float,1>;
+template class BlockSparseMatrix<double,1>;
+
+template <typename scalar, int bs>
+static StatusCode block_sparse_mult(Mat A, Vec x, Vec y)
+{
+	StatusCode ierr = 0;
+	const BlockSparseMatrix<scalar,bs> *mat;
+	ierr = MatShellGetContext(A, (void*)&mat); CHKERRQ(ierr);
+
+	ConstVecHandler<PetscScalar> xh(x);
+	MutableVecHandler<PetscScalar> yh(y);
+	mat->apply(xh.getArray(), yh.getArray());
+	return ierr;
+}
+
+template <typename scalar, int bs>
+StatusCode create_block_sparse_shell_matrix(const BlockSparseMatrix<scalar,bs> *const mat,
+                                            Mat *const A)
+{
+	StatusCode ierr = 0;
+	const PetscInt nlocal = mat->num_block_rows()*bs;
+	ierr = MatCreateShell(PETSC_COMM_WORLD, nlocal, nlocal, PETSC_DETERMINE, PETSC_DETERMINE,
+	                      (void*)mat, A); CHKERRQ(ierr);
+	ierr = MatSetBlockSize(*A, bs); CHKERRQ(ierr);
+	ierr = MatShellSetOperation(*A, MATOP_MULT, (void(*)(void))&block_sparse_mult<scalar,bs>);
+	CHKERRQ(ierr);
+	return ierr;
+}
+
+template StatusCode create_block_sparse_shell_matrix(const BlockSparseMatrix<float,NVARS> *const mat,
+                                                     Mat *const A);
+template StatusCode create_block_sparse_shell_matrix(const BlockSparseMatrix<double,NVARS> *const mat,
+                                                     Mat *const A);
+template StatusCode create_block_sparse_shell_matrix(const BlockSparseMatrix<float,1> *const mat,
+                                                     Mat *const A);
+template StatusCode create_block_sparse_shell_matrix(const BlockSparseMatrix<double,1> *const mat,
+                                                     Mat *const A);
+
+/// Context of the shell PC of a \ref BlockShellPreconditioner
+template <int bs>
+struct BlockShellPCContext {
+	const UMesh<freal,NDIM> *mesh;
+	BlockShellPreconditioner<bs> *prec;
+	BAIJJacobianLayout<bs> *layout;                  ///< Positions of blocks in the current P
+	double setupwtime, applywtime, cputime;          ///< Accumulated times
+};
+
+template <int bs>
+static StatusCode block_shell_pc_setup(PC pc)
+{
+	StatusCode ierr = 0;
+	BlockShellPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+	Mat A, P;
+	ierr = PCGetOperators(pc, &A, &P); CHKERRQ(ierr);
+
+	const double wstart = MPI_Wtime();
+	const std::clock_t cstart = std::clock();
+
+	// The layout is only recomputed when the structure of P changes
+	if(!ctx->layout || !ctx->layout->describes(P)) {
+		delete ctx->layout;
+		ctx->layout = nullptr;
+		try {
+			ctx->layout = new BAIJJacobianLayout<bs>(*ctx->mesh, P);
+		} catch (std::runtime_error& e) {
+			const char *name = NULL;
+			ierr = PCShellGetName(pc, &name); CHKERRQ(ierr);
+			std::cerr << (name ? name : "Block shell PC") << ": " << e.what() << std::endl;
+			SETERRQ(PETSC_COMM_SELF, PETSC_ERR_SUP, "Block shell PC: incompatible matrix!");
+		}
+	}
+	ierr = ctx->prec->setup(P, *ctx->layout); CHKERRQ(ierr);
+
+	ctx->setupwtime += MPI_Wtime() - wstart;
+	ctx->cputime += static_cast<double>(std::clock() - cstart)/CLOCKS_PER_SEC;
+	return ierr;
+}
+
+template <int bs>
+static StatusCode block_shell_pc_apply(PC pc, Vec x, Vec y)
+{
+	StatusCode ierr = 0;
+	BlockShellPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+
+	const double wstart = MPI_Wtime();
+	const std::clock_t cstart = std::clock();
+	{
+		ConstVecHandler<PetscScalar> xh(x);
+		MutableVecHandler<PetscScalar> yh(y);
+		ctx->prec->apply(xh.getArray(), yh.getArray());
+	}
+	ctx->applywtime += MPI_Wtime() - wstart;
+	ctx->cputime += static_cast<double>(std::clock() - cstart)/CLOCKS_PER_SEC;
+	return ierr;
+}
+
+template <int bs>
+static StatusCode block_shell_pc_destroy(PC pc)
+{
+	StatusCode ierr = 0;
+	BlockShellPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+	delete ctx->layout;
+	delete ctx->prec;
+	delete ctx;
+	return ierr;
+}
+
+template <int bs>
+StatusCode setup_block_shell_pc(PC pc, const UMesh<freal,NDIM>& mesh,
+                                BlockShellPreconditioner<bs> *const prec, const std::string name)
+{
+	StatusCode ierr = 0;
+	BlockShellPCContext<bs> *const ctx = new BlockShellPCContext<bs>;
+	ctx->mesh = &mesh;
+	ctx->prec = prec;
+	ctx->layout = nullptr;
+	ctx->setupwtime = ctx->applywtime = ctx->cputime = 0;
+
+	ierr = PCSetType(pc, PCSHELL); CHKERRQ(ierr);
+	ierr = PCShellSetContext(pc, (void*)ctx); CHKERRQ(ierr);
+	ierr = PCShellSetSetUp(pc, &block_shell_pc_setup<bs>); CHKERRQ(ierr);
+	ierr = PCShellSetApply(pc, &block_shell_pc_apply<bs>); CHKERRQ(ierr);
+	ierr = PCShellSetDestroy(pc, &block_shell_pc_destroy<bs>); CHKERRQ(ierr);
+	ierr = PCShellSetName(pc, name.c_str()); CHKERRQ(ierr);
+	return ierr;
+}
+
+template <int bs>
+StatusCode get_block_shell_pc_times(PC pc, const char *const name_prefix,
+                                    bool *const is_block_shell_pc, double *const setupwtime,
+                                    double *const applywtime, double *const cputime)
+{
+	StatusCode ierr = 0;
+	*is_block_shell_pc = false;
+
+	PetscBool isshell = PETSC_FALSE;
+	ierr = PetscObjectTypeCompare((PetscObject)pc, PCSHELL, &isshell); CHKERRQ(ierr);
+	if(!isshell)
+		return ierr;
+	const char *name = NULL;
+	ierr = PCShellGetName(pc, &name); CHKERRQ(ierr);
+	if(!name || std::strncmp(name, name_prefix, std::strlen(name_prefix)))
+		return ierr;
+
+	BlockShellPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+	*is_block_shell_pc = true;
+	*setupwtime = ctx->setupwtime;
+	*applywtime = ctx->applywtime;
+	*cputime = ctx->cputime;
+	return ierr;
+}
+
+template StatusCode setup_block_shell_pc<NVARS>(PC pc, const UMesh<freal,NDIM>& mesh,
+                                                BlockShellPreconditioner<NVARS> *const prec,
+                                                const std::string name);
+template StatusCode setup_block_shell_pc<1>(PC pc, const UMesh<freal,NDIM>& mesh,
+                                            BlockShellPreconditioner<1> *const prec,
+                                            const std::string name);
+template StatusCode get_block_shell_pc_times<NVARS>(PC pc, const char *const name_prefix,
+                                                    bool *const is_block_shell_pc,
+                                                    double *const setupwtime,
+                                                    double *const applywtime, double *const cputime);
+template StatusCode get_block_shell_pc_times<1>(PC pc, const char *const name_prefix,
+                                                bool *const is_block_shell_pc,
+                                                double *const setupwtime,
+                                                double *const applywtime, double *const cputime);
+
+/// Block Jacobi preconditioner applied by a \ref BlockSparseMatrix
+template <int bs>
+class BlockJacobiPreconditioner : public BlockSparseMatrix<freal,bs>,
+                                  public BlockShellPreconditioner<bs>
+{
+public:
+	BlockJacobiPreconditioner(const UMesh<freal,NDIM>& mesh) : BlockSparseMatrix<freal,bs>(mesh)
+	{ }
+
+	StatusCode setup(Mat P, const BAIJJacobianLayout<bs>& layout)
+	{
+		StatusCode ierr = this->copy_from(P, layout); CHKERRQ(ierr);
+		this->invert_diagonal_blocks();
+		return ierr;
+	}
+
+	void apply(const freal *const x, freal *const y) const
+	{
+		this->apply_block_diagonal_inverse(x, y);
+	}
+};
+
+template <int bs>
+StatusCode setup_block_sparse_pc(PC pc, const UMesh<freal,NDIM>& mesh, const std::string type)
+{
+	if(type == "jacobi")
+		return setup_block_shell_pc<bs>(pc, mesh, new BlockJacobiPreconditioner<bs>(mesh),
+		                                "block sparse Jacobi");
+	else
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE,
+		        "Block sparse PC: type must be jacobi; use setup_block_sgs for SGS!");
+}
+
+template StatusCode setup_block_sparse_pc<NVARS>(PC pc, const UMesh<freal,NDIM>& mesh,
+                                                 const std::string type);
+template StatusCode setup_block_sparse_pc<1>(PC pc, const UMesh<freal,NDIM>& mesh,
+                                             const std::string type);
+
+}
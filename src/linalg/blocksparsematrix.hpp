@@ -0,0 +1,225 @@
+/** \file
+ * \brief Block sparse row matrix with the structure of a cell-centred finite volume Jacobian
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_BLOCK_SPARSE_MATRIX_H
+#define FVENS_BLOCK_SPARSE_MATRIX_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <petscksp.h>
+#include "mesh/mesh.hpp"
+#include "haloexchange.hpp"
+#include "jacobianlayout.hpp"
+
+namespace fvens {
+
+/// Block sparse row (BSR) matrix whose non-zero structure is the face graph of a mesh
+/** There is one block row for each subdomain cell. Its blocks are those of the cell itself and of
+ * its face neighbours in the subdomain, in increasing order of column; the position of the diagonal
+ * block is stored separately. Blocks coupling subdomain cells to connectivity ghost cells are stored
+ * in a separate array, one per connectivity face.
+ *
+ * Blocks are stored column-major, as in PETSc BAIJ matrices, so that the product of a block with a
+ * vector is a sum of scaled block columns. Since the block size is known at compile time, each
+ * column is a fixed-size Eigen vector and is operated on with SIMD instructions; for bs = 4 in
+ * double precision, a block column is exactly one AVX register.
+ *
+ * Vectors are always in fvens::freal. The block storage type can be float to halve memory traffic,
+ * in which case blocks are converted to freal as they are used.
+ *
+ * \tparam scalar Type in which blocks are stored
+ * \tparam bs Block size
+ */
+template <typename scalar, int bs>
+class BlockSparseMatrix
+{
+public:
+	/// Sets up the non-zero structure from the mesh; all blocks are zero
+	/** Collective over MPI_COMM_WORLD, because the exchange of ghost vector entries needed for
+	 * products in parallel is also set up.
+	 */
+	BlockSparseMatrix(const UMesh<freal,NDIM>& mesh);
+
+	/// Copies the values of an assembled BAIJ Jacobian with the same structure
+	/** \param A The matrix to copy from
+	 * \param layout Positions of the blocks of A
+	 */
+	StatusCode copy_from(Mat A, const BAIJJacobianLayout<bs>& layout);
+
+	/// Sets all blocks to zero
+	void set_zero();
+
+	/// Adds a multiple of the identity to every diagonal block
+	void shift_diagonal(const freal shift);
+
+	/// Computes y <- A x
+	/** In parallel, the ghost entries of x are exchanged with the neighbouring subdomains, and
+	 * the off-subdomain blocks are applied once they arrive.
+	 * \param x Entries of the vector at subdomain cells
+	 * \param y Product at subdomain cells
+	 */
+	void apply(const freal *const x, freal *const y) const;
+
+	/// Computes y <- A_s x, where A_s is the subdomain part of A
+	void apply_subdomain(const freal *const x, freal *const y) const;
+
+	/// Computes the inverses of the diagonal blocks
+	/** Needed before \ref apply_block_diagonal_inverse, \ref lower_solve and \ref upper_solve.
+	 * The inversion is done in freal, and the result stored in the storage type.
+	 */
+	void invert_diagonal_blocks();
+
+	/// Computes y <- D^{-1} x, where D is the block diagonal of A
+	void apply_block_diagonal_inverse(const freal *const x, freal *const y) const;
+
+	/// Solves (D + L) y = x, where L is the strictly lower block triangular part of A_s
+	void lower_solve(const freal *const x, freal *const y) const;
+
+	/// Solves (D + U) y = x, where U is the strictly upper block triangular part of A_s
+	void upper_solve(const freal *const x, freal *const y) const;
+
+	/// Applies the block symmetric Gauss-Seidel preconditioner of A_s,
+	///  y <- (D+U)^{-1} D (D+L)^{-1} x
+	/** \param work Temporary array of the size of x
+	 */
+	void apply_sgs(const freal *const x, freal *const work, freal *const y) const;
+
+	/// Carries out one forward and one backward block Gauss-Seidel sweep for A_s y = x, starting
+	///  from the current y
+	void sgs_sweep(const freal *const x, freal *const y) const;
+
+	/// Number of block rows
+	fint num_block_rows() const { return nbrows; }
+
+	/// Number of non-zero blocks, including off-subdomain blocks
+	fint num_blocks() const { return static_cast<fint>(bcolind.size() + conncol.size()); }
+
+	/// Number of bytes used for the storage of blocks, inverse diagonal blocks and indices
+	size_t storage_bytes() const;
+
+	/// Value array of all subdomain blocks, in order of block rows
+	const scalar *values() const { return vals.data(); }
+
+protected:
+	/// The mesh from whose face graph the structure comes
+	const UMesh<freal,NDIM>& m;
+
+	/// Number of block rows
+	const fint nbrows;
+
+	/// Index of the first block of each block row in \ref bcolind; size nbrows+1
+	std::vector<fint> browptr;
+	/// Block-column index of each subdomain block
+	std::vector<fint> bcolind;
+	/// Index of the diagonal block of each block row
+	std::vector<fint> diagind;
+	/// Index of the blocks (left cell, right cell) and (right cell, left cell) of each subdomain
+	///  face, in the order of subdomain faces
+	std::vector<fint> faceupper, facelower;
+
+	/// Row of the off-subdomain block of each connectivity face
+	std::vector<fint> connrow;
+	/// Column of the off-subdomain block of each connectivity face - its ghost cell
+	std::vector<fint> conncol;
+
+	/// Subdomain blocks, each stored column-major
+	std::vector<scalar> vals;
+	/// Off-subdomain blocks, one per connectivity face
+	std::vector<scalar> connvals;
+	/// Inverses of diagonal blocks
+	std::vector<scalar> dinv;
+
+	/// Exchange of vector entries at connectivity ghost cells
+	std::unique_ptr<HaloExchange> halo;
+	/// Buffer for the vector entries at subdomain and connectivity ghost cells
+	mutable std::vector<freal> xghost;
+
+	/// Computes D_i^{-1} (x_i - sum_{j in cols} A_ij y_j) for block row i, with cols either all
+	///  columns before or all columns after the diagonal
+	void relax_row(const fint irow, const bool lower, const freal *const x, freal *const y) const;
+
+	/// Computes D_i^{-1} (x_i - sum_{j != i} A_ij y_j) for block row i
+	void relax_row_full(const fint irow, const freal *const x, freal *const y) const;
+};
+
+/// Creates a PETSc shell matrix which applies a \ref BlockSparseMatrix
+/** The BlockSparseMatrix must outlive the shell matrix. Only MatMult is provided.
+ */
+template <typename scalar, int bs>
+StatusCode create_block_sparse_shell_matrix(const BlockSparseMatrix<scalar,bs> *const mat,
+                                            Mat *const A);
+
+/// Preconditioner built from the blocks of a BAIJ preconditioning matrix, for use through
+///  \ref setup_block_shell_pc
+template <int bs>
+class BlockShellPreconditioner
+{
+public:
+	virtual ~BlockShellPreconditioner() { }
+
+	/// Copies the blocks of the preconditioning matrix and computes the preconditioner
+	/** \param P The preconditioning matrix
+	 * \param layout Positions of the blocks of P
+	 */
+	virtual StatusCode setup(Mat P, const BAIJJacobianLayout<bs>& layout) = 0;
+
+	/// Applies the preconditioner: y <- M^{-1} x
+	virtual void apply(const freal *const x, freal *const y) const = 0;
+};
+
+/// Sets a PC to apply a \ref BlockShellPreconditioner, using the PETSc shell PC interface
+/** At every PC set-up, the \ref BAIJJacobianLayout of the preconditioning matrix, which must be
+ * BAIJ, is recomputed if its structure has changed, and the preconditioner is set up from it.
+ * The wall-clock and CPU times of set-up and application are accumulated; see
+ * \ref get_block_shell_pc_times.
+ * \param pc The PC to set; its type is changed to PCSHELL
+ * \param mesh The mesh from which the preconditioning matrix is assembled
+ * \param prec The preconditioner, which the PC takes ownership of
+ * \param name Name of the shell PC
+ */
+template <int bs>
+StatusCode setup_block_shell_pc(PC pc, const UMesh<freal,NDIM>& mesh,
+                                BlockShellPreconditioner<bs> *const prec, const std::string name);
+
+/// Gets the total set-up and application times of a PC, if it was set by
+///  \ref setup_block_shell_pc with a name starting with a given prefix
+/** \param name_prefix Prefix of the names of the PCs to recognize
+ * \param[out] is_block_shell_pc Whether the PC is such a PC; if not, the times are not set
+ * \param[out] setupwtime Wall-clock time spent in set-up
+ * \param[out] applywtime Wall-clock time spent in application
+ * \param[out] cputime Total CPU time, over all threads, of set-up and application
+ */
+template <int bs>
+StatusCode get_block_shell_pc_times(PC pc, const char *const name_prefix,
+                                    bool *const is_block_shell_pc, double *const setupwtime,
+                                    double *const applywtime, double *const cputime);
+
+/// Sets a PC to be a block Jacobi preconditioner applied through a \ref BlockSparseMatrix,
+///  using the PETSc shell PC interface
+/** At every PC set-up, the blocks of the preconditioning matrix, which must be BAIJ, are copied
+ * into the block sparse matrix. Block SGS is set up by \ref setup_block_sgs instead.
+ * \param pc The PC to set; its type is changed to PCSHELL
+ * \param mesh The mesh from which the preconditioning matrix is assembled
+ * \param type "jacobi"
+ */
+template <int bs>
+StatusCode setup_block_sparse_pc(PC pc, const UMesh<freal,NDIM>& mesh, const std::string type);
+
+}
+#endif
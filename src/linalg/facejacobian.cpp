@@ -0,0 +1,355 @@
+/** \file
+ * \brief Implementation of the face-based Jacobian and its PETSc wrappers
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <Eigen/LU>
+#include "facejacobian.hpp"
+#include "blockkernels.hpp"
+#include "petscutils.hpp"
+#include "mesh/ameshutils.hpp"
+#include "utilities/aerrorhandling.hpp"
+
+namespace fvens {
+
+template <int bs>
+FaceJacobian<bs>::FaceJacobian(const UMesh<freal,NDIM>& mesh) : m{mesh}
+{
+	diag.assign(static_cast<size_t>(m.gnelem())*bs*bs, 0);
+	lowervals.assign(static_cast<size_t>(m.gSubDomFaceEnd()-m.gSubDomFaceStart())*bs*bs, 0);
+	uppervals.assign(static_cast<size_t>(m.gDomFaceEnd()-m.gDomFaceStart())*bs*bs, 0);
+	dinv.assign(static_cast<size_t>(m.gnelem())*bs*bs, 0);
+
+	colourFaces(m, colourptr, colourfaces);
+
+	cellcolours = colourCells(m);
+	const int ncellcolours = m.gnelem() > 0
+		? *std::max_element(cellcolours.begin(), cellcolours.end())+1 : 0;
+	cellcolourptr.assign(ncellcolours+1, 0);
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		cellcolourptr[cellcolours[iel]+1]++;
+	for(int icol = 0; icol < ncellcolours; icol++)
+		cellcolourptr[icol+1] += cellcolourptr[icol];
+	colourcells.resize(m.gnelem());
+	std::vector<fint> pos(cellcolourptr.begin(), cellcolourptr.end()-1);
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		colourcells[pos[cellcolours[iel]]++] = iel;
+
+	halo.reset(new HaloExchange(m, {{HALO_CELL, bs}}));
+	xghost.resize(static_cast<size_t>(m.gnelem() + m.gnConnFace())*bs);
+}
+
+template <int bs>
+void FaceJacobian<bs>::set_zero()
+{
+	std::fill(diag.begin(), diag.end(), 0);
+	std::fill(lowervals.begin(), lowervals.end(), 0);
+	std::fill(uppervals.begin(), uppervals.end(), 0);
+}
+
+template <int bs>
+void FaceJacobian<bs>::add_to_diagonal(const freal *const shifts)
+{
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(int i = 0; i < bs; i++)
+			diag[iel*bs*bs + i*bs+i] += shifts[iel];
+}
+
+template <int bs>
+void FaceJacobian<bs>::apply(const freal *const x, freal *const y) const
+{
+	const void *const sources[] = {x};
+	halo->begin(sources);
+
+	const fint subdomstart = m.gSubDomFaceStart(), subdomend = m.gSubDomFaceEnd();
+
+#pragma omp parallel default(shared)
+	{
+#pragma omp for
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+		{
+			BlockVector<bs> yi = BlockVector<bs>::Zero();
+			block_gemv_add<freal,bs>(&diag[iel*bs*bs], &x[iel*bs], yi);
+			Eigen::Map<BlockVector<bs>>(y+iel*bs) = yi;
+		}
+
+		// No two faces of a colour touch the same cell, so each row is updated by one thread
+		for(int icol = 0; icol < numColours(); icol++)
+		{
+#pragma omp for
+			for(fint i = colourptr[icol]; i < colourptr[icol+1]; i++)
+			{
+				const fint iface = colourfaces[i];
+				if(iface < subdomstart || iface >= subdomend)
+					continue;
+				const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+
+				Eigen::Map<BlockVector<bs>> yl(y+lelem*bs);
+				BlockVector<bs> accl = yl;
+				block_gemv_add<freal,bs>(&uppervals[(iface-m.gDomFaceStart())*bs*bs], &x[relem*bs], accl);
+				yl = accl;
+
+				Eigen::Map<BlockVector<bs>> yr(y+relem*bs);
+				BlockVector<bs> accr = yr;
+				block_gemv_add<freal,bs>(&lowervals[(iface-subdomstart)*bs*bs], &x[lelem*bs], accr);
+				yr = accr;
+			}
+		}
+	}
+
+	void *const targets[] = {xghost.data()};
+	halo->end(targets);
+
+	// Few cells have more than one connectivity face, but they may; so this is done serially.
+	for(fint iface = m.gConnBFaceStart(); iface < m.gConnBFaceEnd(); iface++)
+	{
+		const fint lelem = m.gintfac(iface,0), relem = m.gintfac(iface,1);
+		Eigen::Map<BlockVector<bs>> yl(y+lelem*bs);
+		BlockVector<bs> acc = yl;
+		block_gemv_add<freal,bs>(&uppervals[(iface-m.gDomFaceStart())*bs*bs], &xghost[relem*bs], acc);
+		yl = acc;
+	}
+}
+
+template <int bs>
+void FaceJacobian<bs>::invert_diagonal_blocks()
+{
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+	{
+		Eigen::Map<Eigen::Matrix<freal,bs,bs>> di(&dinv[iel*bs*bs]);
+		di = Eigen::Map<const Eigen::Matrix<freal,bs,bs>>(&diag[iel*bs*bs]).inverse();
+	}
+}
+
+template <int bs>
+void FaceJacobian<bs>::apply_block_diagonal_inverse(const freal *const x, freal *const y) const
+{
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+	{
+		BlockVector<bs> yi = BlockVector<bs>::Zero();
+		block_gemv_add<freal,bs>(&dinv[iel*bs*bs], &x[iel*bs], yi);
+		Eigen::Map<BlockVector<bs>>(y+iel*bs) = yi;
+	}
+}
+
+template <int bs>
+inline void FaceJacobian<bs>::relax_cell(const fint iel, const bool lower,
+                                         const freal *const x, freal *const y) const
+{
+	BlockVector<bs> r = Eigen::Map<const BlockVector<bs>>(x+iel*bs);
+	for(int ifael = 0; ifael < m.gnfael(iel); ifael++)
+	{
+		const fint iface = m.gelemface(iel,ifael);
+		if(iface < m.gSubDomFaceStart() || iface >= m.gSubDomFaceEnd())
+			continue;
+
+		// Neighbours never share a colour
+		const fint jel = m.gesuel(iel,ifael);
+		if((lower && cellcolours[jel] > cellcolours[iel])
+		   || (!lower && cellcolours[jel] < cellcolours[iel]))
+			continue;
+
+		// The block in row iel is U of the face if iel is its left cell, else L
+		const freal *const blk = m.gintfac(iface,0) == iel
+			? &uppervals[(iface-m.gDomFaceStart())*bs*bs]
+			: &lowervals[(iface-m.gSubDomFaceStart())*bs*bs];
+		block_gemv_sub<freal,bs>(blk, &y[jel*bs], r);
+	}
+
+	BlockVector<bs> yi = BlockVector<bs>::Zero();
+	block_gemv_add<freal,bs>(&dinv[iel*bs*bs], r.data(), yi);
+	Eigen::Map<BlockVector<bs>>(y+iel*bs) = yi;
+}
+
+template <int bs>
+void FaceJacobian<bs>::apply_sgs(const freal *const x, freal *const work, freal *const y) const
+{
+	const int ncellcolours = static_cast<int>(cellcolourptr.size())-1;
+
+#pragma omp parallel default(shared)
+	{
+		// No two cells of a colour are coupled, so the cells of each colour are relaxed in parallel
+		for(int icol = 0; icol < ncellcolours; icol++)
+		{
+#pragma omp for
+			for(fint i = cellcolourptr[icol]; i < cellcolourptr[icol+1]; i++)
+				relax_cell(colourcells[i], true, x, y);
+		}
+
+#pragma omp for
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+		{
+			BlockVector<bs> wi = BlockVector<bs>::Zero();
+			block_gemv_add<freal,bs>(&diag[iel*bs*bs], &y[iel*bs], wi);
+			Eigen::Map<BlockVector<bs>>(work+iel*bs) = wi;
+		}
+
+		for(int icol = ncellcolours-1; icol >= 0; icol--)
+		{
+#pragma omp for
+			for(fint i = cellcolourptr[icol]; i < cellcolourptr[icol+1]; i++)
+				relax_cell(colourcells[i], false, work, y);
+		}
+	}
+}
+
+template <int bs>
+size_t FaceJacobian<bs>::storage_bytes() const
+{
+	return (diag.size() + lowervals.size() + uppervals.size() + dinv.size())*sizeof(freal)
+		+ (colourptr.size() + colourfaces.size() + cellcolourptr.size() + colourcells.size())
+		  *sizeof(fint) + cellcolours.size()*sizeof(int);
+}
+
+template class FaceJacobian<NVARS>;
+template class FaceJacobian<1>;
+
+template <int bs>
+static StatusCode face_jacobian_mult(Mat A, Vec x, Vec y)
+{
+	StatusCode ierr = 0;
+	const FaceJacobian<bs> *jac;
+	ierr = MatShellGetContext(A, (void*)&jac); CHKERRQ(ierr);
+
+	ConstVecHandler<PetscScalar> xh(x);
+	MutableVecHandler<PetscScalar> yh(y);
+	jac->apply(xh.getArray(), yh.getArray());
+	return ierr;
+}
+
+template <int bs>
+StatusCode create_face_jacobian_shell_matrix(FaceJacobian<bs> *const jac, Mat *const A)
+{
+	StatusCode ierr = 0;
+	const PetscInt nlocal = jac->num_cells()*bs;
+	ierr = MatCreateShell(PETSC_COMM_WORLD, nlocal, nlocal, PETSC_DETERMINE, PETSC_DETERMINE,
+	                      (void*)jac, A); CHKERRQ(ierr);
+	ierr = MatSetBlockSize(*A, bs); CHKERRQ(ierr);
+	ierr = MatShellSetOperation(*A, MATOP_MULT, (void(*)(void))&face_jacobian_mult<bs>);
+	CHKERRQ(ierr);
+	return ierr;
+}
+
+template StatusCode create_face_jacobian_shell_matrix(FaceJacobian<NVARS> *const jac, Mat *const A);
+template StatusCode create_face_jacobian_shell_matrix(FaceJacobian<1> *const jac, Mat *const A);
+
+template <int bs>
+FaceJacobian<bs> *get_face_jacobian(Mat A)
+{
+	MatType mattype;
+	StatusCode ierr = MatGetType(A, &mattype); petsc_throw(ierr, "Get Mat type");
+	if(!mattype || strcmp(mattype, MATSHELL))
+		return nullptr;
+
+	// Shell matrices are told apart by their product operation
+	void (*mult)(void) = nullptr;
+	ierr = MatShellGetOperation(A, MATOP_MULT, &mult); petsc_throw(ierr, "Get shell MatMult");
+	if(mult != (void(*)(void))&face_jacobian_mult<bs>)
+		return nullptr;
+
+	FaceJacobian<bs> *jac = nullptr;
+	ierr = MatShellGetContext(A, (void*)&jac); petsc_throw(ierr, "Get shell context");
+	return jac;
+}
+
+template FaceJacobian<NVARS> *get_face_jacobian(Mat A);
+template FaceJacobian<1> *get_face_jacobian(Mat A);
+
+/// Context of the shell PC
+template <int bs>
+struct FaceJacobianPCContext {
+	bool sgs;                                        ///< SGS if true, else block Jacobi
+	FaceJacobian<bs> *jac;                           ///< Jacobian of the current P
+	std::vector<freal> work;
+};
+
+template <int bs>
+static StatusCode face_jacobian_pc_setup(PC pc)
+{
+	StatusCode ierr = 0;
+	FaceJacobianPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+	Mat A, P;
+	ierr = PCGetOperators(pc, &A, &P); CHKERRQ(ierr);
+
+	ctx->jac = get_face_jacobian<bs>(P);
+	if(!ctx->jac)
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG,
+		        "Face Jacobian PC: preconditioning matrix is not a face Jacobian!");
+
+	// The inverses are kept with the Jacobian, so the PC itself only needs a work vector
+	ctx->jac->invert_diagonal_blocks();
+	ctx->work.resize(static_cast<size_t>(ctx->jac->num_cells())*bs);
+	return ierr;
+}
+
+template <int bs>
+static StatusCode face_jacobian_pc_apply(PC pc, Vec x, Vec y)
+{
+	StatusCode ierr = 0;
+	FaceJacobianPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+
+	ConstVecHandler<PetscScalar> xh(x);
+	MutableVecHandler<PetscScalar> yh(y);
+	if(ctx->sgs)
+		ctx->jac->apply_sgs(xh.getArray(), ctx->work.data(), yh.getArray());
+	else
+		ctx->jac->apply_block_diagonal_inverse(xh.getArray(), yh.getArray());
+	return ierr;
+}
+
+template <int bs>
+static StatusCode face_jacobian_pc_destroy(PC pc)
+{
+	StatusCode ierr = 0;
+	FaceJacobianPCContext<bs> *ctx;
+	ierr = PCShellGetContext(pc, (void*)&ctx); CHKERRQ(ierr);
+	delete ctx;
+	return ierr;
+}
+
+template <int bs>
+StatusCode setup_face_jacobian_pc(PC pc, const std::string type)
+{
+	StatusCode ierr = 0;
+	if(type != "jacobi" && type != "sgs")
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE,
+		        "Face Jacobian PC: type must be jacobi or sgs!");
+
+	FaceJacobianPCContext<bs> *const ctx = new FaceJacobianPCContext<bs>;
+	ctx->sgs = (type == "sgs");
+	ctx->jac = nullptr;
+
+	ierr = PCSetType(pc, PCSHELL); CHKERRQ(ierr);
+	ierr = PCShellSetContext(pc, (void*)ctx); CHKERRQ(ierr);
+	ierr = PCShellSetSetUp(pc, &face_jacobian_pc_setup<bs>); CHKERRQ(ierr);
+	ierr = PCShellSetApply(pc, &face_jacobian_pc_apply<bs>); CHKERRQ(ierr);
+	ierr = PCShellSetDestroy(pc, &face_jacobian_pc_destroy<bs>); CHKERRQ(ierr);
+	ierr = PCShellSetName(pc, ctx->sgs ? "face Jacobian SGS" : "face Jacobian block Jacobi");
+	CHKERRQ(ierr);
+	return ierr;
+}
+
+template StatusCode setup_face_jacobian_pc<NVARS>(PC pc, const std::string type);
+template StatusCode setup_face_jacobian_pc<1>(PC pc, const std::string type);
+
+}
@@ -0,0 +1,169 @@
+/** \file
+ * \brief Face-based storage of first-order finite volume Jacobians
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_FACE_JACOBIAN_H
+#define FVENS_FACE_JACOBIAN_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <petscksp.h>
+#include "mesh/mesh.hpp"
+#include "haloexchange.hpp"
+
+namespace fvens {
+
+/// First-order Jacobian stored as one diagonal block per cell and the off-diagonal blocks of
+///  each face, in the order of the faces of the mesh
+/** The blocks (right cell, left cell) and (left cell, right cell) of a subdomain face are the L and
+ * U computed by Spatial::compute_local_jacobian_interior for that face; a connectivity face only has
+ * the latter, which couples its subdomain cell to its ghost cell. Unlike a BAIJ matrix, no column
+ * indices or row pointers are stored: the structure is the face connectivity of the mesh.
+ *
+ * Products are computed by a loop over faces. For thread parallelism, the faces are coloured such
+ * that no two faces of a colour touch the same subdomain cell; the same colouring lets the
+ * Jacobian be assembled without synchronization, see Spatial::assemble_jacobian.
+ *
+ * Blocks are stored column-major, as in PETSc BAIJ matrices.
+ *
+ * \tparam bs Block size
+ */
+template <int bs>
+class FaceJacobian
+{
+public:
+	/// Allocates storage for the mesh and colours its faces; all blocks are zero
+	/** Collective over MPI_COMM_WORLD, because the exchange of ghost vector entries needed for
+	 * products in parallel is also set up.
+	 */
+	FaceJacobian(const UMesh<freal,NDIM>& mesh);
+
+	/// Sets all blocks to zero
+	void set_zero();
+
+	/// Diagonal block of a subdomain cell
+	freal *diagonal(const fint iel) { return &diag[iel*bs*bs]; }
+
+	/// Block (right cell, left cell) of a subdomain face
+	freal *lower(const fint iface) { return &lowervals[(iface-m.gSubDomFaceStart())*bs*bs]; }
+
+	/// Block (left cell, right cell) of a connectivity or subdomain face
+	freal *upper(const fint iface) { return &uppervals[(iface-m.gDomFaceStart())*bs*bs]; }
+
+	/// Number of face colours
+	int numColours() const { return static_cast<int>(colourptr.size())-1; }
+
+	/// Faces of one colour
+	/// @{
+	fint colourStart(const int icol) const { return colourptr[icol]; }
+	fint colourEnd(const int icol) const { return colourptr[icol+1]; }
+	fint colourFace(const fint i) const { return colourfaces[i]; }
+	/// @}
+
+	/// Adds a multiple of the identity to each diagonal block
+	/** \param shifts The multiple for each subdomain cell
+	 */
+	void add_to_diagonal(const freal *const shifts);
+
+	/// Computes y <- A x
+	/** In parallel, the ghost entries of x are exchanged with the neighbouring subdomains, and
+	 * the blocks of connectivity faces are applied once they arrive.
+	 * \param x Entries of the vector at subdomain cells
+	 * \param y Product at subdomain cells
+	 */
+	void apply(const freal *const x, freal *const y) const;
+
+	/// Computes the inverses of the diagonal blocks
+	/** Needed before \ref apply_block_diagonal_inverse and \ref apply_sgs.
+	 */
+	void invert_diagonal_blocks();
+
+	/// Computes y <- D^{-1} x, where D is the block diagonal of A
+	void apply_block_diagonal_inverse(const freal *const x, freal *const y) const;
+
+	/// Applies the block symmetric Gauss-Seidel preconditioner of the subdomain part A_s of A,
+	///  y <- (D+U)^{-1} D (D+L)^{-1} x, with L and U in the multicolour ordering of the cells
+	/** The cells are coloured by fvens::colourCells, and those of one colour come after those of
+	 * all lower colours, as in ThreadedBlockPreconditioner with SCHEDULE_COLOURS. Since no two cells
+	 * of a colour are neighbours, the cells of each colour are relaxed in parallel by threads. The
+	 * neighbours of each cell are found through its faces.
+	 * \param work Temporary array of the size of x
+	 */
+	void apply_sgs(const freal *const x, freal *const work, freal *const y) const;
+
+	/// Number of subdomain cells
+	fint num_cells() const { return m.gnelem(); }
+
+	/// Number of bytes used for the storage of blocks, inverse diagonal blocks and face and cell
+	///  colours
+	size_t storage_bytes() const;
+
+protected:
+	/// The mesh whose faces give the structure
+	const UMesh<freal,NDIM>& m;
+
+	/// Diagonal blocks of subdomain cells
+	std::vector<freal> diag;
+	/// Blocks (right cell, left cell) of subdomain faces
+	std::vector<freal> lowervals;
+	/// Blocks (left cell, right cell) of connectivity and subdomain faces
+	std::vector<freal> uppervals;
+	/// Inverses of diagonal blocks
+	std::vector<freal> dinv;
+
+	std::vector<fint> colourptr;         ///< Start of each colour in \ref colourfaces
+	std::vector<fint> colourfaces;       ///< Faces sorted by colour
+
+	std::vector<int> cellcolours;        ///< Colour of each subdomain cell, for SGS
+	std::vector<fint> cellcolourptr;     ///< Start of each cell colour in \ref colourcells
+	std::vector<fint> colourcells;       ///< Subdomain cells sorted by colour
+
+	/// Exchange of vector entries at connectivity ghost cells
+	std::unique_ptr<HaloExchange> halo;
+	/// Buffer for the vector entries at subdomain and connectivity ghost cells
+	mutable std::vector<freal> xghost;
+
+	/// Computes D_i^{-1} (x_i - sum_j A_ij y_j) for a cell i, with j either all face neighbours
+	///  of lower colour than i or all face neighbours of higher colour
+	void relax_cell(const fint iel, const bool lower, const freal *const x, freal *const y) const;
+};
+
+/// Creates a PETSc shell matrix which applies a \ref FaceJacobian
+/** The FaceJacobian must outlive the shell matrix, which does not own it. MatMult is provided.
+ * The Jacobian is assembled into the face storage by the nonlinear solvers when the shell matrix
+ * is the preconditioning matrix; see \ref get_face_jacobian.
+ */
+template <int bs>
+StatusCode create_face_jacobian_shell_matrix(FaceJacobian<bs> *const jac, Mat *const A);
+
+/// Returns the \ref FaceJacobian applied by a shell matrix, or null if the matrix is not a shell
+///  matrix created by \ref create_face_jacobian_shell_matrix
+template <int bs>
+FaceJacobian<bs> *get_face_jacobian(Mat A);
+
+/// Sets a PC to be a block Jacobi or block SGS preconditioner built on the \ref FaceJacobian of
+///  the preconditioning matrix, using the PETSc shell PC interface
+/** The preconditioning matrix must have been created by \ref create_face_jacobian_shell_matrix.
+ * \param pc The PC to set; its type is changed to PCSHELL
+ * \param type "jacobi" or "sgs"
+ */
+template <int bs>
+StatusCode setup_face_jacobian_pc(PC pc, const std::string type);
+
+}
+#endif
@@ -0,0 +1,298 @@
+/** \file
+ * \brief Implementation of the exchange of data across connectivity faces
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+#include <map>
+#include <numeric>
+#include <cstring>
+#include "utilities/mpiutils.hpp"
+#include "haloexchange.hpp"
+
+namespace fvens {
+
+static int totalWidth(const std::vector<HaloFieldLayout>& layouts)
+{
+	return std::accumulate(layouts.begin(), layouts.end(), 0,
+	                       [](const int w, const HaloFieldLayout& l) { return w + l.width; });
+}
+
+/// Size in bytes of one value of a given type
+static int valueSize(const HaloValueType type)
+{
+	return type == HALO_FLOAT ? static_cast<int>(sizeof(float)) : static_cast<int>(sizeof(freal));
+}
+
+static int totalBytes(const std::vector<HaloFieldLayout>& layouts)
+{
+	return std::accumulate(layouts.begin(), layouts.end(), 0,
+	                       [](const int b, const HaloFieldLayout& l)
+	                       { return b + l.width*valueSize(l.type); });
+}
+
+HaloExchange::HaloExchange(const UMesh<freal,NDIM>& mesh,
+                           const std::vector<HaloFieldLayout>& layouts)
+	: m{mesh}, fields(layouts), facewidth{totalWidth(layouts)}, facebytes{totalBytes(layouts)}
+{
+	int ierr = MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+	mpi_throw(ierr, "HaloExchange: Could not duplicate communicator!");
+
+	compute_comm_pattern();
+
+	// One message buffer in each direction per neighbour, each row holding all fields at one face
+	for(size_t irank = 0; irank < nbdranks.size(); irank++) {
+		sendbufs.push_back(buffers.reserve<char>(static_cast<fint>(sendfaces[irank].size()),
+		                                         facebytes));
+		recvbufs.push_back(buffers.reserve<char>(static_cast<fint>(recvfaces[irank].size()),
+		                                         facebytes));
+	}
+	buffers.allocate();
+
+	srequests.resize(nbdranks.size());
+	rrequests.resize(nbdranks.size());
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+	{
+		const int count = static_cast<int>(sendfaces[irank].size())*facebytes;
+		ierr = MPI_Send_init(buffers.get<char>(sendbufs[irank]), count, MPI_BYTE,
+		                     nbdranks[irank], 0, comm, &srequests[irank]);
+		mpi_throw(ierr, "HaloExchange: Could not set up send!");
+		ierr = MPI_Recv_init(buffers.get<char>(recvbufs[irank]), count, MPI_BYTE,
+		                     nbdranks[irank], 0, comm, &rrequests[irank]);
+		mpi_throw(ierr, "HaloExchange: Could not set up receive!");
+	}
+}
+
+HaloExchange::~HaloExchange()
+{
+	for(size_t irank = 0; irank < nbdranks.size(); irank++) {
+		MPI_Request_free(&srequests[irank]);
+		MPI_Request_free(&rrequests[irank]);
+	}
+	MPI_Comm_free(&comm);
+}
+
+void HaloExchange::compute_comm_pattern()
+{
+	std::set<int> nbds;
+	for(fint icface = 0; icface < m.gnConnFace(); icface++)
+		nbds.insert(static_cast<int>(m.gconnface(icface,2)));
+	nbdranks.assign(nbds.begin(), nbds.end());
+
+	std::map<int,int> rankindex;
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+		rankindex[nbdranks[irank]] = static_cast<int>(irank);
+
+	sendfaces.assign(nbdranks.size(), std::vector<fint>());
+	for(fint icface = 0; icface < m.gnConnFace(); icface++)
+		sendfaces[rankindex.at(static_cast<int>(m.gconnface(icface,2)))].push_back(icface);
+
+	// Exchange global face indices of shared faces, in the order of sending
+	std::vector<std::vector<fint>> myGFaceIndex(nbdranks.size()), nbdGFaceIndex(nbdranks.size());
+	std::vector<MPI_Request> sreqs(nbdranks.size()), rreqs(nbdranks.size());
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+	{
+		// Both subdomains see the same set of faces between them
+		nbdGFaceIndex[irank].resize(sendfaces[irank].size());
+		const int ierr = MPI_Irecv(nbdGFaceIndex[irank].data(),
+		                           static_cast<int>(nbdGFaceIndex[irank].size()),
+		                           FVENS_MPI_INT, nbdranks[irank], 0, comm, &rreqs[irank]);
+		mpi_throw(ierr, "HaloExchange: Could not receive face indices!");
+	}
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+	{
+		for(const fint icface : sendfaces[irank])
+			myGFaceIndex[irank].push_back(m.gconnface(icface,4));
+		const int ierr = MPI_Isend(myGFaceIndex[irank].data(),
+		                           static_cast<int>(myGFaceIndex[irank].size()),
+		                           FVENS_MPI_INT, nbdranks[irank], 0, comm, &sreqs[irank]);
+		mpi_throw(ierr, "HaloExchange: Could not send face indices!");
+	}
+	int ierr = MPI_Waitall(static_cast<int>(rreqs.size()), rreqs.data(), MPI_STATUSES_IGNORE);
+	mpi_throw(ierr, "HaloExchange: Could not complete receiving face indices!");
+	ierr = MPI_Waitall(static_cast<int>(sreqs.size()), sreqs.data(), MPI_STATUSES_IGNORE);
+	mpi_throw(ierr, "HaloExchange: Could not complete sending face indices!");
+
+	// Map each face received from a neighbour to the local connectivity face
+	recvfaces.resize(nbdranks.size());
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+	{
+		std::map<fint,fint> gfacetolocal;
+		for(const fint icface : sendfaces[irank])
+			gfacetolocal[m.gconnface(icface,4)] = icface;
+
+		recvfaces[irank].resize(nbdGFaceIndex[irank].size());
+		for(size_t isface = 0; isface < nbdGFaceIndex[irank].size(); isface++) {
+			assert(gfacetolocal.count(nbdGFaceIndex[irank][isface]));
+			recvfaces[irank][isface] = gfacetolocal[nbdGFaceIndex[irank][isface]];
+		}
+	}
+}
+
+fint HaloExchange::num_values_sent() const
+{
+	fint nfaces = 0;
+	for(const std::vector<fint>& faces : sendfaces)
+		nfaces += static_cast<fint>(faces.size());
+	return nfaces*facewidth;
+}
+
+void HaloExchange::begin(const void *const *const sources)
+{
+	if(nbdranks.empty())
+		return;
+
+	// Post receives first so that messages can land directly in the receive buffers
+	int ierr = MPI_Startall(static_cast<int>(rrequests.size()), rrequests.data());
+	mpi_throw(ierr, "HaloExchange: Could not start receives!");
+
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+	{
+		char *const buffer = buffers.get<char>(sendbufs[irank]);
+		for(size_t isface = 0; isface < sendfaces[irank].size(); isface++)
+		{
+			char *const row = buffer + isface*facebytes;
+			int offset = 0;
+			for(size_t ifield = 0; ifield < fields.size(); ifield++)
+			{
+				const int nbytes = fields[ifield].width*valueSize(fields[ifield].type);
+				const char *const src = static_cast<const char*>(sources[ifield])
+					+ sourceRow(fields[ifield].kind, sendfaces[irank][isface])*nbytes;
+				std::memcpy(row+offset, src, nbytes);
+				offset += nbytes;
+			}
+		}
+	}
+
+	ierr = MPI_Startall(static_cast<int>(srequests.size()), srequests.data());
+	mpi_throw(ierr, "HaloExchange: Could not start sends!");
+}
+
+void HaloExchange::end(void *const *const targets)
+{
+	if(nbdranks.empty())
+		return;
+
+	for(size_t irank = 0; irank < nbdranks.size(); irank++)
+	{
+		const int ierr = MPI_Wait(&rrequests[irank], MPI_STATUS_IGNORE);
+		mpi_throw(ierr, "HaloExchange: Could not complete receive!");
+
+		const char *const buffer = buffers.get<char>(recvbufs[irank]);
+		for(size_t isface = 0; isface < recvfaces[irank].size(); isface++)
+		{
+			const char *const row = buffer + isface*facebytes;
+			int offset = 0;
+			for(size_t ifield = 0; ifield < fields.size(); ifield++)
+			{
+				const int nbytes = fields[ifield].width*valueSize(fields[ifield].type);
+				char *const tgt = static_cast<char*>(targets[ifield])
+					+ targetRow(fields[ifield].kind, recvfaces[irank][isface])*nbytes;
+				std::memcpy(tgt, row+offset, nbytes);
+				offset += nbytes;
+			}
+		}
+	}
+
+	// The send buffers may only be overwritten by the next exchange once the sends are done
+	const int ierr = MPI_Waitall(static_cast<int>(srequests.size()), srequests.data(),
+	                             MPI_STATUSES_IGNORE);
+	mpi_throw(ierr, "HaloExchange: Could not complete sends!");
+}
+
+GhostLayerExchange::GhostLayerExchange(const SecondGhostLayer& layer, const int w)
+	: gl{layer}, width{w}
+{
+	int ierr = MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+	mpi_throw(ierr, "GhostLayerExchange: Could not duplicate communicator!");
+
+	const std::vector<std::vector<fint>>& sendcells = gl.sendCells();
+	for(size_t irank = 0; irank < sendcells.size(); irank++)
+		sendbufs.push_back(buffers.reserve<freal>(static_cast<fint>(sendcells[irank].size()), width));
+	slotbuf = buffers.reserve<freal>(gl.numSlots(), width);
+	buffers.allocate();
+
+	srequests.resize(gl.destinationRanks().size());
+	for(size_t irank = 0; irank < srequests.size(); irank++)
+	{
+		ierr = MPI_Send_init(buffers.get<freal>(sendbufs[irank]),
+		                     static_cast<int>(sendcells[irank].size())*width, FVENS_MPI_REAL,
+		                     gl.destinationRanks()[irank], 0, comm, &srequests[irank]);
+		mpi_throw(ierr, "GhostLayerExchange: Could not set up send!");
+	}
+
+	// Slots are contiguous for each source rank, so each message is received in place
+	rrequests.resize(gl.sourceRanks().size());
+	for(size_t irank = 0; irank < rrequests.size(); irank++)
+	{
+		const fint start = gl.sourceSlotStart()[irank];
+		const fint count = gl.sourceSlotStart()[irank+1] - start;
+		ierr = MPI_Recv_init(buffers.get<freal>(slotbuf) + start*width,
+		                     static_cast<int>(count)*width, FVENS_MPI_REAL,
+		                     gl.sourceRanks()[irank], 0, comm, &rrequests[irank]);
+		mpi_throw(ierr, "GhostLayerExchange: Could not set up receive!");
+	}
+}
+
+GhostLayerExchange::~GhostLayerExchange()
+{
+	for(MPI_Request& req : srequests)
+		MPI_Request_free(&req);
+	for(MPI_Request& req : rrequests)
+		MPI_Request_free(&req);
+	MPI_Comm_free(&comm);
+}
+
+fint GhostLayerExchange::num_values_sent() const
+{
+	fint ncells = 0;
+	for(const std::vector<fint>& cells : gl.sendCells())
+		ncells += static_cast<fint>(cells.size());
+	return ncells*width;
+}
+
+void GhostLayerExchange::begin(const freal *const cellvalues)
+{
+	if(!rrequests.empty()) {
+		const int ierr = MPI_Startall(static_cast<int>(rrequests.size()), rrequests.data());
+		mpi_throw(ierr, "GhostLayerExchange: Could not start receives!");
+	}
+
+	const std::vector<std::vector<fint>>& sendcells = gl.sendCells();
+	for(size_t irank = 0; irank < sendcells.size(); irank++)
+	{
+		freal *const buffer = buffers.get<freal>(sendbufs[irank]);
+		for(size_t i = 0; i < sendcells[irank].size(); i++)
+			for(int j = 0; j < width; j++)
+				buffer[i*width+j] = cellvalues[sendcells[irank][i]*width+j];
+	}
+
+	if(!srequests.empty()) {
+		const int ierr = MPI_Startall(static_cast<int>(srequests.size()), srequests.data());
+		mpi_throw(ierr, "GhostLayerExchange: Could not start sends!");
+	}
+}
+
+void GhostLayerExchange::end()
+{
+	int ierr = MPI_Waitall(static_cast<int>(rrequests.size()), rrequests.data(),
+	                       MPI_STATUSES_IGNORE);
+	mpi_throw(ierr, "GhostLayerExchange: Could not complete receives!");
+	ierr = MPI_Waitall(static_cast<int>(srequests.size()), srequests.data(), MPI_STATUSES_IGNORE);
+	mpi_throw(ierr, "GhostLayerExchange: Could not complete sends!");
+}
+
+}
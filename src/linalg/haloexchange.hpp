@@ -0,0 +1,230 @@
+/** \file
+ * \brief Exchange of data associated with connectivity faces between neighbouring subdomains
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_HALO_EXCHANGE_H
+#define FVENS_HALO_EXCHANGE_H
+
+#include <vector>
+#include <mpi.h>
+#include "mesh/mesh.hpp"
+#include "mesh/ghostlayer.hpp"
+#include "utilities/workspace.hpp"
+
+namespace fvens {
+
+/// Kinds of data that can be exchanged across connectivity faces
+enum HaloFieldKind {
+	/// Data at cells, such as cell-centred states or gradients
+	/** The source array has a row for each subdomain cell and each connectivity ghost cell, as
+	 * in the local form of a vector created by \ref createGhostedSystemVector. Rows of subdomain
+	 * cells adjacent to connectivity faces are sent, and rows of connectivity ghost cells are
+	 * received into the target array, which is usually the same as the source.
+	 */
+	HALO_CELL,
+	/// Data at faces, such as the "left" and "right" parts of an \ref L2TraceVector
+	/** Source and target arrays have a row for every face of the subdomain. Rows of connectivity
+	 * faces are sent from the source array and received into the target array.
+	 */
+	HALO_TRACE,
+	/// Data at connectivity faces only
+	/** Source and target arrays have a row for each connectivity face, in the order of the
+	 * connectivity faces of the mesh.
+	 */
+	HALO_CONNFACE
+};
+
+/// Types of the values of a field
+enum HaloValueType {
+	HALO_FREAL,                 ///< fvens::freal
+	HALO_FLOAT                  ///< float, for fields stored in single precision
+};
+
+/// Number, kind and type of values to exchange for one field
+struct HaloFieldLayout {
+	HaloFieldKind kind;         ///< What the rows of the field's arrays correspond to
+	int width;                  ///< Number of values in each row
+	HaloValueType type = HALO_FREAL;   ///< Type of the values, which are sent as they are stored
+};
+
+/// Exchange of several fields at once across the connectivity faces of a distributed mesh
+/** The communication pattern is computed once from the connectivity faces of the mesh. Every
+ * exchange then sends a single message to each neighbouring subdomain, containing the values of all
+ * fields at the shared faces, through persistent MPI requests on a communicator of its own. Message
+ * buffers are allocated once, aligned, and registered with the persistent requests.
+ *
+ * Fields may have values of different types (\ref HaloValueType). Values are copied into the
+ * messages as they are stored, so a field stored in single precision also takes half the bytes on
+ * the wire.
+ */
+class HaloExchange
+{
+public:
+	/// Computes the communication pattern and sets up buffers and requests
+	/** Collective over MPI_COMM_WORLD.
+	 * \param mesh The distributed mesh whose connectivity faces are to be used
+	 * \param layouts The fields to be exchanged together, in the order in which their arrays are
+	 *   passed to \ref begin and \ref end
+	 */
+	HaloExchange(const UMesh<freal,NDIM>& mesh, const std::vector<HaloFieldLayout>& layouts);
+
+	~HaloExchange();
+
+	HaloExchange(const HaloExchange&) = delete;
+	HaloExchange& operator=(const HaloExchange&) = delete;
+
+	/// Packs the values to send from each field's source array and starts the exchange
+	/** \param sources Source array of each field, see \ref HaloFieldKind, holding values of the
+	 *   field's \ref HaloValueType
+	 */
+	void begin(const void *const *const sources);
+
+	/// Waits for the exchange to finish and unpacks received values into each field's target array
+	/** \param targets Target array of each field, see \ref HaloFieldKind, holding values of the
+	 *   field's \ref HaloValueType
+	 */
+	void end(void *const *const targets);
+
+	/// Number of neighbouring subdomains
+	int num_neighbours() const { return static_cast<int>(nbdranks.size()); }
+
+	/// Number of values sent to all neighbours in one exchange
+	fint num_values_sent() const;
+
+protected:
+	/// The mesh over whose connectivity faces the exchange happens
+	const UMesh<freal,NDIM>& m;
+
+	/// The fields exchanged together
+	const std::vector<HaloFieldLayout> fields;
+
+	/// Total number of values of all fields at one face
+	const int facewidth;
+
+	/// Total size in bytes of the values of all fields at one face
+	const int facebytes;
+
+	/// Duplicate of MPI_COMM_WORLD used only by this exchange
+	MPI_Comm comm;
+
+	/// MPI ranks of neighbouring subdomains of this subdomain
+	std::vector<int> nbdranks;
+
+	/// Connectivity face indices associated with each of the neighbouring subdomains
+	/** For each neighbouring subdomain, gives the connface index of each shared face in the order
+	 * in which values are sent to that subdomain.
+	 */
+	std::vector<std::vector<fint>> sendfaces;
+
+	/// Connectivity face indices associated with shared faces as seen by the neighbouring subdomain
+	/** For each neighbouring subdomain, gives the connface index (of this subdomain) of each face
+	 * in the order in which that subdomain sends values. This is necessary because the other
+	 * subdomain has a different ordering of the shared connectivity faces.
+	 */
+	std::vector<std::vector<fint>> recvfaces;
+
+	/// Send and receive buffers of all neighbours
+	WorkspaceArena buffers;
+	/// Handles of send buffers in \ref buffers
+	std::vector<int> sendbufs;
+	/// Handles of receive buffers in \ref buffers
+	std::vector<int> recvbufs;
+
+	/// Persistent requests for the sends
+	std::vector<MPI_Request> srequests;
+	/// Persistent requests for the receives
+	std::vector<MPI_Request> rrequests;
+
+	/// Computes \ref nbdranks, \ref sendfaces and \ref recvfaces
+	void compute_comm_pattern();
+
+	/// Returns the row of a field's source array which is sent for a connectivity face
+	fint sourceRow(const HaloFieldKind kind, const fint icface) const
+	{
+		return kind == HALO_CELL ? m.gconnface(icface,0)
+			: (kind == HALO_TRACE ? m.gConnBFaceStart()+icface : icface);
+	}
+
+	/// Returns the row of a field's target array into which values for a connectivity face
+	///  are received
+	fint targetRow(const HaloFieldKind kind, const fint icface) const
+	{
+		return kind == HALO_CELL ? m.gnelem()+icface
+			: (kind == HALO_TRACE ? m.gConnBFaceStart()+icface : icface);
+	}
+};
+
+/// Exchange of cell data into the slots of a \ref SecondGhostLayer
+/** Each rank sends the rows of the requested cells directly to every rank which needs them, through
+ * persistent MPI requests on a communicator of its own. Received rows land directly in a slot
+ * array of the exchange, without unpacking.
+ */
+class GhostLayerExchange
+{
+public:
+	/// Sets up buffers and requests; collective over MPI_COMM_WORLD
+	/** \param layer The second ghost layer, which must outlive this object
+	 * \param width Number of values in each row of cell data
+	 */
+	GhostLayerExchange(const SecondGhostLayer& layer, const int width);
+
+	~GhostLayerExchange();
+
+	GhostLayerExchange(const GhostLayerExchange&) = delete;
+	GhostLayerExchange& operator=(const GhostLayerExchange&) = delete;
+
+	/// Packs the rows of requested cells and starts the exchange
+	/** \param cellvalues Array with a row of width values for each subdomain cell
+	 */
+	void begin(const freal *const cellvalues);
+
+	/// Waits for the exchange to finish
+	void end();
+
+	/// Slot array, with a row for each slot of the layer; valid after \ref end
+	const freal *received() const { return buffers.get<freal>(slotbuf); }
+
+	/// Number of ranks that this rank sends messages to in one exchange
+	int num_messages_sent() const { return static_cast<int>(gl.destinationRanks().size()); }
+
+	/// Number of values sent to all ranks in one exchange
+	fint num_values_sent() const;
+
+protected:
+	/// Communication pattern
+	const SecondGhostLayer& gl;
+	/// Number of values per cell
+	const int width;
+
+	/// Duplicate of MPI_COMM_WORLD used only by this exchange
+	MPI_Comm comm;
+
+	/// Send buffers and the slot array
+	WorkspaceArena buffers;
+	/// Handles of send buffers in \ref buffers
+	std::vector<int> sendbufs;
+	/// Handle of the slot array in \ref buffers
+	int slotbuf;
+
+	/// Persistent requests for the sends
+	std::vector<MPI_Request> srequests;
+	/// Persistent requests for the receives
+	std::vector<MPI_Request> rrequests;
+};
+
+}
+#endif
@@ -0,0 +1,222 @@
+/** \file
+ * \brief Computation of the positions of Jacobian blocks in BAIJ matrices
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "jacobianlayout.hpp"
+#include "mesh/ameshutils.hpp"
+#include "utilities/aerrorhandling.hpp"
+#include "utilities/mpiutils.hpp"
+
+namespace fvens {
+
+/// Returns the position of a column in a sorted row of a block CSR structure, or -1
+static PetscInt findBlock(const PetscInt *const ia, const PetscInt *const ja,
+                          const PetscInt row, const PetscInt col)
+{
+	const PetscInt *const pos = std::lower_bound(ja+ia[row], ja+ia[row+1], col);
+	if(pos == ja+ia[row+1] || *pos != col)
+		return -1;
+	return static_cast<PetscInt>(pos-ja);
+}
+
+template <int bs>
+bool BAIJJacobianLayout<bs>::is_compatible(Mat A)
+{
+	PetscBool isbaij = PETSC_FALSE;
+	StatusCode ierr = PetscObjectTypeCompareAny((PetscObject)A, &isbaij, MATMPIBAIJ, MATSEQBAIJ, "");
+	if(ierr || !isbaij)
+		return false;
+	PetscInt matbs;
+	ierr = MatGetBlockSize(A, &matbs);
+	PetscBool assembled = PETSC_FALSE;
+	ierr += MatAssembled(A, &assembled);
+	return !ierr && matbs == bs && assembled;
+}
+
+template <int bs>
+StatusCode BAIJJacobianLayout<bs>::getParts(Mat A, Mat *const Ad, Mat *const Ao,
+                                            const PetscInt **const garray) const
+{
+	StatusCode ierr = 0;
+	PetscBool ismpi = PETSC_FALSE;
+	ierr = PetscObjectTypeCompare((PetscObject)A, MATMPIBAIJ, &ismpi); CHKERRQ(ierr);
+	if(ismpi) {
+		ierr = MatMPIBAIJGetSeqBAIJ(A, Ad, Ao, garray); CHKERRQ(ierr);
+	}
+	else {
+		*Ad = A;
+		*Ao = NULL;
+		*garray = NULL;
+	}
+	return ierr;
+}
+
+template <int bs>
+BAIJJacobianLayout<bs>::BAIJJacobianLayout(const UMesh<freal,NDIM>& m, Mat A) : mat{A}
+{
+	if(!is_compatible(A))
+		throw std::runtime_error("BAIJJacobianLayout: Matrix must be assembled BAIJ with block size "
+		                         + std::to_string(bs));
+
+	StatusCode ierr = MatGetNonzeroState(A, &nzstate);
+	petsc_throw(ierr, "BAIJJacobianLayout: Could not get non-zero state!");
+
+	MPI_Comm comm;
+	ierr = PetscObjectGetComm((PetscObject)A, &comm);
+	petsc_throw(ierr, "BAIJJacobianLayout: Could not get communicator!");
+	const bool isdistributed = get_mpi_size(comm) > 1;
+
+	PetscInt rstart, rend;
+	ierr = MatGetOwnershipRange(A, &rstart, &rend);
+	petsc_throw(ierr, "BAIJJacobianLayout: Could not get ownership range!");
+	const PetscInt browstart = rstart/bs;
+
+	// Block row or column of a subdomain cell in the subdomain part of the matrix
+	auto localBlock = [&m,isdistributed,browstart](const fint iel) {
+		return static_cast<PetscInt>(isdistributed ? m.gglobalElemIndex(iel) : iel) - browstart;
+	};
+
+	Mat Ad, Ao;
+	const PetscInt *garray;
+	ierr = getParts(A, &Ad, &Ao, &garray);
+	petsc_throw(ierr, "BAIJJacobianLayout: Could not get parts of the matrix!");
+
+	diagblk.assign(m.gnelem(), -1);
+	lowerblk.assign(m.gFaceEnd(), -1);
+	upperblk.assign(m.gFaceEnd(), -1);
+
+	{
+		const PetscInt *ia, *ja;
+		PetscInt nbrows;
+		PetscBool done = PETSC_FALSE;
+		ierr = MatGetRowIJ(Ad, 0, PETSC_FALSE, PETSC_FALSE, &nbrows, &ia, &ja, &done);
+		petsc_throw(ierr || !done, "BAIJJacobianLayout: Could not get subdomain structure!");
+
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			diagblk[iel] = findBlock(ia, ja, localBlock(iel), localBlock(iel));
+
+		for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++)
+		{
+			const PetscInt lb = localBlock(m.gintfac(iface,0));
+			const PetscInt rb = localBlock(m.gintfac(iface,1));
+			lowerblk[iface] = findBlock(ia, ja, rb, lb);
+			upperblk[iface] = findBlock(ia, ja, lb, rb);
+		}
+
+		ierr = MatRestoreRowIJ(Ad, 0, PETSC_FALSE, PETSC_FALSE, &nbrows, &ia, &ja, &done);
+		petsc_throw(ierr, "BAIJJacobianLayout: Could not restore subdomain structure!");
+	}
+
+	if(m.gnConnFace() > 0)
+	{
+		if(!Ao)
+			throw std::runtime_error("BAIJJacobianLayout: Connectivity faces need a parallel matrix!");
+
+		const PetscInt *ia, *ja;
+		PetscInt nbrows;
+		PetscBool done = PETSC_FALSE;
+		ierr = MatGetRowIJ(Ao, 0, PETSC_FALSE, PETSC_FALSE, &nbrows, &ia, &ja, &done);
+		petsc_throw(ierr || !done, "BAIJJacobianLayout: Could not get off-subdomain structure!");
+
+		// Columns of the off-subdomain part are numbered in the order of their global indices
+		PetscInt nbcols;
+		ierr = MatGetLocalSize(Ao, NULL, &nbcols);
+		petsc_throw(ierr, "BAIJJacobianLayout: Could not get off-subdomain size!");
+		std::map<PetscInt,PetscInt> globaltocol;
+		for(PetscInt icol = 0; icol < nbcols/bs; icol++)
+			globaltocol[garray[icol]] = icol;
+
+		for(fint icface = 0; icface < m.gnConnFace(); icface++)
+		{
+			const fint iface = m.gConnBFaceStart()+icface;
+			const auto it = globaltocol.find(m.gconnface(icface,3));
+			if(it != globaltocol.end())
+				upperblk[iface] = findBlock(ia, ja, localBlock(m.gintfac(iface,0)), it->second);
+			if(upperblk[iface] < 0)
+				throw std::runtime_error("BAIJJacobianLayout: Block for connectivity face "
+				                         + std::to_string(icface) + " not found!");
+		}
+
+		ierr = MatRestoreRowIJ(Ao, 0, PETSC_FALSE, PETSC_FALSE, &nbrows, &ia, &ja, &done);
+		petsc_throw(ierr, "BAIJJacobianLayout: Could not restore off-subdomain structure!");
+	}
+
+	if(std::find(diagblk.begin(), diagblk.end(), -1) != diagblk.end()
+	   || std::find(lowerblk.begin()+m.gSubDomFaceStart(), lowerblk.begin()+m.gSubDomFaceEnd(), -1)
+	      != lowerblk.begin()+m.gSubDomFaceEnd()
+	   || std::find(upperblk.begin()+m.gSubDomFaceStart(), upperblk.begin()+m.gSubDomFaceEnd(), -1)
+	      != upperblk.begin()+m.gSubDomFaceEnd())
+		throw std::runtime_error("BAIJJacobianLayout: Matrix does not contain all Jacobian blocks!");
+
+	// Faces are coloured such that no two faces of a colour touch the same subdomain cell
+	colourFaces(m, colourptr, colourfaces);
+}
+
+template <int bs>
+bool BAIJJacobianLayout<bs>::describes(Mat A) const
+{
+	if(A != mat)
+		return false;
+	PetscObjectState state;
+	const StatusCode ierr = MatGetNonzeroState(A, &state);
+	return !ierr && state == nzstate;
+}
+
+template <int bs>
+StatusCode BAIJJacobianLayout<bs>::getArrays(Mat A, PetscScalar **const diagpart,
+                                             PetscScalar **const offdiagpart) const
+{
+	StatusCode ierr = 0;
+	Mat Ad, Ao;
+	const PetscInt *garray;
+	ierr = getParts(A, &Ad, &Ao, &garray); CHKERRQ(ierr);
+	ierr = MatSeqBAIJGetArray(Ad, diagpart); CHKERRQ(ierr);
+	*offdiagpart = NULL;
+	if(Ao) {
+		ierr = MatSeqBAIJGetArray(Ao, offdiagpart); CHKERRQ(ierr);
+	}
+	return ierr;
+}
+
+template <int bs>
+StatusCode BAIJJacobianLayout<bs>::restoreArrays(Mat A, PetscScalar **const diagpart,
+                                                 PetscScalar **const offdiagpart,
+                                                 const bool modified) const
+{
+	StatusCode ierr = 0;
+	Mat Ad, Ao;
+	const PetscInt *garray;
+	ierr = getParts(A, &Ad, &Ao, &garray); CHKERRQ(ierr);
+	ierr = MatSeqBAIJRestoreArray(Ad, diagpart); CHKERRQ(ierr);
+	if(Ao) {
+		ierr = MatSeqBAIJRestoreArray(Ao, offdiagpart); CHKERRQ(ierr);
+	}
+	// The parts have changed, so must the state of the whole matrix
+	if(modified) {
+		ierr = PetscObjectStateIncrease((PetscObject)A); CHKERRQ(ierr);
+	}
+	return ierr;
+}
+
+template class BAIJJacobianLayout<NVARS>;
+template class BAIJJacobianLayout<1>;
+
+}
@@ -0,0 +1,111 @@
+/** \file
+ * \brief Precomputed positions of the blocks of a finite volume Jacobian in a BAIJ matrix
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_JACOBIAN_LAYOUT_H
+#define FVENS_JACOBIAN_LAYOUT_H
+
+#include <vector>
+#include <petscmat.h>
+#include "mesh/mesh.hpp"
+
+namespace fvens {
+
+/// Positions, in the value arrays of an assembled BAIJ matrix, of the blocks that each cell and
+///  each face of a mesh contribute to in a first-order (face-neighbour) Jacobian
+/** With these, the Jacobian can be assembled by adding blocks directly into the matrix storage,
+ * without MatSetValuesBlocked and its searches. To let threads do so without synchronization, the
+ * faces are also coloured such that no two faces of the same colour touch the same subdomain cell.
+ * Each diagonal block is then written by at most one thread at a time, and off-diagonal blocks
+ * belong to one face each.
+ *
+ * The layout is computed from the non-zero structure of the matrix, which must have been assembled
+ * at least once with all the blocks of the Jacobian. It only remains valid as long as that
+ * structure does not change; see \ref describes.
+ *
+ * \tparam bs Block size of the matrix
+ */
+template <int bs>
+class BAIJJacobianLayout
+{
+public:
+	/// Whether a matrix is an assembled MATSEQBAIJ or MATMPIBAIJ matrix with block size bs
+	static bool is_compatible(Mat A);
+
+	/// Computes block positions and the face colouring
+	/** Throws if the matrix is not compatible or does not contain all the blocks of the Jacobian.
+	 */
+	BAIJJacobianLayout(const UMesh<freal,NDIM>& mesh, Mat A);
+
+	/// Whether this layout is for a matrix and its current non-zero structure
+	bool describes(Mat A) const;
+
+	/// Index of the diagonal block of a cell in the values of the subdomain part of the matrix
+	PetscInt diagonal(const fint iel) const { return diagblk[iel]; }
+
+	/// Index of the block (right cell, left cell) of a subdomain face in the subdomain part
+	PetscInt lower(const fint iface) const { return lowerblk[iface]; }
+
+	/// Index of the block (left cell, right cell) of an interior face
+	/** For subdomain faces, this is in the subdomain part of the matrix; for connectivity faces,
+	 * it is in the off-subdomain part.
+	 */
+	PetscInt upper(const fint iface) const { return upperblk[iface]; }
+
+	/// Number of face colours
+	int numColours() const { return static_cast<int>(colourptr.size())-1; }
+
+	/// Faces of one colour
+	/// @{
+	fint colourStart(const int icol) const { return colourptr[icol]; }
+	fint colourEnd(const int icol) const { return colourptr[icol+1]; }
+	fint colourFace(const fint i) const { return colourfaces[i]; }
+	/// @}
+
+	/// Gives access to the value arrays of the subdomain and off-subdomain parts of the matrix
+	/** The off-subdomain array is null if the matrix is sequential.
+	 * The arrays must be given back by \ref restoreArrays.
+	 */
+	StatusCode getArrays(Mat A, PetscScalar **const diagpart, PetscScalar **const offdiagpart)
+		const;
+
+	/// Gives back arrays obtained by \ref getArrays
+	/** \param modified Whether values were written, in which case the state of the matrix is
+	 *   increased. Pass false after only reading the values.
+	 */
+	StatusCode restoreArrays(Mat A, PetscScalar **const diagpart, PetscScalar **const offdiagpart,
+	                         const bool modified = true) const;
+
+protected:
+	/// The matrix for which the layout was computed
+	Mat mat;
+	/// Non-zero state of the matrix when the layout was computed
+	PetscObjectState nzstate;
+
+	std::vector<PetscInt> diagblk;       ///< Diagonal block of each subdomain cell
+	std::vector<PetscInt> lowerblk;      ///< Lower block of each face, -1 where there is none
+	std::vector<PetscInt> upperblk;      ///< Upper block of each face, -1 where there is none
+
+	std::vector<fint> colourptr;         ///< Start of each colour in \ref colourfaces
+	std::vector<fint> colourfaces;       ///< Faces sorted by colour
+
+	/// Gets the subdomain and off-subdomain parts of the matrix
+	StatusCode getParts(Mat A, Mat *const Ad, Mat *const Ao, const PetscInt **const garray) const;
+};
+
+}
+#endif
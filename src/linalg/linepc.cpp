@@ -0,0 +1,251 @@
+/** \file
+ * \brief Implementation of line-implicit block-tridiagonal preconditioners
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <Eigen/LU>
+#include "linepc.hpp"
+#include "blockkernels.hpp"
+#include "petscutils.hpp"
+#include "mesh/details_lineordering.hpp"
+
+namespace fvens {
+
+template <int bs>
+using Block = Eigen::Matrix<freal,bs,bs>;
+
+template <int bs>
+LinePreconditioner<bs>::LinePreconditioner(const UMesh<freal,NDIM>& mesh, const LinePCType type,
+                                           const freal threshold)
+	: BlockSparseMatrix<freal,bs>(mesh), pctype{type}
+{
+	const LineConfig lc = findLines(mesh, threshold);
+	nlines = static_cast<fint>(lc.lines.size());
+
+	// Lines first, then points
+	vertptr.push_back(0);
+	std::vector<fint> cellvert(nbrows, -1);
+	for(fint iline = 0; iline < nlines; iline++) {
+		for(const fint iel : lc.lines[iline]) {
+			vertcells.push_back(iel);
+			cellvert[iel] = iline;
+		}
+		vertptr.push_back(static_cast<fint>(vertcells.size()));
+	}
+	for(fint iel = 0; iel < nbrows; iel++)
+		if(lc.celline[iel] == -1) {
+			cellvert[iel] = static_cast<fint>(vertptr.size())-1;
+			vertcells.push_back(iel);
+			vertptr.push_back(static_cast<fint>(vertcells.size()));
+		}
+
+	// Position of the block (row, col), which must exist
+	auto findBlock = [this](const fint row, const fint col) {
+		const auto pos = std::lower_bound(bcolind.begin()+browptr[row], bcolind.begin()+browptr[row+1],
+		                                  col);
+		if(pos == bcolind.begin()+browptr[row+1] || *pos != col)
+			throw std::runtime_error("LinePreconditioner: Consecutive cells of a line are not coupled!");
+		return static_cast<fint>(pos - bcolind.begin());
+	};
+
+	prevblk.assign(nbrows, -1);
+	nextblk.assign(nbrows, -1);
+	for(fint iline = 0; iline < nlines; iline++)
+		for(fint k = vertptr[iline]; k < vertptr[iline+1]-1; k++) {
+			nextblk[vertcells[k]] = findBlock(vertcells[k], vertcells[k+1]);
+			prevblk[vertcells[k+1]] = findBlock(vertcells[k+1], vertcells[k]);
+		}
+
+	/* Greedy colouring of lines and points: each gets the lowest colour not used by any line or
+	 * point containing a face neighbour of one of its cells.
+	 */
+	const fint nverts = num_vertices();
+	std::vector<int> vertcolour(nverts, -1);
+	std::vector<fint> colourstamp;
+	for(fint ivert = 0; ivert < nverts; ivert++)
+	{
+		for(fint k = vertptr[ivert]; k < vertptr[ivert+1]; k++)
+		{
+			const fint iel = vertcells[k];
+			for(fint jj = browptr[iel]; jj < browptr[iel+1]; jj++) {
+				const fint jvert = cellvert[bcolind[jj]];
+				if(jvert != ivert && vertcolour[jvert] >= 0)
+					colourstamp[vertcolour[jvert]] = ivert;
+			}
+		}
+
+		int icol = 0;
+		while(icol < static_cast<int>(colourstamp.size()) && colourstamp[icol] == ivert)
+			icol++;
+		if(icol == static_cast<int>(colourstamp.size()))
+			colourstamp.push_back(-1);
+		vertcolour[ivert] = icol;
+	}
+
+	const int ncolours = static_cast<int>(colourstamp.size());
+	colourptr.assign(ncolours+1, 0);
+	for(fint ivert = 0; ivert < nverts; ivert++)
+		colourptr[vertcolour[ivert]+1]++;
+	for(int icol = 0; icol < ncolours; icol++)
+		colourptr[icol+1] += colourptr[icol];
+	colourverts.resize(nverts);
+	std::vector<fint> pos(colourptr.begin(), colourptr.end()-1);
+	for(fint ivert = 0; ivert < nverts; ivert++)
+		colourverts[pos[vertcolour[ivert]]++] = ivert;
+
+	linemult.assign(static_cast<size_t>(nbrows)*bs*bs, 0);
+}
+
+template <int bs>
+inline void LinePreconditioner<bs>::factor_vertex(const fint ivert)
+{
+	for(fint k = vertptr[ivert]; k < vertptr[ivert+1]; k++)
+	{
+		const fint iel = vertcells[k];
+		Block<bs> pivot = Eigen::Map<const Block<bs>>(&vals[diagind[iel]*bs*bs]);
+		if(k > vertptr[ivert])
+		{
+			const fint prevel = vertcells[k-1];
+			Eigen::Map<Block<bs>> mult(&linemult[iel*bs*bs]);
+			mult.noalias() = Eigen::Map<const Block<bs>>(&vals[prevblk[iel]*bs*bs])
+				* Eigen::Map<const Block<bs>>(&dinv[prevel*bs*bs]);
+			pivot.noalias() -= mult * Eigen::Map<const Block<bs>>(&vals[nextblk[prevel]*bs*bs]);
+		}
+		Eigen::Map<Block<bs>> di(&dinv[iel*bs*bs]);
+		di = pivot.inverse();
+	}
+}
+
+template <int bs>
+inline void LinePreconditioner<bs>::solve_vertex(const fint ivert, const bool gs,
+                                                 const freal *const x, freal *const y) const
+{
+	const fint start = vertptr[ivert], end = vertptr[ivert+1];
+
+	// Forward elimination; y temporarily holds the transformed right-hand side
+	for(fint k = start; k < end; k++)
+	{
+		const fint iel = vertcells[k];
+		BlockVector<bs> r = Eigen::Map<const BlockVector<bs>>(x+iel*bs);
+		if(gs)
+			for(fint jj = browptr[iel]; jj < browptr[iel+1]; jj++)
+				if(jj != diagind[iel] && jj != prevblk[iel] && jj != nextblk[iel])
+					r.noalias() -= Eigen::Map<const Block<bs>>(&vals[jj*bs*bs])
+						* Eigen::Map<const BlockVector<bs>>(y+bcolind[jj]*bs);
+		if(k > start)
+			r.noalias() -= Eigen::Map<const Block<bs>>(&linemult[iel*bs*bs])
+				* Eigen::Map<const BlockVector<bs>>(y+vertcells[k-1]*bs);
+		Eigen::Map<BlockVector<bs>>(y+iel*bs) = r;
+	}
+
+	// Back substitution
+	for(fint k = end-1; k >= start; k--)
+	{
+		const fint iel = vertcells[k];
+		BlockVector<bs> g = Eigen::Map<const BlockVector<bs>>(y+iel*bs);
+		if(k < end-1)
+			g.noalias() -= Eigen::Map<const Block<bs>>(&vals[nextblk[iel]*bs*bs])
+				* Eigen::Map<const BlockVector<bs>>(y+vertcells[k+1]*bs);
+		Eigen::Map<BlockVector<bs>>(y+iel*bs).noalias()
+			= Eigen::Map<const Block<bs>>(&dinv[iel*bs*bs]) * g;
+	}
+}
+
+template <int bs>
+StatusCode LinePreconditioner<bs>::setup(Mat P, const BAIJJacobianLayout<bs>& layout)
+{
+	StatusCode ierr = this->copy_from(P, layout); CHKERRQ(ierr);
+
+	// Lines differ in length, so the work is distributed dynamically
+#pragma omp parallel for default(shared) schedule(dynamic, 16)
+	for(fint ivert = 0; ivert < num_vertices(); ivert++)
+		factor_vertex(ivert);
+
+	return ierr;
+}
+
+template <int bs>
+void LinePreconditioner<bs>::apply(const freal *const x, freal *const y) const
+{
+	const fint nverts = num_vertices();
+	const int ncolours = num_colours();
+	std::fill(y, y+nbrows*bs, 0);
+
+	if(pctype == LINE_JACOBI)
+	{
+#pragma omp parallel for default(shared) schedule(dynamic, 16)
+		for(fint ivert = 0; ivert < nverts; ivert++)
+			solve_vertex(ivert, false, x, y);
+	}
+	else
+	{
+#pragma omp parallel default(shared)
+		{
+			for(int icol = 0; icol < ncolours; icol++)
+			{
+#pragma omp for schedule(dynamic, 16)
+				for(fint i = colourptr[icol]; i < colourptr[icol+1]; i++)
+					solve_vertex(colourverts[i], true, x, y);
+			}
+			for(int icol = ncolours-1; icol >= 0; icol--)
+			{
+#pragma omp for schedule(dynamic, 16)
+				for(fint i = colourptr[icol]; i < colourptr[icol+1]; i++)
+					solve_vertex(colourverts[i], true, x, y);
+			}
+		}
+	}
+}
+
+template class LinePreconditioner<NVARS>;
+template class LinePreconditioner<1>;
+
+template <int bs>
+StatusCode setup_line_pc(PC pc, const UMesh<freal,NDIM>& mesh)
+{
+	StatusCode ierr = 0;
+
+	char typestr[16] = "sgs";
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetString(NULL, NULL, "-line_pc_type", typestr, sizeof(typestr), &set);
+	CHKERRQ(ierr);
+	PetscReal threshold = 10.0;
+	ierr = PetscOptionsGetReal(NULL, NULL, "-line_pc_anisotropy_threshold", &threshold, &set);
+	CHKERRQ(ierr);
+
+	LinePCType type;
+	if(!std::strcmp(typestr, "jacobi"))
+		type = LINE_JACOBI;
+	else if(!std::strcmp(typestr, "sgs"))
+		type = LINE_SGS;
+	else
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Line PC: type must be jacobi or sgs!");
+
+	ierr = setup_block_shell_pc<bs>(pc, mesh, new LinePreconditioner<bs>(mesh, type, threshold),
+	                                type == LINE_JACOBI ? "line Jacobi" : "line SGS");
+	CHKERRQ(ierr);
+	return ierr;
+}
+
+template StatusCode setup_line_pc<NVARS>(PC pc, const UMesh<freal,NDIM>& mesh);
+template StatusCode setup_line_pc<1>(PC pc, const UMesh<freal,NDIM>& mesh);
+
+}
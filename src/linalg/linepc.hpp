@@ -0,0 +1,129 @@
+/** \file
+ * \brief Line-implicit block-tridiagonal preconditioners along anisotropic lines of the mesh
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_LINE_PC_H
+#define FVENS_LINE_PC_H
+
+#include "blocksparsematrix.hpp"
+
+namespace fvens {
+
+/// The line-implicit preconditioning operation
+enum LinePCType {
+	LINE_JACOBI,          ///< Independent block-tridiagonal solves along each line
+	LINE_SGS              ///< One symmetric line Gauss-Seidel sweep
+};
+
+/// Line-implicit preconditioner for the subdomain part of a Jacobian
+/** The cells are grouped into lines of strongly coupled cells, as found by fvens::findLines in
+ * regions of high mesh anisotropy, and single cells ('points') not in any line. On each line, the
+ * block-tridiagonal system made of the diagonal blocks and the blocks coupling consecutive cells is
+ * solved by the block Thomas algorithm; at points, this is just the inverse of the diagonal block.
+ * The block LU factors of the lines are computed at set-up.
+ *
+ * Line Jacobi treats all other couplings as zero, and all lines are solved in parallel. Line SGS
+ * moves the other couplings to the right-hand side with the latest values, sweeping forward and
+ * then backward over the lines. For thread parallelism, lines and points are coloured such that no
+ * two of the same colour are coupled; the sweeps go colour by colour, and lines of one colour are
+ * solved in parallel. The result does not depend on the number of threads.
+ *
+ * Couplings to other subdomains are ignored; lines do not cross subdomain boundaries.
+ *
+ * \tparam bs Block size
+ */
+template <int bs>
+class LinePreconditioner : public BlockSparseMatrix<freal,bs>,
+                           public BlockShellPreconditioner<bs>
+{
+public:
+	/** \param mesh The mesh from which the preconditioning matrix is assembled
+	 * \param type Line Jacobi or line SGS
+	 * \param threshold Local anisotropy above which cells are regarded as part of a line
+	 */
+	LinePreconditioner(const UMesh<freal,NDIM>& mesh, const LinePCType type, const freal threshold);
+
+	/// Copies the subdomain blocks of a BAIJ matrix and factors the block-tridiagonal line systems
+	StatusCode setup(Mat P, const BAIJJacobianLayout<bs>& layout);
+
+	/// Applies the preconditioner: y <- M^{-1} x
+	void apply(const freal *const x, freal *const y) const;
+
+	/// Number of lines of more than one cell
+	fint num_lines() const { return nlines; }
+
+	/// Number of lines and points
+	fint num_vertices() const { return static_cast<fint>(vertptr.size())-1; }
+
+	/// Number of colours of lines and points
+	int num_colours() const { return static_cast<int>(colourptr.size())-1; }
+
+protected:
+	using BlockSparseMatrix<freal,bs>::nbrows;
+	using BlockSparseMatrix<freal,bs>::browptr;
+	using BlockSparseMatrix<freal,bs>::bcolind;
+	using BlockSparseMatrix<freal,bs>::diagind;
+	using BlockSparseMatrix<freal,bs>::vals;
+	using BlockSparseMatrix<freal,bs>::dinv;
+
+	const LinePCType pctype;
+
+	/// Number of lines; the lines come first among the vertices, followed by the points
+	fint nlines;
+
+	/// Start of each line or point in \ref vertcells
+	std::vector<fint> vertptr;
+	/// Cells of each line, in order along the line, followed by the points
+	std::vector<fint> vertcells;
+
+	/// Block coupling each cell to the previous cell in its line, -1 if it is first or not in a line
+	std::vector<fint> prevblk;
+	/// Block coupling each cell to the next cell in its line, -1 if it is last or not in a line
+	std::vector<fint> nextblk;
+
+	/// Start of each colour in \ref colourverts
+	std::vector<fint> colourptr;
+	/// Lines and points sorted by colour
+	std::vector<fint> colourverts;
+
+	/// For each cell after the first of a line, the multiplier L_k D'_{k-1}^{-1} of the block LU
+	///  factorization; \ref dinv holds the inverses D'_k^{-1} of the pivot blocks
+	std::vector<freal> linemult;
+
+	/// Factors the block-tridiagonal system of one line or point
+	void factor_vertex(const fint ivert);
+
+	/// Solves the block-tridiagonal system of one line or point
+	/** \param gs If true, the right-hand side is x minus the couplings to other lines and points
+	 *   applied to the current y; otherwise it is x.
+	 */
+	void solve_vertex(const fint ivert, const bool gs, const freal *const x, freal *const y) const;
+};
+
+/// Sets a PC to be a \ref LinePreconditioner through the PETSc shell PC interface
+/** The PETSc options database is queried for
+ * - `-line_pc_type` (string argument): `jacobi` or `sgs`
+ * - `-line_pc_anisotropy_threshold` (real argument): anisotropy threshold for finding lines,
+ *   default 10
+ * \param pc The PC to set; its type is changed to PCSHELL
+ * \param mesh The mesh from which the preconditioning matrix is assembled
+ */
+template <int bs>
+StatusCode setup_line_pc(PC pc, const UMesh<freal,NDIM>& mesh);
+
+}
+#endif
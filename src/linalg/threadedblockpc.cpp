@@ -0,0 +1,312 @@
+/** \file
+ * \brief Implementation of thread-parallel block ILU(0) and SGS preconditioners
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <Eigen/LU>
+#include "threadedblockpc.hpp"
+#include "blockkernels.hpp"
+#include "petscutils.hpp"
+#include "mesh/ameshutils.hpp"
+
+namespace fvens {
+
+template <int bs>
+using Block = Eigen::Matrix<freal,bs,bs>;
+
+template <int bs>
+ThreadedBlockPreconditioner<bs>::ThreadedBlockPreconditioner(const UMesh<freal,NDIM>& mesh,
+                                                             const ThreadedPCType type,
+                                                             const ThreadedPCSchedule schedule,
+                                                             const int build_sweeps,
+                                                             const int apply_sweeps)
+	: BlockSparseMatrix<freal,bs>(mesh), pctype{type}, sched{schedule},
+	  nbuildsweeps{build_sweeps}, napplysweeps{apply_sweeps}
+{
+	rowpos.resize(nbrows);
+	grouprows.resize(nbrows);
+
+	if(sched == SCHEDULE_COLOURS)
+	{
+		const std::vector<int> colours = colourCells(mesh);
+		const int ncolours = nbrows > 0 ? *std::max_element(colours.begin(), colours.end())+1 : 0;
+
+		groupptr.assign(ncolours+1, 0);
+		for(fint irow = 0; irow < nbrows; irow++)
+			groupptr[colours[irow]+1]++;
+		for(int icol = 0; icol < ncolours; icol++)
+			groupptr[icol+1] += groupptr[icol];
+
+		std::vector<fint> pos(groupptr.begin(), groupptr.end()-1);
+		for(fint irow = 0; irow < nbrows; irow++) {
+			rowpos[irow] = pos[colours[irow]];
+			grouprows[pos[colours[irow]]++] = irow;
+		}
+	}
+	else
+	{
+		for(fint irow = 0; irow < nbrows; irow++) {
+			rowpos[irow] = irow;
+			grouprows[irow] = irow;
+		}
+		if(sched == SCHEDULE_LEVELS)
+			groupptr = levelSchedule(mesh);
+		else
+			groupptr = {0, nbrows};
+	}
+
+	ordblocks.resize(bcolind.size());
+	orddiag.resize(nbrows);
+	for(fint irow = 0; irow < nbrows; irow++)
+	{
+		for(fint jj = browptr[irow]; jj < browptr[irow+1]; jj++)
+			ordblocks[jj] = jj;
+		std::sort(ordblocks.begin()+browptr[irow], ordblocks.begin()+browptr[irow+1],
+		          [this](const fint a, const fint b) {
+			          return rowpos[bcolind[a]] < rowpos[bcolind[b]];
+		          });
+		orddiag[irow] = static_cast<fint>(std::find(ordblocks.begin()+browptr[irow],
+		                                            ordblocks.begin()+browptr[irow+1], diagind[irow])
+		                                  - ordblocks.begin());
+	}
+
+	if(pctype == THREADED_ILU0) {
+		luvals.resize(vals.size());
+		work.resize(static_cast<size_t>(nbrows)*bs);
+	}
+}
+
+template <int bs>
+inline void ThreadedBlockPreconditioner<bs>::factor_row(const fint irow)
+{
+	// Position of the block (row, col) in the row's blocks sorted by column, or -1
+	auto findBlock = [this](const fint row, const fint col) {
+		const auto pos = std::lower_bound(bcolind.begin()+browptr[row], bcolind.begin()+browptr[row+1],
+		                                  col);
+		return (pos == bcolind.begin()+browptr[row+1] || *pos != col)
+			? -1 : static_cast<fint>(pos - bcolind.begin());
+	};
+
+	for(fint p = browptr[irow]; p < browptr[irow+1]; p++)
+	{
+		const fint jj = ordblocks[p];
+		const fint jcol = bcolind[jj];
+
+		// A_ij - sum over k before both i and j of L_ik U_kj
+		Block<bs> s = Eigen::Map<const Block<bs>>(&vals[jj*bs*bs]);
+		for(fint q = browptr[irow]; q < orddiag[irow]; q++)
+		{
+			const fint kk = ordblocks[q];
+			const fint kcell = bcolind[kk];
+			if(rowpos[kcell] >= rowpos[jcol])
+				break;
+			const fint kj = findBlock(kcell, jcol);
+			if(kj >= 0)
+				s.noalias() -= Eigen::Map<const Block<bs>>(&luvals[kk*bs*bs])
+					* Eigen::Map<const Block<bs>>(&luvals[kj*bs*bs]);
+		}
+
+		Eigen::Map<Block<bs>> lu(&luvals[jj*bs*bs]);
+		if(p < orddiag[irow])
+			lu.noalias() = s * Eigen::Map<const Block<bs>>(&dinv[jcol*bs*bs]);
+		else
+			lu = s;
+	}
+
+	Eigen::Map<Block<bs>> di(&dinv[irow*bs*bs]);
+	di = Eigen::Map<const Block<bs>>(&luvals[diagind[irow]*bs*bs]).inverse();
+}
+
+template <int bs>
+inline void ThreadedBlockPreconditioner<bs>::forward_row(const fint irow, const freal *const x,
+                                                         freal *const y) const
+{
+	BlockVector<bs> r = Eigen::Map<const BlockVector<bs>>(x+irow*bs);
+	if(pctype == THREADED_SGS)
+	{
+		for(fint jj = browptr[irow]; jj < browptr[irow+1]; jj++)
+			if(jj != diagind[irow])
+				r.noalias() -= Eigen::Map<const Block<bs>>(&vals[jj*bs*bs])
+					* Eigen::Map<const BlockVector<bs>>(y+bcolind[jj]*bs);
+		Eigen::Map<BlockVector<bs>>(y+irow*bs).noalias()
+			= Eigen::Map<const Block<bs>>(&dinv[irow*bs*bs]) * r;
+	}
+	else
+	{
+		for(fint p = browptr[irow]; p < orddiag[irow]; p++) {
+			const fint jj = ordblocks[p];
+			r.noalias() -= Eigen::Map<const Block<bs>>(&luvals[jj*bs*bs])
+				* Eigen::Map<const BlockVector<bs>>(y+bcolind[jj]*bs);
+		}
+		Eigen::Map<BlockVector<bs>>(y+irow*bs) = r;
+	}
+}
+
+template <int bs>
+inline void ThreadedBlockPreconditioner<bs>::backward_row(const fint irow, const freal *const x,
+                                                          freal *const y) const
+{
+	if(pctype == THREADED_SGS) {
+		forward_row(irow, x, y);
+		return;
+	}
+
+	BlockVector<bs> r = Eigen::Map<const BlockVector<bs>>(x+irow*bs);
+	for(fint p = orddiag[irow]+1; p < browptr[irow+1]; p++) {
+		const fint jj = ordblocks[p];
+		r.noalias() -= Eigen::Map<const Block<bs>>(&luvals[jj*bs*bs])
+			* Eigen::Map<const BlockVector<bs>>(y+bcolind[jj]*bs);
+	}
+	Eigen::Map<BlockVector<bs>>(y+irow*bs).noalias()
+		= Eigen::Map<const Block<bs>>(&dinv[irow*bs*bs]) * r;
+}
+
+template <int bs>
+template <typename RowOp>
+void ThreadedBlockPreconditioner<bs>::sweep(const bool forward, const int nsweeps,
+                                            RowOp&& rowop) const
+{
+	const fint ngroups = num_groups();
+#pragma omp parallel default(shared)
+	for(int isweep = 0; isweep < nsweeps; isweep++)
+		for(fint ig = 0; ig < ngroups; ig++)
+		{
+			const fint igroup = forward ? ig : ngroups-1-ig;
+			const fint start = groupptr[igroup], end = groupptr[igroup+1];
+			// the implied barrier separates the groups
+#pragma omp for
+			for(fint i = start; i < end; i++)
+				rowop(grouprows[forward ? i : end-1-(i-start)]);
+		}
+}
+
+template <int bs>
+StatusCode ThreadedBlockPreconditioner<bs>::setup(Mat P, const BAIJJacobianLayout<bs>& layout)
+{
+	StatusCode ierr = this->copy_from(P, layout); CHKERRQ(ierr);
+	this->invert_diagonal_blocks();
+
+	if(pctype == THREADED_ILU0)
+	{
+		// The initial guess of the asynchronous factorization is the matrix itself
+		std::copy(vals.begin(), vals.end(), luvals.begin());
+		sweep(true, sched == SCHEDULE_ASYNC ? nbuildsweeps : 1,
+		      [this](const fint irow) { factor_row(irow); });
+	}
+	return ierr;
+}
+
+template <int bs>
+void ThreadedBlockPreconditioner<bs>::apply(const freal *const x, freal *const y) const
+{
+	const int nsweeps = sched == SCHEDULE_ASYNC ? napplysweeps : 1;
+	std::fill(y, y+nbrows*bs, 0);
+
+	if(pctype == THREADED_SGS)
+	{
+		for(int isweep = 0; isweep < nsweeps; isweep++) {
+			sweep(true, 1, [this,x,y](const fint irow) { forward_row(irow, x, y); });
+			sweep(false, 1, [this,x,y](const fint irow) { backward_row(irow, x, y); });
+		}
+	}
+	else
+	{
+		freal *const z = work.data();
+		std::fill(work.begin(), work.end(), 0);
+		sweep(true, nsweeps, [this,x,z](const fint irow) { forward_row(irow, x, z); });
+		sweep(false, nsweeps, [this,z,y](const fint irow) { backward_row(irow, z, y); });
+	}
+}
+
+template class ThreadedBlockPreconditioner<NVARS>;
+template class ThreadedBlockPreconditioner<1>;
+
+/// Prefix of the names of the shell PCs, by which they are recognized
+static const char threaded_pc_name_prefix[] = "threaded block";
+
+template <int bs>
+StatusCode setup_threaded_block_pc(PC pc, const UMesh<freal,NDIM>& mesh)
+{
+	StatusCode ierr = 0;
+
+	char typestr[16] = "sgs", schedstr[16] = "async";
+	PetscBool set = PETSC_FALSE;
+	ierr = PetscOptionsGetString(NULL, NULL, "-threaded_pc_type", typestr, sizeof(typestr), &set);
+	CHKERRQ(ierr);
+	ierr = PetscOptionsGetString(NULL, NULL, "-threaded_pc_schedule", schedstr, sizeof(schedstr),
+	                             &set);
+	CHKERRQ(ierr);
+
+	ThreadedPCType type;
+	if(!std::strcmp(typestr, "sgs"))
+		type = THREADED_SGS;
+	else if(!std::strcmp(typestr, "ilu0"))
+		type = THREADED_ILU0;
+	else
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Threaded block PC: unknown type!");
+
+	ThreadedPCSchedule schedule;
+	if(!std::strcmp(schedstr, "async"))
+		schedule = SCHEDULE_ASYNC;
+	else if(!std::strcmp(schedstr, "levels"))
+		schedule = SCHEDULE_LEVELS;
+	else if(!std::strcmp(schedstr, "colours"))
+		schedule = SCHEDULE_COLOURS;
+	else
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_OUTOFRANGE, "Threaded block PC: unknown schedule!");
+
+	PetscInt sweeps[2] = {1, 1};
+	PetscInt nmax = 2;
+	ierr = PetscOptionsGetIntArray(NULL, NULL, "-threaded_pc_sweeps", sweeps, &nmax, &set);
+	CHKERRQ(ierr);
+
+	const std::string name = std::string(threaded_pc_name_prefix) + " "
+		+ (type == THREADED_SGS ? "SGS" : "ILU(0)") + ", " + schedstr;
+
+	ierr = setup_block_shell_pc<bs>(pc, mesh,
+	                                new ThreadedBlockPreconditioner<bs>(mesh, type, schedule,
+	                                                                    static_cast<int>(sweeps[0]),
+	                                                                    static_cast<int>(sweeps[1])),
+	                                name);
+	CHKERRQ(ierr);
+	return ierr;
+}
+
+template <int bs>
+StatusCode get_threaded_block_pc_times(PC pc, bool *const is_threaded_pc, double *const setupwtime,
+                                       double *const applywtime, double *const cputime)
+{
+	return get_block_shell_pc_times<bs>(pc, threaded_pc_name_prefix, is_threaded_pc,
+	                                    setupwtime, applywtime, cputime);
+}
+
+template StatusCode setup_threaded_block_pc<NVARS>(PC pc, const UMesh<freal,NDIM>& mesh);
+template StatusCode setup_threaded_block_pc<1>(PC pc, const UMesh<freal,NDIM>& mesh);
+template StatusCode get_threaded_block_pc_times<NVARS>(PC pc, bool *const is_threaded_pc,
+                                                       double *const setupwtime,
+                                                       double *const applywtime,
+                                                       double *const cputime);
+template StatusCode get_threaded_block_pc_times<1>(PC pc, bool *const is_threaded_pc,
+                                                   double *const setupwtime,
+                                                   double *const applywtime,
+                                                   double *const cputime);
+
+}
@@ -0,0 +1,160 @@
+/** \file
+ * \brief Thread-parallel block ILU(0) and SGS preconditioners, asynchronous or scheduled
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_THREADED_BLOCK_PC_H
+#define FVENS_THREADED_BLOCK_PC_H
+
+#include "blocksparsematrix.hpp"
+
+namespace fvens {
+
+/// The preconditioning operation
+enum ThreadedPCType {
+	THREADED_SGS,              ///< Block symmetric Gauss-Seidel
+	THREADED_ILU0              ///< Block incomplete LU factorization with no fill-in
+};
+
+/// How the work of a preconditioner is divided among threads
+enum ThreadedPCSchedule {
+	/// All block rows are processed in parallel without synchronization, for a fixed number of
+	///  sweeps - the asynchronous fine-grained ILU and asynchronous triangular solves
+	SCHEDULE_ASYNC,
+	/// Block rows are processed level by level (see fvens::levelSchedule); exactly equivalent to the
+	///  sequential preconditioner in the natural ordering
+	SCHEDULE_LEVELS,
+	/// Block rows are processed colour by colour (see fvens::colourCells); exactly equivalent to the
+	///  sequential preconditioner in the multicolour ordering
+	SCHEDULE_COLOURS
+};
+
+/// Block ILU(0) or SGS preconditioner for the subdomain part of a Jacobian, parallelized with OpenMP
+/** The blocks of the preconditioning matrix are held in the underlying \ref BlockSparseMatrix.
+ * Factorization and triangular solves use an ordering of the cells: the natural ordering for the
+ * asynchronous and level schedules, or the multicolour ordering, in which the cells of one colour
+ * come after those of all lower colours. The L and U parts of each block row are those of its
+ * blocks whose column comes before, or after, the row in this ordering.
+ *
+ * With SCHEDULE_ASYNC, each build sweep is one parallel fixed-point sweep over all the non-zero
+ * blocks of the factors (for SGS, the build consists only of the inversion of diagonal blocks),
+ * and each apply sweep is one parallel Jacobi-like sweep of each triangular solve. The threads
+ * read entries that other threads may be writing at the same time; this is the defining property
+ * of asynchronous iterations, and the results are not deterministic. With one thread, or enough
+ * sweeps, they are those of the sequential preconditioner. The deterministic schedules ignore the
+ * sweep counts.
+ *
+ * Couplings to other subdomains are ignored, so in parallel this is a block-Jacobi preconditioner
+ * with ILU(0) or SGS on each subdomain.
+ *
+ * \tparam bs Block size
+ */
+template <int bs>
+class ThreadedBlockPreconditioner : public BlockSparseMatrix<freal,bs>,
+                                    public BlockShellPreconditioner<bs>
+{
+public:
+	/** \param mesh The mesh from which the preconditioning matrix is assembled
+	 * \param type The preconditioning operation
+	 * \param schedule Thread parallelization strategy
+	 * \param build_sweeps Number of asynchronous factorization sweeps
+	 * \param apply_sweeps Number of asynchronous sweeps of each triangular solve
+	 */
+	ThreadedBlockPreconditioner(const UMesh<freal,NDIM>& mesh, const ThreadedPCType type,
+	                            const ThreadedPCSchedule schedule,
+	                            const int build_sweeps, const int apply_sweeps);
+
+	/// Copies the subdomain blocks of a BAIJ matrix and computes the factorization
+	StatusCode setup(Mat P, const BAIJJacobianLayout<bs>& layout);
+
+	/// Applies the preconditioner: y <- M^{-1} x
+	void apply(const freal *const x, freal *const y) const;
+
+	/// Number of groups of block rows processed one after the other by the deterministic schedules
+	fint num_groups() const { return static_cast<fint>(groupptr.size())-1; }
+
+protected:
+	using BlockSparseMatrix<freal,bs>::nbrows;
+	using BlockSparseMatrix<freal,bs>::browptr;
+	using BlockSparseMatrix<freal,bs>::bcolind;
+	using BlockSparseMatrix<freal,bs>::diagind;
+	using BlockSparseMatrix<freal,bs>::vals;
+	using BlockSparseMatrix<freal,bs>::dinv;
+
+	const ThreadedPCType pctype;
+	const ThreadedPCSchedule sched;
+	const int nbuildsweeps;
+	const int napplysweeps;
+
+	/// Start of each group in \ref grouprows; size is one more than the number of groups
+	std::vector<fint> groupptr;
+	/// Block rows sorted by group
+	std::vector<fint> grouprows;
+
+	/// Position of each block row in the ordering
+	std::vector<fint> rowpos;
+	/// For each block row, in the range given by \ref browptr, the indices of its blocks sorted by
+	///  the position of their columns in the ordering
+	std::vector<fint> ordblocks;
+	/// Index into \ref ordblocks of the diagonal block of each row
+	std::vector<fint> orddiag;
+
+	/// Blocks of the ILU factors, with the structure of the matrix; the unit diagonal of L is not
+	///  stored
+	std::vector<freal> luvals;
+
+	/// Intermediate vector of the ILU application
+	mutable std::vector<freal> work;
+
+	/// Computes the ILU(0) factors in one block row from the current factors in other rows
+	void factor_row(const fint irow);
+
+	/// Forward relaxation of one block row
+	void forward_row(const fint irow, const freal *const x, freal *const y) const;
+
+	/// Backward relaxation of one block row
+	void backward_row(const fint irow, const freal *const x, freal *const y) const;
+
+	/// Applies a row operation to all rows, forwards or backwards according to the schedule
+	template <typename RowOp>
+	void sweep(const bool forward, const int nsweeps, RowOp&& rowop) const;
+};
+
+/// Sets a PC to be a \ref ThreadedBlockPreconditioner through the PETSc shell PC interface
+/** The PETSc options database is queried for
+ * - `-threaded_pc_type` (string argument): `sgs` or `ilu0`
+ * - `-threaded_pc_schedule` (string argument): `async` (default), `levels` or `colours`
+ * - `-threaded_pc_sweeps` (two ints, comma-separated): numbers of build and apply sweeps for
+ *   the asynchronous schedule, default 1,1
+ * \param pc The PC to set; its type is changed to PCSHELL
+ * \param mesh The mesh from which the preconditioning matrix is assembled
+ */
+template <int bs>
+StatusCode setup_threaded_block_pc(PC pc, const UMesh<freal,NDIM>& mesh);
+
+/// Gets the total set-up and application times of a PC, if it is a threaded block preconditioner
+/** \param[out] is_threaded_pc Whether the PC is a threaded block preconditioner; if not, the
+ *   times are not set
+ * \param[out] setupwtime Wall-clock time spent in set-up (copying and factorization)
+ * \param[out] applywtime Wall-clock time spent in application
+ * \param[out] cputime Total CPU time, over all threads, of set-up and application
+ */
+template <int bs>
+StatusCode get_threaded_block_pc_times(PC pc, bool *const is_threaded_pc, double *const setupwtime,
+                                       double *const applywtime, double *const cputime);
+
+}
+#endif
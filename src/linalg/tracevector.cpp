@@ -16,8 +16,6 @@
  *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <set>
-#include "utilities/mpiutils.hpp"
 #include "tracevector.hpp"
 
 namespace fvens {
@@ -31,156 +29,10 @@ L2TraceVector<scalar,nvars>::L2TraceVector(const UMesh<scalar,NDIM>& mesh) : m{m
 template <typename scalar, int nvars>
 void L2TraceVector<scalar,nvars>::update_comm_pattern()
 {
-	// const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
-	// std::cout << "RAnk " << mpirank << ": Started updated comm pattern.." << std::endl;
-
 	left.resize(m.gnaface()*nvars);
 	right.resize(m.gnaface()*nvars);
 
-	sharedfacemap.resize(m.gnConnFace(),1);
-
-	std::set<int> nbds;
-	for(fint icface = 0; icface < m.gnConnFace(); icface++)
-	{
-		nbds.insert(m.gconnface(icface,2));
-	}
-	nbdranks.resize(nbds.size());
-	std::copy(nbds.begin(), nbds.end(), nbdranks.begin());
-
-// #ifdef DEBUG
-// 	std::cout << "Rank " << mpirank << ": nbd = " << nbdranks.size() << std::endl;
-// 	std::cout << "Rank " << mpirank << ":    nbds = ";
-// 	for(size_t i= 0; i < nbdranks.size(); i++) {
-// 		std::cout << nbdranks[i] << " ";
-// 	}
-// 	std::cout << std::endl;
-// #endif
-
-	for(fint icface = 0; icface < m.gnConnFace(); icface++)
-	{
-#ifdef DEBUG
-		bool matched = false;
-#endif
-		for(int i = 0; i < static_cast<int>(nbdranks.size()); i++)
-			if(m.gconnface(icface,2) == nbdranks[i]) {
-				sharedfacemap(icface,0) = i;
-#ifdef DEBUG
-				matched = true;
-#endif
-				break;
-			}
-#ifdef DEBUG
-		assert(matched);
-#endif
-	}
-
-	sharedfaces.resize(nbdranks.size());
-	for(fint icface = 0; icface < m.gnConnFace(); icface++)
-	{
-		sharedfaces[sharedfacemap(icface,0)].push_back(icface);
-	}
-
-#ifdef DEBUG
-	// check face counts
-	{
-		fint totface = 0;
-		for(size_t irank = 0; irank < nbdranks.size(); irank++)
-			totface += sharedfaces[irank].size();
-		assert(totface == m.gnConnFace());
-	}
-
-	// check sharedfaces against connface
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-		for(size_t isface = 0; isface < sharedfaces[irank].size(); isface++)
-			assert(nbdranks[irank] == m.gconnface(sharedfaces[irank][isface],2));
-
-	// check sharedfacemap
-	for(fint icface = 0; icface < m.gnConnFace(); icface++)
-		assert(nbdranks[sharedfacemap(icface,0)] == m.gconnface(icface,2));
-#endif
-
-	sharedfacesother.resize(nbdranks.size());
-	for(size_t irank = 0; irank < nbdranks.size(); irank++) {
-		sharedfacesother[irank].assign(sharedfaces[irank].size(), -1);
-	}
-
-	std::vector<std::vector<fint>> nbdGFaceIndex(nbdranks.size());
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-		nbdGFaceIndex[irank].resize(sharedfaces[irank].size());
-
-	std::vector<MPI_Request> rrequests(nbdranks.size());
-
-	// Send and receive element indices corresponding to shared faces
-	{
-		std::vector<MPI_Request> srequests(nbdranks.size());
-		std::vector<std::vector<fint>> myGFaceIndex(nbdranks.size());
-
-		for(size_t irank = 0; irank < nbdranks.size(); irank++)
-		{
-			myGFaceIndex[irank].resize(sharedfaces[irank].size());
-			for(size_t iface = 0; iface < sharedfaces[irank].size(); iface++)
-				myGFaceIndex[irank][iface] = m.gconnface(sharedfaces[irank][iface],4);
-
-			const int dest = nbdranks[irank];
-			const int tag = irank;
-			MPI_Isend(&myGFaceIndex[irank][0], myGFaceIndex[irank].size(), FVENS_MPI_INT, dest, tag,
-			          MPI_COMM_WORLD, &srequests[irank]);
-		}
-
-		for(size_t irank = 0; irank < nbdranks.size(); irank++)
-		{
-			const int source = nbdranks[irank];
-			//const int tag = irank;
-			MPI_Irecv(&nbdGFaceIndex[irank][0], nbdGFaceIndex[irank].size(), FVENS_MPI_INT,
-			          source, MPI_ANY_TAG,
-			          MPI_COMM_WORLD, &rrequests[irank]);
-		}
-
-		// Wait for sends to finish
-		for(size_t irank = 0; irank < nbdranks.size(); irank++)
-			MPI_Wait(&srequests[irank], MPI_STATUS_IGNORE);
-	}
-
-	// Wait for receives to finish
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-		MPI_Wait(&rrequests[irank], MPI_STATUS_IGNORE);
-
-	// set the mapping between connectivity faces and receive buffers
-	for(fint icface = 0; icface < m.gnConnFace(); icface++)
-	{
-		const int rankindex = sharedfacemap(icface,0);
-		assert(nbdranks[rankindex] == m.gconnface(icface,2));
-
-#ifdef DEBUG
-		bool matched = false;
-#endif
-		for(fint isface = 0; isface < static_cast<fint>(sharedfaces[rankindex].size()); isface++)
-		{
-			if(nbdGFaceIndex[rankindex][isface] == m.gconnface(icface,4))
-			{
-				sharedfacesother[rankindex][isface] = icface;
-#ifdef DEBUG
-				matched = true;
-#endif
-				break;
-			}
-		}
-
-#ifdef DEBUG
-		assert(matched);
-#endif
-	}
-
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-		for(size_t isface = 0; isface < sharedfacesother[irank].size(); isface++)
-			assert(sharedfacesother[irank][isface] != -1);
-
-	// buffers for comms
-	sendbuffers.resize(nbdranks.size());
-	recvbuffers.resize(nbdranks.size());
-	srequests.resize(nbdranks.size());
-
-	//std::cout << "Trace communication pattern computed." << std::endl;
+	halo.reset(new HaloExchange(m, {{HALO_TRACE, nvars}}));
 }
 
 template <typename scalar, int nvars>
@@ -207,136 +59,18 @@ const scalar *L2TraceVector<scalar,nvars>::getLocalArrayRight() const
 	return &right[0];
 }
 
-/** A more general implementation would use MPI_BYTE and manually serialize the array of scalars.
- * But the easier way would be to define templated MPI communication functions and use those below.
- */
 template <typename scalar, int nvars>
 void L2TraceVector<scalar,nvars>::updateSharedFacesBegin()
 {
-	std::vector<MPI_Request> sreq(nbdranks.size());
-
-// #ifdef DEBUG
-// 	const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
-// 	const int mpisize = get_mpi_size(MPI_COMM_WORLD);
-// 	for(int irank = 0; irank < mpisize; irank++)
-// 	{
-// 		MPI_Barrier(MPI_COMM_WORLD);
-// 		if(irank == mpirank) {
-// 			std::cout << "Rank " << irank << " beginning send" << std::endl;
-// 			std::cout << " Num conn faces = " << m.gnConnFace() << std::endl;
-// 			for(size_t jrank = 0; jrank < nbdranks.size(); jrank++)
-// 			{
-// 				std::cout << "  Nbd rank " << nbdranks[jrank] << std::endl;
-// 				for(size_t iface = 0; iface < sharedfaces[jrank].size(); iface++) {
-// 					std::cout << "  Conn face " << sharedfaces[jrank][iface] << ": ";
-// 					for(int i = 0; i < nvars; i++)
-// 						std::cout << " " << left[sharedfaces[jrank][iface]*nvars+i];
-// 					std::cout << std::endl;
-// 				}
-// 			}
-// 		}
-// 		MPI_Barrier(MPI_COMM_WORLD);
-// 	}
-// #endif
-
-	//const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
-
-	const fint fstart = m.gConnBFaceStart();
-	//std::cout << "Rank = " << mpirank << ": buffering..." << std::endl;
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-	{
-		sendbuffers[irank].resize(sharedfaces[irank].size()*nvars);
-
-		//std::cout << "Rank " << mpirank << ": Buffer for nbd rank " << nbdranks[irank] << std::endl;
-		for(size_t iface = 0; iface < sharedfaces[irank].size(); iface++)
-		{
-			for(int ivar = 0; ivar < nvars; ivar++) {
-				sendbuffers[irank][iface*nvars+ivar]
-					= left [(sharedfaces[irank][iface]+fstart)*nvars + ivar];
-				//std::cout << " " << buffers[irank][iface*nvars+ivar];
-			}
-			//std::cout << std::endl;
-		}
-		//std::cout << "Rank = " << mpirank << ": buffer ready." << std::endl;
-
-		MPI_Isend(&sendbuffers[irank][0], sharedfaces[irank].size()*nvars, FVENS_MPI_REAL,
-		          nbdranks[irank], irank,
-		          MPI_COMM_WORLD, &srequests[irank]);
-	}
-
-	//std::cout << "Rank = " << mpirank << ": all sends initiated" << std::endl;
+	const void *const sources[] = {left.data()};
+	halo->begin(sources);
 }
 
 template <typename scalar, int nvars>
 void L2TraceVector<scalar,nvars>::updateSharedFacesEnd()
 {
-	//const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
-	//std::cout << "Rank " << mpirank << ": receiving.." << std::endl;
-
-	std::vector<MPI_Request> rreq(nbdranks.size());
-
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-	{
-		recvbuffers[irank].resize(sharedfaces[irank].size()*nvars);
-		MPI_Irecv(&recvbuffers[irank][0], sharedfaces[irank].size()*nvars, FVENS_MPI_REAL,
-		          nbdranks[irank], MPI_ANY_TAG,
-		          MPI_COMM_WORLD, &rreq[irank]);
-	}
-
-	//std::cout << "Rank " << mpirank << ": receives posted." << std::endl;
-
-	MPI_Waitall(nbdranks.size(), &srequests[0], MPI_STATUS_IGNORE);
-	// for(size_t irank = 0; irank < nbdranks.size(); irank++)
-	// 	MPI_Wait(&srequests[irank], MPI_STATUS_IGNORE);
-	//std::cout << "Rank = " << mpirank << ": all sends completed." << std::endl;
-
-	const fint fstart = m.gConnBFaceStart();
-	for(size_t irank = 0; irank < nbdranks.size(); irank++)
-	{
-		MPI_Wait(&rreq[irank], MPI_STATUS_IGNORE);
-
-		//std::cout << "Buffer for nbd rank " << nbdranks[irank] << std::endl;
-		for(size_t isface = 0; isface < sharedfaces[irank].size(); isface++)
-		{
-			for(int ivar = 0; ivar < nvars; ivar++) {
-				//std::cout << " " << buffers[irank][isface*nvars+ivar];
-				right[(fstart+sharedfacesother[irank][isface])*nvars+ivar]
-					= recvbuffers[irank][isface*nvars+ivar];
-			}
-			//std::cout << std::endl;
-		}
-	}
-
-	for(size_t irank = 0; irank < nbdranks.size(); irank++) {
-		sendbuffers[irank].resize(0);
-		sendbuffers[irank].shrink_to_fit();
-		recvbuffers[irank].resize(0);
-		recvbuffers[irank].shrink_to_fit();
-	}
-
-// #ifdef DEBUG
-// 	const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
-// 	const int mpisize = get_mpi_size(MPI_COMM_WORLD);
-// 	std::cout << "Rank " << mpirank << " completed receives." << std::endl;
-// 	for(int irank = 0; irank < mpisize; irank++)
-// 	{
-// 		MPI_Barrier(MPI_COMM_WORLD);
-// 		if(irank == mpirank) {
-// 			std::cout << "Rank " << irank << " ending receive" << std::endl;
-// 			for(size_t jrank = 0; jrank < nbdranks.size(); jrank++)
-// 			{
-// 				std::cout << "  Nbd rank " << nbdranks[jrank] << std::endl;
-// 				for(size_t iface = 0; iface < sharedfaces[jrank].size(); iface++) {
-// 					std::cout << "  Conn face " << sharedfacesother[jrank][iface] << ": ";
-// 					for(int i = 0; i < nvars; i++)
-// 						std::cout << " " << right[sharedfacesother[jrank][iface]*nvars+i];
-// 					std::cout << std::endl;
-// 				}
-// 			}
-// 		}
-// 		MPI_Barrier(MPI_COMM_WORLD);
-// 	}
-// #endif
+	void *const targets[] = {right.data()};
+	halo->end(targets);
 }
 
 template class L2TraceVector<freal,1>;
@@ -22,7 +22,9 @@
 #define FVENS_TRACE_VECTOR_H
 
 #include <vector>
+#include <memory>
 #include "mesh/mesh.hpp"
+#include "haloexchange.hpp"
 
 namespace fvens {
 
@@ -66,34 +68,8 @@ protected:
 	/// Storage for right vector
 	std::vector<scalar> right;
 
-	/// MPI ranks of neighbouring subdomains of this subdomain
-	std::vector<int> nbdranks;
-	/// List of connectivity face indices associated with each of the neighbouring subdomains
-	/** For each neighbouring subdomain, gives the connface index associated with each face.
-	 */
-	std::vector<std::vector<fint>> sharedfaces;
-
-	/// Connectivity face indices associated with shared faces as seen by the neighbouring subdomain
-	/** This gives the connface index (of this subdomain) associated with each face of
-	 *  the *other* subdomain neighbouring this one. So the size is same as \ref sharedfaces.
-	 *  This is necessary because the other subdomain has a different ordering
-	 *  of the shared connectivity faces.
-	 */
-	std::vector<std::vector<fint>> sharedfacesother;
-
-	/// Indices into the received buffer corresponding to the connectivity faces of this subdomain
-	/** For each connectivity face in this subdomain, we store, in order,
-	 *  - Index into nbdranks of the neighbouring subdomain which shares this face
-	 *  NO: - Index (modulo nvars) into the buffer that will be received from that subdomain.
-	 */
-	amat::Array2d<fint> sharedfacemap;
-
-	/// Temporary storage to buffer the message
-	std::vector<std::vector<scalar>> sendbuffers;
-	/// Temporary storage to buffer the message
-	std::vector<std::vector<scalar>> recvbuffers;
-	/// MPI requests corresponding to the sends
-	std::vector<MPI_Request> srequests;
+	/// Exchange of left values at connectivity faces into neighbours' right values
+	std::unique_ptr<HaloExchange> halo;
 
 	/// Updates communication pattern and also updates the size of the vector
 	/** Computes data needed for message passing. Should be called if the mesh topology changes.
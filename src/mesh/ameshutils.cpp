@@ -5,13 +5,20 @@
 #include <vector>
 #include <iostream>
 #include <cstring>
+#include <sstream>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include "ameshutils.hpp"
 #include "meshpartitioning.hpp"
+#include "distributedmeshbuilder.hpp"
+#include "meshcache.hpp"
 #include "meshordering.hpp"
 #include "linalg/alinalg.hpp"
-#include "spatial/diffusion.hpp"
 #include "utilities/aerrorhandling.hpp"
+#include "utilities/aoptionparser.hpp"
 #include "utilities/mpiutils.hpp"
 
 #ifdef USE_ADOLC
@@ -25,15 +32,17 @@ namespace fvens {
  * \warning It is the caller's responsibility to recompute things that are affected by the reordering,
  * such as \ref UMesh2dh::compute_topological.
  *
+ * The ordering is computed from the adjacency graph of the cells of the subdomain, given by its
+ * subdomain faces; connectivity faces to other subdomains are ignored, so that each subdomain is
+ * reordered independently.
+ *
  * \param ordering The ordering to use - "rcm" is recommended. See the relevant
  * [page](www.mcs.anl.gov/petsc/petsc-current/docs/manualpages/Mat/MatOrderingType.html)
  * in the PETSc manual for the full list.
- * \param sd Spatial discretization to be used to generate a Jacobian matrix
- * \param m The mesh context
+ * \param m The mesh context; its topological data must have been computed
  */
 template <typename scalar>
-static StatusCode reorderMeshPetsc(const char *const ordering, const Spatial<freal,1>& sd,
-                                   UMesh<scalar,NDIM>& m);
+static StatusCode reorderMeshPetsc(const char *const ordering, UMesh<scalar,NDIM>& m);
 
 template <typename scalar>
 StatusCode preprocessMesh(UMesh<scalar,NDIM>& m)
@@ -63,6 +72,9 @@ StatusCode preprocessMesh(UMesh<scalar,NDIM>& m)
 			}
 			lineReorder(m,threshold);
 		}
+		else if(orderstr == "hilbert" || orderstr == "morton") {
+			spaceFillingCurveReorder(m, orderstr);
+		}
 		else if(orderstr.find("line") != std::string::npos) {
 			// split string at _
 			std::vector<std::string> orders;
@@ -81,17 +93,12 @@ StatusCode preprocessMesh(UMesh<scalar,NDIM>& m)
 			hybridLineReorder(m, threshold, secondorder.c_str());
 		}
 		else {
-			DiffusionMA<1> sd(&m, 1.0, 0.0,
-			                  [](const freal *const r, const freal t,
-			                     const freal *const u,
-			                     freal *const sourceterm)
-			                  { sourceterm[0] = 0; },
-			                  "NONE");
-
-			ierr = reorderMeshPetsc(ordstr, sd, m); CHKERRQ(ierr);
+			ierr = reorderMeshPetsc(ordstr, m); CHKERRQ(ierr);
 		}
 	}
 
+	m.renumber_global_cells(PETSC_COMM_WORLD);
+
 	m.compute_topological();
 	m.compute_areas();
 	m.compute_face_data();
@@ -99,8 +106,73 @@ StatusCode preprocessMesh(UMesh<scalar,NDIM>& m)
 	return ierr;
 }
 
-UMesh<freal,NDIM> constructMesh(const std::string mesh_path)
+/// Prints the quality of the partition on rank 0 if there is more than one rank
+static void reportPartitionQuality(const UMesh<freal,NDIM>& lm, const MeshPartitionConfig& pconf)
+{
+	if(get_mpi_size(PETSC_COMM_WORLD) == 1)
+		return;
+	const PartitionQuality pq = computePartitionQuality(lm, pconf, PETSC_COMM_WORLD);
+	if(get_mpi_rank(PETSC_COMM_WORLD) == 0)
+		printPartitionQuality(pq, pconf.report_per_rank, std::cout);
+}
+
+/// Reads and partitions the mesh in parallel without ever building the global mesh
+/** \param prepartitioned If true, the mesh file is already partitioned (by Gmsh) and each rank
+ *   reads its own partition; otherwise the mesh is partitioned in parallel after reading.
+ */
+static UMesh<freal,NDIM> constructMeshDistributed(const std::string mesh_path,
+                                                  const MeshPartitionConfig& pconf,
+                                                  const bool prepartitioned)
+{
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	UMesh<freal,NDIM> lm = [&]() {
+		if(prepartitioned) {
+			if(mpirank == 0)
+				std::cout << "Reading the partitioned mesh in parallel\n";
+			const PartitionedMeshReader reader(mesh_path, PETSC_COMM_WORLD);
+			return reader.build();
+		}
+
+		char partstr[PETSCOPTION_STR_LEN];
+		PetscBool flag = PETSC_FALSE;
+		int ierr = PetscOptionsGetString(NULL, NULL, "-mesh_distributed_partitioner", partstr,
+		                                 PETSCOPTION_STR_LEN, &flag);
+		petsc_throw(ierr, "Could not get partitioner option!");
+		// The parallel counterpart of the Scotch partitioner is PT-Scotch
+		const std::string partitioner = flag ? partstr
+			: (pconf.partitioner == "scotch" ? "ptscotch" : pconf.partitioner);
+
+		if(mpirank == 0)
+			std::cout << "Reading and distributing the mesh in parallel, partitioner "
+			          << partitioner << "\n";
+
+		DistributedMeshBuilder builder(mesh_path, partitioner, PETSC_COMM_WORLD, pconf);
+		return builder.build();
+	}();
+
+	lm.correctBoundaryFaceOrientation();
+
+	const int ierr = preprocessMesh<freal>(lm);
+	fvens_throw(ierr, "Mesh could not be preprocessed!");
+
+#ifdef DEBUG
+	std::cout << " Rank " << mpirank << ":\n\t elems = " << lm.gnelem() << ", faces = " << lm.gnaface()
+	          << ",\n\t interior faces = " << lm.gninface() << ", phy boun faces = " << lm.gnbface()
+	          << ", conn faces = " << lm.gnConnFace() << ",\n\t vertices = " << lm.gnpoin() << std::endl;
+#endif
+	return lm;
+}
+
+/// Reads, partitions and preprocesses the mesh \sa constructMesh
+static UMesh<freal,NDIM> buildMesh(const std::string mesh_path, const MeshPartitionConfig& pconf)
 {
+	int ierr = 0;
+	if(parseOptionalPetscCmd_bool("-mesh_partitioned_read"))
+		return constructMeshDistributed(mesh_path, pconf, true);
+	if(parseOptionalPetscCmd_bool("-mesh_distributed_read"))
+		return constructMeshDistributed(mesh_path, pconf, false);
+
 	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
 
 	// Read mesh
@@ -118,11 +190,16 @@ UMesh<freal,NDIM> constructMesh(const std::string mesh_path)
 
 	// Partition
 	if(mpirank == 0)
-		std::cout << "Distributing the mesh\n";
-	TrivialReplicatedGlobalMeshPartitioner p(gm);
-	//ScotchRGMPartitioner p(gm);
-	p.compute_partition();
-	UMesh<freal,NDIM> lm = p.restrictMeshToPartitions();
+		std::cout << "Distributing the mesh, partitioner " << pconf.partitioner << "\n";
+	std::unique_ptr<ReplicatedGlobalMeshPartitioner> p;
+	if(pconf.partitioner == "trivial")
+		p = std::make_unique<TrivialReplicatedGlobalMeshPartitioner>(gm);
+	else if(pconf.partitioner == "scotch")
+		p = std::make_unique<ScotchRGMPartitioner>(gm, pconf);
+	else
+		throw UnsupportedOptionError("constructMesh: Unknown partitioner " + pconf.partitioner);
+	p->compute_partition();
+	UMesh<freal,NDIM> lm = p->restrictMeshToPartitions();
 
 #ifdef DEBUG
 	const int mpisize = get_mpi_size(PETSC_COMM_WORLD);
@@ -133,7 +210,7 @@ UMesh<freal,NDIM> constructMesh(const std::string mesh_path)
 	}
 #endif
 
-	int ierr = preprocessMesh<freal>(lm); 
+	ierr = preprocessMesh<freal>(lm); 
 	fvens_throw(ierr, "Mesh could not be preprocessed!");
 
 #ifdef DEBUG
@@ -147,11 +224,82 @@ UMesh<freal,NDIM> constructMesh(const std::string mesh_path)
 	}
 
 	// check global face numbering of connectivity faces
-	//assert(p.checkConnFaces(lm));
+	//assert(p->checkConnFaces(lm));
 #endif
 	return lm;
 }
 
+/// Returns the value of a PETSc option as a string, or an empty string if it is not set
+static std::string getPetscOptionString(const char *const optname)
+{
+	char optstr[PETSCOPTION_STR_LEN];
+	PetscBool flag = PETSC_FALSE;
+	const int ierr = PetscOptionsGetString(NULL, NULL, optname, optstr, PETSCOPTION_STR_LEN, &flag);
+	petsc_throw(ierr, std::string("Could not get option ") + optname);
+	return flag ? std::string(optstr) : std::string();
+}
+
+/// Describes all options that affect the preprocessed mesh, to identify entries of the mesh cache
+static std::string describeMeshOptions(const MeshPartitionConfig& pconf)
+{
+	std::ostringstream desc;
+	desc << "partitioned_read=" << parseOptionalPetscCmd_bool("-mesh_partitioned_read")
+	     << " distributed_read=" << parseOptionalPetscCmd_bool("-mesh_distributed_read")
+	     << " partitioner=" << pconf.partitioner
+	     << " distributed_partitioner=" << getPetscOptionString("-mesh_distributed_partitioner")
+	     << " weights=" << pconf.triangle_weight << ',' << pconf.quadrilateral_weight << ','
+	     << pconf.boundary_face_weight << ',' << pconf.viscous_face_weight << ','
+	     << pconf.interface_weight << ',' << pconf.viscous_interface_weight
+	     << " viscous=" << pconf.viscous
+	     << " reorder=" << getPetscOptionString("-mesh_reorder")
+	     << " anisotropy_threshold=" << getPetscOptionString("-mesh_anisotropy_threshold");
+	return desc.str();
+}
+
+UMesh<freal,NDIM> constructMesh(const std::string mesh_path, const MeshPartitionConfig& partconf)
+{
+	MeshPartitionConfig pconf = partconf;
+	const std::string partitioner = getPetscOptionString("-mesh_partitioner");
+	if(!partitioner.empty())
+		pconf.partitioner = partitioner;
+
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+	const double starttime = MPI_Wtime();
+
+	const std::string cachedir = getPetscOptionString("-mesh_cache_dir");
+	std::string source = "built";
+	UMesh<freal,NDIM> lm = [&]() {
+		if(cachedir.empty())
+			return buildMesh(mesh_path, pconf);
+
+		PetscBool hashcontents = PETSC_FALSE;
+		const int ierr = PetscOptionsGetBool(NULL, NULL, "-mesh_cache_hash_contents",
+		                                     &hashcontents, NULL);
+		petsc_throw(ierr, "Could not get option -mesh_cache_hash_contents");
+
+		const MeshCache cache(cachedir, mesh_path, describeMeshOptions(pconf), PETSC_COMM_WORLD,
+		                      hashcontents == PETSC_TRUE);
+		if(cache.available()) {
+			source = "loaded from cache " + cache.filename();
+			return cache.load();
+		}
+
+		UMesh<freal,NDIM> m = buildMesh(mesh_path, pconf);
+		cache.store(m);
+		source = "built and written to cache " + cache.filename();
+		return m;
+	}();
+
+	const double loctime = MPI_Wtime() - starttime;
+	double setuptime = 0;
+	MPI_Allreduce(&loctime, &setuptime, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+	if(mpirank == 0)
+		std::cout << "constructMesh: Mesh set up in " << setuptime << "s; " << source << std::endl;
+
+	reportPartitionQuality(lm, pconf);
+	return lm;
+}
+
 /* Returns a list of cell indices corresponding to the start of each level.
  * The length of the list is one more than the number of levels.
  */
@@ -195,6 +343,71 @@ std::vector<fint> levelSchedule(const UMesh<scalar,NDIM>& m)
 	return levels;
 }
 
+template <typename scalar>
+std::vector<int> colourCells(const UMesh<scalar,NDIM>& m)
+{
+	std::vector<int> colours(m.gnelem(), -1);
+	std::vector<bool> used;
+
+	for(fint icell = 0; icell < m.gnelem(); icell++)
+	{
+		// a cell has at most as many coloured neighbours as faces
+		used.assign(m.gnfael(icell)+1, false);
+		for(int iface = 0; iface < m.gnfael(icell); iface++)
+		{
+			const fint othercell = m.gesuel(icell,iface);
+			if(othercell < m.gnelem() && colours[othercell] >= 0
+			   && colours[othercell] < static_cast<int>(used.size()))
+				used[colours[othercell]] = true;
+		}
+
+		int icol = 0;
+		while(used[icol])
+			icol++;
+		colours[icell] = icol;
+	}
+
+	return colours;
+}
+
+template <typename scalar>
+void colourFaces(const UMesh<scalar,NDIM>& m, std::vector<fint>& colourptr,
+                 std::vector<fint>& colourfaces)
+{
+	std::vector<uint64_t> cellcolours(m.gnelem(), 0);
+	std::vector<int> facecolour(m.gFaceEnd());
+	int ncolours = 0;
+	for(fint iface = m.gFaceStart(); iface < m.gFaceEnd(); iface++)
+	{
+		const fint lelem = m.gintfac(iface,0);
+		const bool interior = iface >= m.gSubDomFaceStart() && iface < m.gSubDomFaceEnd();
+		const fint relem = interior ? m.gintfac(iface,1) : lelem;
+		const uint64_t used = cellcolours[lelem] | cellcolours[relem];
+
+		int icol = 0;
+		while(icol < 64 && (used & (uint64_t(1) << icol)))
+			icol++;
+		if(icol >= 64)
+			throw std::runtime_error("colourFaces: Too many face colours!");
+
+		facecolour[iface] = icol;
+		cellcolours[lelem] |= uint64_t(1) << icol;
+		cellcolours[relem] |= uint64_t(1) << icol;
+		ncolours = std::max(ncolours, icol+1);
+	}
+
+	colourptr.assign(ncolours+1, 0);
+	for(fint iface = m.gFaceStart(); iface < m.gFaceEnd(); iface++)
+		colourptr[facecolour[iface]+1]++;
+	for(int icol = 0; icol < ncolours; icol++)
+		colourptr[icol+1] += colourptr[icol];
+
+	colourfaces.resize(m.gFaceEnd());
+	std::vector<fint> pos(colourptr.begin(), colourptr.end()-1);
+	for(fint iface = m.gFaceStart(); iface < m.gFaceEnd(); iface++)
+		colourfaces[pos[facecolour[iface]]++] = iface;
+}
+
 std::array<bool,8> compareMeshes(const UMesh<freal,NDIM>& m1, const UMesh<freal,NDIM>& m2)
 {
 	std::array<bool,8> isequal;
@@ -243,24 +456,32 @@ std::array<bool,8> compareMeshes(const UMesh<freal,NDIM>& m1, const UMesh<freal,
 }
 
 template <typename scalar>
-StatusCode reorderMeshPetsc(const char *const ordering, const Spatial<freal,1>& sd, UMesh<scalar,NDIM>& m)
+StatusCode reorderMeshPetsc(const char *const ordering, UMesh<scalar,NDIM>& m)
 {
-	// The implementation must be changed for the multi-process case
 	StatusCode ierr = 0;
 
 	// If the ordering requested is not 'natural', reorder the mesh
 	if(std::strcmp(ordering,"natural")) {
+		// Adjacency graph of the subdomain cells, including the diagonal
+		std::vector<PetscInt> nnz(m.gnelem());
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			nnz[iel] = 1 + m.gnfael(iel);
+
 		Mat A;
-		CHKERRQ(MatCreate(PETSC_COMM_SELF, &A));
-		CHKERRQ(MatSetType(A, MATSEQAIJ));
-		CHKERRQ(MatSetSizes(A, PETSC_DECIDE, PETSC_DECIDE, m.gnelem(), m.gnelem()));
-		CHKERRQ(setJacobianPreallocation<1>(&m, A));
+		CHKERRQ(MatCreateSeqAIJ(PETSC_COMM_SELF, m.gnelem(), m.gnelem(), 0, nnz.data(), &A));
 
-		Vec u;
-		CHKERRQ(VecCreateSeq(PETSC_COMM_SELF, m.gnelem(), &u));
-		CHKERRQ(VecSet(u,1.0));
+		const PetscScalar val = 1.0;
+		for(PetscInt iel = 0; iel < m.gnelem(); iel++) {
+			CHKERRQ(MatSetValues(A, 1, &iel, 1, &iel, &val, INSERT_VALUES));
+		}
+		for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++)
+		{
+			const PetscInt lelem = m.gintfac(iface,0);
+			const PetscInt relem = m.gintfac(iface,1);
+			CHKERRQ(MatSetValues(A, 1, &lelem, 1, &relem, &val, INSERT_VALUES));
+			CHKERRQ(MatSetValues(A, 1, &relem, 1, &lelem, &val, INSERT_VALUES));
+		}
 
-		ierr = sd.assemble_jacobian(u, A); CHKERRQ(ierr);
 		CHKERRQ(MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY));
 		CHKERRQ(MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY));
 
@@ -276,10 +497,10 @@ StatusCode reorderMeshPetsc(const char *const ordering, const Spatial<freal,1>&
 		m.reorder_cells(rinds);
 
 		CHKERRQ(ISRestoreIndices(rperm, &rinds));
+		CHKERRQ(ISRestoreIndices(cperm, &cinds));
 		ierr = ISDestroy(&rperm); CHKERRQ(ierr);
 		ierr = ISDestroy(&cperm); CHKERRQ(ierr);
 		CHKERRQ(MatDestroy(&A));
-		CHKERRQ(VecDestroy(&u));
 	}
 	else {
 		std::cout << " reorderMesh: Natural ordering requested; doing nothing." << std::endl;
@@ -289,9 +510,9 @@ StatusCode reorderMeshPetsc(const char *const ordering, const Spatial<freal,1>&
 
 template StatusCode preprocessMesh(UMesh<freal,NDIM>& m);
 
-// template StatusCode reorderMeshPetsc(const char *const ordering, const Spatial<freal,1>& sd,
-//                                      UMesh<freal,NDIM>& m);
-
 template std::vector<fint> levelSchedule(const UMesh<freal,NDIM>& m);
+template std::vector<int> colourCells(const UMesh<freal,NDIM>& m);
+template void colourFaces(const UMesh<freal,NDIM>& m, std::vector<fint>& colourptr,
+                          std::vector<fint>& colourfaces);
 
 }
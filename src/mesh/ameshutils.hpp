@@ -8,17 +8,43 @@
 #define AMESHUTILS_H
 
 #include "mesh.hpp"
+#include "meshpartitioning.hpp"
 #include "spatial/aspatial.hpp"
 
 namespace fvens {
 
 /// Returns a ready-to-use mesh object from the path to mesh file
-UMesh<freal,2> constructMesh(const std::string mesh_path);
+/** By default, every rank reads the whole mesh and then restricts it to its partition, computed
+ * by the partitioner given in the partitioning settings. The partitioner can be overridden by the
+ * PETSc option -mesh_partitioner (trivial or scotch).
+ * If the PETSc option -mesh_distributed_read is true, each rank instead reads only a slice of the
+ * mesh file and the mesh is partitioned in parallel (see \ref DistributedMeshBuilder); "scotch"
+ * then means PT-Scotch. The parallel partitioner can also be chosen with
+ * -mesh_distributed_partitioner (trivial or ptscotch).
+ * If the PETSc option -mesh_partitioned_read is true, the mesh file must be in the Gmsh 4.1 format
+ * and already partitioned into as many partitions as there are ranks; each rank reads only its
+ * own partition (see \ref PartitionedMeshReader).
+ *
+ * If the PETSc option -mesh_cache_dir is given, the preprocessed mesh of each rank is loaded from
+ * the \ref MeshCache in that directory if an entry for the mesh file, the number of ranks and the
+ * mesh options exists; otherwise the mesh is built as above and the entry is written.
+ * The time taken to set up the mesh is printed by rank 0.
+ *
+ * In multi-process runs, the quality of the resulting partition is printed by rank 0
+ * (see \ref computePartitionQuality).
+ */
+UMesh<freal,2> constructMesh(const std::string mesh_path,
+                             const MeshPartitionConfig& partconf = MeshPartitionConfig());
 
 /// Computes various entity lists required for mesh traversal, also reorders the cells if requested
 /** This can, and should, be called immediately after [reading](UMesh2dh::readMesh) the mesh.
  * Does not compute [periodic boundary maps](UMesh2dh::compute_periodic_map);
  * this must be done separately.
+ *
+ * Reordering is local to each subdomain. In a distributed mesh, the cells of each subdomain are
+ * then given contiguous global indices whether or not they were reordered, and the connectivity
+ * data is exchanged with neighbouring subdomains (see UMesh::renumber_global_cells), so this must
+ * be called by all ranks together.
  */
 template <typename scalar>
 StatusCode preprocessMesh(UMesh<scalar,2>& m);
@@ -30,6 +56,26 @@ StatusCode preprocessMesh(UMesh<scalar,2>& m);
 template <typename scalar>
 std::vector<fint> levelSchedule(const UMesh<scalar,2>& m);
 
+/// Colours the cells of the subdomain such that no two face neighbours have the same colour
+/** Greedy colouring in the order of the cells: each cell gets the lowest colour not used by any of
+ * its neighbours coloured before it. Connectivity ghost cells are ignored.
+ * \return The colour of each cell, from 0 to one less than the number of colours
+ */
+template <typename scalar>
+std::vector<int> colourCells(const UMesh<scalar,2>& m);
+
+/// Colours the faces such that no two faces of the same colour touch the same subdomain cell
+/** Greedy colouring in the order of the faces: each face gets the lowest colour not yet used by a
+ * face of any of its subdomain cells. The number of colours is at most one less than twice the
+ * maximum number of faces of a cell; more than 64 colours is an error.
+ * \param[out] colourptr Start of each colour in colourfaces; its size is one more than the number
+ *   of colours
+ * \param[out] colourfaces All faces, sorted by colour
+ */
+template <typename scalar>
+void colourFaces(const UMesh<scalar,2>& m, std::vector<fint>& colourptr,
+                 std::vector<fint>& colourfaces);
+
 /// Compares two meshes for equality
 /** \return An array of booleans which represents whether the following, in order, are the same:
  *  - number of elements
@@ -0,0 +1,283 @@
+/** \file
+ * \brief Implementation of reading and writing the native binary mesh format
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "binarymesh.hpp"
+#include "mesh.hpp"
+#include "utilities/aerrorhandling.hpp"
+
+namespace fvens {
+
+static const char binary_mesh_magic[8] = {'F','V','E','N','S','M','S','H'};
+static const uint32_t binary_mesh_endiancheck = 0x01020304;
+
+/// Alignment of sections in the file, in bytes
+static const uint64_t binary_mesh_alignment = 64;
+
+static inline uint64_t alignOffset(const uint64_t offset)
+{
+	return (offset + binary_mesh_alignment-1)/binary_mesh_alignment * binary_mesh_alignment;
+}
+
+/// Writes an array at the given offset, padding the file with zeros up to that offset
+static void writeSection(std::ofstream& fout, const uint64_t offset, const void *const data,
+                         const uint64_t nbytes)
+{
+	const uint64_t curpos = static_cast<uint64_t>(fout.tellp());
+	assert(curpos <= offset);
+	const std::vector<char> padding(offset-curpos, 0);
+	fout.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+	if(nbytes > 0)
+		fout.write(static_cast<const char*>(data), static_cast<std::streamsize>(nbytes));
+}
+
+void writeBinaryMesh(const std::string mfile, const MeshData& md,
+                     const fint *const esuel, const fint *const intfac, const fint naface)
+{
+	BinaryMeshHeader hdr;
+	std::memset(&hdr, 0, sizeof(BinaryMeshHeader));
+	std::memcpy(hdr.magic, binary_mesh_magic, 8);
+	hdr.version = BINARY_MESH_VERSION;
+	hdr.endiancheck = binary_mesh_endiancheck;
+	hdr.realsize = sizeof(freal);
+	hdr.intsize = sizeof(fint);
+	hdr.npoin = md.npoin;
+	hdr.nelem = md.nelem;
+	hdr.nbface = md.nbface;
+	hdr.ndim = NDIM;
+	hdr.maxnnode = md.maxnnode;
+	hdr.maxnfael = md.maxnfael;
+	hdr.nnofa = md.nnofa;
+	hdr.nbtag = md.nbtag;
+	hdr.ndtag = md.ndtag;
+	hdr.hastopology = (esuel && intfac) ? 1 : 0;
+	hdr.naface = hdr.hastopology ? naface : 0;
+
+	const uint64_t nbytes[BMS_NUM_SECTIONS] = {
+		static_cast<uint64_t>(hdr.npoin*NDIM)*sizeof(freal),
+		static_cast<uint64_t>(hdr.nelem)*sizeof(int),
+		static_cast<uint64_t>(hdr.nelem)*sizeof(int),
+		static_cast<uint64_t>(hdr.nelem*hdr.maxnnode)*sizeof(fint),
+		static_cast<uint64_t>(hdr.nelem*hdr.ndtag)*sizeof(int),
+		static_cast<uint64_t>(hdr.nbface*(hdr.nnofa+hdr.nbtag))*sizeof(fint),
+		hdr.hastopology ? static_cast<uint64_t>(hdr.nelem*hdr.maxnfael)*sizeof(fint) : 0,
+		static_cast<uint64_t>(hdr.naface*(hdr.nnofa+2))*sizeof(fint)
+	};
+
+	uint64_t offset = alignOffset(sizeof(BinaryMeshHeader));
+	for(int is = 0; is < BMS_NUM_SECTIONS; is++) {
+		hdr.offsets[is] = offset;
+		offset = alignOffset(offset + nbytes[is]);
+	}
+
+	assert(md.nnode.size() == static_cast<size_t>(md.nelem));
+	const void *const data[BMS_NUM_SECTIONS] = {
+		md.nelem > 0 && md.npoin > 0 ? md.coords.const_row_pointer(0) : nullptr,
+		md.nnode.data(),
+		md.nfael.data(),
+		md.nelem > 0 ? md.inpoel.const_row_pointer(0) : nullptr,
+		md.nelem > 0 && md.ndtag > 0 ? md.vol_regions.const_row_pointer(0) : nullptr,
+		md.nbface > 0 ? md.bface.const_row_pointer(0) : nullptr,
+		esuel,
+		intfac
+	};
+
+	std::ofstream fout;
+	open_file_toWrite(mfile, fout);
+	fout.write(reinterpret_cast<const char*>(&hdr), sizeof(BinaryMeshHeader));
+	for(int is = 0; is < BMS_NUM_SECTIONS; is++)
+		writeSection(fout, hdr.offsets[is], data[is], nbytes[is]);
+	fout.close();
+}
+
+void writeBinaryMeshWithTopology(const std::string mfile, const MeshData& md,
+                                 const UMesh<freal,NDIM>& m)
+{
+	assert(m.gnConnFace() == 0);
+
+	MeshData bmd = md;
+	for(fint iface = m.gPhyBFaceStart(); iface < m.gPhyBFaceEnd(); iface++)
+	{
+		const fint ibface = iface - m.gPhyBFaceStart();
+		for(int j = 0; j < md.nnofa; j++)
+			bmd.bface(ibface,j) = m.gintfac(iface,2+j);
+		for(int j = 0; j < md.nbtag; j++)
+			bmd.bface(ibface,md.nnofa+j) = m.gbtags(iface,j);
+	}
+
+	std::vector<fint> esuel(m.gnelem()*m.gmaxnfael());
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(int j = 0; j < m.gmaxnfael(); j++)
+			esuel[iel*m.gmaxnfael()+j] = m.gesuel(iel,j);
+
+	const int nfacecols = md.nnofa+2;
+	std::vector<fint> intfac(m.gnaface()*nfacecols);
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+		for(int j = 0; j < nfacecols; j++)
+			intfac[iface*nfacecols+j] = m.gintfac(iface,j);
+
+	writeBinaryMesh(mfile, bmd, esuel.data(), intfac.data(), m.gnaface());
+}
+
+MappedMeshFile::MappedMeshFile(const std::string mfile)
+	: mapping{nullptr}, mapsize{0}, hdr{nullptr}
+{
+	const int fd = open(mfile.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw std::runtime_error("MappedMeshFile: Could not open file " + mfile);
+
+	struct stat st;
+	if(fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::runtime_error("MappedMeshFile: Could not stat file " + mfile);
+	}
+	mapsize = static_cast<size_t>(st.st_size);
+	if(mapsize < sizeof(BinaryMeshHeader)) {
+		close(fd);
+		throw std::runtime_error("MappedMeshFile: " + mfile + " is too small to be a mesh file!");
+	}
+
+	mapping = mmap(nullptr, mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the file is closed
+	close(fd);
+	if(mapping == MAP_FAILED) {
+		mapping = nullptr;
+		throw std::runtime_error("MappedMeshFile: Could not map file " + mfile);
+	}
+
+	hdr = static_cast<const BinaryMeshHeader*>(mapping);
+
+	std::string error;
+	if(std::memcmp(hdr->magic, binary_mesh_magic, 8))
+		error = " is not an FVENS binary mesh file!";
+	else if(hdr->endiancheck != binary_mesh_endiancheck)
+		error = " was written on a machine with different endianness!";
+	else if(hdr->version > BINARY_MESH_VERSION)
+		error = " has format version " + std::to_string(hdr->version)
+			+ ", which is newer than supported!";
+	else if(hdr->realsize != sizeof(freal) || hdr->intsize != sizeof(fint))
+		error = " was written with different floating-point or integer types!";
+	else if(hdr->ndim != NDIM)
+		error = " is not " + std::to_string(NDIM) + "-dimensional!";
+	else if(hdr->offsets[BMS_NUM_SECTIONS-1]
+	        + static_cast<uint64_t>(hdr->naface*(hdr->nnofa+2))*sizeof(fint) > mapsize)
+		error = " is truncated!";
+
+	if(!error.empty()) {
+		munmap(mapping, mapsize);
+		throw std::runtime_error("MappedMeshFile: " + mfile + error);
+	}
+}
+
+MappedMeshFile::~MappedMeshFile()
+{
+	if(mapping)
+		munmap(mapping, mapsize);
+}
+
+/// Copies a range of rows of a mapped array into an Array2d
+template <typename T>
+static void copyRows(const amat::Array2dView<T> src, const fint start, const fint nrows,
+                     amat::Array2d<T>& dest)
+{
+	dest.resize(nrows, src.cols());
+	if(nrows > 0 && src.cols() > 0)
+		std::memcpy(dest.row_pointer(0), &src(start,0),
+		            static_cast<size_t>(nrows)*src.cols()*sizeof(T));
+}
+
+MeshData MappedMeshFile::getMeshData() const
+{
+	MeshData md;
+	md.npoin = static_cast<fint>(hdr->npoin);
+	md.nelem = static_cast<fint>(hdr->nelem);
+	md.nbface = static_cast<fint>(hdr->nbface);
+	md.maxnnode = hdr->maxnnode;
+	md.maxnfael = hdr->maxnfael;
+	md.nnofa = hdr->nnofa;
+	md.nbtag = hdr->nbtag;
+	md.ndtag = hdr->ndtag;
+
+	md.nnode.assign(nnode(), nnode()+md.nelem);
+	md.nfael.assign(nfael(), nfael()+md.nelem);
+	copyRows(coords(), 0, md.npoin, md.coords);
+	copyRows(inpoel(), 0, md.nelem, md.inpoel);
+	copyRows(vol_regions(), 0, md.nelem, md.vol_regions);
+	copyRows(bface(), 0, md.nbface, md.bface);
+	if(hasTopology()) {
+		copyRows(esuel(), 0, md.nelem, md.esuel);
+		copyRows(intfac(), 0, static_cast<fint>(hdr->naface), md.intfac);
+	}
+
+	return md;
+}
+
+MeshSlice MappedMeshFile::getMeshSlice(const int nranks, const int rank) const
+{
+	MeshSlice m;
+	m.npoinglobal = static_cast<fint>(hdr->npoin);
+	m.nelemglobal = static_cast<fint>(hdr->nelem);
+	m.nbfaceglobal = static_cast<fint>(hdr->nbface);
+	m.maxnnode = hdr->maxnnode;
+	m.maxnfael = hdr->maxnfael;
+	m.nnofa = hdr->nnofa;
+	m.nbtag = hdr->nbtag;
+	m.ndtag = hdr->ndtag;
+
+	const BlockDistribution elemdist {m.nelemglobal, nranks};
+	m.elemstart = elemdist.start(rank);
+	m.nelem = elemdist.end(rank) - m.elemstart;
+	m.nnode.assign(nnode()+m.elemstart, nnode()+m.elemstart+m.nelem);
+	m.nfael.assign(nfael()+m.elemstart, nfael()+m.elemstart+m.nelem);
+	copyRows(inpoel(), m.elemstart, m.nelem, m.inpoel);
+	copyRows(vol_regions(), m.elemstart, m.nelem, m.vol_regions);
+
+	const BlockDistribution pointdist {m.npoinglobal, nranks};
+	m.poinstart = pointdist.start(rank);
+	m.npoin = pointdist.end(rank) - m.poinstart;
+	copyRows(coords(), m.poinstart, m.npoin, m.coords);
+
+	const BlockDistribution bfacedist {m.nbfaceglobal, nranks};
+	m.bfacestart = bfacedist.start(rank);
+	m.nbface = bfacedist.end(rank) - m.bfacestart;
+	copyRows(bface(), m.bfacestart, m.nbface, m.bface);
+
+	return m;
+}
+
+MeshData readBinaryMesh(const std::string mfile)
+{
+	const MappedMeshFile mf(mfile);
+	std::cout << "readBinaryMesh(): No. of points: " << mf.header().npoin
+		<< ", number of elements: " << mf.header().nelem
+		<< ",\nnumber of boundary faces " << mf.header().nbface
+		<< ", max no. of nodes per element: " << mf.header().maxnnode
+		<< ",\nno. of nodes per face: " << mf.header().nnofa
+		<< ", max faces per element: " << mf.header().maxnfael
+		<< (mf.hasTopology() ? ",\nwith precomputed topology" : "") << std::endl;
+	return mf.getMeshData();
+}
+
+}
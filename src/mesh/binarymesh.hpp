@@ -0,0 +1,171 @@
+/** \file
+ * \brief A native binary mesh format that can be memory-mapped
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_BINARYMESH_H
+#define FVENS_BINARYMESH_H
+
+#include <cstdint>
+#include <string>
+#include "meshreaders.hpp"
+
+namespace fvens {
+
+template <typename scalar, int ndim>
+class UMesh;
+
+/// Version of the binary mesh format written by this code
+constexpr uint32_t BINARY_MESH_VERSION = 1;
+
+/// Sections of a binary mesh file, in the order in which they are stored
+enum BinaryMeshSection {
+	BMS_COORDS = 0,         ///< npoin x NDIM point coordinates
+	BMS_NNODE,              ///< Number of nodes of each cell
+	BMS_NFAEL,              ///< Number of faces of each cell
+	BMS_INPOEL,             ///< nelem x maxnnode cell-node connectivity
+	BMS_VOLREGIONS,         ///< nelem x ndtag cell tags
+	BMS_BFACE,              ///< nbface x (nnofa+nbtag) boundary faces' nodes and tags
+	BMS_ESUEL,              ///< Optional: nelem x maxnfael elements surrounding elements
+	BMS_INTFAC,             ///< Optional: naface x (nnofa+2) face structure
+	BMS_NUM_SECTIONS
+};
+
+/// Header at the start of a binary mesh file
+/** All sections are stored as raw row-major arrays, each starting at an offset that is a
+ * multiple of 64 bytes from the start of the file.
+ */
+struct BinaryMeshHeader
+{
+	char magic[8];                ///< "FVENSMSH"
+	uint32_t version;             ///< Format version \sa BINARY_MESH_VERSION
+	uint32_t endiancheck;         ///< Set to 0x01020304 by the writer
+	uint32_t realsize;            ///< sizeof(freal) of the writer
+	uint32_t intsize;             ///< sizeof(fint) of the writer
+	int64_t npoin;                ///< Number of points
+	int64_t nelem;                ///< Number of cells
+	int64_t nbface;               ///< Number of physical boundary faces
+	int64_t naface;               ///< Number of faces in intfac; 0 if topology is not stored
+	int32_t ndim;                 ///< Spatial dimension
+	int32_t maxnnode;             ///< Maximum number of nodes per cell
+	int32_t maxnfael;             ///< Maximum number of faces per cell
+	int32_t nnofa;                ///< Number of nodes per face
+	int32_t nbtag;                ///< Number of tags per boundary face
+	int32_t ndtag;                ///< Number of tags per cell
+	uint32_t hastopology;         ///< Non-zero if esuel and intfac are stored
+	uint32_t reserved;
+	uint64_t offsets[BMS_NUM_SECTIONS];  ///< Byte offset of each section from the start of file
+};
+
+/// Writes mesh data into a binary mesh file
+/** \param mfile Path of the file to write
+ * \param md The mesh data to write
+ * \param esuel Optional precomputed elements-surrounding-elements array to store (nelem rows),
+ *   as computed by \ref UMesh::compute_topological. Pass nullptr to omit topology.
+ * \param intfac Optional precomputed face structure (naface x (nnofa+2)), stored only if esuel
+ *   is also given
+ * \param naface Number of faces in intfac
+ */
+void writeBinaryMesh(const std::string mfile, const MeshData& md,
+                     const fint *const esuel = nullptr,
+                     const fint *const intfac = nullptr, const fint naface = 0);
+
+/// Writes a mesh into a binary mesh file along with its esuel and intfac, so that
+///  \ref UMesh::compute_topological can use them instead of recomputing them after reading
+/** The physical boundary faces are written in the order and orientation of the faces in intfac,
+ * which \ref UMesh::compute_topological needs to use the stored topology.
+ * \param mfile Path of the file to write
+ * \param md The mesh data from which the mesh was constructed
+ * \param m The mesh, not distributed, with boundary face orientations corrected
+ *   (\ref UMesh::correctBoundaryFaceOrientation) and topology computed
+ */
+void writeBinaryMeshWithTopology(const std::string mfile, const MeshData& md,
+                                 const UMesh<freal,NDIM>& m);
+
+/// A read-only memory-mapped binary mesh file
+/** The arrays in the file are accessed in place through views, without copying or parsing.
+ * Only the pages actually accessed are read from disk.
+ */
+class MappedMeshFile
+{
+public:
+	/// Maps the file into memory and checks its header
+	MappedMeshFile(const std::string mfile);
+
+	~MappedMeshFile();
+
+	MappedMeshFile(const MappedMeshFile&) = delete;
+	MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+
+	const BinaryMeshHeader& header() const { return *hdr; }
+
+	amat::Array2dView<freal> coords() const {
+		return amat::Array2dView<freal>(section<freal>(BMS_COORDS), static_cast<fint>(hdr->npoin),
+		                                hdr->ndim);
+	}
+	const int *nnode() const { return section<int>(BMS_NNODE); }
+	const int *nfael() const { return section<int>(BMS_NFAEL); }
+	amat::Array2dView<fint> inpoel() const {
+		return amat::Array2dView<fint>(section<fint>(BMS_INPOEL), static_cast<fint>(hdr->nelem),
+		                               hdr->maxnnode);
+	}
+	amat::Array2dView<int> vol_regions() const {
+		return amat::Array2dView<int>(section<int>(BMS_VOLREGIONS), static_cast<fint>(hdr->nelem),
+		                              hdr->ndtag);
+	}
+	amat::Array2dView<fint> bface() const {
+		return amat::Array2dView<fint>(section<fint>(BMS_BFACE), static_cast<fint>(hdr->nbface),
+		                               hdr->nnofa+hdr->nbtag);
+	}
+
+	/// Whether precomputed esuel and intfac are available
+	bool hasTopology() const { return hdr->hastopology != 0; }
+
+	amat::Array2dView<fint> esuel() const {
+		return amat::Array2dView<fint>(section<fint>(BMS_ESUEL), static_cast<fint>(hdr->nelem),
+		                               hdr->maxnfael);
+	}
+	amat::Array2dView<fint> intfac() const {
+		return amat::Array2dView<fint>(section<fint>(BMS_INTFAC), static_cast<fint>(hdr->naface),
+		                               hdr->nnofa+2);
+	}
+
+	/// Copies the whole mesh, including the topology if available, into a MeshData object
+	MeshData getMeshData() const;
+
+	/// Copies one rank's slice of the mesh \sa readMeshSlice
+	MeshSlice getMeshSlice(const int nranks, const int rank) const;
+
+protected:
+	/// Start of the mapped region
+	void *mapping;
+	/// Size of the mapped region in bytes
+	size_t mapsize;
+	/// The header at the start of the mapped region
+	const BinaryMeshHeader *hdr;
+
+	template <typename T>
+	const T *section(const BinaryMeshSection s) const {
+		return reinterpret_cast<const T*>(static_cast<const char*>(mapping) + hdr->offsets[s]);
+	}
+};
+
+/// Reads a binary mesh file into mesh data \sa readMesh
+MeshData readBinaryMesh(const std::string mfile);
+
+}
+
+#endif
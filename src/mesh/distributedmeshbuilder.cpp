@@ -0,0 +1,823 @@
+/** \file
+ * \brief Parallel reading and partitioning of the mesh without a replicated global mesh
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <array>
+#include <iterator>
+#ifdef USE_PTSCOTCH
+#include <cstdio>
+#include <ptscotch.h>
+#endif
+#include "distributedmeshbuilder.hpp"
+#include "utilities/mpiutils.hpp"
+
+namespace fvens {
+
+/// Sends a list of entries to each rank and receives the lists sent to this rank by all ranks
+/** \param[in] sendbufs Entries to send to each rank
+ * \param[in] dtype MPI data type corresponding to T
+ * \param[in] comm Communicator
+ * \param[out] recvdispls Positions in the returned array where the entries received from each
+ *   rank start, with one extra entry at the end containing the total number of entries
+ * \return Entries received from all ranks, ordered by source rank
+ */
+template <typename T>
+static std::vector<T> exchangeLists(const std::vector<std::vector<T>>& sendbufs,
+                                    const MPI_Datatype dtype, const MPI_Comm comm,
+                                    std::vector<int>& recvdispls)
+{
+	const int nranks = get_mpi_size(comm);
+	assert(sendbufs.size() == static_cast<size_t>(nranks));
+
+	std::vector<int> sendcounts(nranks), recvcounts(nranks), senddispls(nranks+1,0);
+	recvdispls.assign(nranks+1,0);
+	for(int irank = 0; irank < nranks; irank++) {
+		sendcounts[irank] = static_cast<int>(sendbufs[irank].size());
+		senddispls[irank+1] = senddispls[irank] + sendcounts[irank];
+	}
+
+	int ierr = MPI_Alltoall(sendcounts.data(), 1, MPI_INT, recvcounts.data(), 1, MPI_INT, comm);
+	mpi_throw(ierr, "exchangeLists: Could not exchange counts!");
+	for(int irank = 0; irank < nranks; irank++)
+		recvdispls[irank+1] = recvdispls[irank] + recvcounts[irank];
+
+	std::vector<T> sendbuf(senddispls[nranks]);
+	for(int irank = 0; irank < nranks; irank++)
+		std::copy(sendbufs[irank].begin(), sendbufs[irank].end(),
+		          sendbuf.begin()+senddispls[irank]);
+
+	std::vector<T> recvbuf(recvdispls[nranks]);
+	ierr = MPI_Alltoallv(sendbuf.data(), sendcounts.data(), senddispls.data(), dtype,
+	                     recvbuf.data(), recvcounts.data(), recvdispls.data(), dtype, comm);
+	mpi_throw(ierr, "exchangeLists: Could not exchange lists!");
+	return recvbuf;
+}
+
+/// Returns the rank at which a face, given by its sorted vertex indices, is matched up
+static inline int rendezvousRank(const fint k0, const fint k1, const int nranks)
+{
+	const uint64_t h = static_cast<uint64_t>(k0)*2654435761u + static_cast<uint64_t>(k1);
+	return static_cast<int>(h % static_cast<uint64_t>(nranks));
+}
+
+/// Orders two face records according to their face vertices (the first two entries)
+static inline bool faceKeyLess(const fint *const a, const fint *const b)
+{
+	return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+}
+
+static inline bool faceKeyEqual(const fint *const a, const fint *const b)
+{
+	return a[0] == b[0] && a[1] == b[1];
+}
+
+DistributedMeshBuilder::DistributedMeshBuilder(const std::string mesh_path,
+                                               const std::string partitioner_name,
+                                               const MPI_Comm communicator,
+                                               const MeshPartitionConfig& weights)
+	: comm{communicator}, rank{get_mpi_rank(communicator)}, nranks{get_mpi_size(communicator)},
+	  partitioner{partitioner_name}, pconf{weights},
+	  slice(readMeshSlice(mesh_path, communicator))
+{
+	if(slice.nelemglobal < nranks)
+		throw std::runtime_error("Not enough cells in this mesh for " +
+		                         std::to_string(nranks) + " processes!");
+}
+
+UMesh<freal,NDIM> DistributedMeshBuilder::build()
+{
+	computeAdjacency();
+	computePartition();
+	return migrate();
+}
+
+void DistributedMeshBuilder::computeAdjacency()
+{
+	static_assert(NDIM == 2, "Only 2D is currently supported!");
+
+	// Width of face records: 2 vertices, global cell index, local cell index, EIndex
+	constexpr int fw = 5;
+	// Width of boundary face records: 2 vertices, global bface index, points and tags
+	const int bw = 3 + slice.nnofa + slice.nbtag;
+	// Width of replies: local cell index, EIndex, global neighbour index, global face index
+	constexpr int rw = 4;
+
+	//! 1. Send faces of cells and physical boundary faces to their rendezvous ranks
+
+	std::vector<std::vector<fint>> facesend(nranks), bfacesend(nranks);
+	for(fint iel = 0; iel < slice.nelem; iel++)
+		for(EIndex ifael = 0; ifael < slice.nfael[iel]; ifael++)
+		{
+			const fint p0 = slice.inpoel(iel,ifael);
+			const fint p1 = slice.inpoel(iel,(ifael+1) % slice.nnode[iel]);
+			const fint k0 = std::min(p0,p1), k1 = std::max(p0,p1);
+			std::vector<fint>& buf = facesend[rendezvousRank(k0,k1,nranks)];
+			buf.insert(buf.end(), {k0, k1, slice.elemstart+iel, iel, ifael});
+		}
+
+	for(fint ibf = 0; ibf < slice.nbface; ibf++)
+	{
+		const fint k0 = std::min(slice.bface(ibf,0), slice.bface(ibf,1));
+		const fint k1 = std::max(slice.bface(ibf,0), slice.bface(ibf,1));
+		std::vector<fint>& buf = bfacesend[rendezvousRank(k0,k1,nranks)];
+		buf.insert(buf.end(), {k0, k1, slice.bfacestart+ibf});
+		for(int j = 0; j < slice.nnofa+slice.nbtag; j++)
+			buf.push_back(slice.bface(ibf,j));
+	}
+
+	std::vector<int> facedispls, bfacedispls;
+	const std::vector<fint> faces = exchangeLists(facesend, FVENS_MPI_INT, comm, facedispls);
+	const std::vector<fint> bfaces = exchangeLists(bfacesend, FVENS_MPI_INT, comm, bfacedispls);
+	std::vector<std::vector<fint>>().swap(facesend);
+	std::vector<std::vector<fint>>().swap(bfacesend);
+
+	//! 2. Match up faces at the rendezvous ranks
+
+	const fint nrecvfaces = static_cast<fint>(faces.size())/fw;
+	const fint nrecvbfaces = static_cast<fint>(bfaces.size())/bw;
+
+	std::vector<int> facesource(nrecvfaces);
+	for(int irank = 0; irank < nranks; irank++)
+		for(fint i = facedispls[irank]/fw; i < facedispls[irank+1]/fw; i++)
+			facesource[i] = irank;
+
+	std::vector<fint> faceorder(nrecvfaces);
+	std::iota(faceorder.begin(), faceorder.end(), 0);
+	std::sort(faceorder.begin(), faceorder.end(), [&faces](const fint i, const fint j) {
+		return faceKeyLess(&faces[i*fw], &faces[j*fw]);
+	});
+
+	std::vector<fint> bfaceorder(nrecvbfaces);
+	std::iota(bfaceorder.begin(), bfaceorder.end(), 0);
+	std::sort(bfaceorder.begin(), bfaceorder.end(), [&bfaces,bw](const fint i, const fint j) {
+		return faceKeyLess(&bfaces[i*bw], &bfaces[j*bw]);
+	});
+
+	// Number the interior faces found here, after those found at lower ranks
+	fint nlocinterior = 0;
+	for(fint i = 0; i+1 < nrecvfaces; i++)
+		if(faceKeyEqual(&faces[faceorder[i]*fw], &faces[faceorder[i+1]*fw]))
+			nlocinterior++;
+	fint faceoffset = 0;
+	int ierr = MPI_Exscan(&nlocinterior, &faceoffset, 1, FVENS_MPI_INT, MPI_SUM, comm);
+	mpi_throw(ierr, "DistributedMeshBuilder: Could not number faces!");
+	if(rank == 0)
+		faceoffset = 0;
+
+	std::vector<std::vector<fint>> facereply(nranks), bfacereply(nranks);
+	fint iinterior = 0, ibfo = 0, nmatchedbfaces = 0;
+	for(fint i = 0; i < nrecvfaces; )
+	{
+		const fint *const fi = &faces[faceorder[i]*fw];
+		const int ri = facesource[faceorder[i]];
+		fint j = i+1;
+		while(j < nrecvfaces && faceKeyEqual(fi, &faces[faceorder[j]*fw]))
+			j++;
+
+		if(j-i == 2)
+		{
+			const fint *const fj = &faces[faceorder[i+1]*fw];
+			const int rj = facesource[faceorder[i+1]];
+			facereply[ri].insert(facereply[ri].end(), {fi[3], fi[4], fj[2], faceoffset+iinterior});
+			facereply[rj].insert(facereply[rj].end(), {fj[3], fj[4], fi[2], faceoffset+iinterior});
+			iinterior++;
+		}
+		else if(j-i == 1)
+		{
+			// Must be a physical boundary face
+			while(ibfo < nrecvbfaces && faceKeyLess(&bfaces[bfaceorder[ibfo]*bw], fi))
+				ibfo++;
+			if(ibfo == nrecvbfaces || !faceKeyEqual(&bfaces[bfaceorder[ibfo]*bw], fi))
+				throw std::logic_error("DistributedMeshBuilder: Face (" + std::to_string(fi[0])
+				                       + "," + std::to_string(fi[1]) + ") of cell "
+				                       + std::to_string(fi[2])
+				                       + " has no neighbour and is not a boundary face!");
+
+			const fint *const bf = &bfaces[bfaceorder[ibfo]*bw];
+			facereply[ri].insert(facereply[ri].end(), {fi[3], fi[4], -1, -1});
+			bfacereply[ri].insert(bfacereply[ri].end(), {bf[2], fi[3], fi[4]});
+			bfacereply[ri].insert(bfacereply[ri].end(), bf+3, bf+bw);
+			nmatchedbfaces++;
+			ibfo++;
+		}
+		else
+			throw std::logic_error("DistributedMeshBuilder: Face (" + std::to_string(fi[0])
+			                       + "," + std::to_string(fi[1]) + ") is shared by "
+			                       + std::to_string(j-i) + " cells!");
+
+		i = j;
+	}
+	assert(iinterior == nlocinterior);
+
+	if(nmatchedbfaces != nrecvbfaces)
+		throw std::logic_error("DistributedMeshBuilder: Some boundary faces do not belong to any cell!");
+
+	//! 3. Send the results back to the ranks holding the cells
+
+	std::vector<int> replydispls;
+	const std::vector<fint> replies = exchangeLists(facereply, FVENS_MPI_INT, comm, replydispls);
+	const std::vector<fint> bfreplies = exchangeLists(bfacereply, FVENS_MPI_INT, comm, replydispls);
+
+	nbrelem.resize(slice.nelem, slice.maxnfael);
+	faceindex.resize(slice.nelem, slice.maxnfael);
+	for(fint iel = 0; iel < slice.nelem; iel++)
+		for(int j = 0; j < slice.maxnfael; j++) {
+			nbrelem(iel,j) = -1;
+			faceindex(iel,j) = -1;
+		}
+
+	for(size_t i = 0; i < replies.size(); i += rw)
+	{
+		nbrelem(replies[i],replies[i+1]) = replies[i+2];
+		faceindex(replies[i],replies[i+1]) = replies[i+3];
+	}
+
+	hostedbfaces.clear();
+	for(size_t i = 0; i < bfreplies.size(); i += bw)
+		hostedbfaces.emplace_back(bfreplies.begin()+i, bfreplies.begin()+i+bw);
+}
+
+#ifdef USE_PTSCOTCH
+/// Partitions the distributed dual graph of the mesh using PT-Scotch
+/** \param[in] slice This rank's slice of the mesh
+ * \param[in] nbrelem Global index of the neighbouring cell across each face of each cell
+ * \param[in] pconf Cell and face weights for the graph
+ * \param[in] comm The communicator over which the mesh is distributed
+ * \param[out] elempart Destination rank of each cell in the slice
+ */
+static void partitionPTScotch(const MeshSlice& slice, const amat::Array2d<fint>& nbrelem,
+                              const MeshPartitionConfig& pconf,
+                              const MPI_Comm comm, std::vector<int>& elempart)
+{
+	static_assert(sizeof(SCOTCH_Num) == sizeof(fint), "Scotch's integer type must match fint!");
+	const int nranks = get_mpi_size(comm);
+	const int rank = get_mpi_rank(comm);
+
+	std::vector<SCOTCH_Num> vertloctab(slice.nelem+1, 0);
+	std::vector<SCOTCH_Num> veloloctab(slice.nelem);
+	std::vector<SCOTCH_Num> edgeloctab;
+	std::vector<int> isbouncell(slice.nelem, 0);
+	edgeloctab.reserve(slice.nelem*slice.maxnfael);
+	for(fint iel = 0; iel < slice.nelem; iel++)
+	{
+		int nphybface = 0;
+		for(EIndex j = 0; j < slice.nfael[iel]; j++)
+			if(nbrelem(iel,j) >= 0)
+				edgeloctab.push_back(nbrelem(iel,j));
+			else
+				nphybface++;
+		vertloctab[iel+1] = static_cast<SCOTCH_Num>(edgeloctab.size());
+		veloloctab[iel] = cellPartitionWeight(slice.nfael[iel], nphybface, pconf);
+		isbouncell[iel] = nphybface > 0 ? 1 : 0;
+	}
+	const SCOTCH_Num nedges = static_cast<SCOTCH_Num>(edgeloctab.size());
+
+	// Face weights depend on whether either cell touches the boundary; ask the ranks holding
+	//  neighbouring cells in other slices about them.
+	const BlockDistribution elemdist {slice.nelemglobal, nranks};
+	std::vector<std::vector<fint>> requests(nranks);
+	for(const SCOTCH_Num nbr : edgeloctab)
+		if(elemdist.owner(nbr) != rank)
+			requests[elemdist.owner(nbr)].push_back(nbr);
+
+	std::vector<int> reqdispls;
+	const std::vector<fint> inrequests = exchangeLists(requests, FVENS_MPI_INT, comm, reqdispls);
+	std::vector<std::vector<int>> replies(nranks);
+	for(int irank = 0; irank < nranks; irank++)
+		for(int i = reqdispls[irank]; i < reqdispls[irank+1]; i++)
+			replies[irank].push_back(isbouncell[inrequests[i]-slice.elemstart]);
+	std::vector<int> repdispls;
+	const std::vector<int> nbrbouncell = exchangeLists(replies, MPI_INT, comm, repdispls);
+
+	// The replies from each rank are in the same order as the requests to it
+	std::vector<int> pos(repdispls.begin(), repdispls.end()-1);
+	std::vector<SCOTCH_Num> edloloctab(edgeloctab.size());
+	for(fint iel = 0; iel < slice.nelem; iel++)
+		for(SCOTCH_Num k = vertloctab[iel]; k < vertloctab[iel+1]; k++)
+		{
+			const int owner = elemdist.owner(edgeloctab[k]);
+			const bool nbrboun = owner == rank ? isbouncell[edgeloctab[k]-slice.elemstart] != 0
+				: nbrbouncell[pos[owner]++] != 0;
+			edloloctab[k] = facePartitionWeight(isbouncell[iel] != 0 || nbrboun, pconf);
+		}
+
+	SCOTCH_Dgraph *dgraph = SCOTCH_dgraphAlloc();
+	int ierr = SCOTCH_dgraphInit(dgraph, comm);
+	fvens_throw(ierr, "PT-Scotch could not initialize the distributed graph!");
+	ierr = SCOTCH_dgraphBuild(dgraph, 0, slice.nelem, slice.nelem, vertloctab.data(), NULL,
+	                          veloloctab.data(), NULL, nedges, nedges, edgeloctab.data(), NULL,
+	                          edloloctab.data());
+	fvens_throw(ierr, "PT-Scotch could not build the distributed graph!");
+	ierr = SCOTCH_dgraphCheck(dgraph);
+	fvens_throw(ierr, "PT-Scotch distributed graph is not consistent!");
+
+	SCOTCH_Strat *strat = SCOTCH_stratAlloc();
+	ierr = SCOTCH_stratInit(strat); fvens_throw(ierr, "Scotch could not initialize strategy!");
+
+	std::vector<SCOTCH_Num> partloctab(slice.nelem);
+	ierr = SCOTCH_dgraphPart(dgraph, nranks, strat, partloctab.data());
+	fvens_throw(ierr, "PT-Scotch could not partition the graph!");
+
+	for(fint iel = 0; iel < slice.nelem; iel++)
+		elempart[iel] = static_cast<int>(partloctab[iel]);
+
+	SCOTCH_dgraphExit(dgraph);
+	SCOTCH_stratExit(strat);
+	SCOTCH_memFree(strat);
+	SCOTCH_memFree(dgraph);
+}
+#endif
+
+void DistributedMeshBuilder::computePartition()
+{
+	elempart.resize(slice.nelem);
+
+	if(partitioner == "ptscotch") {
+#ifdef USE_PTSCOTCH
+		if(rank == 0)
+			printf(" DistributedMeshBuilder: Using PT-Scotch to compute a partition..\n");
+		partitionPTScotch(slice, nbrelem, pconf, comm, elempart);
+#else
+		throw UnsupportedOptionError("DistributedMeshBuilder: FVENS was not built with PT-Scotch!");
+#endif
+	}
+	else if(partitioner == "trivial") {
+		// The slices are already divided in the same way as the trivial partitioner does it
+		for(fint iel = 0; iel < slice.nelem; iel++)
+			elempart[iel] = rank;
+	}
+	else
+		throw UnsupportedOptionError("DistributedMeshBuilder: Unknown partitioner " + partitioner);
+
+	// Get the partitions of neighbouring cells that are in other slices
+
+	const BlockDistribution elemdist {slice.nelemglobal, nranks};
+	std::vector<std::vector<fint>> requests(nranks);
+	for(fint iel = 0; iel < slice.nelem; iel++)
+		for(EIndex j = 0; j < slice.nfael[iel]; j++)
+			if(nbrelem(iel,j) >= 0 && elemdist.owner(nbrelem(iel,j)) != rank)
+				requests[elemdist.owner(nbrelem(iel,j))].push_back(nbrelem(iel,j));
+
+	std::vector<int> reqdispls;
+	const std::vector<fint> inrequests = exchangeLists(requests, FVENS_MPI_INT, comm, reqdispls);
+
+	std::vector<std::vector<int>> replies(nranks);
+	for(int irank = 0; irank < nranks; irank++)
+		for(int i = reqdispls[irank]; i < reqdispls[irank+1]; i++) {
+			assert(elemdist.owner(inrequests[i]) == rank);
+			replies[irank].push_back(elempart[inrequests[i]-slice.elemstart]);
+		}
+
+	std::vector<int> repdispls;
+	const std::vector<int> nbrparts = exchangeLists(replies, MPI_INT, comm, repdispls);
+
+	// The replies from each rank are in the same order as the requests to it
+	std::vector<int> pos(repdispls.begin(), repdispls.end()-1);
+	nbrpart.resize(slice.nelem, slice.maxnfael);
+	for(fint iel = 0; iel < slice.nelem; iel++)
+		for(EIndex j = 0; j < slice.maxnfael; j++)
+		{
+			if(j >= slice.nfael[iel] || nbrelem(iel,j) < 0)
+				nbrpart(iel,j) = -1;
+			else {
+				const int owner = elemdist.owner(nbrelem(iel,j));
+				if(owner == rank)
+					nbrpart(iel,j) = elempart[nbrelem(iel,j)-slice.elemstart];
+				else
+					nbrpart(iel,j) = nbrparts[pos[owner]++];
+			}
+		}
+}
+
+UMesh<freal,NDIM> DistributedMeshBuilder::migrate() const
+{
+	// Width of cell records: global index, nnode, nfael, nodes, volume tags,
+	//  and the neighbour, its partition and the global face index for each face
+	const int cw = 3 + slice.maxnnode + slice.ndtag + 3*slice.maxnfael;
+	// Width of boundary face records: global bface index, global host cell index, EIndex in the
+	//  host cell, points and tags
+	const int bw = 3 + slice.nnofa + slice.nbtag;
+
+	//! 1. Send cells and boundary faces to their destination ranks
+
+	std::vector<std::vector<fint>> cellsend(nranks), bfacesend(nranks);
+	for(fint iel = 0; iel < slice.nelem; iel++)
+	{
+		std::vector<fint>& buf = cellsend[elempart[iel]];
+		buf.insert(buf.end(), {slice.elemstart+iel, slice.nnode[iel], slice.nfael[iel]});
+		for(int j = 0; j < slice.maxnnode; j++)
+			buf.push_back(slice.inpoel(iel,j));
+		for(int j = 0; j < slice.ndtag; j++)
+			buf.push_back(slice.vol_regions(iel,j));
+		for(EIndex j = 0; j < slice.maxnfael; j++)
+			buf.insert(buf.end(), {nbrelem(iel,j), nbrpart(iel,j), faceindex(iel,j)});
+	}
+
+	for(const std::vector<fint>& bf : hostedbfaces)
+	{
+		std::vector<fint>& buf = bfacesend[elempart[bf[1]]];
+		buf.insert(buf.end(), {bf[0], slice.elemstart+bf[1], bf[2]});
+		buf.insert(buf.end(), bf.begin()+3, bf.end());
+	}
+
+	std::vector<int> displs;
+	const std::vector<fint> cells = exchangeLists(cellsend, FVENS_MPI_INT, comm, displs);
+	const std::vector<fint> bfaces = exchangeLists(bfacesend, FVENS_MPI_INT, comm, displs);
+	std::vector<std::vector<fint>>().swap(cellsend);
+	std::vector<std::vector<fint>>().swap(bfacesend);
+
+	UMesh<freal,NDIM> lm;
+	lm.nelemglobal = slice.nelemglobal;
+	lm.npoinglobal = slice.npoinglobal;
+	lm.maxnnode = slice.maxnnode;
+	lm.maxnfael = slice.maxnfael;
+	lm.nnofa = slice.nnofa;
+	lm.nbtag = slice.nbtag;
+	lm.ndtag = slice.ndtag;
+
+	//! 2. Arrange the cells in the order of their global indices, like the replicated partitioner
+
+	lm.nelem = static_cast<fint>(cells.size())/cw;
+	if(lm.nelem == 0)
+		throw std::runtime_error("DistributedMeshBuilder: Rank " + std::to_string(rank)
+		                         + " received no cells!");
+
+	std::vector<fint> cellorder(lm.nelem);
+	std::iota(cellorder.begin(), cellorder.end(), 0);
+	std::sort(cellorder.begin(), cellorder.end(), [&cells,cw](const fint i, const fint j) {
+		return cells[i*cw] < cells[j*cw];
+	});
+
+	lm.globalElemIndex.resize(lm.nelem);
+	lm.nnode.resize(lm.nelem);
+	lm.nfael.resize(lm.nelem);
+	lm.inpoel.resize(lm.nelem, lm.maxnnode);
+	lm.vol_regions.resize(lm.nelem, lm.ndtag);
+	for(fint iel = 0; iel < lm.nelem; iel++)
+	{
+		const fint *const c = &cells[cellorder[iel]*cw];
+		lm.globalElemIndex[iel] = c[0];
+		lm.nnode[iel] = c[1];
+		lm.nfael[iel] = c[2];
+		for(int j = 0; j < lm.maxnnode; j++)
+			lm.inpoel(iel,j) = c[3+j];
+		for(int j = 0; j < lm.ndtag; j++)
+			lm.vol_regions(iel,j) = c[3+lm.maxnnode+j];
+	}
+
+	//! 3. Fetch coordinates of the required points from the ranks that read them
+
+	std::vector<fint> locpoints;
+	locpoints.reserve(lm.nelem*lm.maxnnode);
+	for(fint iel = 0; iel < lm.nelem; iel++)
+		for(int inode = 0; inode < lm.nnode[iel]; inode++)
+			locpoints.push_back(lm.inpoel(iel,inode));
+	std::sort(locpoints.begin(), locpoints.end());
+	locpoints.erase(std::unique(locpoints.begin(), locpoints.end()), locpoints.end());
+	lm.npoin = static_cast<fint>(locpoints.size());
+
+	const BlockDistribution pointdist {slice.npoinglobal, nranks};
+	std::vector<std::vector<fint>> pointrequests(nranks);
+	for(fint ip = 0; ip < lm.npoin; ip++)
+		pointrequests[pointdist.owner(locpoints[ip])].push_back(locpoints[ip]);
+
+	const std::vector<fint> inpointreqs = exchangeLists(pointrequests, FVENS_MPI_INT, comm, displs);
+	std::vector<std::vector<fint>>().swap(pointrequests);
+
+	std::vector<std::vector<freal>> coordreplies(nranks);
+	for(int irank = 0; irank < nranks; irank++)
+		for(int i = displs[irank]; i < displs[irank+1]; i++)
+			for(int idim = 0; idim < NDIM; idim++)
+				coordreplies[irank].push_back(slice.coords(inpointreqs[i]-slice.poinstart, idim));
+
+	// Point owners increase with global point index, so the replies arrive in the sorted order
+	const std::vector<freal> coords = exchangeLists(coordreplies, FVENS_MPI_REAL, comm, displs);
+	assert(coords.size() == static_cast<size_t>(lm.npoin*NDIM));
+
+	lm.coords.resize(lm.npoin,NDIM);
+	for(fint ip = 0; ip < lm.npoin; ip++)
+		for(int idim = 0; idim < NDIM; idim++)
+			lm.coords(ip,idim) = coords[ip*NDIM+idim];
+
+	const auto pointGlob2Loc = [&locpoints](const fint gpoint) {
+		const auto it = std::lower_bound(locpoints.begin(), locpoints.end(), gpoint);
+		assert(it != locpoints.end() && *it == gpoint);
+		return static_cast<fint>(it - locpoints.begin());
+	};
+
+	for(fint iel = 0; iel < lm.nelem; iel++)
+		for(int j = 0; j < lm.nnode[iel]; j++)
+			lm.inpoel(iel,j) = pointGlob2Loc(lm.inpoel(iel,j));
+
+	//! 4. Physical boundary faces, in the order of their global indices
+
+	lm.nbface = static_cast<fint>(bfaces.size())/bw;
+	std::vector<fint> bfaceorder(lm.nbface);
+	std::iota(bfaceorder.begin(), bfaceorder.end(), 0);
+	std::sort(bfaceorder.begin(), bfaceorder.end(), [&bfaces,bw](const fint i, const fint j) {
+		return bfaces[i*bw] < bfaces[j*bw];
+	});
+
+	lm.bface.resize(lm.nbface, lm.nnofa+lm.nbtag);
+	for(fint iface = 0; iface < lm.nbface; iface++)
+	{
+		const fint *const bf = &bfaces[bfaceorder[iface]*bw];
+		for(int j = 0; j < lm.nnofa; j++)
+			lm.bface(iface,j) = pointGlob2Loc(bf[3+j]);
+		for(int j = lm.nnofa; j < lm.nnofa+lm.nbtag; j++)
+			lm.bface(iface,j) = bf[3+j];
+	}
+
+	//! 5. Connectivity faces: faces whose neighbouring cell went to another rank
+
+	const int nbrpos = 3 + lm.maxnnode + lm.ndtag;
+	lm.nconnface = 0;
+	for(fint iel = 0; iel < lm.nelem; iel++)
+	{
+		const fint *const c = &cells[cellorder[iel]*cw];
+		for(EIndex j = 0; j < lm.nfael[iel]; j++)
+			if(c[nbrpos+3*j] >= 0 && c[nbrpos+3*j+1] != rank)
+				lm.nconnface++;
+	}
+
+	if(lm.nconnface > 0)
+		lm.connface.resize(lm.nconnface,5);
+	fint icofa = 0;
+	for(fint iel = 0; iel < lm.nelem; iel++)
+	{
+		const fint *const c = &cells[cellorder[iel]*cw];
+		for(EIndex j = 0; j < lm.nfael[iel]; j++)
+			if(c[nbrpos+3*j] >= 0 && c[nbrpos+3*j+1] != rank)
+			{
+				lm.connface(icofa,0) = iel;
+				lm.connface(icofa,1) = j;
+				lm.connface(icofa,2) = c[nbrpos+3*j+1];
+				lm.connface(icofa,3) = c[nbrpos+3*j];
+				lm.connface(icofa,4) = c[nbrpos+3*j+2];
+				icofa++;
+			}
+	}
+	assert(icofa == lm.nconnface);
+
+	//! 6. Number the cells of each rank contiguously; so far they have their indices in the file
+
+	lm.renumber_global_cells(comm);
+
+#ifdef DEBUG
+	std::cout << "DistributedMeshBuilder: Rank " << rank << ": Nelem = " << lm.nelem
+	          << ", nbface = " << lm.nbface << ", nconnface = " << lm.nconnface << std::endl;
+#endif
+
+	return lm;
+}
+
+PartitionedMeshReader::PartitionedMeshReader(const std::string mesh_path,
+                                             const MPI_Comm communicator)
+	: comm{communicator}, rank{get_mpi_rank(communicator)}, nranks{get_mpi_size(communicator)},
+	  part(readGmsh4Partition(mesh_path, get_mpi_rank(communicator)))
+{
+	if(part.npartitions != nranks)
+		throw std::runtime_error("PartitionedMeshReader: The mesh has "
+		                         + std::to_string(part.npartitions) + " partitions but there are "
+		                         + std::to_string(nranks) + " processes!");
+	if(part.nelem == 0)
+		throw std::runtime_error("PartitionedMeshReader: Partition " + std::to_string(rank+1)
+		                         + " has no cells!");
+}
+
+UMesh<freal,NDIM> PartitionedMeshReader::build() const
+{
+	static_assert(NDIM == 2, "Only 2D is currently supported!");
+
+	UMesh<freal,NDIM> lm;
+
+	//! 1. Global sizes and global cell numbering
+
+	fint elemoffset = 0;
+	int ierr = MPI_Exscan(&part.nelem, &elemoffset, 1, FVENS_MPI_INT, MPI_SUM, comm);
+	mpi_throw(ierr, "PartitionedMeshReader: Could not number cells!");
+	if(rank == 0)
+		elemoffset = 0;
+	ierr = MPI_Allreduce(&part.nelem, &lm.nelemglobal, 1, FVENS_MPI_INT, MPI_SUM, comm);
+	mpi_throw(ierr, "PartitionedMeshReader: Could not get number of cells!");
+
+	const fint maxpoint = part.npoin > 0 ? part.pointtags.back() : -1;
+	ierr = MPI_Allreduce(&maxpoint, &lm.npoinglobal, 1, FVENS_MPI_INT, MPI_MAX, comm);
+	mpi_throw(ierr, "PartitionedMeshReader: Could not get number of points!");
+	lm.npoinglobal++;
+
+	int locmax[] = {part.maxnnode, part.maxnfael}, globmax[2];
+	ierr = MPI_Allreduce(locmax, globmax, 2, MPI_INT, MPI_MAX, comm);
+	mpi_throw(ierr, "PartitionedMeshReader: Could not get maximum cell sizes!");
+
+	lm.nelem = part.nelem;
+	lm.npoin = part.npoin;
+	lm.nbface = part.nbface;
+	lm.maxnnode = globmax[0];
+	lm.maxnfael = globmax[1];
+	lm.nnofa = part.nnofa;
+	lm.nbtag = part.nbtag;
+	lm.ndtag = part.ndtag;
+	lm.nnode = part.nnode;
+	lm.nfael = part.nfael;
+	lm.coords = part.coords;
+	lm.bface = part.bface;
+	lm.vol_regions = part.vol_regions;
+
+	lm.inpoel.resize(lm.nelem, lm.maxnnode);
+	for(fint iel = 0; iel < lm.nelem; iel++)
+		for(int j = 0; j < lm.maxnnode; j++)
+			lm.inpoel(iel,j) = j < part.maxnnode ? part.inpoel(iel,j) : -1;
+
+	lm.globalElemIndex.resize(lm.nelem);
+	std::iota(lm.globalElemIndex.begin(), lm.globalElemIndex.end(), elemoffset);
+
+	//! 2. Match up faces within the partition
+
+	// Width of face records: 2 vertices' global indices, local cell index, EIndex
+	constexpr int fw = 4;
+	std::vector<fint> faces;
+	faces.reserve(lm.nelem*lm.maxnfael*fw);
+	for(fint iel = 0; iel < lm.nelem; iel++)
+		for(EIndex ifael = 0; ifael < lm.nfael[iel]; ifael++)
+		{
+			const fint p0 = part.pointtags[lm.inpoel(iel,ifael)];
+			const fint p1 = part.pointtags[lm.inpoel(iel,(ifael+1) % lm.nnode[iel])];
+			faces.insert(faces.end(), {std::min(p0,p1), std::max(p0,p1), iel, ifael});
+		}
+	const fint nlocfaces = static_cast<fint>(faces.size())/fw;
+
+	std::vector<fint> faceorder(nlocfaces);
+	std::iota(faceorder.begin(), faceorder.end(), 0);
+	std::sort(faceorder.begin(), faceorder.end(), [&faces](const fint i, const fint j) {
+		return faceKeyLess(&faces[i*fw], &faces[j*fw]);
+	});
+
+	std::vector<fint> bfacekeys(2*lm.nbface);
+	for(fint ibf = 0; ibf < lm.nbface; ibf++) {
+		const fint p0 = part.pointtags[lm.bface(ibf,0)], p1 = part.pointtags[lm.bface(ibf,1)];
+		bfacekeys[2*ibf] = std::min(p0,p1);
+		bfacekeys[2*ibf+1] = std::max(p0,p1);
+	}
+	std::vector<fint> bfaceorder(lm.nbface);
+	std::iota(bfaceorder.begin(), bfaceorder.end(), 0);
+	std::sort(bfaceorder.begin(), bfaceorder.end(), [&bfacekeys](const fint i, const fint j) {
+		return faceKeyLess(&bfacekeys[2*i], &bfacekeys[2*j]);
+	});
+
+	// Faces on partition boundaries (as indices into faces) to be matched with each rank
+	std::vector<std::vector<fint>> candidates(nranks);
+	fint ibfo = 0, nmatchedbfaces = 0;
+	for(fint i = 0; i < nlocfaces; )
+	{
+		const fint *const fi = &faces[faceorder[i]*fw];
+		fint j = i+1;
+		while(j < nlocfaces && faceKeyEqual(fi, &faces[faceorder[j]*fw]))
+			j++;
+
+		if(j-i == 1)
+		{
+			while(ibfo < lm.nbface && faceKeyLess(&bfacekeys[2*bfaceorder[ibfo]], fi))
+				ibfo++;
+
+			if(ibfo < lm.nbface && faceKeyEqual(&bfacekeys[2*bfaceorder[ibfo]], fi)) {
+				nmatchedbfaces++;
+				ibfo++;
+			}
+			else
+			{
+				// Must be a face shared with the partitions that share both of its vertices
+				const fint p0 = lm.inpoel(fi[2],fi[3]);
+				const fint p1 = lm.inpoel(fi[2],(fi[3]+1) % lm.nnode[fi[2]]);
+				if(part.pointinterface[p0] < 0 || part.pointinterface[p1] < 0)
+					throw std::logic_error("PartitionedMeshReader: Face (" + std::to_string(fi[0]+1)
+					                       + "," + std::to_string(fi[1]+1)
+					                       + ") has no neighbour and is not a boundary face!");
+
+				const std::vector<int>& parts0 = part.interfacepartitions[part.pointinterface[p0]];
+				const std::vector<int>& parts1 = part.interfacepartitions[part.pointinterface[p1]];
+				std::vector<int> nbrparts;
+				std::set_intersection(parts0.begin(), parts0.end(), parts1.begin(), parts1.end(),
+				                      std::back_inserter(nbrparts));
+				if(nbrparts.empty())
+					throw std::logic_error("PartitionedMeshReader: Face (" + std::to_string(fi[0]+1)
+					                       + "," + std::to_string(fi[1]+1)
+					                       + ") is not on the boundary of any other partition!");
+
+				for(const int nbr : nbrparts)
+					candidates[nbr].push_back(faceorder[i]);
+			}
+		}
+		else if(j-i > 2)
+			throw std::logic_error("PartitionedMeshReader: Face (" + std::to_string(fi[0]+1)
+			                       + "," + std::to_string(fi[1]+1) + ") is shared by "
+			                       + std::to_string(j-i) + " cells!");
+
+		i = j;
+	}
+
+	if(nmatchedbfaces != lm.nbface)
+		throw std::logic_error("PartitionedMeshReader: Some boundary faces do not belong to any"
+		                       " cell of the partition!");
+
+	//! 3. Exchange partition-boundary faces with neighbouring partitions
+	//!  The lower rank of each pair assigns the global index of their shared faces.
+
+	fint nnumbered = 0;
+	for(int irank = rank+1; irank < nranks; irank++)
+		nnumbered += static_cast<fint>(candidates[irank].size());
+	fint faceoffset = 0;
+	ierr = MPI_Exscan(&nnumbered, &faceoffset, 1, FVENS_MPI_INT, MPI_SUM, comm);
+	mpi_throw(ierr, "PartitionedMeshReader: Could not number faces!");
+	if(rank == 0)
+		faceoffset = 0;
+
+	// Width of exchanged records: 2 vertices, global cell index, global face index
+	constexpr int sw = 4;
+	std::vector<std::vector<fint>> facesend(nranks);
+	std::vector<std::vector<fint>> faceids(nranks);
+	for(int irank = 0; irank < nranks; irank++)
+		for(const fint iface : candidates[irank])
+		{
+			const fint *const f = &faces[iface*fw];
+			const fint faceid = rank < irank ? faceoffset++ : -1;
+			facesend[irank].insert(facesend[irank].end(), {f[0], f[1], elemoffset+f[2], faceid});
+			faceids[irank].push_back(faceid);
+		}
+
+	std::vector<int> displs;
+	const std::vector<fint> recvfaces = exchangeLists(facesend, FVENS_MPI_INT, comm, displs);
+	std::vector<std::vector<fint>>().swap(facesend);
+
+	//! 4. Match up the partition-boundary faces
+
+	amat::Array2d<int> nmatches(lm.nelem, lm.maxnfael);
+	nmatches.zeros();
+	std::vector<std::array<fint,5>> conn;
+
+	for(int irank = 0; irank < nranks; irank++)
+	{
+		const fint start = displs[irank]/sw;
+		std::vector<fint> recvorder(displs[irank+1]/sw - start);
+		std::iota(recvorder.begin(), recvorder.end(), start);
+		std::sort(recvorder.begin(), recvorder.end(), [&recvfaces](const fint i, const fint j) {
+			return faceKeyLess(&recvfaces[i*sw], &recvfaces[j*sw]);
+		});
+
+		for(size_t ic = 0; ic < candidates[irank].size(); ic++)
+		{
+			const fint *const f = &faces[candidates[irank][ic]*fw];
+			const auto it = std::lower_bound(recvorder.begin(), recvorder.end(), f,
+				[&recvfaces](const fint i, const fint *const key) {
+					return faceKeyLess(&recvfaces[i*sw], key);
+				});
+			if(it == recvorder.end() || !faceKeyEqual(&recvfaces[*it*sw], f))
+				continue;
+
+			const fint *const r = &recvfaces[*it*sw];
+			conn.push_back({f[2], f[3], irank, r[2], rank < irank ? faceids[irank][ic] : r[3]});
+			nmatches(f[2],f[3])++;
+		}
+	}
+
+	for(const std::array<fint,5>& c : conn)
+		if(nmatches(c[0],c[1]) != 1)
+			throw std::logic_error("PartitionedMeshReader: A face of cell "
+			                       + std::to_string(c[0]) + " of rank " + std::to_string(rank)
+			                       + " was matched with " + std::to_string(nmatches(c[0],c[1]))
+			                       + " faces of other partitions!");
+	for(int irank = 0; irank < nranks; irank++)
+		for(const fint iface : candidates[irank])
+			if(nmatches(faces[iface*fw+2],faces[iface*fw+3]) == 0)
+				throw std::logic_error("PartitionedMeshReader: Face ("
+				                       + std::to_string(faces[iface*fw]+1) + ","
+				                       + std::to_string(faces[iface*fw+1]+1)
+				                       + ") could not be matched with any other partition!");
+
+	//! 5. Connectivity faces, in the order of the cells and their faces
+
+	std::sort(conn.begin(), conn.end(),
+	          [](const std::array<fint,5>& a, const std::array<fint,5>& b) {
+	          	return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+	          });
+
+	lm.nconnface = static_cast<fint>(conn.size());
+	if(lm.nconnface > 0)
+		lm.connface.resize(lm.nconnface,5);
+	for(fint icofa = 0; icofa < lm.nconnface; icofa++)
+		for(int j = 0; j < 5; j++)
+			lm.connface(icofa,j) = conn[icofa][j];
+
+#ifdef DEBUG
+	std::cout << "PartitionedMeshReader: Rank " << rank << ": Nelem = " << lm.nelem
+	          << ", nbface = " << lm.nbface << ", nconnface = " << lm.nconnface << std::endl;
+#endif
+
+	return lm;
+}
+
+}
@@ -0,0 +1,140 @@
+/** \file
+ * \brief Construction of the distributed mesh without a replicated global mesh
+ */
+
+#ifndef FVENS_DISTRIBUTED_MESH_BUILDER_H
+#define FVENS_DISTRIBUTED_MESH_BUILDER_H
+
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "mesh.hpp"
+#include "meshpartitioning.hpp"
+
+namespace fvens {
+
+/// Reads a mesh file in parallel and builds each rank's subdomain mesh
+/** No process ever stores the global mesh; peak memory per rank is O(local mesh).
+ * The steps are:
+ *  - each rank reads a contiguous slice of cells, points and boundary faces (\ref readMeshSlice),
+ *  - faces of the cells are hashed to 'rendezvous' ranks where they are matched up, giving cell
+ *    neighbours across slices, a unique global index for each interior face and the host cell of
+ *    each physical boundary face,
+ *  - the distributed dual graph is partitioned in parallel,
+ *  - cells and boundary faces are migrated to their new ranks and the coordinates of the points
+ *    they need are fetched from the ranks that read them.
+ *
+ * The result is a local mesh with the same data as that produced by
+ * ReplicatedGlobalMeshPartitioner::restrictMeshToPartitions for the same partition, after
+ * UMesh::renumber_global_cells. The only difference is that column 4 of the connectivity face
+ * array (the global face index) is a unique index of the face among all interior faces of the
+ * global mesh, rather than the index of the face in the global mesh's intfac.
+ */
+class DistributedMeshBuilder
+{
+public:
+	/// Reads this rank's slice of the mesh file
+	/** \param mesh_path Path to a mesh file in any format supported by \ref readMeshSlice
+	 * \param partitioner The parallel partitioner to use:
+	 *   - "trivial": the cells are divided according to their index in the mesh file
+	 *   - "ptscotch": PT-Scotch's parallel graph partitioning (if FVENS was built with PT-Scotch)
+	 * \param comm The communicator over which the mesh is to be distributed
+	 * \param weights Cell and face weights used by graph partitioners; its partitioner name is
+	 *   not used
+	 */
+	DistributedMeshBuilder(const std::string mesh_path, const std::string partitioner,
+	                       const MPI_Comm comm,
+	                       const MeshPartitionConfig& weights = MeshPartitionConfig());
+
+	/// Computes cell adjacency, partitions the cells and returns the local subdomain mesh
+	/** Topological data structures of the local mesh other than the connectivity face data are
+	 * not computed; see \ref preprocessMesh.
+	 */
+	UMesh<freal,NDIM> build();
+
+protected:
+	const MPI_Comm comm;
+	const int rank;
+	const int nranks;
+	const std::string partitioner;
+	const MeshPartitionConfig pconf;
+
+	/// This rank's slice of the mesh file
+	MeshSlice slice;
+
+	/// Global index of the neighbouring cell across each face of each cell in the slice
+	/** Negative for faces lying on the physical boundary.
+	 */
+	amat::Array2d<fint> nbrelem;
+
+	/// The partition (destination rank) of the neighbouring cell across each face of each cell
+	amat::Array2d<int> nbrpart;
+
+	/// Unique global index of each interior face of each cell in the slice; negative otherwise
+	amat::Array2d<fint> faceindex;
+
+	/// Physical boundary faces that belong to the cells of this slice
+	/** Each row contains the global boundary face index, the local index of the host cell in the
+	 * slice, the EIndex of the face in the host cell, the global point indices of the face and
+	 * the face's tags, in that order.
+	 */
+	std::vector<std::vector<fint>> hostedbfaces;
+
+	/// Destination rank of each cell in the slice
+	std::vector<int> elempart;
+
+	/// Matches up faces among all slices
+	/** Computes \ref nbrelem, \ref faceindex and \ref hostedbfaces.
+	 */
+	void computeAdjacency();
+
+	/// Computes the partition \ref elempart of the cells of this slice and also \ref nbrpart
+	void computePartition();
+
+	/// Sends cells and boundary faces to their destination ranks and assembles the local mesh
+	/** The cells of each rank keep the order of their indices in the file, but get the contiguous
+	 * global indices required by distributed PETSc objects (see UMesh::renumber_global_cells).
+	 */
+	UMesh<freal,NDIM> migrate() const;
+};
+
+/// Builds each rank's subdomain mesh from a mesh file that has already been partitioned by Gmsh
+/** Each rank reads only its own partition (see \ref readGmsh4Partition), so the work and memory
+ * needed scale with the size of the local mesh. Faces that have no neighbour within the partition
+ * and are not physical boundary faces must lie on partition-boundary entities. They are sent only
+ * to the partitions sharing those entities, where they are matched up to build the connectivity
+ * faces directly.
+ *
+ * Rank i gets partition i+1 of the file. The cells of each rank get contiguous global indices
+ * following those of the lower ranks, in the order in which they appear in the file.
+ * The global index of a connectivity face (column 4 of connface) is assigned by the lower of the
+ * two ranks sharing it.
+ */
+class PartitionedMeshReader
+{
+public:
+	/// Reads this rank's partition of the mesh file
+	/** \param mesh_path Path to a mesh file partitioned by Gmsh into as many partitions as there
+	 *   are ranks in comm
+	 * \param comm The communicator over which the mesh is distributed
+	 */
+	PartitionedMeshReader(const std::string mesh_path, const MPI_Comm comm);
+
+	/// Finds the connectivity faces and returns the local subdomain mesh
+	/** Topological data structures of the local mesh other than the connectivity face data are
+	 * not computed; see \ref preprocessMesh.
+	 */
+	UMesh<freal,NDIM> build() const;
+
+protected:
+	const MPI_Comm comm;
+	const int rank;
+	const int nranks;
+
+	/// This rank's partition
+	const MeshPartitionData part;
+};
+
+}
+
+#endif
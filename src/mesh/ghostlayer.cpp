@@ -0,0 +1,204 @@
+/** \file
+ * \brief Construction of the second layer of ghost cells
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "utilities/mpiutils.hpp"
+#include "ghostlayer.hpp"
+
+namespace fvens {
+
+SecondGhostLayer::SecondGhostLayer(const UMesh<freal,NDIM>& m, const MPI_Comm comm)
+	: nslots{0}
+{
+	const int myrank = get_mpi_rank(comm);
+	const int nranks = get_mpi_size(comm);
+	const fint nelem = m.gnelem();
+	const fint nconnface = m.gnConnFace();
+
+	int maxnfael = m.gmaxnfael();
+	int ierr = MPI_Allreduce(MPI_IN_PLACE, &maxnfael, 1, MPI_INT, MPI_MAX, comm);
+	mpi_throw(ierr, "SecondGhostLayer: Could not reduce max faces per cell!");
+
+	/* For each connectivity face, the neighbouring subdomain is told the global face index, the
+	 * global index of our cell, the number of its neighbours and (owner rank, global index) of each
+	 * neighbour in our order. Records have a fixed length so that the number of values exchanged
+	 * with each neighbour is known from the number of shared faces.
+	 */
+	const int recsize = 3 + 2*maxnfael;
+
+	std::vector<int> nbdranks;
+	for(fint icface = 0; icface < nconnface; icface++)
+		nbdranks.push_back(static_cast<int>(m.gconnface(icface,2)));
+	std::sort(nbdranks.begin(), nbdranks.end());
+	nbdranks.erase(std::unique(nbdranks.begin(), nbdranks.end()), nbdranks.end());
+	const int nnbd = static_cast<int>(nbdranks.size());
+
+	auto nbdIndex = [&nbdranks](const fint rank) {
+		return static_cast<int>(std::lower_bound(nbdranks.begin(), nbdranks.end(), rank)
+		                        - nbdranks.begin());
+	};
+
+	std::vector<std::vector<fint>> sendbuf(nnbd), recvbuf(nnbd);
+	for(fint icface = 0; icface < nconnface; icface++)
+	{
+		std::vector<fint>& buf = sendbuf[nbdIndex(m.gconnface(icface,2))];
+		const fint iel = m.gconnface(icface,0);
+		buf.push_back(m.gconnface(icface,4));
+		buf.push_back(m.gglobalElemIndex(iel));
+		const size_t countpos = buf.size();
+		buf.push_back(0);
+
+		int nnbr = 0;
+		for(int jfa = 0; jfa < m.gnfael(iel); jfa++)
+		{
+			const fint jel = m.gesuel(iel,jfa);
+			if(jel >= nelem+nconnface)
+				continue;
+			if(jel < nelem) {
+				buf.push_back(myrank);
+				buf.push_back(m.gglobalElemIndex(jel));
+			}
+			else {
+				buf.push_back(m.gconnface(jel-nelem,2));
+				buf.push_back(m.gconnface(jel-nelem,3));
+			}
+			nnbr++;
+		}
+		buf[countpos] = nnbr;
+		for(int j = nnbr; j < maxnfael; j++) {
+			buf.push_back(-1);
+			buf.push_back(-1);
+		}
+	}
+
+	{
+		std::vector<MPI_Request> requests(2*nnbd);
+		for(int irank = 0; irank < nnbd; irank++)
+		{
+			recvbuf[irank].resize(sendbuf[irank].size());
+			ierr = MPI_Irecv(recvbuf[irank].data(), static_cast<int>(recvbuf[irank].size()),
+			                 FVENS_MPI_INT, nbdranks[irank], 0, comm, &requests[irank]);
+			mpi_throw(ierr, "SecondGhostLayer: Could not receive stencils!");
+			ierr = MPI_Isend(sendbuf[irank].data(), static_cast<int>(sendbuf[irank].size()),
+			                 FVENS_MPI_INT, nbdranks[irank], 0, comm, &requests[nnbd+irank]);
+			mpi_throw(ierr, "SecondGhostLayer: Could not send stencils!");
+		}
+		ierr = MPI_Waitall(2*nnbd, requests.data(), MPI_STATUSES_IGNORE);
+		mpi_throw(ierr, "SecondGhostLayer: Could not exchange stencils!");
+	}
+
+	// Local index of each of our cells from its global index
+	std::map<fint,fint> globaltolocal;
+	for(fint iel = 0; iel < nelem; iel++)
+		globaltolocal[m.gglobalElemIndex(iel)] = iel;
+
+	// Received records, by local connectivity face
+	std::vector<const fint*> records(nconnface, nullptr);
+	for(int irank = 0; irank < nnbd; irank++)
+	{
+		std::map<fint,fint> gfacetolocal;
+		for(fint icface = 0; icface < nconnface; icface++)
+			if(m.gconnface(icface,2) == nbdranks[irank])
+				gfacetolocal[m.gconnface(icface,4)] = icface;
+
+		for(size_t irec = 0; irec < recvbuf[irank].size(); irec += recsize)
+		{
+			const auto it = gfacetolocal.find(recvbuf[irank][irec]);
+			if(it == gfacetolocal.end())
+				throw std::runtime_error("SecondGhostLayer: Connectivity face "
+				                         + std::to_string(recvbuf[irank][irec])
+				                         + " not found in this subdomain!");
+			records[it->second] = &recvbuf[irank][irec];
+		}
+	}
+
+	// Cells of other subdomains that are needed, as (owner rank, global index)
+	std::set<std::pair<fint,fint>> remotecells;
+	for(fint icface = 0; icface < nconnface; icface++)
+	{
+		const fint *const rec = records[icface];
+		remotecells.insert(std::make_pair(m.gconnface(icface,2), rec[1]));
+		for(fint j = 0; j < rec[2]; j++)
+			if(rec[3+2*j] != myrank)
+				remotecells.insert(std::make_pair(rec[3+2*j], rec[4+2*j]));
+	}
+
+	// Slots in order of (rank, global index), which makes them contiguous per source rank
+	std::map<std::pair<fint,fint>,fint> slotof;
+	std::vector<int> recvcounts(nranks, 0);
+	std::vector<fint> requested;
+	for(const std::pair<fint,fint>& cell : remotecells)
+	{
+		if(srcranks.empty() || srcranks.back() != cell.first) {
+			srcranks.push_back(static_cast<int>(cell.first));
+			srcslotstart.push_back(nslots);
+		}
+		slotof[cell] = nslots++;
+		recvcounts[cell.first]++;
+		requested.push_back(cell.second);
+	}
+	srcslotstart.push_back(nslots);
+
+	stencilptr.resize(nconnface+1);
+	connslot.resize(nconnface);
+	stencilptr[0] = 0;
+	for(fint icface = 0; icface < nconnface; icface++)
+	{
+		const fint *const rec = records[icface];
+		connslot[icface] = slotof.at(std::make_pair(m.gconnface(icface,2), rec[1]));
+		for(fint j = 0; j < rec[2]; j++)
+		{
+			if(rec[3+2*j] == myrank)
+				stencilcells.push_back(globaltolocal.at(rec[4+2*j]));
+			else
+				stencilcells.push_back(-1-slotof.at(std::make_pair(rec[3+2*j], rec[4+2*j])));
+		}
+		stencilptr[icface+1] = static_cast<fint>(stencilcells.size());
+	}
+
+	// Tell the owners which of their cells we need
+	std::vector<int> sendcounts(nranks);
+	ierr = MPI_Alltoall(recvcounts.data(), 1, MPI_INT, sendcounts.data(), 1, MPI_INT, comm);
+	mpi_throw(ierr, "SecondGhostLayer: Could not exchange the number of requested cells!");
+
+	std::vector<int> rdispls(nranks+1, 0), sdispls(nranks+1, 0);
+	for(int irank = 0; irank < nranks; irank++) {
+		rdispls[irank+1] = rdispls[irank] + recvcounts[irank];
+		sdispls[irank+1] = sdispls[irank] + sendcounts[irank];
+	}
+	std::vector<fint> tosend(sdispls[nranks]);
+	ierr = MPI_Alltoallv(requested.data(), recvcounts.data(), rdispls.data(), FVENS_MPI_INT,
+	                     tosend.data(), sendcounts.data(), sdispls.data(), FVENS_MPI_INT, comm);
+	mpi_throw(ierr, "SecondGhostLayer: Could not exchange requested cells!");
+
+	for(int irank = 0; irank < nranks; irank++)
+	{
+		if(sendcounts[irank] == 0)
+			continue;
+		destranks.push_back(irank);
+		sendcells.push_back(std::vector<fint>());
+		for(int i = sdispls[irank]; i < sdispls[irank+1]; i++)
+			sendcells.back().push_back(globaltolocal.at(tosend[i]));
+	}
+}
+
+}
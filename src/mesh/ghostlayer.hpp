@@ -0,0 +1,94 @@
+/** \file
+ * \brief Second layer of ghost cells behind the connectivity faces of a distributed mesh
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_GHOSTLAYER_H
+#define FVENS_GHOSTLAYER_H
+
+#include <vector>
+#include <mpi.h>
+#include "mesh.hpp"
+
+namespace fvens {
+
+/// The cells needed to compute, in this subdomain, cell data at connectivity ghost cells which
+///  depends on the ghost cells' own neighbours
+/** Each connectivity ghost cell is a cell of a neighbouring subdomain. Its neighbours in that
+ * subdomain (the 'stencil' of the ghost cell) are either cells of this subdomain or cells of other
+ * subdomains - the neighbouring subdomain itself or yet others which touch the ghost cell.
+ * Cells of other subdomains which are needed, including the connectivity ghost cells themselves,
+ * are given 'slots': rows of a receive array into which their data can be exchanged in a single
+ * step, directly from the subdomains that own them. Slots are contiguous for each source subdomain.
+ *
+ * The layer is built from the mesh connectivity by communication between subdomains; the
+ * partitioning itself is not changed. Neighbours across physical boundaries are not included.
+ */
+class SecondGhostLayer
+{
+public:
+	/// Builds the layer; collective over the communicator
+	/** \param mesh A distributed mesh whose global cell indices have been finalized
+	 *   (see UMesh::renumber_global_cells)
+	 * \param comm The communicator over which the mesh is distributed
+	 */
+	SecondGhostLayer(const UMesh<freal,NDIM>& mesh, const MPI_Comm comm);
+
+	/// Number of neighbours of a connectivity ghost cell in its own subdomain
+	int stencilSize(const fint icface) const {
+		return static_cast<int>(stencilptr[icface+1] - stencilptr[icface]);
+	}
+
+	/// The j-th neighbour of a connectivity ghost cell
+	/** Non-negative values are local cell indices of this subdomain;
+	 * a negative value v refers to slot -1-v.
+	 */
+	fint stencil(const fint icface, const int j) const { return stencilcells[stencilptr[icface]+j]; }
+
+	/// Slot of a connectivity ghost cell itself
+	fint connSlot(const fint icface) const { return connslot[icface]; }
+
+	/// Total number of slots
+	fint numSlots() const { return nslots; }
+
+	/// Ranks from which slot data is received
+	const std::vector<int>& sourceRanks() const { return srcranks; }
+	/// First slot of each source rank, and the total number of slots at the end
+	const std::vector<fint>& sourceSlotStart() const { return srcslotstart; }
+
+	/// Ranks to which cell data is sent
+	const std::vector<int>& destinationRanks() const { return destranks; }
+	/// Local cells whose data is sent to each destination rank, in the order expected there
+	const std::vector<std::vector<fint>>& sendCells() const { return sendcells; }
+
+protected:
+	/// Index into \ref stencilcells of the first neighbour of each connectivity ghost cell
+	std::vector<fint> stencilptr;
+	/// Neighbours of all connectivity ghost cells, in the order of the owning subdomain
+	std::vector<fint> stencilcells;
+	/// Slot of each connectivity ghost cell
+	std::vector<fint> connslot;
+	/// Total number of slots
+	fint nslots;
+
+	std::vector<int> srcranks;
+	std::vector<fint> srcslotstart;
+	std::vector<int> destranks;
+	std::vector<std::vector<fint>> sendcells;
+};
+
+}
+#endif
@@ -21,10 +21,12 @@
 #include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <map>
 #include <boost/algorithm/string.hpp>
 
 #include "mesh.hpp"
 #include "utilities/mpiutils.hpp"
+#include "utilities/helper_algorithms.hpp"
 
 #ifdef USE_ADOLC
 #include <adolc/adolc.h>
@@ -34,7 +36,7 @@ namespace fvens {
 
 template <typename scalar, int ndim>
 UMesh<scalar,ndim>::UMesh()
-	: nconnface{0}, isBoundaryMaps{false}
+	: nconnface{0}, isBoundaryMaps{false}, precomputedTopology{false}
 {  }
 
 template <typename scalar, int ndim>
@@ -43,7 +45,20 @@ UMesh<scalar,ndim>::UMesh(const MeshData& md)
 	  npoin{md.npoin}, nelem{md.nelem}, nbface{md.nbface}, nnode(md.nnode), maxnnode{md.maxnnode},
 	  nfael(md.nfael), maxnfael{md.maxnfael}, nnofa{md.nnofa}, nbtag{md.nbtag}, ndtag{md.ndtag},
 	  coords(md.coords), inpoel(md.inpoel), bface(md.bface), vol_regions(md.vol_regions),
-	  nconnface{0}
+	  nconnface{0}, esuel(md.esuel), intfac(md.intfac),
+	  precomputedTopology{md.esuel.rows() > 0 && md.intfac.rows() > 0}
+{  }
+
+template <typename scalar, int ndim>
+UMesh<scalar,ndim>::UMesh(MeshData&& md)
+	: npoinglobal{md.npoin}, nelemglobal{md.nelem},
+	  npoin{md.npoin}, nelem{md.nelem}, nbface{md.nbface}, nnode(std::move(md.nnode)),
+	  maxnnode{md.maxnnode}, nfael(std::move(md.nfael)), maxnfael{md.maxnfael}, nnofa{md.nnofa},
+	  nbtag{md.nbtag}, ndtag{md.ndtag},
+	  coords(std::move(md.coords)), inpoel(std::move(md.inpoel)), bface(std::move(md.bface)),
+	  vol_regions(std::move(md.vol_regions)),
+	  nconnface{0}, esuel(std::move(md.esuel)), intfac(std::move(md.intfac)),
+	  precomputedTopology{esuel.rows() > 0 && intfac.rows() > 0}
 {  }
 
 template <typename scalar, int ndim>
@@ -84,18 +99,109 @@ void UMesh<scalar,ndim>::correctBoundaryFaceOrientation()
 template <typename scalar, int ndim>
 void UMesh<scalar,ndim>::reorder_cells(const PetscInt *const permvec)
 {
-	// reorder inpoel, nnode, nfael, vol_regions
+	// reorder inpoel, nnode, nfael, vol_regions and global indices
 	const amat::Array2d<fint> tempelems = inpoel;
+	const amat::Array2d<int> tempvolregions = vol_regions;
 	const std::vector<int> tempnnode = nnode;
 	const std::vector<int> tempnfael = nfael;
+	const std::vector<fint> tempglobalindex = globalElemIndex;
+	const bool hasglobalindex = static_cast<fint>(globalElemIndex.size()) == nelem;
+	precomputedTopology = false;
 
 	for(fint i = 0; i < nelem; i++)
 	{
 		for(int j = 0; j < inpoel.cols(); j++)
 			inpoel(i,j) = tempelems(permvec[i],j);
+		for(int j = 0; j < vol_regions.cols(); j++)
+			vol_regions(i,j) = tempvolregions(permvec[i],j);
 		nnode[i] = tempnnode[permvec[i]];
 		nfael[i] = tempnfael[permvec[i]];
+		if(hasglobalindex)
+			globalElemIndex[i] = tempglobalindex[permvec[i]];
 	}
+
+	// connectivity faces refer to cells of this subdomain by their local index
+	std::vector<fint> newindex(nelem);
+	for(fint i = 0; i < nelem; i++)
+		newindex[permvec[i]] = i;
+	for(fint icface = 0; icface < nconnface; icface++)
+		connface(icface,0) = newindex[connface(icface,0)];
+}
+
+template <typename scalar, int ndim>
+void UMesh<scalar,ndim>::renumber_global_cells(const MPI_Comm comm)
+{
+	if(static_cast<fint>(globalElemIndex.size()) != nelem)
+		return;
+
+	// The cells of each subdomain get the contiguous range of global indices after those of the
+	//  lower-ranked subdomains.
+	fint offset = 0;
+	int ierr = MPI_Exscan(&nelem, &offset, 1, FVENS_MPI_INT, MPI_SUM, comm);
+	mpi_throw(ierr, "renumber_global_cells: Could not compute the global index offset!");
+	if(get_mpi_rank(comm) == 0)
+		offset = 0;
+	for(fint iel = 0; iel < nelem; iel++)
+		globalElemIndex[iel] = offset + iel;
+
+	// Tell the neighbouring subdomains the new global index of the cell behind each shared face.
+	//  The number of faces shared between two subdomains is the same on both sides.
+	std::vector<int> nbdranks;
+	for(fint icface = 0; icface < nconnface; icface++)
+		nbdranks.push_back(static_cast<int>(connface(icface,2)));
+	std::sort(nbdranks.begin(), nbdranks.end());
+	nbdranks.erase(std::unique(nbdranks.begin(), nbdranks.end()), nbdranks.end());
+	const int nnbd = static_cast<int>(nbdranks.size());
+
+	std::vector<std::vector<fint>> sendbuf(nnbd), recvbuf(nnbd);
+	for(fint icface = 0; icface < nconnface; icface++)
+	{
+		const int irank = static_cast<int>(std::lower_bound(nbdranks.begin(), nbdranks.end(),
+		                                                    connface(icface,2)) - nbdranks.begin());
+		sendbuf[irank].push_back(connface(icface,4));
+		sendbuf[irank].push_back(globalElemIndex[connface(icface,0)]);
+	}
+
+	std::vector<MPI_Request> requests(2*nnbd);
+	for(int irank = 0; irank < nnbd; irank++)
+	{
+		recvbuf[irank].resize(sendbuf[irank].size());
+		ierr = MPI_Irecv(&recvbuf[irank][0], static_cast<int>(recvbuf[irank].size()),
+		                     FVENS_MPI_INT, nbdranks[irank], 0, comm, &requests[irank]);
+		mpi_throw(ierr, "renumber_global_cells: Could not receive new global indices!");
+		ierr = MPI_Isend(&sendbuf[irank][0], static_cast<int>(sendbuf[irank].size()),
+		                 FVENS_MPI_INT, nbdranks[irank], 0, comm, &requests[nnbd+irank]);
+		mpi_throw(ierr, "renumber_global_cells: Could not send new global indices!");
+	}
+	ierr = MPI_Waitall(2*nnbd, requests.data(), MPI_STATUSES_IGNORE);
+	mpi_throw(ierr, "renumber_global_cells: Could not exchange new global indices!");
+
+	std::vector<std::map<fint,fint>> nbdcells(nnbd);
+	for(int irank = 0; irank < nnbd; irank++)
+		for(size_t i = 0; i < recvbuf[irank].size(); i += 2)
+			nbdcells[irank][recvbuf[irank][i]] = recvbuf[irank][i+1];
+
+	for(fint icface = 0; icface < nconnface; icface++)
+	{
+		const int irank = static_cast<int>(std::lower_bound(nbdranks.begin(), nbdranks.end(),
+		                                                    connface(icface,2)) - nbdranks.begin());
+		const auto it = nbdcells[irank].find(connface(icface,4));
+		if(it == nbdcells[irank].end())
+			throw std::runtime_error("renumber_global_cells: Connectivity face "
+			                         + std::to_string(connface(icface,4))
+			                         + " not found in its neighbouring subdomain!");
+		connface(icface,3) = it->second;
+	}
+}
+
+template <typename scalar, int ndim>
+void UMesh<scalar,ndim>::reorder_boundary_faces(const fint *const permvec)
+{
+	precomputedTopology = false;
+	const amat::Array2d<fint> tempbface = bface;
+	for(fint i = 0; i < nbface; i++)
+		for(int j = 0; j < bface.cols(); j++)
+			bface(i,j) = tempbface(permvec[i],j);
 }
 
 /**	Stores (in array bpointsb) for each boundary point: the associated global point number and
@@ -335,10 +441,83 @@ void UMesh<scalar,ndim>::compute_topological()
 #endif
 
 	compute_elementsSurroundingPoints();
+	if(precomputedTopology && use_precomputed_faceConnectivity())
+		return;
 	compute_elementsSurroundingElements();
 	compute_faceConnectivity();
 }
 
+template <typename scalar, int ndim>
+bool UMesh<scalar,ndim>::use_precomputed_faceConnectivity()
+{
+	static_assert(ndim == 2, "Only 2D is currently supported!");
+	precomputedTopology = false;
+
+	// The stored topology is that of a mesh which is not distributed, with the physical boundary
+	//  faces in bface in the same order and orientation as in intfac
+	bool valid = nconnface == 0 && esuel.rows() == nelem && esuel.cols() == maxnfael
+		&& intfac.cols() == nnofa+2 && intfac.rows() >= nbface;
+	for(fint iface = 0; valid && iface < nbface; iface++)
+	{
+		valid = intfac(iface,1) == nelem+iface;
+		for(FIndex inode = 0; inode < nnofa; inode++)
+			valid = valid && intfac(iface,2+inode) == bface(iface,inode);
+	}
+	if(!valid) {
+		std::cout << " UMesh: compute_topological(): Precomputed topology does not fit the mesh;"
+		          << " recomputing it.\n";
+		return false;
+	}
+
+	naface = intfac.rows();
+	ninface = naface - nbface;
+	std::cout << "UMesh: compute_topological(): Using precomputed faces; total number of faces= "
+	          << naface << std::endl;
+
+	phyBFaceStart = 0;
+	phyBFaceEnd = nbface;
+	subDomFaceStart = nbface;
+	subDomFaceEnd = nbface + ninface;
+	connBFaceStart = nbface+ninface;
+	connBFaceEnd = nbface+ninface;
+	domFaceStart = nbface;
+	domFaceEnd = nbface + ninface;
+
+	elemface.resize(nelem,maxnfael);
+	btags.resize(nbface,nbtag);
+	bfaceToFace.resize(nbface);
+
+#pragma omp parallel for default(shared)
+	for(fint iface = 0; iface < nbface; iface++)
+	{
+		bfaceToFace[iface] = iface;
+		for(int j = 0; j < nbtag; j++)
+			btags(iface,j) = bface(iface,nnofa+j);
+
+		const fint ielem = intfac(iface,0);
+		for(EIndex in = 0; in < nfael[ielem]; in++)
+			if(esuel(ielem,in) == nelem+iface)
+				elemface(ielem,in) = iface;
+	}
+
+	// As in compute_faceConnectivity, the face is the edge of its left cell that starts at its first
+	//  node and the edge of its right cell that starts at its second node.
+	// Each entry of elemface is written by exactly one face.
+#pragma omp parallel for default(shared)
+	for(fint iface = subDomFaceStart; iface < subDomFaceEnd; iface++)
+	{
+		const fint ie = intfac(iface,0), je = intfac(iface,1);
+		for(EIndex in = 0; in < nnode[ie]; in++)
+			if(inpoel(ie,in) == intfac(iface,2))
+				elemface(ie,in) = iface;
+		for(EIndex jnode = 0; jnode < nnode[je]; jnode++)
+			if(inpoel(je,jnode) == intfac(iface,3))
+				elemface(je,jnode) = iface;
+	}
+
+	return true;
+}
+
 /** Assumption: order of nodes of boundary faces is such that normal points outside,
  * when normal is calculated as
  * 		nx = y2 - y1, ny = -(x2-x1).
@@ -429,117 +608,85 @@ void UMesh<scalar,ndim>::compute_elementsSurroundingPoints()
 	esup_p.resize(npoin+1,1);
 	esup_p.zeros();
 
-	for(int i = 0; i < nelem; i++)
+	// Count the elements surrounding each point. The count of the first point is stored at index 1,
+	//  so that a prefix sum gives the start of each point's list.
+#pragma omp parallel for default(shared)
+	for(fint i = 0; i < nelem; i++)
 	{
 		for(int j = 0; j < nfael[i]; j++)
 		{
-			/* The first index is inpoel(i,j) + 1 : the + 1 is there because
-			 * the storage corresponding to the first node begins at 0, not at 1
-			 */
+#pragma omp atomic update
 			esup_p(inpoel(i,j)+1,0) += 1;
 		}
 	}
-	// Now make the members of esup_p cumulative
-	for(int i = 1; i < npoin+1; i++)
-		esup_p(i,0) += esup_p(i-1,0);
-	// Now populate esup
+
+	inclusive_scan(&esup_p(0,0), static_cast<size_t>(npoin+1));
+
+	// Now populate esup. The position of each element in its point's list depends on the order in
+	//  which threads reach it, so each list is sorted afterwards; this gives the same lists as
+	//  inserting the elements in order of their indices.
 	esup.resize(esup_p(npoin,0),1);
-	esup.zeros();
-	for(int i = 0; i < nelem; i++)
+	std::vector<fint> nextpos(npoin);
+#pragma omp parallel default(shared)
 	{
-		for(int j = 0; j < nfael[i]; j++)
-		{
-			int ipoin = inpoel(i,j);
+#pragma omp for
+		for(fint ipoin = 0; ipoin < npoin; ipoin++)
+			nextpos[ipoin] = esup_p(ipoin,0);
 
-			// now put that element no. in the space pointed to by esup_p(ipoin):
-			esup(esup_p(ipoin,0),0) = i;
-
-			// an element corresponding to ipoin has been found - increment esup_p for that point:
-			esup_p(ipoin,0) += 1;
+#pragma omp for
+		for(fint i = 0; i < nelem; i++)
+		{
+			for(int j = 0; j < nfael[i]; j++)
+			{
+				fint pos;
+#pragma omp atomic capture
+				pos = nextpos[inpoel(i,j)]++;
+				esup(pos,0) = i;
+			}
 		}
-	}
 
-	//But now esup_p holds increased values:
-	// each member increased by the number elements surrounding the corresponding point.
-	// So now correct this.
-	for(int i = npoin; i >= 1; i--)
-		esup_p(i,0) = esup_p(i-1,0);
-	esup_p(0,0) = 0;
+#pragma omp for
+		for(fint ipoin = 0; ipoin < npoin; ipoin++)
+			std::sort(&esup(0,0) + esup_p(ipoin,0), &esup(0,0) + esup_p(ipoin+1,0));
+	}
 }
 
 template <typename scalar, int ndim>
 void UMesh<scalar,ndim>::compute_elementsSurroundingElements()
 {
 	esuel.resize(nelem, maxnfael);
-	for(int ii = 0; ii < nelem; ii++)
-		for(int jj = 0; jj < maxnfael; jj++)
-			esuel(ii,jj) = -1;
-
-	amat::Array2d<int > lpoin(npoin,1);
-	lpoin.zeros();
 
 	// TODO: Fix for 3D - this would then be different for each face and the kernel below changes
-	const int nverfa = 2;      // number of vertices per face
+	static_assert(ndim == 2, "Only 2D is currently supported!");
 
-	for(int ielem = 0; ielem < nelem; ielem++)
+	// The neighbour across each face of an element is searched among the elements surrounding the
+	//  face's first node. Each element only writes its own row of esuel.
+#pragma omp parallel for default(shared)
+	for(fint ielem = 0; ielem < nelem; ielem++)
 	{
-		amat::Array2d<int > lhelp(nverfa,1);
-		lhelp.zeros();
-
-		// first get lpofa for this element
-		// lpofa(i,j) holds local vertex number of jth vertex of ith face
-		//   (j in [0:nverfa], i in [0:nfael])
-		amat::Array2d<int > lpofai(nfael[ielem], nverfa);
-		for(int i = 0; i < nfael[ielem]; i++)
-		{
-			for(int j = 0; j < nverfa; j++)
-			{
-				// fine as long as operands of % are not negative
-				lpofai(i,j) = (i+j) % nnode[ielem];
-			}
-		}
+		for(int jj = 0; jj < maxnfael; jj++)
+			esuel(ielem,jj) = -1;
 
-		for(int ifael = 0; ifael < nfael[ielem]; ifael++)
+		for(EIndex ifael = 0; ifael < nfael[ielem]; ifael++)
 		{
-			for(int i = 0; i < nverfa; i++)
-			{
-				// lhelp stores global node nos. of vertices of current face of current element
-				lhelp(i,0) = inpoel(ielem, lpofai(ifael,i));
-				lpoin(lhelp(i,0)) = 1;
-			}
-			int ipoin = lhelp(0);
-			for(int istor = esup_p(ipoin); istor < esup_p(ipoin+1); istor++)
+			// global node nos. of vertices of current face of current element
+			const fint ipoin = inpoel(ielem, ifael);
+			const fint ipoin1 = inpoel(ielem, (ifael+1) % nnode[ielem]);
+
+			for(fint istor = esup_p(ipoin); istor < esup_p(ipoin+1); istor++)
 			{
-				int jelem = esup(istor);
+				const fint jelem = esup(istor);
+				if(jelem == ielem)
+					continue;
 
-				if(jelem != ielem)
+				for(EIndex jfael = 0; jfael < nfael[jelem]; jfael++)
 				{
-					// setup lpofa for jelem
-					amat::Array2d<int > lpofaj;
-					lpofaj.resize(nfael[jelem],nverfa);
-					for(int i = 0; i < nfael[jelem]; i++)
-						for(int j = 0; j < nverfa; j++)
-							lpofaj(i,j) = (i+j)%nfael[jelem];
-
-					for(int jfael = 0; jfael < nfael[jelem]; jfael++)
-					{
-						//Assume that no. of nodes in face ifael is same as that in face jfael
-						int icoun = 0;
-						for(int jnofa = 0; jnofa < nverfa; jnofa++)
-						{
-							int jpoin = inpoel(jelem, lpofaj(jfael,jnofa));
-							if(lpoin(jpoin)==1) icoun++;
-						}
-						if(icoun == nverfa)		// nnofa is 2
-						{
-							esuel(ielem,ifael) = jelem;
-							esuel(jelem,jfael) = ielem;
-						}
-					}
+					const fint jpoin = inpoel(jelem, jfael);
+					const fint jpoin1 = inpoel(jelem, (jfael+1) % nfael[jelem]);
+					if((jpoin == ipoin && jpoin1 == ipoin1) || (jpoin == ipoin1 && jpoin1 == ipoin))
+						esuel(ielem,ifael) = jelem;
 				}
 			}
-			for(int i = 0; i < nverfa; i++)
-				lpoin(lhelp(i)) = 0;
 		}
 	}
 }
@@ -608,6 +755,10 @@ std::vector<std::pair<fint,EIndex>> UMesh<scalar,ndim>::compute_phyBFaceNeighbor
 	static_assert(ndim==2, "Only 2D is currently supported!");
 	std::vector<std::pair<fint,EIndex>> interiorelem(nbface);
 
+	// An exception cannot leave a parallel region, so errors are recorded and thrown afterwards
+	fint errorface = -1;
+
+#pragma omp parallel for default(shared)
 	for(fint iface = 0; iface < nbface; iface++)
 	{
 		// First get sorted list of elements around each point of this face.
@@ -642,8 +793,9 @@ std::vector<std::pair<fint,EIndex>> UMesh<scalar,ndim>::compute_phyBFaceNeighbor
 		}
 
 		if(intersection.size() > 1) {
-			throw std::logic_error("More than one neighboring element found for bface "
-			                       + std::to_string(iface));
+#pragma omp critical
+			errorface = iface;
+			continue;
 		}
 
 		interiorelem[iface].first = intersection[0];
@@ -653,25 +805,40 @@ std::vector<std::pair<fint,EIndex>> UMesh<scalar,ndim>::compute_phyBFaceNeighbor
 		assert(interiorelem[iface].second >= 0);
 	}
 
+	if(errorface >= 0)
+		throw std::logic_error("More than one neighboring element found for bface "
+		                       + std::to_string(errorface));
+
 	return interiorelem;
 }
 
 template <typename scalar, int ndim>
 void UMesh<scalar,ndim>::compute_faceConnectivity()
 {
-	// calculate number of internal faces
-	ninface = 0;
-	for(int ie = 0; ie < nelem; ie++)
+	static_assert(ndim == 2, "Only 2D is currently supported!");   // only remove after generalizing the loops below to 3D
+
+	// Interior faces are numbered in the order of their left cells. Count the interior faces of
+	//  which each element is the left cell; their prefix sum gives the position of the first
+	//  such face of each element, so that the faces can then be generated independently per element.
+	std::vector<fint> leftfacestart(nelem+1);
+	leftfacestart[0] = 0;
+#pragma omp parallel for default(shared)
+	for(fint ie = 0; ie < nelem; ie++)
 	{
-		for(int in = 0; in < nfael[ie]; in++)
+		fint nright = 0;
+		for(EIndex in = 0; in < nfael[ie]; in++)
 		{
-			int je = esuel(ie,in);
+			const fint je = esuel(ie,in);
 			if(je > ie && je < nelem) {
-				ninface++;
+				nright++;
 			}
 		}
+		leftfacestart[ie+1] = nright;
 	}
 
+	inclusive_scan(leftfacestart);
+	ninface = leftfacestart[nelem];
+
 	naface = ninface + nbface + nconnface;
 	std::cout << "UMesh: compute_faceConnectivity(): Total number of faces= " << naface << std::endl;
 
@@ -686,17 +853,28 @@ void UMesh<scalar,ndim>::compute_faceConnectivity()
 	phyBFaceEnd = nbface;
 	const std::vector<std::pair<fint,EIndex>> intelems = compute_phyBFaceNeighboringElements();
 
+	// Order the physical boundary faces by their interior cells
+	std::vector<fint> bfaceorder(nbface);
+	for(fint iface = 0; iface < nbface; iface++)
+		bfaceorder[iface] = iface;
+	std::stable_sort(bfaceorder.begin(), bfaceorder.end(),
+	                 [&intelems](const fint a, const fint b) { return intelems[a] < intelems[b]; });
+
+	bfaceToFace.resize(nbface);
+#pragma omp parallel for default(shared)
 	for(fint iface = 0; iface < nbface; iface++)
 	{
-		intfac(iface,0) = intelems[iface].first;
+		const fint ibface = bfaceorder[iface];
+		bfaceToFace[ibface] = phyBFaceStart + iface;
+		intfac(iface,0) = intelems[ibface].first;
 		intfac(iface,1) = nelem + nconnface + iface;
 		for(FIndex inode = 0; inode < nnofa; inode++)
-			intfac(iface,2+inode) = bface(iface,inode);
+			intfac(iface,2+inode) = bface(ibface,inode);
 		for(int j = nnofa; j < nnofa+nbtag; j++)
-			btags(iface,j-nnofa) = bface(iface,j);
+			btags(iface,j-nnofa) = bface(ibface,j);
  
-		esuel(intelems[iface].first, intelems[iface].second) = nelem+nconnface+iface;
-		elemface(intelems[iface].first, intelems[iface].second) = iface;
+		esuel(intelems[ibface].first, intelems[ibface].second) = nelem+nconnface+iface;
+		elemface(intelems[ibface].first, intelems[ibface].second) = iface;
 	}
 
 	// Next, subdomain interior faces
@@ -704,18 +882,31 @@ void UMesh<scalar,ndim>::compute_faceConnectivity()
 	subDomFaceStart = nbface;
 	subDomFaceEnd = nbface + ninface;
 
-	static_assert(ndim == 2, "Only 2D is currently supported!");   // only remove after generalizing the loop below to 3D
-
-	fint faceindex = nbface;
-	//fint faceindex = nbface;
-
-	for(fint ie = 0; ie < nelem; ie++)
+	// Faces are generated in the order of their left cells, and for each left cell, in the order of
+	//  their right cells, so that face loops stream through cell arrays.
+	// Each entry of elemface is written by exactly one face.
+#pragma omp parallel default(shared)
 	{
-		for(EIndex in = 0; in < nnode[ie]; in++)
+		std::vector<std::pair<fint,EIndex>> rightcells(maxnfael);
+
+#pragma omp for
+		for(fint ie = 0; ie < nelem; ie++)
 		{
-			const fint je = esuel(ie,in);
-			if(je > ie && je < nelem)
+			int nright = 0;
+			for(EIndex in = 0; in < nnode[ie]; in++)
 			{
+				const fint je = esuel(ie,in);
+				if(je > ie && je < nelem)
+					rightcells[nright++] = std::make_pair(je,in);
+			}
+			assert(nright == leftfacestart[ie+1]-leftfacestart[ie]);
+			std::sort(rightcells.begin(), rightcells.begin()+nright);
+
+			for(int iright = 0; iright < nright; iright++)
+			{
+				const fint faceindex = nbface + leftfacestart[ie] + iright;
+				const fint je = rightcells[iright].first;
+				const EIndex in = rightcells[iright].second;
 				const EIndex in1 = (in+1)%nnode[ie];
 				intfac(faceindex,0) = ie;
 				intfac(faceindex,1) = je;
@@ -726,21 +917,33 @@ void UMesh<scalar,ndim>::compute_faceConnectivity()
 				for(EIndex jnode = 0; jnode < nnode[je]; jnode++)
 					if(inpoel.get(ie,in1) == inpoel.get(je,jnode))
 						elemface(je,jnode) = faceindex;
-
-				faceindex++;
 			}
 		}
 	}
 
-	assert(faceindex-nbface == ninface);
-
 	// Connectivity faces
 
 	connBFaceStart = nbface+ninface;
-	assert(connBFaceStart == faceindex);
 	connBFaceEnd = nbface+ninface+nconnface;
 	assert(connBFaceEnd == naface);
 
+	// Order the connectivity faces by their cells in this subdomain. The rows of connface are
+	//  permuted, because their ordering defines the ghost cell index of each face.
+	{
+		std::vector<fint> connorder(nconnface);
+		for(fint icface = 0; icface < nconnface; icface++)
+			connorder[icface] = icface;
+		std::sort(connorder.begin(), connorder.end(), [this](const fint a, const fint b) {
+			return connface(a,0) < connface(b,0)
+				|| (connface(a,0) == connface(b,0) && connface(a,1) < connface(b,1)); });
+
+		const amat::Array2d<fint> tempconnface = connface;
+		for(fint icface = 0; icface < nconnface; icface++)
+			for(int j = 0; j < connface.cols(); j++)
+				connface(icface,j) = tempconnface(connorder[icface],j);
+	}
+
+#pragma omp parallel for default(shared)
 	for(fint iface = connBFaceStart; iface < connBFaceEnd; iface++)
 	{
 		const fint icface = iface - connBFaceStart;
@@ -771,6 +974,54 @@ std::vector<fint> UMesh<scalar,ndim>::getConnectivityGlobalIndices() const
 	return cgind;
 }
 
+/// Lists the points connected to a point by an edge of one of its surrounding elements
+/** The points are listed in the order in which they are first encountered when traversing the
+ * nodes of the elements surrounding the point in the order of \ref esup.
+ * \param nbrs On output, the list of surrounding points; its previous contents are discarded
+ */
+static void getPointsSurroundingPoint(const fint ip, const amat::Array2d<fint>& esup_p,
+                                      const amat::Array2d<fint>& esup,
+                                      const amat::Array2d<fint>& inpoel,
+                                      const std::vector<int>& nnode, std::vector<fint>& nbrs)
+{
+	nbrs.clear();
+
+	// Loop over elements surrounding this point
+	for(fint ie = esup_p(ip,0); ie < esup_p(ip+1,0); ie++)
+	{
+		const fint ielem = esup(ie,0);		// element number
+
+		// find local node number of ip in ielem
+		int inode = -1;
+		for(int jnode = 0; jnode < nnode[ielem]; jnode++)
+			if(inpoel(ielem,jnode) == ip) inode = jnode;
+#ifdef DEBUG
+		if(inode == -1) {
+			std::cout << " ! UMesh: compute_topological(): ";
+			std::cout << "inode not found while computing psup!\n";
+		}
+#endif
+
+		//loop over nodes of the element
+		for(int jnode = 0; jnode < nnode[ielem]; jnode++)
+		{
+			// whether ip is connected to local node number jnode of ielem
+			const bool connected = nnode[ielem] == 3
+				|| (nnode[ielem] == 4 && (jnode == (inode + 1) % nnode[ielem]
+				                          || jnode == (inode + nnode[ielem]-1) % nnode[ielem]));
+
+			//Get global index of this node
+			const fint jpoin = inpoel(ielem, jnode);
+
+			/* test if this point as already been counted as a surrounding point of ip,
+			 * and whether it's connected to ip. The point ip itself is not counted.
+			 */
+			if(connected && jpoin != ip && std::find(nbrs.begin(), nbrs.end(), jpoin) == nbrs.end())
+				nbrs.push_back(jpoin);
+		}
+	}
+}
+
 /** \todo: There is an issue with psup for some boundary nodes
  * belonging to elements of different types. Correct this.
  */
@@ -781,124 +1032,33 @@ void UMesh<scalar,ndim>::compute_pointsSurroundingPoints()
 	std::cout << "UMesh: compute_topological(): Points surrounding points\n";
 #endif
 	psup_p.resize(npoin+1,1);
-	psup_p.zeros();
 	psup_p(0,0) = 0;
 
-	// The ith member indicates the global point number of which
-	// the ith point is a surrounding point
-	amat::Array2d<int > lpoin(npoin,1);
-	for(int i = 0; i < npoin; i++) lpoin(i,0) = -1;	// initialize this std::vector to -1
-	int istor = 0;
-
 	// first pass: calculate storage needed for psup
-	for(fint ip = 0; ip < npoin; ip++)
+#pragma omp parallel default(shared)
 	{
-		lpoin(ip,0) = ip;		// the point ip itself is not counted as a surrounding point of ip
-		// Loop over elements surrounding this point
-		for(fint ie = esup_p(ip,0); ie <= esup_p(ip+1,0)-1; ie++)
+		std::vector<fint> nbrs;
+#pragma omp for
+		for(fint ip = 0; ip < npoin; ip++)
 		{
-			fint ielem = esup(ie,0);		// element number
-
-			// find local node number of ip in ielem
-			int inode = -1;
-			for(int jnode = 0; jnode < nnode[ielem]; jnode++)
-				if(inpoel(ielem,jnode) == ip) inode = jnode;
-#ifdef DEBUG
-			if(inode == -1) {
-				std::cout << " ! UMesh: compute_topological(): ";
-				std::cout << "inode not found while computing psup!\n";
-			}
-#endif
-
-			// contains true if that local node number is connected to a particular local node.
-			std::vector<bool> nbd(nnode[ielem]);
-			for(int j = 0; j < nnode[ielem]; j++)
-				nbd[j] = false;
-
-			if(nnode[ielem] == 3)
-				for(size_t i = 0; i < nbd.size(); i++)
-					nbd[i] = true;
-			else if(nnode[ielem] == 4)
-				for(int jnode = 0; jnode < nnode[ielem]; jnode++)
-				{
-					if(jnode == (inode + 1) % nnode[ielem]
-							|| jnode == (inode + nnode[ielem]-1) % nnode[ielem])
-						nbd[jnode] = true;
-				}
-
-			//loop over nodes of the element
-			for(int inode = 0; inode < nnode[ielem]; inode++)
-			{
-				//Get global index of this node
-				int jpoin = inpoel(ielem, inode);
-
-				/* test if this point as already been counted as a surrounding point of ip,
-				 * and whether it's connected to ip.
-				 */
-				if(lpoin(jpoin,0) != ip && nbd[inode])
-				{
-					istor++;
-					lpoin(jpoin,0) = ip;		// set this point as a surrounding point of ip
-				}
-			}
+			getPointsSurroundingPoint(ip, esup_p, esup, inpoel, nnode, nbrs);
+			psup_p(ip+1,0) = static_cast<fint>(nbrs.size());
 		}
-		psup_p(ip+1,0) = istor;
 	}
 
-	psup.resize(istor,1);
+	inclusive_scan(&psup_p(0,0), static_cast<size_t>(npoin+1));
+
+	psup.resize(psup_p(npoin,0),1);
 
 	//second pass: populate psup
-	istor = 0;
-	for(fint i = 0; i < npoin; i++)
-		lpoin(i,0) = -1;
-	for(fint ip = 0; ip < npoin; ip++)
+#pragma omp parallel default(shared)
 	{
-		lpoin(ip,0) = ip;		// the point ip itself is not counted as a surrounding point of ip
-		// Loop over elements surrounding this point
-		for(int ie = esup_p(ip,0); ie <= esup_p(ip+1,0)-1; ie++)
+		std::vector<fint> nbrs;
+#pragma omp for
+		for(fint ip = 0; ip < npoin; ip++)
 		{
-			fint ielem = esup(ie,0);		// element number
-
-			// find local node number of ip in ielem
-			int inode = -1;
-			for(int jnode = 0; jnode < nnode[ielem]; jnode++)
-				if(inpoel(ielem,jnode) == ip) inode = jnode;
-#ifdef DEBUG
-			if(inode == -1) {
-				std::cout << " ! UMesh: compute_topological(): ";
-				std::cout << "inode not found while computing psup!\n";
-			}
-#endif
-
-			// nbd[j] contains true if ip is connected to local node number j of ielem.
-			std::vector<bool> nbd(nnode[ielem]);
-			for(int j = 0; j < nnode[ielem]; j++)
-				nbd[j] = false;
-
-			if(nnode[ielem] == 3)
-				for(size_t i = 0; i < nbd.size(); i++)
-					nbd[i] = true;
-			else if(nnode[ielem] == 4)
-				for(int jnode = 0; jnode < nnode[ielem]; jnode++)
-				{
-					if(jnode == (inode + 1) % nnode[ielem]
-							|| jnode == (inode + nnode[ielem]-1) % nnode[ielem])
-						nbd[jnode] = true;
-				}
-
-			//loop over nodes of the element
-			for(int inode = 0; inode < nnode[ielem]; inode++)
-			{
-				//Get global index of this node
-				int jpoin = inpoel(ielem, inode);
-				if(lpoin(jpoin,0) != ip && nbd[inode])
-					// test of this point as already been counted as a surrounding point of ip
-				{
-					psup(istor,0) = jpoin;
-					istor++;
-					lpoin(jpoin,0) = ip;		// set this point as a surrounding point of ip
-				}
-			}
+			getPointsSurroundingPoint(ip, esup_p, esup, inpoel, nnode, nbrs);
+			std::copy(nbrs.begin(), nbrs.end(), &psup(0,0) + psup_p(ip,0));
 		}
 	}
 }
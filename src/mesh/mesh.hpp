@@ -7,6 +7,7 @@
 #define FVENS_MESH_H
 
 #include <vector>
+#include <mpi.h>
 #include <petscsys.h>
 #include "aconstants.hpp"
 #include "utilities/aarray2d.hpp"
@@ -20,6 +21,9 @@ typedef int EIndex;
 typedef int FIndex;
 
 class ReplicatedGlobalMeshPartitioner;
+class DistributedMeshBuilder;
+class PartitionedMeshReader;
+class MeshCache;
 
 /// Hybrid unstructured mesh class supporting triangular and quadrangular elements
 template <typename scalar, int ndim>
@@ -28,8 +32,15 @@ class UMesh
 public:
 	UMesh();
 
+	/// Constructs the mesh from mesh data
+	/** If the mesh data contains a precomputed topology, it is used by the next call to
+	 * \ref compute_topological.
+	 */
 	UMesh(const MeshData& md);
 
+	/// Constructs the mesh by taking over the arrays of the mesh data, without copying them
+	UMesh(MeshData&& md);
+
 	~UMesh();
 
 	/* Functions to get mesh data are defined right here so as to enable inlining.
@@ -104,6 +115,11 @@ public:
 	/// Returns the global element index of an element of this subdomain
 	fint gglobalElemIndex(const fint iel) const { return globalElemIndex[iel]; }
 
+	/// Returns the index in \ref intfac of a physical boundary face given by its row in \ref bface
+	/** Available after \ref compute_topological.
+	 */
+	fint gPhyBFaceIndex(const fint ibface) const { return bfaceToFace[ibface]; }
+
 	/// Returns an entry from the face data structure \ref intfac
 	/** \param face Index of the face about which data is needed.
 	 *  Boundary faces, connectivity faces or interior faces are to be accessed using \ref FaceIterators.
@@ -246,12 +262,35 @@ public:
 	}
 
 	/// Re-orders cells according to some permutation vector locally in the subdomain
-	/** \warning If reordering is needed, this function must be called immediately after reading
+	/** The new cell i is the old cell permvec[i]. The volume tags and global indices of the cells
+	 * are permuted along with them, and the local cell indices in \ref connface are updated.
+	 * In a distributed mesh, \ref renumber_global_cells must be called afterwards.
+	 * \warning If reordering is needed, this function must be called immediately after reading
 	 * and distributing the mesh.
-	 * \todo TODO: Update connectivity data between subdomains after reordering the cells!
 	 */
 	void reorder_cells(const PetscInt *const permvec);
 
+	/// Numbers the cells of each subdomain contiguously in the order of their local indices
+	/** The cells of rank r get the global indices offset+i, where i is the local index and offset
+	 * is the total number of cells on the ranks below r. This is the layout of distributed PETSc
+	 * vectors and matrices, which partitioners in general do not produce, and it is kept after
+	 * cells are reordered. Each subdomain then exchanges the new global indices of its cells
+	 * adjacent to connectivity faces with its neighbours, which update column 3 of their
+	 * \ref connface. This is collective over the communicator.
+	 *
+	 * The ghost indices of vectors (\ref getConnectivityGlobalIndices) and the communication
+	 * pattern of trace vectors must be set up after this.
+	 * \param comm The communicator over which the mesh is distributed
+	 */
+	void renumber_global_cells(const MPI_Comm comm);
+
+	/// Re-orders the physical boundary faces according to some permutation vector
+	/** The new face i is the old face permvec[i], as in \ref reorder_cells.
+	 * \warning Like \ref reorder_cells, this must be called before the topological structures
+	 * are computed.
+	 */
+	void reorder_boundary_faces(const fint *const permvec);
+
 	/** Stores (in array bpointsb) for each boundary point: the associated global point number
 	 * and the two bfaces associated with it.
 	 */
@@ -279,6 +318,10 @@ public:
 	 * elements surrounding faces along with points in faces (intfac),
 	 * element-face connectivity array elemface (for each facet of each element,
 	 * it stores the intfac face number)
+	 *
+	 * If the mesh was constructed from mesh data containing esuel and intfac (see
+	 * writeBinaryMeshWithTopology), and the cells and boundary faces have not been reordered since,
+	 * those are used instead of searching for neighbours and generating the faces again.
 	 */
 	void compute_topological();
 
@@ -327,6 +370,9 @@ public:
 	EIndex getFaceEIndex(const bool phyboundary, const fint iface, const fint elem) const;
 
 	friend class ReplicatedGlobalMeshPartitioner;
+	friend class DistributedMeshBuilder;
+	friend class PartitionedMeshReader;
+	friend class MeshCache;
 
 private:
 	// Global properties
@@ -384,6 +430,9 @@ private:
 	 */
 	amat::Array2d<fint> connface;
 
+	/// Index in \ref intfac of the physical boundary face in each row of \ref bface
+	std::vector<fint> bfaceToFace;
+
 	/// Stores global element indices of each element in this subdomain
 	/** Computed by the partitioner.
 	 */
@@ -433,6 +482,9 @@ private:
 
 	bool isBoundaryMaps;			///< Specifies whether bface-intfac maps have been created
 
+	/// Whether \ref esuel and \ref intfac were given with the mesh data and are still valid
+	bool precomputedTopology;
+
 	/** \brief Boundary points list
 	 *
 	 * bpoints contains: bpoints(0) = global point number,
@@ -489,6 +541,15 @@ private:
 	 * Also computes element-face connectivity array \ref elemface in the same loop
 	 * which computes intfac.
 	 *
+	 * Within each block of faces (see \ref FaceIterators), faces are sorted by the pair
+	 * (left cell, right cell), so that loops over faces access cell data in a streaming fashion
+	 * when the cells are well-ordered. For physical boundary faces and connectivity faces, whose
+	 * right cells are ghost cells numbered by face, this means sorting by the left cell
+	 * (and, for connectivity faces, by the face's EIndex in the cell). The rows of \ref connface
+	 * are permuted accordingly, because they define the ghost cell numbering of connectivity
+	 * faces. The physical boundary face array \ref bface is left as it is;
+	 * see \ref gPhyBFaceIndex instead.
+	 *
 	 * \note After the following portion, \ref esuel holds (nelem + face no.) for each ghost cell,
 	 * instead of -1 as before.
 	 */
@@ -496,6 +557,14 @@ private:
 
 	/// Compute a list of points surrounding each point \sa psup
 	void compute_pointsSurroundingPoints();
+
+	/// Sets up the face structure from the precomputed \ref esuel and \ref intfac
+	/** Computes \ref elemface, \ref btags, \ref bfaceToFace, the number of faces and the face
+	 * ranges, as \ref compute_faceConnectivity would. This requires the physical boundary faces in
+	 * \ref bface to be in the order of the faces, as written by writeBinaryMeshWithTopology.
+	 * \return False, with nothing changed, if the precomputed arrays do not fit the mesh
+	 */
+	bool use_precomputed_faceConnectivity();
 };
 
 } // end namespace
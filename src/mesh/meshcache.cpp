@@ -0,0 +1,337 @@
+/** \file
+ * \brief Implementation of the on-disk cache of preprocessed meshes
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <vector>
+#include <sys/stat.h>
+#include "meshcache.hpp"
+#include "utilities/aerrorhandling.hpp"
+#include "utilities/mpiutils.hpp"
+
+namespace fvens {
+
+static const char mesh_cache_magic[8] = {'F','V','E','N','S','M','C','H'};
+static const uint32_t mesh_cache_endiancheck = 0x01020304;
+
+uint64_t fnv1aHash(const void *const data, const size_t nbytes, const uint64_t seed)
+{
+	const unsigned char *const bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed;
+	for(size_t i = 0; i < nbytes; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/// Hashes the contents of a file
+static uint64_t hashFileContents(const std::string path)
+{
+	std::ifstream fin(path, std::ios::binary);
+	if(!fin)
+		throw std::runtime_error("MeshCache: Could not open mesh file " + path);
+
+	std::vector<char> buffer(1<<20);
+	uint64_t hash = fnv1aHash(nullptr, 0);
+	while(fin) {
+		fin.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		hash = fnv1aHash(buffer.data(), static_cast<size_t>(fin.gcount()), hash);
+	}
+	return hash;
+}
+
+/// Hashes the size and modification time of a file
+static uint64_t hashFileIdentity(const std::string path)
+{
+	struct stat st;
+	if(stat(path.c_str(), &st) != 0)
+		throw std::runtime_error("MeshCache: Could not stat mesh file " + path);
+
+	const int64_t size = static_cast<int64_t>(st.st_size);
+	const int64_t mtime = static_cast<int64_t>(st.st_mtime);
+	uint64_t hash = fnv1aHash(&size, sizeof(size));
+	hash = fnv1aHash(&mtime, sizeof(mtime), hash);
+	return hash;
+}
+
+MeshCache::MeshCache(const std::string cachedir, const std::string mesh_path,
+                     const std::string options, const MPI_Comm communicator,
+                     const bool hash_contents)
+	: comm{communicator}, rank{get_mpi_rank(communicator)}, nranks{get_mpi_size(communicator)}
+{
+	uint64_t filehash = 0;
+	if(rank == 0) {
+		filehash = hash_contents ? hashFileContents(mesh_path) : hashFileIdentity(mesh_path);
+		if(mkdir(cachedir.c_str(), 0755) != 0 && errno != EEXIST)
+			throw std::runtime_error("MeshCache: Could not create cache directory " + cachedir);
+	}
+	int ierr = MPI_Bcast(&filehash, 1, MPI_UINT64_T, 0, comm);
+	mpi_throw(ierr, "MeshCache: Could not broadcast mesh file hash");
+
+	ckey = fnv1aHash(&filehash, sizeof(filehash));
+	ckey = fnv1aHash(&nranks, sizeof(nranks), ckey);
+	ckey = fnv1aHash(options.data(), options.size(), ckey);
+
+	const size_t slashpos = mesh_path.find_last_of('/');
+	const std::string meshname
+		= slashpos == std::string::npos ? mesh_path : mesh_path.substr(slashpos+1);
+
+	std::ostringstream fn;
+	fn << cachedir << '/' << meshname << '-' << std::hex << std::setw(16) << std::setfill('0')
+	   << ckey << std::dec << "-r" << rank << "of" << nranks << ".fvmc";
+	fname = fn.str();
+}
+
+MeshCacheHeader MeshCache::expectedHeader() const
+{
+	MeshCacheHeader hdr;
+	std::memset(&hdr, 0, sizeof(MeshCacheHeader));
+	std::memcpy(hdr.magic, mesh_cache_magic, 8);
+	hdr.version = MESH_CACHE_VERSION;
+	hdr.endiancheck = mesh_cache_endiancheck;
+	hdr.realsize = sizeof(freal);
+	hdr.intsize = sizeof(fint);
+	hdr.ndim = NDIM;
+	hdr.rank = rank;
+	hdr.nranks = nranks;
+	hdr.key = ckey;
+	return hdr;
+}
+
+bool MeshCache::available() const
+{
+	int valid = 0;
+	std::ifstream fin(fname, std::ios::binary);
+	if(fin) {
+		MeshCacheHeader hdr;
+		fin.read(reinterpret_cast<char*>(&hdr), sizeof(MeshCacheHeader));
+		const MeshCacheHeader exphdr = expectedHeader();
+		valid = fin && std::memcmp(&hdr, &exphdr, sizeof(MeshCacheHeader)) == 0 ? 1 : 0;
+	}
+
+	int allvalid = 0;
+	const int ierr = MPI_Allreduce(&valid, &allvalid, 1, MPI_INT, MPI_MIN, comm);
+	mpi_throw(ierr, "MeshCache: Could not reduce validity of cache files");
+	return allvalid == 1;
+}
+
+/// Writes a scalar value
+template <typename T>
+static void writeValue(std::ofstream& fout, const T& val)
+{
+	fout.write(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+/// Reads a scalar value
+template <typename T>
+static void readValue(std::ifstream& fin, T& val)
+{
+	fin.read(reinterpret_cast<char*>(&val), sizeof(T));
+}
+
+/// Writes the size and then the contents of a vector
+template <typename T>
+static void writeVector(std::ofstream& fout, const std::vector<T>& v)
+{
+	writeValue(fout, static_cast<int64_t>(v.size()));
+	if(v.size() > 0)
+		fout.write(reinterpret_cast<const char*>(v.data()),
+		           static_cast<std::streamsize>(v.size()*sizeof(T)));
+}
+
+/// Reads a vector written by \ref writeVector
+template <typename T>
+static void readVector(std::ifstream& fin, std::vector<T>& v)
+{
+	int64_t size = 0;
+	readValue(fin, size);
+	v.resize(static_cast<size_t>(size));
+	if(size > 0)
+		fin.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(size*sizeof(T)));
+}
+
+/// Writes the dimensions and then the contents of a row-major array
+template <typename T>
+static void writeArray(std::ofstream& fout, const amat::Array2d<T>& a)
+{
+	writeValue(fout, static_cast<int64_t>(a.rows()));
+	writeValue(fout, static_cast<int64_t>(a.cols()));
+	if(a.msize() > 0)
+		fout.write(reinterpret_cast<const char*>(a.const_row_pointer(0)),
+		           static_cast<std::streamsize>(a.msize()*sizeof(T)));
+}
+
+/// Reads an array written by \ref writeArray
+template <typename T>
+static void readArray(std::ifstream& fin, amat::Array2d<T>& a)
+{
+	int64_t nrows = 0, ncols = 0;
+	readValue(fin, nrows);
+	readValue(fin, ncols);
+	a.resize(static_cast<fint>(nrows), static_cast<fint>(ncols));
+	if(a.msize() > 0)
+		fin.read(reinterpret_cast<char*>(a.row_pointer(0)),
+		         static_cast<std::streamsize>(a.msize()*sizeof(T)));
+}
+
+UMesh<freal,NDIM> MeshCache::load() const
+{
+	std::ifstream fin(fname, std::ios::binary);
+	if(!fin)
+		throw std::runtime_error("MeshCache: Could not open cache file " + fname);
+
+	MeshCacheHeader hdr;
+	readValue(fin, hdr);
+	const MeshCacheHeader exphdr = expectedHeader();
+	if(!fin || std::memcmp(&hdr, &exphdr, sizeof(MeshCacheHeader)) != 0)
+		throw std::runtime_error("MeshCache: Invalid cache file " + fname);
+
+	UMesh<freal,NDIM> m;
+
+	readValue(fin, m.npoinglobal);
+	readValue(fin, m.nelemglobal);
+	readValue(fin, m.npoin);
+	readValue(fin, m.nelem);
+	readValue(fin, m.nbface);
+	readValue(fin, m.maxnnode);
+	readValue(fin, m.maxnfael);
+	readValue(fin, m.nnofa);
+	readValue(fin, m.nbtag);
+	readValue(fin, m.ndtag);
+	readValue(fin, m.naface);
+	readValue(fin, m.ninface);
+	readValue(fin, m.nconnface);
+	readValue(fin, m.nbpoin);
+	readValue(fin, m.connBFaceStart);
+	readValue(fin, m.connBFaceEnd);
+	readValue(fin, m.subDomFaceStart);
+	readValue(fin, m.subDomFaceEnd);
+	readValue(fin, m.domFaceStart);
+	readValue(fin, m.domFaceEnd);
+	readValue(fin, m.phyBFaceStart);
+	readValue(fin, m.phyBFaceEnd);
+	uint8_t isboundarymaps = 0;
+	readValue(fin, isboundarymaps);
+	m.isBoundaryMaps = isboundarymaps != 0;
+
+	readVector(fin, m.nnode);
+	readVector(fin, m.nfael);
+	readVector(fin, m.bfaceToFace);
+	readVector(fin, m.globalElemIndex);
+	readVector(fin, m.connGlobalIndices);
+
+	readArray(fin, m.coords);
+	readArray(fin, m.inpoel);
+	readArray(fin, m.bface);
+	readArray(fin, m.vol_regions);
+	readArray(fin, m.connface);
+	readArray(fin, m.esup_p);
+	readArray(fin, m.esup);
+	readArray(fin, m.psup_p);
+	readArray(fin, m.psup);
+	readArray(fin, m.esuel);
+	readArray(fin, m.intfac);
+	readArray(fin, m.btags);
+	readArray(fin, m.elemface);
+	readArray(fin, m.bifmap);
+	readArray(fin, m.ifbmap);
+	readArray(fin, m.bpoints);
+	readArray(fin, m.bpointsb);
+	readArray(fin, m.bfacebp);
+	readArray(fin, m.area);
+	readArray(fin, m.facemetric);
+
+	if(!fin)
+		throw std::runtime_error("MeshCache: Cache file " + fname + " is truncated");
+
+	return m;
+}
+
+void MeshCache::store(const UMesh<freal,NDIM>& m) const
+{
+	const std::string tmpname = fname + ".tmp";
+	std::ofstream fout(tmpname, std::ios::binary);
+	if(!fout)
+		throw std::runtime_error("MeshCache: Could not open cache file " + tmpname);
+
+	writeValue(fout, expectedHeader());
+
+	writeValue(fout, m.npoinglobal);
+	writeValue(fout, m.nelemglobal);
+	writeValue(fout, m.npoin);
+	writeValue(fout, m.nelem);
+	writeValue(fout, m.nbface);
+	writeValue(fout, m.maxnnode);
+	writeValue(fout, m.maxnfael);
+	writeValue(fout, m.nnofa);
+	writeValue(fout, m.nbtag);
+	writeValue(fout, m.ndtag);
+	writeValue(fout, m.naface);
+	writeValue(fout, m.ninface);
+	writeValue(fout, m.nconnface);
+	writeValue(fout, m.nbpoin);
+	writeValue(fout, m.connBFaceStart);
+	writeValue(fout, m.connBFaceEnd);
+	writeValue(fout, m.subDomFaceStart);
+	writeValue(fout, m.subDomFaceEnd);
+	writeValue(fout, m.domFaceStart);
+	writeValue(fout, m.domFaceEnd);
+	writeValue(fout, m.phyBFaceStart);
+	writeValue(fout, m.phyBFaceEnd);
+	writeValue(fout, static_cast<uint8_t>(m.isBoundaryMaps ? 1 : 0));
+
+	writeVector(fout, m.nnode);
+	writeVector(fout, m.nfael);
+	writeVector(fout, m.bfaceToFace);
+	writeVector(fout, m.globalElemIndex);
+	writeVector(fout, m.connGlobalIndices);
+
+	writeArray(fout, m.coords);
+	writeArray(fout, m.inpoel);
+	writeArray(fout, m.bface);
+	writeArray(fout, m.vol_regions);
+	writeArray(fout, m.connface);
+	writeArray(fout, m.esup_p);
+	writeArray(fout, m.esup);
+	writeArray(fout, m.psup_p);
+	writeArray(fout, m.psup);
+	writeArray(fout, m.esuel);
+	writeArray(fout, m.intfac);
+	writeArray(fout, m.btags);
+	writeArray(fout, m.elemface);
+	writeArray(fout, m.bifmap);
+	writeArray(fout, m.ifbmap);
+	writeArray(fout, m.bpoints);
+	writeArray(fout, m.bpointsb);
+	writeArray(fout, m.bfacebp);
+	writeArray(fout, m.area);
+	writeArray(fout, m.facemetric);
+
+	fout.close();
+	if(!fout)
+		throw std::runtime_error("MeshCache: Could not write cache file " + tmpname);
+	if(std::rename(tmpname.c_str(), fname.c_str()) != 0)
+		throw std::runtime_error("MeshCache: Could not rename " + tmpname + " to " + fname);
+}
+
+}
@@ -0,0 +1,113 @@
+/** \file
+ * \brief On-disk cache of preprocessed, partitioned meshes
+ *
+ * This file is part of FVENS.
+ *   FVENS is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   FVENS is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with FVENS.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FVENS_MESHCACHE_H
+#define FVENS_MESHCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <mpi.h>
+#include "mesh.hpp"
+
+namespace fvens {
+
+/// Version of the mesh cache file format written by this code
+constexpr uint32_t MESH_CACHE_VERSION = 1;
+
+/// Header at the start of each mesh cache file
+struct MeshCacheHeader
+{
+	char magic[8];                ///< "FVENSMCH"
+	uint32_t version;             ///< Format version \sa MESH_CACHE_VERSION
+	uint32_t endiancheck;         ///< Set to 0x01020304 by the writer
+	uint32_t realsize;            ///< sizeof(freal) of the writer
+	uint32_t intsize;             ///< sizeof(fint) of the writer
+	int32_t ndim;                 ///< Spatial dimension
+	int32_t rank;                 ///< Rank whose subdomain is stored in the file
+	int32_t nranks;               ///< Total number of ranks of the run that wrote the file
+	uint32_t reserved;
+	uint64_t key;                 ///< Key of the cache entry \sa MeshCache
+};
+
+/// Computes the 64-bit FNV-1a hash of a sequence of bytes, continuing from a previous hash
+uint64_t fnv1aHash(const void *const data, const size_t nbytes,
+                   const uint64_t seed = 0xcbf29ce484222325ULL);
+
+/// Stores and retrieves preprocessed subdomain meshes on disk
+/** Reading, partitioning and preprocessing a large mesh can take much longer than loading the
+ * result. An entry of the cache consists of one file per rank, which contains everything in the
+ * rank's local \ref UMesh after preprocessing, including the partition (the global indices of
+ * the local cells and the connectivity with other subdomains) and the cell ordering.
+ *
+ * An entry is identified by a key computed from a hash of the mesh file, the number of ranks and
+ * a string describing all the options that affect the preprocessed mesh (eg. the partitioner and
+ * the cell ordering). Changing the mesh file or any of those options thus leads to a new entry
+ * rather than a stale one. By default, the size and modification time of the mesh file are
+ * hashed, which is cheap for any size of mesh; hashing the whole contents instead also detects
+ * a file replaced by one of the same size and time stamp, at the cost of reading it. The files of an entry are named
+ * <mesh file name>-<key in hex>-r<rank>of<number of ranks>.fvmc in the cache directory.
+ *
+ * Each file is first written under a temporary name and then renamed, so that an interrupted
+ * run never leaves a truncated file behind.
+ */
+class MeshCache
+{
+public:
+	/// Sets up access to the cache entry for a mesh and a set of options
+	/** Collective: the mesh file is hashed on the first rank and the hash is broadcast.
+	 * \param cachedir Directory in which cache files are stored; created if it does not exist
+	 * \param mesh_path Path to the mesh file
+	 * \param options Description of all options that affect the preprocessed mesh
+	 * \param comm The communicator over which the mesh is distributed
+	 * \param hash_contents Whether to hash the contents of the mesh file rather than only its
+	 *   size and modification time
+	 */
+	MeshCache(const std::string cachedir, const std::string mesh_path, const std::string options,
+	          const MPI_Comm comm, const bool hash_contents = false);
+
+	/// Key of the cache entry
+	uint64_t key() const { return ckey; }
+
+	/// Path of this rank's cache file
+	const std::string& filename() const { return fname; }
+
+	/// Checks whether a valid cache entry exists for all ranks
+	/** Collective. Only the headers of the files are checked.
+	 */
+	bool available() const;
+
+	/// Reads this rank's preprocessed mesh from the cache
+	UMesh<freal,NDIM> load() const;
+
+	/// Writes this rank's preprocessed mesh to the cache
+	void store(const UMesh<freal,NDIM>& m) const;
+
+protected:
+	MPI_Comm comm;                ///< Communicator over which the mesh is distributed
+	int rank;                     ///< Rank of this process in comm
+	int nranks;                   ///< Size of comm
+	uint64_t ckey;                ///< Key of the cache entry
+	std::string fname;            ///< This rank's cache file
+
+	/// Returns the header this rank's cache file should have
+	MeshCacheHeader expectedHeader() const;
+};
+
+}
+
+#endif
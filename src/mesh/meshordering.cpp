@@ -20,6 +20,9 @@
 #include <vector>
 #include <utility>
 #include <set>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
 #include "utilities/adolcutils.hpp"
 #include "utilities/aerrorhandling.hpp"
 #include "meshordering.hpp"
@@ -401,6 +404,139 @@ void createLinePointGraph(const UMesh<scalar,2>& m, const GraphVertices& gv, Mat
 	petsc_throw(ierr, "Assembly of line-point graph failed!");
 }
 
+/// Number of points along each axis of the grid on which space-filling curves are computed
+static const uint32_t sfc_gridsize = 1u << 16;
+
+/// Index of a grid point along the Hilbert curve
+/** See Wikipedia's "Hilbert curve" article.
+ */
+static inline uint64_t hilbertIndex(uint32_t x, uint32_t y)
+{
+	uint64_t d = 0;
+	for(uint32_t s = sfc_gridsize/2; s > 0; s /= 2)
+	{
+		const uint32_t rx = (x & s) > 0;
+		const uint32_t ry = (y & s) > 0;
+		d += static_cast<uint64_t>(s)*s*((3*rx) ^ ry);
+
+		// rotate the quadrant
+		if(ry == 0) {
+			if(rx == 1) {
+				x = sfc_gridsize-1 - x;
+				y = sfc_gridsize-1 - y;
+			}
+			std::swap(x,y);
+		}
+	}
+	return d;
+}
+
+/// Index of a grid point along the Morton (Z-order) curve, obtained by interleaving the bits
+static inline uint64_t mortonIndex(const uint32_t x, const uint32_t y)
+{
+	uint64_t d = 0;
+	for(int ib = 0; ib < 16; ib++)
+		d |= (static_cast<uint64_t>((x >> ib) & 1u) << (2*ib))
+			| (static_cast<uint64_t>((y >> ib) & 1u) << (2*ib+1));
+	return d;
+}
+
+/// Maps points to the grid covering a given bounding box and computes their curve indices
+/** \param points Coordinates of the points, stored point-wise
+ * \param lo Lower corner of the bounding box
+ * \param extent The largest side of the bounding box; the same scale is used along both axes
+ */
+static std::vector<uint64_t> computeCurveIndices(const std::vector<freal>& points,
+                                                 const freal lo[2], const freal extent,
+                                                 const std::string curve)
+{
+	const bool hilbert = (curve == "hilbert");
+	if(!hilbert && curve != "morton")
+		throw std::runtime_error("Unknown space-filling curve " + curve);
+
+	const freal scale = extent > 0 ? (sfc_gridsize-1)/extent : 0;
+	const size_t npoints = points.size()/2;
+	std::vector<uint64_t> keys(npoints);
+	for(size_t i = 0; i < npoints; i++)
+	{
+		uint32_t ij[2];
+		for(int idim = 0; idim < 2; idim++) {
+			const freal pos = std::min((points[2*i+idim]-lo[idim])*scale, freal(sfc_gridsize-1));
+			ij[idim] = static_cast<uint32_t>(std::max(pos, freal(0)));
+		}
+		keys[i] = hilbert ? hilbertIndex(ij[0],ij[1]) : mortonIndex(ij[0],ij[1]);
+	}
+	return keys;
+}
+
+/// Returns the permutation which sorts the keys, breaking ties by the original index
+static std::vector<fint> sortByKeys(const std::vector<uint64_t>& keys)
+{
+	std::vector<fint> ordering(keys.size());
+	for(size_t i = 0; i < keys.size(); i++)
+		ordering[i] = static_cast<fint>(i);
+	std::stable_sort(ordering.begin(), ordering.end(),
+	                 [&keys](const fint a, const fint b) { return keys[a] < keys[b]; });
+	return ordering;
+}
+
+/// Computes the bounding box of the mesh points
+/** Cell centres and face midpoints are averages of mesh points, so the box covers all of them and
+ * none of them is clamped to the edge of the grid.
+ */
+template <typename scalar>
+static void getBoundingBox(const UMesh<scalar,2>& m, freal lo[2], freal& extent)
+{
+	freal hi[2];
+	for(int idim = 0; idim < 2; idim++) {
+		lo[idim] = std::numeric_limits<freal>::max();
+		hi[idim] = std::numeric_limits<freal>::lowest();
+	}
+	for(fint ipoin = 0; ipoin < m.gnpoin(); ipoin++)
+		for(int idim = 0; idim < 2; idim++) {
+			lo[idim] = std::min(lo[idim], m.gcoords(ipoin,idim));
+			hi[idim] = std::max(hi[idim], m.gcoords(ipoin,idim));
+		}
+	extent = m.gnpoin() == 0 ? 0 : std::max(hi[0]-lo[0], hi[1]-lo[1]);
+}
+
+template <typename scalar>
+std::vector<fint> getSpaceFillingCurveOrdering(const UMesh<scalar,2>& m, const std::string curve)
+{
+	std::vector<freal> centres(m.gnelem()*2);
+	m.compute_cell_centres(&centres[0]);
+
+	freal lo[2], extent;
+	getBoundingBox(m, lo, extent);
+	return sortByKeys(computeCurveIndices(centres, lo, extent, curve));
+}
+
+template <typename scalar>
+void spaceFillingCurveReorder(UMesh<scalar,2>& m, const std::string curve)
+{
+	std::vector<freal> centres(m.gnelem()*2);
+	m.compute_cell_centres(&centres[0]);
+	freal lo[2], extent;
+	getBoundingBox(m, lo, extent);
+
+	const std::vector<fint> cellordering = sortByKeys(computeCurveIndices(centres, lo, extent,
+	                                                                      curve));
+	m.reorder_cells(&cellordering[0]);
+
+	// Boundary faces are ordered by their midpoints on the same grid as the cells
+	std::vector<freal> midpoints(m.gnbface()*2, 0);
+	for(fint iface = 0; iface < m.gnbface(); iface++) {
+		for(int inofa = 0; inofa < m.gnnofa(iface); inofa++)
+			for(int idim = 0; idim < 2; idim++)
+				midpoints[2*iface+idim] += m.gcoords(m.gbface(iface,inofa),idim);
+		for(int idim = 0; idim < 2; idim++)
+			midpoints[2*iface+idim] /= m.gnnofa(iface);
+	}
+	const std::vector<fint> faceordering = sortByKeys(computeCurveIndices(midpoints, lo, extent,
+	                                                                      curve));
+	m.reorder_boundary_faces(&faceordering[0]);
+}
+
 std::vector<PetscInt> getPetscOrdering(Mat G, const char *const ordering)
 {
 	PetscInt rows, cols;
@@ -439,9 +575,13 @@ std::vector<PetscInt> getPetscOrdering(Mat G, const char *const ordering)
 	return ord;
 }
 
+template LineConfig findLines(const UMesh<freal,2>& m, const freal threshold);
 template void lineReorder(UMesh<freal,2>& m, const freal threshold);
 template std::vector<fint> getHybridLineOrdering(const UMesh<freal,2>& m, const freal threshold,
                                                   const char *const ordering);
 template void hybridLineReorder(UMesh<freal,2>& m, const freal threshold, const char *const ordering);
+template std::vector<fint> getSpaceFillingCurveOrdering(const UMesh<freal,2>& m,
+                                                        const std::string curve);
+template void spaceFillingCurveReorder(UMesh<freal,2>& m, const std::string curve);
 
 }
@@ -7,6 +7,8 @@
 #ifndef FVENS_MESH_ORDERING_H
 #define FVENS_MESH_ORDERING_H
 
+#include <string>
+#include <vector>
 #include "mesh.hpp"
 
 namespace fvens {
@@ -32,6 +34,27 @@ void lineReorder(UMesh<scalar,2>& m, const freal threshold);
 template <typename scalar>
 void hybridLineReorder(UMesh<scalar,2>& m, const freal threshold, const char *const ordering);
 
+/// Computes an ordering of the cells along a space-filling curve through their centres
+/** The cell centres are mapped to a uniform 2^16 x 2^16 grid covering the bounding box of the
+ * mesh points, and the cells are sorted by the index of their grid point along the curve. Cells that are close in space
+ * thus get close indices, which improves cache reuse in loops over faces.
+ * \param m The mesh (only coordinates and cell-node connectivity are needed)
+ * \param curve "hilbert" or "morton"
+ * \return The ordering, in the form expected by \ref UMesh::reorder_cells
+ */
+template <typename scalar>
+std::vector<fint> getSpaceFillingCurveOrdering(const UMesh<scalar,2>& m, const std::string curve);
+
+/// Orders the cells and the physical boundary faces along a space-filling curve
+/** Cells are ordered by \ref getSpaceFillingCurveOrdering and the physical boundary faces by the
+ * position of their midpoints along the same curve. Interior faces are generated in the order
+ * of their cells by \ref UMesh::compute_topological, so all face blocks follow the curve.
+ * The topological structures need to be recomputed afterwards.
+ * \param curve "hilbert" or "morton"
+ */
+template <typename scalar>
+void spaceFillingCurveReorder(UMesh<scalar,2>& m, const std::string curve);
+
 }
 
 #endif
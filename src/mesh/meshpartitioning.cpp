@@ -3,7 +3,9 @@
  */
 
 #include <iostream>
+#include <iomanip>
 #include <map>
+#include <algorithm>
 #include <scotch.h>
 #include "meshpartitioning.hpp"
 #include "utilities/mpiutils.hpp"
@@ -244,7 +246,7 @@ void ReplicatedGlobalMeshPartitioner::extractbfaces(const std::map<fint,fint>& p
 		// 		break;
 		// 	}
 		// }
-		const fint globelem = gm.gintfac(iface+gm.gPhyBFaceStart(),0);
+		const fint globelem = gm.gintfac(gm.gPhyBFaceIndex(iface),0);
 		if(elemdist[globelem] == irank)
 		{
 			for(int j = 0; j < gm.nnofa; j++)
@@ -263,7 +265,7 @@ void ReplicatedGlobalMeshPartitioner::extractbfaces(const std::map<fint,fint>& p
 #ifdef DEBUG
 		// Do the global intfac and element partition agree that this face is in this partition?
 		if(reqd) {
-			const fint globelem = gm.gintfac(iface+gm.gPhyBFaceStart(),0);
+			const fint globelem = gm.gintfac(gm.gPhyBFaceIndex(iface),0);
 			assert(elemdist[globelem] == irank);
 		}
 #endif
@@ -366,19 +368,18 @@ void TrivialReplicatedGlobalMeshPartitioner::compute_partition()
 		elemdist[iel] = nranks-1;
 }
 
-ScotchRGMPartitioner::ScotchRGMPartitioner(const UMesh<freal,NDIM>& globalmesh)
-	: ReplicatedGlobalMeshPartitioner(globalmesh)
+ScotchRGMPartitioner::ScotchRGMPartitioner(const UMesh<freal,NDIM>& globalmesh,
+                                           const MeshPartitionConfig& config)
+	: ReplicatedGlobalMeshPartitioner(globalmesh), pconf{config}
 { }
 
-/// Computes the adjacency lists of the graph respresented by cells of the mesh
-/** \param m The mesh; assumes that the elements-surrounding-elements array esuel is already computed.
- */
 ListOfArrays<fint> getCellAdjLists(const UMesh<freal,NDIM>& m)
 {
 	ListOfArrays<fint> loa;
 	loa.ptrs.resize(m.gnelem()+1);
 
 	loa.ptrs[0] = 0;
+#pragma omp parallel for default(shared)
 	for(fint iel = 0; iel < m.gnelem(); iel++)
 	{
 		fint elnumadj = 0;
@@ -394,6 +395,7 @@ ListOfArrays<fint> getCellAdjLists(const UMesh<freal,NDIM>& m)
 	const fint adjsize = loa.ptrs.back();
 	loa.store.resize(adjsize);
 
+#pragma omp parallel for default(shared)
 	for(fint iel = 0; iel < m.gnelem(); iel++)
 	{
 		int k = 0;
@@ -440,8 +442,24 @@ void ScotchRGMPartitioner::compute_partition()
 		printf(" Using Scotch to compute a partition..\n");
 		SCOTCH_Graph *sgraph = SCOTCH_graphAlloc();
 		const ListOfArrays<fint> loa = getCellAdjLists(gm);
-		int ierr = SCOTCH_graphBuild(sgraph, 0, gm.gnelem(), &loa.ptrs[0], NULL, NULL, NULL,
-		                             loa.ptrs.back(), &loa.store[0], NULL);
+
+		std::vector<fint> cellweights(gm.gnelem());
+		std::vector<int> nphybface(gm.gnelem(), 0);
+		for(fint iel = 0; iel < gm.gnelem(); iel++) {
+			for(int j = 0; j < gm.gnfael(iel); j++)
+				if(gm.gesuel(iel,j) >= gm.gnelem())
+					nphybface[iel]++;
+			cellweights[iel] = cellPartitionWeight(gm.gnfael(iel), nphybface[iel], pconf);
+		}
+
+		std::vector<fint> faceweights(loa.store.size());
+		for(fint iel = 0; iel < gm.gnelem(); iel++)
+			for(fint k = loa.ptrs[iel]; k < loa.ptrs[iel+1]; k++)
+				faceweights[k] = facePartitionWeight(nphybface[iel] > 0
+				                                     || nphybface[loa.store[k]] > 0, pconf);
+
+		int ierr = SCOTCH_graphBuild(sgraph, 0, gm.gnelem(), &loa.ptrs[0], NULL, &cellweights[0],
+		                             NULL, loa.ptrs.back(), &loa.store[0], &faceweights[0]);
 		fvens_throw(ierr, "Scotch could not build the global graph!");
 		ierr = SCOTCH_graphCheck(sgraph); fvens_throw(ierr, "Scotch graph is not consistent!");
 
@@ -479,4 +497,84 @@ void ScotchRGMPartitioner::compute_partition()
 	// 	elemdist[iel] = mpisize-1;
 }
 
+PartitionQuality computePartitionQuality(const UMesh<freal,NDIM>& lm,
+                                         const MeshPartitionConfig& pconf, const MPI_Comm comm)
+{
+	const int nranks = get_mpi_size(comm);
+
+	// Cells whose neighbour index is beyond the connectivity ghost cells are on the physical boundary
+	const fint phybstart = lm.gnelem() + lm.gnConnFace();
+	fint load = 0;
+	for(fint iel = 0; iel < lm.gnelem(); iel++) {
+		int nphybface = 0;
+		for(int j = 0; j < lm.gnfael(iel); j++)
+			if(lm.gesuel(iel,j) >= phybstart)
+				nphybface++;
+		load += cellPartitionWeight(lm.gnfael(iel), nphybface, pconf);
+	}
+
+	std::vector<int> nbrranks(lm.gnConnFace());
+	for(fint icface = 0; icface < lm.gnConnFace(); icface++)
+		nbrranks[icface] = static_cast<int>(lm.gconnface(icface,2));
+	std::sort(nbrranks.begin(), nbrranks.end());
+	const int nnbr = static_cast<int>(std::unique(nbrranks.begin(), nbrranks.end())
+	                                  - nbrranks.begin());
+
+	const fint locinfo[4] = {lm.gnelem(), load, lm.gnConnFace(), nnbr};
+	std::vector<fint> allinfo(4*nranks);
+	const int ierr = MPI_Allgather(locinfo, 4, FVENS_MPI_INT, &allinfo[0], 4, FVENS_MPI_INT, comm);
+	mpi_throw(ierr, "computePartitionQuality: Could not gather partition data!");
+
+	PartitionQuality pq;
+	pq.nelem.resize(nranks);
+	pq.load.resize(nranks);
+	pq.nconnface.resize(nranks);
+	pq.nnbrranks.resize(nranks);
+	fint totnconnface = 0;
+	freal sumelem = 0, sumload = 0;
+	for(int irank = 0; irank < nranks; irank++) {
+		pq.nelem[irank] = allinfo[4*irank];
+		pq.load[irank] = allinfo[4*irank+1];
+		pq.nconnface[irank] = allinfo[4*irank+2];
+		pq.nnbrranks[irank] = static_cast<int>(allinfo[4*irank+3]);
+		totnconnface += pq.nconnface[irank];
+		sumelem += static_cast<freal>(pq.nelem[irank]);
+		sumload += static_cast<freal>(pq.load[irank]);
+	}
+
+	// Every cut face is a connectivity face on both sides
+	pq.edgecut = totnconnface/2;
+	pq.elem_imbalance = static_cast<freal>(*std::max_element(pq.nelem.begin(), pq.nelem.end()))
+		* nranks / sumelem;
+	pq.load_imbalance = static_cast<freal>(*std::max_element(pq.load.begin(), pq.load.end()))
+		* nranks / sumload;
+	return pq;
+}
+
+void printPartitionQuality(const PartitionQuality& pq, const bool perrank, std::ostream& os)
+{
+	const int nranks = static_cast<int>(pq.nelem.size());
+	const auto nconnrange = std::minmax_element(pq.nconnface.begin(), pq.nconnface.end());
+	const auto nnbrrange = std::minmax_element(pq.nnbrranks.begin(), pq.nnbrranks.end());
+
+	os << " Partition quality over " << nranks << " ranks:\n"
+	   << "  Cell imbalance (max/avg) = " << pq.elem_imbalance
+	   << ", load imbalance (max/avg) = " << pq.load_imbalance << '\n'
+	   << "  Edge cut = " << pq.edgecut << " faces\n"
+	   << "  Connectivity faces per rank: min " << *nconnrange.first
+	   << ", max " << *nconnrange.second << '\n'
+	   << "  Neighbour ranks per rank: min " << *nnbrrange.first
+	   << ", max " << *nnbrrange.second << '\n';
+
+	if(perrank) {
+		os << "  " << std::setw(8) << "Rank" << std::setw(12) << "Cells" << std::setw(12) << "Load"
+		   << std::setw(12) << "Conn faces" << std::setw(12) << "Neighbours" << '\n';
+		for(int irank = 0; irank < nranks; irank++)
+			os << "  " << std::setw(8) << irank << std::setw(12) << pq.nelem[irank]
+			   << std::setw(12) << pq.load[irank] << std::setw(12) << pq.nconnface[irank]
+			   << std::setw(12) << pq.nnbrranks[irank] << '\n';
+	}
+	os.flush();
+}
+
 }
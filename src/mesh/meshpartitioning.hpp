@@ -10,10 +10,58 @@
 #include <vector>
 #include <map>
 #include <tuple>
+#include <string>
+#include <ostream>
+#include <mpi.h>
 #include "mesh.hpp"
+#include "utilities/listofarrays.hpp"
 
 namespace fvens {
 
+/// Settings for partitioning the mesh among processes
+/** The load of a cell, used as its vertex weight in the dual graph, is
+ *   (triangle_weight or quadrilateral_weight) + boundary_face_weight * (no. of physical boundary
+ *     faces of the cell) + viscous_face_weight * (no. of faces of the cell, viscous flows only).
+ * The weight of each edge of the dual graph, ie., each interior face, is interface_weight, except
+ * that in viscous flows, faces of cells having a physical boundary face get
+ * viscous_interface_weight. These near-wall faces couple the thin cells of boundary layers
+ * strongly through the viscous terms, so cutting them is costlier for the implicit solver.
+ * Weights are only used by graph partitioners; the trivial partitioner ignores them.
+ */
+struct MeshPartitionConfig
+{
+	/// Partitioner: "trivial" (contiguous blocks of cells by index) or "scotch"
+	std::string partitioner = "trivial";
+	int triangle_weight = 3;            ///< Base load of a triangle
+	int quadrilateral_weight = 4;       ///< Base load of a quadrilateral
+	int boundary_face_weight = 1;       ///< Extra load per physical boundary face of a cell
+	int viscous_face_weight = 1;        ///< Extra load per face of a cell for viscous flows
+	int interface_weight = 1;           ///< Weight of an interior face
+	/// Weight of an interior face adjacent to the physical boundary, for viscous flows
+	int viscous_interface_weight = 2;
+	bool viscous = false;               ///< Whether the flow is viscous
+	bool report_per_rank = false;       ///< Whether to print the partition quality for every rank
+};
+
+/// Computes the load of a cell for partitioning \sa MeshPartitionConfig
+/** \param nfael Number of faces of the cell
+ * \param nphybface Number of faces of the cell which lie on the physical boundary
+ */
+inline fint cellPartitionWeight(const int nfael, const int nphybface, const MeshPartitionConfig& pc)
+{
+	return (nfael == 3 ? pc.triangle_weight : pc.quadrilateral_weight)
+		+ pc.boundary_face_weight*nphybface + (pc.viscous ? pc.viscous_face_weight*nfael : 0);
+}
+
+/// Returns the weight of an interior face for partitioning \sa MeshPartitionConfig
+/** \param boundaryadjacent Whether either of the two cells of the face has a face on the physical
+ *   boundary
+ */
+inline fint facePartitionWeight(const bool boundaryadjacent, const MeshPartitionConfig& pc)
+{
+	return pc.viscous && boundaryadjacent ? pc.viscous_interface_weight : pc.interface_weight;
+}
+
 /// Memory-inefficient partitioner that assumes the global mesh is available on all partitions
 class ReplicatedGlobalMeshPartitioner
 {
@@ -22,6 +70,8 @@ public:
 	/** The mesh must be setup with the element adjacency list (esuel) before passing here.
 	 */
 	ReplicatedGlobalMeshPartitioner(const UMesh<freal,NDIM>& global_mesh);
+
+	virtual ~ReplicatedGlobalMeshPartitioner() { }
 	
 	/// Given the global mesh, computes the distribution of the elements
 	virtual void compute_partition() = 0;
@@ -96,14 +146,53 @@ public:
 };
 
 /// A simple partitioner that just serially partitions the mesh using Scotch
+/** The dual graph is weighted according to the partitioning configuration.
+ */
 class ScotchRGMPartitioner : public ReplicatedGlobalMeshPartitioner
 {
 public:
-	ScotchRGMPartitioner(const UMesh<freal,NDIM>& global_mesh);
+	/** The mesh must be setup with all topological connectivity structures before passing here.
+	 * \param config Cell and face weights to use
+	 */
+	ScotchRGMPartitioner(const UMesh<freal,NDIM>& global_mesh,
+	                     const MeshPartitionConfig& config = MeshPartitionConfig());
 
 	void compute_partition();
+
+protected:
+	const MeshPartitionConfig pconf;
 };
 
+/// Measures of the quality of a mesh partition
+/** The vectors hold one entry per rank.
+ */
+struct PartitionQuality
+{
+	std::vector<fint> nelem;           ///< Number of cells
+	std::vector<fint> load;            ///< Total weighted load of the cells \sa cellPartitionWeight
+	std::vector<fint> nconnface;       ///< Number of connectivity faces
+	std::vector<int> nnbrranks;        ///< Number of neighbouring ranks
+	fint edgecut;                      ///< Number of faces shared by cells on different ranks
+	freal elem_imbalance;              ///< Max. number of cells divided by the average
+	freal load_imbalance;              ///< Max. load divided by the average load
+};
+
+/// Computes the quality of the partition from the local subdomain meshes
+/** Collective over comm.
+ * \param lm The local mesh on this rank with the topological structures (esuel) computed
+ * \param pconf The partitioning settings which determine the load of each cell
+ */
+PartitionQuality computePartitionQuality(const UMesh<freal,NDIM>& lm,
+                                         const MeshPartitionConfig& pconf, const MPI_Comm comm);
+
+/// Prints a summary of the partition quality, and optionally the numbers for each rank
+void printPartitionQuality(const PartitionQuality& pq, const bool perrank, std::ostream& os);
+
+/// Computes the adjacency lists of the graph respresented by cells of the mesh
+/** \param m The mesh; assumes that the elements-surrounding-elements array esuel is already computed.
+ */
+ListOfArrays<fint> getCellAdjLists(const UMesh<freal,NDIM>& m);
+
 }
 
 #endif
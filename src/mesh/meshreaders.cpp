@@ -20,11 +20,18 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <numeric>
+#include <limits>
+#include <array>
 #include <boost/algorithm/string.hpp>
 #include "utilities/aerrorhandling.hpp"
 #include "utilities/mpiutils.hpp"
 
 #include "meshreaders.hpp"
+#include "binarymesh.hpp"
 
 namespace fvens {
 
@@ -32,6 +39,11 @@ namespace fvens {
 static MeshData readGmsh2(const std::string mfile);
 static MeshData readSU2(const std::string mfile);
 
+/// Reads one rank's slice of a Gmsh 2 format file \sa readMeshSlice
+static MeshSlice readGmsh2Slice(const std::string mfile, const MPI_Comm comm);
+/// Reads one rank's slice of an SU2 format file \sa readMeshSlice
+static MeshSlice readSU2Slice(const std::string mfile, const MPI_Comm comm);
+
 MeshData readMesh(const std::string mfile)
 {
 	// const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
@@ -42,6 +54,8 @@ MeshData readMesh(const std::string mfile)
 
 	if(parts[parts.size()-1] == "su2")
 		mdata = readSU2(mfile);
+	else if(parts[parts.size()-1] == "fvm")
+		mdata = readBinaryMesh(mfile);
 	else
 		mdata = readGmsh2(mfile);
 
@@ -394,4 +408,946 @@ MeshData readSU2(const std::string mfile)
 	return m;
 }
 
+MeshSlice readMeshSlice(const std::string mfile, const MPI_Comm comm)
+{
+	std::vector<std::string> parts;
+	boost::split(parts, mfile, boost::is_any_of("."));
+
+	if(parts[parts.size()-1] == "su2")
+		return readSU2Slice(mfile, comm);
+	else if(parts[parts.size()-1] == "fvm")
+		return MappedMeshFile(mfile).getMeshSlice(get_mpi_size(comm), get_mpi_rank(comm));
+	else
+		return readGmsh2Slice(mfile, comm);
+}
+
+/// Reads the next integer from a C string and advances the pointer past it
+static inline fint nextInt(const char *& ptr)
+{
+	char *end;
+	const fint val = static_cast<fint>(std::strtol(ptr, &end, 10));
+	ptr = end;
+	return val;
+}
+
+/// Reads the next real number from a C string and advances the pointer past it
+static inline freal nextReal(const char *& ptr)
+{
+	char *end;
+	const freal val = std::strtod(ptr, &end);
+	ptr = end;
+	return val;
+}
+
+/// Gets the properties of a Gmsh 2 element type that we need
+/** \param[in] elmtype Gmsh 2 element type
+ * \param[out] isface True if the element is a boundary face, false if it is a cell
+ * \param[out] nnode Number of nodes of the element
+ * \param[out] nfael Number of faces of the element, if it is a cell
+ * \param[out] nnofa Number of nodes per face
+ * \return False if the element type is not recognized, in which case the outputs are set for
+ *   a linear triangle
+ */
+static bool gmsh2ElementType(const int elmtype, bool& isface, int& nnode, int& nfael, int& nnofa)
+{
+	isface = false;
+	switch(elmtype)
+	{
+		case(1): // linear edge
+			isface = true; nnode = 2; nfael = 0; nnofa = 2;
+			return true;
+		case(8): // quadratic edge
+			isface = true; nnode = 3; nfael = 0; nnofa = 3;
+			return true;
+		case(2): // linear triangles
+			nnode = 3; nfael = 3; nnofa = 2;
+			return true;
+		case(3): // linear quads
+			nnode = 4; nfael = 4; nnofa = 2;
+			return true;
+		case(9): // quadratic triangles
+			nnode = 6; nfael = 3; nnofa = 3;
+			return true;
+		case(16): // quadratic quad (8 nodes)
+			nnode = 8; nfael = 4; nnofa = 3;
+			return true;
+		case(10): // quadratic quad (9 nodes)
+			nnode = 9; nfael = 4; nnofa = 3;
+			return true;
+		default:
+			nnode = 3; nfael = 3; nnofa = 2;
+			return false;
+	}
+}
+
+/// Global sizes of a text mesh file and the positions in it at which the slices of each rank start
+/** One rank scans the file to compute this and broadcasts it, so that the other ranks read only
+ * the lines of their own slices. Positions are byte offsets of lines in the file.
+ */
+struct TextMeshIndex
+{
+	/// Number of points, cells and boundary faces in the whole mesh
+	std::array<fint,3> nglobal;
+	/// maxnnode, maxnfael, nnofa, nbtag and ndtag of \ref MeshSlice
+	std::array<int,5> sizes;
+	std::vector<long long> pointpos;   ///< Position of the first point of each rank's slice
+	std::vector<long long> cellpos;    ///< Position of the first cell of each rank's slice
+	std::vector<long long> bfacepos;   ///< Position of the first boundary face of each rank's slice
+	/// SU2 only: tag of the marker containing the first boundary face of each rank's slice
+	std::vector<long long> bfacetag;
+	/// SU2 only: number of faces of that marker, starting at the first one of the rank's slice
+	std::vector<long long> bfaceleft;
+};
+
+/// Sends the index of a text mesh file computed on rank 0 to the other ranks
+static void broadcastIndex(TextMeshIndex& index, const MPI_Comm comm)
+{
+	const int nranks = get_mpi_size(comm);
+	int ierr = MPI_Bcast(index.nglobal.data(), 3, FVENS_MPI_INT, 0, comm);
+	mpi_throw(ierr, "readMeshSlice: Could not broadcast global mesh sizes!");
+	ierr = MPI_Bcast(index.sizes.data(), 5, MPI_INT, 0, comm);
+	mpi_throw(ierr, "readMeshSlice: Could not broadcast global mesh sizes!");
+
+	for(std::vector<long long> *const v : {&index.pointpos, &index.cellpos, &index.bfacepos,
+	                                       &index.bfacetag, &index.bfaceleft})
+	{
+		v->resize(nranks, 0);
+		ierr = MPI_Bcast(v->data(), nranks, MPI_LONG_LONG, 0, comm);
+		mpi_throw(ierr, "readMeshSlice: Could not broadcast slice positions!");
+	}
+}
+
+/// Records the position of the current entity for each rank whose slice starts with it
+/** \param dist Division of the entities among ranks
+ * \param ientity Index of the current entity
+ * \param pos Position of the current entity in the file
+ * \param nextrank The first rank whose start position has not yet been recorded; updated
+ * \param positions The start positions of the ranks' slices
+ */
+static void recordSliceStart(const BlockDistribution& dist, const fint ientity, const long long pos,
+                             int& nextrank, std::vector<long long>& positions)
+{
+	while(nextrank < dist.nranks && dist.start(nextrank) == ientity)
+		positions[nextrank++] = pos;
+}
+
+/// Scans a Gmsh 2 format file and computes the global sizes and slice positions for all ranks
+static TextMeshIndex indexGmsh2File(std::ifstream& infile, const int nranks)
+{
+	TextMeshIndex index;
+	index.pointpos.assign(nranks, 0);
+	index.cellpos.assign(nranks, 0);
+	index.bfacepos.assign(nranks, 0);
+	index.bfacetag.assign(nranks, 0);
+	index.bfaceleft.assign(nranks, 0);
+	std::string line;
+
+	for(int i = 0; i < 4; i++)		//skip 4 lines
+		std::getline(infile, line);
+
+	std::getline(infile, line);
+	index.nglobal[0] = std::stoi(line);
+
+	// Positions are tracked by adding up line lengths; a '\r' of a DOS line end stays in the line
+	const BlockDistribution pointdist {index.nglobal[0], nranks};
+	long long pos = infile.tellg();
+	int nextrank = 0;
+	for(fint ip = 0; ip < index.nglobal[0]; ip++)
+	{
+		recordSliceStart(pointdist, ip, pos, nextrank, index.pointpos);
+		std::getline(infile, line);
+		pos += static_cast<long long>(line.size()) + 1;
+	}
+
+	std::getline(infile, line);        // 'endnodes'
+	std::getline(infile, line);        // 'elements'
+	std::getline(infile, line);
+	const fint nelm = std::stoi(line);
+
+	// First pass over the elements: get global sizes
+
+	const std::streampos elmstartpos = infile.tellg();
+
+	fint nelemglobal = 0, nbfaceglobal = 0;
+	int maxnnode = 0, maxnfael = 0, nnofa = 2, nbtag = 0, ndtag = 0;
+	bool unknowntype = false;
+
+	for(fint i = 0; i < nelm; i++)
+	{
+		std::getline(infile, line);
+		const char *ptr = line.c_str();
+		nextInt(ptr);
+		const int elmtype = nextInt(ptr);
+		const int ntags = nextInt(ptr);
+
+		bool isface; int nnode, nfael;
+		if(!gmsh2ElementType(elmtype, isface, nnode, nfael, nnofa))
+			unknowntype = true;
+
+		if(isface) {
+			if(ntags > nbtag) nbtag = ntags;
+			nbfaceglobal++;
+		}
+		else {
+			if(ntags > ndtag) ndtag = ntags;
+			if(nnode > maxnnode) maxnnode = nnode;
+			if(nfael > maxnfael) maxnfael = nfael;
+			nelemglobal++;
+		}
+	}
+
+	if(unknowntype) {
+		std::cout << "! readGmsh2Slice(): Element type not recognized.";
+		std::cout << " Setting as linear triangle." << std::endl;
+	}
+	if(nbfaceglobal == 0)
+		std::cout << "readGmsh2Slice(): WARNING: There is no boundary data!" << std::endl;
+
+	index.nglobal[1] = nelemglobal;
+	index.nglobal[2] = nbfaceglobal;
+	index.sizes = {maxnnode, maxnfael, nnofa, nbtag, ndtag};
+
+	// Second pass: find where the slices of cells and boundary faces start
+
+	infile.seekg(elmstartpos);
+	pos = elmstartpos;
+
+	const BlockDistribution elemdist {nelemglobal, nranks};
+	const BlockDistribution bfacedist {nbfaceglobal, nranks};
+	int nextcellrank = 0, nextbfacerank = 0;
+	fint ielem = 0, ibface = 0;
+	for(fint i = 0; i < nelm; i++)
+	{
+		std::getline(infile, line);
+		const char *ptr = line.c_str();
+		nextInt(ptr);
+		const int elmtype = nextInt(ptr);
+
+		bool isface; int nnode, nfael, elnnofa;
+		gmsh2ElementType(elmtype, isface, nnode, nfael, elnnofa);
+		if(isface)
+			recordSliceStart(bfacedist, ibface++, pos, nextbfacerank, index.bfacepos);
+		else
+			recordSliceStart(elemdist, ielem++, pos, nextcellrank, index.cellpos);
+
+		pos += static_cast<long long>(line.size()) + 1;
+	}
+
+	return index;
+}
+
+MeshSlice readGmsh2Slice(const std::string mfile, const MPI_Comm comm)
+{
+	const int nranks = get_mpi_size(comm);
+	const int rank = get_mpi_rank(comm);
+
+	MeshSlice m;
+	std::string line;
+
+	std::ifstream infile;
+	open_file_toRead(mfile, infile);
+
+	TextMeshIndex index;
+	if(rank == 0)
+		index = indexGmsh2File(infile, nranks);
+	broadcastIndex(index, comm);
+
+	m.npoinglobal = index.nglobal[0];
+	m.nelemglobal = index.nglobal[1];
+	m.nbfaceglobal = index.nglobal[2];
+	m.maxnnode = index.sizes[0];
+	m.maxnfael = index.sizes[1];
+	m.nnofa = index.sizes[2];
+	m.nbtag = index.sizes[3];
+	m.ndtag = index.sizes[4];
+
+	const BlockDistribution pointdist {m.npoinglobal, nranks};
+	m.poinstart = pointdist.start(rank);
+	m.npoin = pointdist.end(rank) - m.poinstart;
+	m.coords.resize(m.npoin,NDIM);
+
+	const BlockDistribution elemdist {m.nelemglobal, nranks};
+	m.elemstart = elemdist.start(rank);
+	m.nelem = elemdist.end(rank) - m.elemstart;
+	const BlockDistribution bfacedist {m.nbfaceglobal, nranks};
+	m.bfacestart = bfacedist.start(rank);
+	m.nbface = bfacedist.end(rank) - m.bfacestart;
+
+	m.nnode.resize(m.nelem);
+	m.nfael.resize(m.nelem);
+	m.inpoel.resize(m.nelem, m.maxnnode);
+	m.vol_regions.resize(m.nelem, m.ndtag);
+	m.bface.resize(m.nbface, m.nnofa+m.nbtag);
+
+	infile.clear();
+	infile.seekg(index.pointpos[rank]);
+	for(fint ip = 0; ip < m.npoin; ip++)
+	{
+		std::getline(infile, line);
+		const char *ptr = line.c_str();
+		nextInt(ptr);                        // point number
+		for(int j = 0; j < NDIM; j++)
+			m.coords(ip,j) = nextReal(ptr);
+	}
+
+	// Cells and boundary faces may be interleaved in the elements section, so each of the two
+	//  slices is read from its start position, skipping the other kind of element.
+
+	if(m.nbface > 0)
+		infile.seekg(index.bfacepos[rank]);
+	for(fint locface = 0; locface < m.nbface; )
+	{
+		std::getline(infile, line);
+		const char *ptr = line.c_str();
+		nextInt(ptr);
+		const int elmtype = nextInt(ptr);
+		const int ntags = nextInt(ptr);
+
+		bool isface; int nnode, nfael, nnofa;
+		gmsh2ElementType(elmtype, isface, nnode, nfael, nnofa);
+		if(!isface)
+			continue;
+
+		for(int j = 0; j < m.nbtag; j++)
+			m.bface(locface,m.nnofa+j) = j < ntags ? nextInt(ptr) : 0;
+		for(int j = 0; j < m.nnofa; j++)
+			// -1 to correct for the fact that our numbering starts from zero
+			m.bface(locface,j) = nextInt(ptr)-1;
+		locface++;
+	}
+
+	if(m.nelem > 0)
+		infile.seekg(index.cellpos[rank]);
+	for(fint locelem = 0; locelem < m.nelem; )
+	{
+		std::getline(infile, line);
+		const char *ptr = line.c_str();
+		nextInt(ptr);
+		const int elmtype = nextInt(ptr);
+		const int ntags = nextInt(ptr);
+
+		bool isface; int nnode, nfael, nnofa;
+		gmsh2ElementType(elmtype, isface, nnode, nfael, nnofa);
+		if(isface)
+			continue;
+
+		m.nnode[locelem] = nnode;
+		m.nfael[locelem] = nfael;
+		for(int j = 0; j < ntags; j++) {
+			const int tag = nextInt(ptr);
+			if(j < m.ndtag)
+				m.vol_regions(locelem,j) = tag;
+		}
+		for(int j = 0; j < nnode; j++)
+			m.inpoel(locelem,j) = nextInt(ptr)-1;
+		for(int j = nnode; j < m.maxnnode; j++)
+			m.inpoel(locelem,j) = -1;
+		locelem++;
+	}
+
+	infile.close();
+
+	if(rank == 0)
+		std::cout << "readGmsh2Slice(): No. of points: " << m.npoinglobal
+		          << ", number of elements: " << m.nelemglobal
+		          << ",\nnumber of boundary faces " << m.nbfaceglobal
+		          << ", max no. of nodes per element: " << m.maxnnode
+		          << ",\nno. of nodes per face: " << m.nnofa
+		          << ", max faces per element: " << m.maxnfael << std::endl;
+
+	return m;
+}
+
+/// Reads the value after the '=' of the next keyword line of an SU2 file
+static fint readSU2Value(std::ifstream& fin)
+{
+	std::string dum;
+	std::getline(fin, dum, '='); std::getline(fin,dum);
+	return std::stoi(dum);
+}
+
+/// Scans an SU2 format file and computes the global sizes and slice positions for all ranks
+static TextMeshIndex indexSU2File(std::ifstream& fin, const int nranks)
+{
+	TextMeshIndex index;
+	index.pointpos.assign(nranks, 0);
+	index.cellpos.assign(nranks, 0);
+	index.bfacepos.assign(nranks, 0);
+	index.bfacetag.assign(nranks, 0);
+	index.bfaceleft.assign(nranks, 0);
+	std::string dum;
+
+	const int ndim = readSU2Value(fin);
+	if(ndim != NDIM)
+		std::cout << "readSU2Slice: Mesh is not " << NDIM << "-dimensional!\n";
+
+	// Let's just assume a hybrid grid with triangles and quads
+	index.sizes = {4, 4, 2, 1, 0};
+
+	// Positions are tracked by adding up line lengths; a '\r' of a DOS line end stays in the line
+
+	index.nglobal[1] = readSU2Value(fin);
+	const BlockDistribution elemdist {index.nglobal[1], nranks};
+	long long pos = fin.tellg();
+	int nextrank = 0;
+	for(fint iel = 0; iel < index.nglobal[1]; iel++)
+	{
+		recordSliceStart(elemdist, iel, pos, nextrank, index.cellpos);
+		std::getline(fin, dum);
+		pos += static_cast<long long>(dum.size()) + 1;
+	}
+
+	index.nglobal[0] = readSU2Value(fin);
+	const BlockDistribution pointdist {index.nglobal[0], nranks};
+	pos = fin.tellg();
+	nextrank = 0;
+	for(fint ip = 0; ip < index.nglobal[0]; ip++)
+	{
+		recordSliceStart(pointdist, ip, pos, nextrank, index.pointpos);
+		std::getline(fin, dum);
+		pos += static_cast<long long>(dum.size()) + 1;
+	}
+
+	// Boundary faces - first get the total number of boundary faces
+
+	const int nbmarkers = readSU2Value(fin);
+
+	const std::streampos markerstartpos = fin.tellg();
+	index.nglobal[2] = 0;
+	for(int ib = 0; ib < nbmarkers; ib++)
+	{
+		readSU2Value(fin);
+		const fint numfacs = readSU2Value(fin);
+		index.nglobal[2] += numfacs;
+		for(fint iface = 0; iface < numfacs; iface++)
+			std::getline(fin, dum);
+	}
+
+	fin.clear();
+	fin.seekg(markerstartpos);
+
+	const BlockDistribution bfacedist {index.nglobal[2], nranks};
+	nextrank = 0;
+	fint ibface = 0;
+	for(int ib = 0; ib < nbmarkers; ib++)
+	{
+		const int tag = static_cast<int>(readSU2Value(fin));
+		const fint numfacs = readSU2Value(fin);
+
+		pos = fin.tellg();
+		for(fint iface = 0; iface < numfacs; iface++, ibface++)
+		{
+			const int firstrank = nextrank;
+			recordSliceStart(bfacedist, ibface, pos, nextrank, index.bfacepos);
+			for(int irank = firstrank; irank < nextrank; irank++) {
+				index.bfacetag[irank] = tag;
+				index.bfaceleft[irank] = numfacs - iface;
+			}
+			std::getline(fin, dum);
+			pos += static_cast<long long>(dum.size()) + 1;
+		}
+	}
+
+	return index;
+}
+
+MeshSlice readSU2Slice(const std::string mfile, const MPI_Comm comm)
+{
+	const int nranks = get_mpi_size(comm);
+	const int rank = get_mpi_rank(comm);
+
+	MeshSlice m;
+
+	std::string dum;
+	std::ifstream fin;
+	open_file_toRead(mfile, fin);
+
+	TextMeshIndex index;
+	if(rank == 0)
+		index = indexSU2File(fin, nranks);
+	broadcastIndex(index, comm);
+
+	m.npoinglobal = index.nglobal[0];
+	m.nelemglobal = index.nglobal[1];
+	m.nbfaceglobal = index.nglobal[2];
+	m.maxnnode = index.sizes[0];
+	m.maxnfael = index.sizes[1];
+	m.nnofa = index.sizes[2];
+	m.nbtag = index.sizes[3];
+	m.ndtag = index.sizes[4];
+
+	// read element node connectivity
+
+	const BlockDistribution elemdist {m.nelemglobal, nranks};
+	m.elemstart = elemdist.start(rank);
+	m.nelem = elemdist.end(rank) - m.elemstart;
+	m.inpoel.resize(m.nelem,m.maxnnode);
+	m.vol_regions.resize(m.nelem,m.ndtag);
+	m.nnode.resize(m.nelem); m.nfael.resize(m.nelem);
+
+	fin.clear();
+	fin.seekg(index.cellpos[rank]);
+	for(fint locel = 0; locel < m.nelem; locel++)
+	{
+		std::getline(fin, dum);
+		const char *ptr = dum.c_str();
+		const int id = nextInt(ptr);
+		switch(id)
+		{
+			case 5: // triangle
+				m.nnode[locel] = 3;
+				m.nfael[locel] = 3;
+				break;
+			case 9: // quad
+				m.nnode[locel] = 4;
+				m.nfael[locel] = 4;
+				break;
+			default:
+				throw std::runtime_error("readSU2Slice: Unknown element type!");
+		}
+
+		for(int i = 0; i < m.nnode[locel]; i++)
+			m.inpoel(locel,i) = nextInt(ptr);
+		for(int i = m.nnode[locel]; i < m.maxnnode; i++)
+			m.inpoel(locel,i) = -1;
+	}
+
+	// read coordinates of nodes
+
+	const BlockDistribution pointdist {m.npoinglobal, nranks};
+	m.poinstart = pointdist.start(rank);
+	m.npoin = pointdist.end(rank) - m.poinstart;
+	m.coords.resize(m.npoin,NDIM);
+
+	fin.seekg(index.pointpos[rank]);
+	for(fint ip = 0; ip < m.npoin; ip++)
+	{
+		std::getline(fin, dum);
+		const char *ptr = dum.c_str();
+		for(int j = 0; j < NDIM; j++)
+			m.coords(ip,j) = nextReal(ptr);
+	}
+
+	// read boundary face data; the slice may continue into the following markers
+
+	const BlockDistribution bfacedist {m.nbfaceglobal, nranks};
+	m.bfacestart = bfacedist.start(rank);
+	m.nbface = bfacedist.end(rank) - m.bfacestart;
+	m.bface.resize(m.nbface, m.nnofa+m.nbtag);
+
+	if(m.nbface > 0)
+		fin.seekg(index.bfacepos[rank]);
+	int tag = static_cast<int>(index.bfacetag[rank]);
+	fint markerleft = static_cast<fint>(index.bfaceleft[rank]);
+	for(fint locface = 0; locface < m.nbface; locface++, markerleft--)
+	{
+		while(markerleft == 0) {
+			tag = static_cast<int>(readSU2Value(fin));
+			markerleft = readSU2Value(fin);
+		}
+
+		std::getline(fin, dum);
+		const char *ptr = dum.c_str();
+		nextInt(ptr);                       // face type
+		for(int inofa = 0; inofa < m.nnofa; inofa++)
+			m.bface(locface,inofa) = nextInt(ptr);
+		m.bface(locface,m.nnofa) = tag;
+	}
+
+	fin.close();
+
+	if(rank == 0)
+		std::cout << "readSU2Slice: Number of elements = " << m.nelemglobal
+		          << ", number of boundary faces = " << m.nbfaceglobal << std::endl;
+
+	return m;
+}
+
+/// Information about an entity of a partitioned Gmsh 4 mesh
+struct Gmsh4PartitionedEntity
+{
+	int parentdim;                 ///< Dimension of the entity of the original model it came from
+	int parenttag;                 ///< Tag of the entity of the original model it came from
+	std::vector<int> partitions;   ///< Zero-based indices of partitions this entity belongs to
+	std::vector<int> physicals;    ///< Physical tags of this entity
+};
+
+/// Reads the $Entities section of a Gmsh 4.1 file, after the section header
+/** \return The physical tags of each entity, indexed by (dimension, tag)
+ */
+static std::map<std::pair<int,int>,std::vector<int>> readGmsh4Entities(std::ifstream& infile)
+{
+	std::map<std::pair<int,int>,std::vector<int>> physicals;
+	int nents[4];
+	for(int idim = 0; idim < 4; idim++)
+		infile >> nents[idim];
+
+	for(int idim = 0; idim < 4; idim++)
+		for(int ient = 0; ient < nents[idim]; ient++)
+		{
+			int tag, nphys; double dummy;
+			infile >> tag;
+			// points have coordinates, other entities have bounding boxes
+			for(int j = 0; j < (idim == 0 ? 3 : 6); j++)
+				infile >> dummy;
+			infile >> nphys;
+			std::vector<int>& phys = physicals[std::make_pair(idim,tag)];
+			phys.resize(nphys);
+			for(int j = 0; j < nphys; j++)
+				infile >> phys[j];
+			if(idim > 0) {
+				int nbounding, bdum;
+				infile >> nbounding;
+				for(int j = 0; j < nbounding; j++)
+					infile >> bdum;
+			}
+		}
+
+	return physicals;
+}
+
+/// Reads the $PartitionedEntities section of a Gmsh 4.1 file, after the section header
+/** Ghost entities are not returned.
+ * \param[in,out] infile The file
+ * \param[out] npartitions Total number of partitions
+ * \return The entities, indexed by (dimension, tag)
+ */
+static std::map<std::pair<int,int>,Gmsh4PartitionedEntity>
+readGmsh4PartitionedEntities(std::ifstream& infile, int& npartitions)
+{
+	std::map<std::pair<int,int>,Gmsh4PartitionedEntity> entities;
+	infile >> npartitions;
+
+	int nghost;
+	infile >> nghost;
+	std::set<int> ghosttags;
+	for(int ig = 0; ig < nghost; ig++) {
+		int tag, part;
+		infile >> tag >> part;
+		ghosttags.insert(tag);
+	}
+
+	int nents[4];
+	for(int idim = 0; idim < 4; idim++)
+		infile >> nents[idim];
+
+	for(int idim = 0; idim < 4; idim++)
+		for(int ient = 0; ient < nents[idim]; ient++)
+		{
+			Gmsh4PartitionedEntity ent;
+			int tag, nparts, nphys; double dummy;
+			infile >> tag >> ent.parentdim >> ent.parenttag >> nparts;
+			ent.partitions.resize(nparts);
+			for(int j = 0; j < nparts; j++) {
+				infile >> ent.partitions[j];
+				ent.partitions[j]--;
+			}
+			std::sort(ent.partitions.begin(), ent.partitions.end());
+			for(int j = 0; j < (idim == 0 ? 3 : 6); j++)
+				infile >> dummy;
+			infile >> nphys;
+			ent.physicals.resize(nphys);
+			for(int j = 0; j < nphys; j++)
+				infile >> ent.physicals[j];
+			if(idim > 0) {
+				int nbounding, bdum;
+				infile >> nbounding;
+				for(int j = 0; j < nbounding; j++)
+					infile >> bdum;
+			}
+
+			// Ghost entities hold copies of cells of other partitions
+			if(idim == NDIM && ghosttags.count(tag))
+				continue;
+			entities[std::make_pair(idim,tag)] = ent;
+		}
+
+	return entities;
+}
+
+/// Skips a number of lines in a file
+static inline void skipLines(std::ifstream& infile, const fint nlines)
+{
+	for(fint i = 0; i < nlines; i++)
+		infile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+}
+
+MeshPartitionData readGmsh4Partition(const std::string mfile, const int partition)
+{
+	// Check for one file per partition if there is no single file
+	std::string filename = mfile;
+	if(!std::ifstream(mfile)) {
+		const size_t dotpos = mfile.rfind('.');
+		filename = mfile.substr(0,dotpos) + "_" + std::to_string(partition+1)
+			+ (dotpos == std::string::npos ? "" : mfile.substr(dotpos));
+	}
+
+	std::ifstream infile;
+	open_file_toRead(filename, infile);
+
+	MeshPartitionData m;
+	m.npartitions = 0;
+	m.nnofa = 2;
+
+	std::map<std::pair<int,int>,std::vector<int>> modelphysicals;
+	std::map<std::pair<int,int>,Gmsh4PartitionedEntity> entities;
+
+	// Nodes of this partition's entities, in the order read
+	std::vector<fint> nodetags;
+	std::vector<freal> nodecoords;
+	std::vector<int> nodeinterface;
+
+	// Cells' global node tags, stored contiguously
+	std::vector<fint> cellnodes;
+	std::vector<int> celltags;
+	// Boundary faces' global node tags followed by their tags
+	std::vector<fint> bfacedata;
+	bool unknowntype = false;
+
+	// Returns the entity if it is a non-ghost entity of this partition, nullptr otherwise
+	const auto ownEntity = [&entities,partition](const int dim, const int tag)
+		-> const Gmsh4PartitionedEntity*
+	{
+		const auto it = entities.find(std::make_pair(dim,tag));
+		if(it == entities.end() || !std::binary_search(it->second.partitions.begin(),
+		                                               it->second.partitions.end(), partition))
+			return nullptr;
+		return &it->second;
+	};
+
+	// Physical tag and elementary tag of the original model entity
+	const auto elementTags = [&modelphysicals](const int dim, const int tag,
+	                                           const Gmsh4PartitionedEntity& ent)
+	{
+		const bool hasparent = ent.parentdim == dim;
+		const std::vector<int>& parentphys = modelphysicals[std::make_pair(ent.parentdim,
+		                                                                  ent.parenttag)];
+		const int phystag = hasparent && parentphys.size() > 0 ? parentphys[0]
+			: (ent.physicals.size() > 0 ? ent.physicals[0] : 0);
+		return std::make_pair(phystag, hasparent ? ent.parenttag : tag);
+	};
+
+	std::string line;
+	while(std::getline(infile, line))
+	{
+		if(line.compare(0, 11, "$MeshFormat") == 0)
+		{
+			std::getline(infile, line);
+			const char *ptr = line.c_str();
+			const freal version = nextReal(ptr);
+			const int filetype = nextInt(ptr);
+			if(version < 4.1 - 1e-10 || version >= 5.0)
+				throw std::runtime_error("readGmsh4Partition: " + filename
+				                         + " is not in version 4.1 of the Gmsh format!");
+			if(filetype != 0)
+				throw std::runtime_error("readGmsh4Partition: Binary Gmsh files are not supported!");
+		}
+		else if(line.compare(0, 9, "$Entities") == 0)
+			modelphysicals = readGmsh4Entities(infile);
+		else if(line.compare(0, 20, "$PartitionedEntities") == 0)
+		{
+			entities = readGmsh4PartitionedEntities(infile, m.npartitions);
+			if(partition >= m.npartitions)
+				throw std::runtime_error("readGmsh4Partition: Partition " + std::to_string(partition+1)
+				                         + " requested, but " + filename + " has only "
+				                         + std::to_string(m.npartitions) + " partitions!");
+		}
+		else if(line.compare(0, 6, "$Nodes") == 0)
+		{
+			if(m.npartitions == 0)
+				throw std::runtime_error("readGmsh4Partition: " + filename
+				                         + " is not a partitioned mesh!");
+
+			std::getline(infile, line);
+			const char *ptr = line.c_str();
+			const fint nblocks = nextInt(ptr);
+
+			for(fint iblock = 0; iblock < nblocks; iblock++)
+			{
+				std::getline(infile, line);
+				ptr = line.c_str();
+				const int dim = nextInt(ptr);
+				const int tag = nextInt(ptr);
+				nextInt(ptr);                   // parametric
+				const fint nblocknodes = nextInt(ptr);
+
+				const Gmsh4PartitionedEntity *const ent = ownEntity(dim,tag);
+				if(!ent) {
+					// tags and then coordinates
+					skipLines(infile, 2*nblocknodes);
+					continue;
+				}
+
+				int interface = -1;
+				if(ent->partitions.size() > 1) {
+					interface = static_cast<int>(m.interfacepartitions.size());
+					m.interfacepartitions.emplace_back();
+					for(const int part : ent->partitions)
+						if(part != partition)
+							m.interfacepartitions.back().push_back(part);
+				}
+
+				for(fint i = 0; i < nblocknodes; i++) {
+					std::getline(infile, line);
+					nodetags.push_back(std::stoi(line));
+					nodeinterface.push_back(interface);
+				}
+				for(fint i = 0; i < nblocknodes; i++) {
+					std::getline(infile, line);
+					ptr = line.c_str();
+					for(int j = 0; j < NDIM; j++)
+						nodecoords.push_back(nextReal(ptr));
+				}
+			}
+		}
+		else if(line.compare(0, 9, "$Elements") == 0)
+		{
+			std::getline(infile, line);
+			const char *ptr = line.c_str();
+			const fint nblocks = nextInt(ptr);
+
+			for(fint iblock = 0; iblock < nblocks; iblock++)
+			{
+				std::getline(infile, line);
+				ptr = line.c_str();
+				const int dim = nextInt(ptr);
+				const int tag = nextInt(ptr);
+				const int elmtype = nextInt(ptr);
+				const fint nblockelems = nextInt(ptr);
+
+				const Gmsh4PartitionedEntity *const ent = ownEntity(dim,tag);
+				// Skip other partitions, points and elements lying on partition boundaries
+				if(!ent || (dim != NDIM && dim != NDIM-1) || ent->partitions.size() > 1) {
+					skipLines(infile, nblockelems);
+					continue;
+				}
+
+				bool isface; int nnode, nfael, nnofa;
+				if(!gmsh2ElementType(elmtype, isface, nnode, nfael, nnofa))
+					unknowntype = true;
+				if(isface != (dim == NDIM-1))
+					throw std::runtime_error("readGmsh4Partition: Element type "
+					                         + std::to_string(elmtype)
+					                         + " does not match its entity's dimension!");
+				m.nnofa = nnofa;
+
+				const std::pair<int,int> tags = elementTags(dim, tag, *ent);
+
+				for(fint i = 0; i < nblockelems; i++)
+				{
+					std::getline(infile, line);
+					ptr = line.c_str();
+					nextInt(ptr);                // element tag
+					if(isface) {
+						for(int j = 0; j < nnofa; j++)
+							bfacedata.push_back(nextInt(ptr)-1);
+						bfacedata.insert(bfacedata.end(), {tags.first, tags.second});
+					}
+					else {
+						m.nnode.push_back(nnode);
+						m.nfael.push_back(nfael);
+						for(int j = 0; j < nnode; j++)
+							cellnodes.push_back(nextInt(ptr)-1);
+						celltags.insert(celltags.end(), {tags.first, tags.second});
+					}
+				}
+			}
+		}
+	}
+
+	infile.close();
+
+	if(unknowntype) {
+		std::cout << "! readGmsh4Partition(): Element type not recognized.";
+		std::cout << " Setting as linear triangle." << std::endl;
+	}
+
+	//! Keep only the points used by the cells of this partition, in the order of their tags
+
+	m.pointtags = cellnodes;
+	std::sort(m.pointtags.begin(), m.pointtags.end());
+	m.pointtags.erase(std::unique(m.pointtags.begin(), m.pointtags.end()), m.pointtags.end());
+	m.npoin = static_cast<fint>(m.pointtags.size());
+
+	std::vector<fint> nodeorder(nodetags.size());
+	std::iota(nodeorder.begin(), nodeorder.end(), 0);
+	std::sort(nodeorder.begin(), nodeorder.end(), [&nodetags](const fint i, const fint j) {
+		return nodetags[i] < nodetags[j];
+	});
+
+	m.coords.resize(m.npoin, NDIM);
+	m.pointinterface.resize(m.npoin);
+	for(fint ip = 0, inode = 0; ip < m.npoin; ip++)
+	{
+		// Nodes are 1-based in the file
+		while(inode < static_cast<fint>(nodeorder.size())
+		      && nodetags[nodeorder[inode]]-1 < m.pointtags[ip])
+			inode++;
+		if(inode == static_cast<fint>(nodeorder.size())
+		   || nodetags[nodeorder[inode]]-1 != m.pointtags[ip])
+			throw std::runtime_error("readGmsh4Partition: Node " + std::to_string(m.pointtags[ip]+1)
+			                         + " of partition " + std::to_string(partition+1)
+			                         + " does not belong to any entity of the partition!");
+		for(int j = 0; j < NDIM; j++)
+			m.coords(ip,j) = nodecoords[nodeorder[inode]*NDIM+j];
+		m.pointinterface[ip] = nodeinterface[nodeorder[inode]];
+	}
+
+	const auto pointGlob2Loc = [&m](const fint gpoint) {
+		const auto it = std::lower_bound(m.pointtags.begin(), m.pointtags.end(), gpoint);
+		assert(it != m.pointtags.end() && *it == gpoint);
+		return static_cast<fint>(it - m.pointtags.begin());
+	};
+
+	//! Cells
+
+	m.nelem = static_cast<fint>(m.nnode.size());
+	m.maxnnode = 0; m.maxnfael = 0;
+	for(fint iel = 0; iel < m.nelem; iel++) {
+		m.maxnnode = std::max(m.maxnnode, m.nnode[iel]);
+		m.maxnfael = std::max(m.maxnfael, m.nfael[iel]);
+	}
+
+	m.ndtag = 2;
+	m.inpoel.resize(m.nelem, m.maxnnode);
+	m.vol_regions.resize(m.nelem, m.ndtag);
+	for(fint iel = 0, pos = 0; iel < m.nelem; iel++)
+	{
+		for(int j = 0; j < m.nnode[iel]; j++)
+			m.inpoel(iel,j) = pointGlob2Loc(cellnodes[pos++]);
+		for(int j = m.nnode[iel]; j < m.maxnnode; j++)
+			m.inpoel(iel,j) = -1;
+		for(int j = 0; j < m.ndtag; j++)
+			m.vol_regions(iel,j) = celltags[iel*m.ndtag+j];
+	}
+
+	//! Physical boundary faces
+
+	m.nbtag = 2;
+	const int bw = m.nnofa + m.nbtag;
+	m.nbface = static_cast<fint>(bfacedata.size())/bw;
+	m.bface.resize(m.nbface, bw);
+	for(fint iface = 0; iface < m.nbface; iface++)
+	{
+		for(int j = 0; j < m.nnofa; j++)
+		{
+			const fint gpoint = bfacedata[iface*bw+j];
+			if(!std::binary_search(m.pointtags.begin(), m.pointtags.end(), gpoint))
+				throw std::runtime_error("readGmsh4Partition: Boundary face of partition "
+				                         + std::to_string(partition+1)
+				                         + " does not belong to any cell of the partition!");
+			m.bface(iface,j) = pointGlob2Loc(gpoint);
+		}
+		for(int j = m.nnofa; j < bw; j++)
+			m.bface(iface,j) = bfacedata[iface*bw+j];
+	}
+
+	if(partition == 0)
+		std::cout << "readGmsh4Partition(): No. of partitions: " << m.npartitions
+		          << "; partition 1 has " << m.npoin << " points, " << m.nelem << " elements and "
+		          << m.nbface << " boundary faces" << std::endl;
+
+	return m;
+}
+
 }
@@ -21,6 +21,8 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <mpi.h>
 #include "aconstants.hpp"
 #include "utilities/aarray2d.hpp"
 
@@ -52,20 +54,145 @@ struct MeshData
 
 	/// Volume tags
 	amat::Array2d<int> vol_regions;
+
+	/// Precomputed elements surrounding elements (see UMesh::compute_topological), if available
+	///  in the file; empty otherwise
+	amat::Array2d<fint> esuel;
+
+	/// Precomputed face structure (see UMesh::compute_topological), if available in the file;
+	///  empty otherwise
+	amat::Array2d<fint> intfac;
 };
 
 /// Reads a mesh from a file
 /**
- * The file should be in either the Gmsh 2.0 format or the SU2 format
+ * The file should be in either the Gmsh 2.0 format, the SU2 format or FVENS' binary format.
  * The file extensions should be
  * - msh for Gmsh 2.0
  * - su2 for SU2 format
+ * - fvm for the binary format (see binarymesh.hpp)
  *
  * \note For an SU2 mesh file, string marker names must be replaced with integers
  * before this function is called on it.
  */
 MeshData readMesh(const std::string mfile);
 
+/// Contiguous division of a range of global indices among processes
+/** Every rank except the last gets floor(n/nranks) indices and the last rank gets the rest.
+ * This is the same division as that used by the trivial partitioner.
+ */
+struct BlockDistribution
+{
+	fint nglobal;                  ///< Total number of indices
+	int nranks;                    ///< Number of processes
+
+	/// Number of indices on each rank other than the last
+	fint blocksize() const { return std::max(nglobal/nranks, static_cast<fint>(1)); }
+
+	/// First index owned by a rank
+	fint start(const int rank) const { return std::min(rank*blocksize(), nglobal); }
+
+	/// One past the last index owned by a rank
+	fint end(const int rank) const { return rank == nranks-1 ? nglobal : start(rank+1); }
+
+	/// Rank that owns a global index
+	int owner(const fint i) const { return std::min(static_cast<int>(i/blocksize()), nranks-1); }
+};
+
+/// The part of a mesh file read by one process
+/** Cells, points and physical boundary faces are each divided among the processes in contiguous
+ * blocks of their indices in the file, see \ref BlockDistribution.
+ * Point indices stored in inpoel and bface are global (zero-based) point indices.
+ */
+struct MeshSlice
+{
+	fint npoinglobal;              ///< Number of points in the whole mesh
+	fint nelemglobal;              ///< Number of cells in the whole mesh
+	fint nbfaceglobal;             ///< Number of physical boundary faces in the whole mesh
+	int maxnnode;                  ///< Maximum number of nodes per element in the whole mesh
+	int maxnfael;                  ///< Maximum number of faces per element in the whole mesh
+	int nnofa;                     ///< Number of nodes in a face
+	int nbtag;                     ///< Number of tags for each boundary face
+	int ndtag;                     ///< Number of tags for each element
+
+	fint elemstart;                ///< Global index of the first cell of this slice
+	fint nelem;                    ///< Number of cells in this slice
+	std::vector<int> nnode;        ///< Number of nodes of each cell in this slice
+	std::vector<int> nfael;        ///< Number of faces of each cell in this slice
+	amat::Array2d<fint> inpoel;    ///< Global point indices of the nodes of each cell
+	amat::Array2d<int> vol_regions;///< Volume tags of each cell
+
+	fint poinstart;                ///< Global index of the first point of this slice
+	fint npoin;                    ///< Number of points in this slice
+	amat::Array2d<freal> coords;   ///< Coordinates of points of this slice
+
+	fint bfacestart;               ///< Global index of the first boundary face of this slice
+	fint nbface;                   ///< Number of boundary faces in this slice
+	amat::Array2d<fint> bface;     ///< Global point indices and tags of boundary faces
+};
+
+/// Reads only each rank's slice of a mesh file
+/** Supports the same formats as \ref readMesh. For text formats, rank 0 scans the whole file to
+ * find the global sizes and the byte offsets at which the slices of all ranks start, and
+ * broadcasts them; every rank then seeks to its own slices and reads only those lines.
+ * Only O(global size / nranks) data is stored. Binary files are memory-mapped and only this
+ * rank's portions are read.
+ * Collective over the communicator.
+ * \param mfile Path to the mesh file
+ * \param comm The communicator among whose processes the mesh is divided
+ */
+MeshSlice readMeshSlice(const std::string mfile, const MPI_Comm comm);
+
+/// One partition of a mesh that was partitioned by Gmsh
+/** Point indices in inpoel and bface are local to the partition. The points are ordered by
+ * their global tags in the file.
+ */
+struct MeshPartitionData
+{
+	int npartitions;               ///< Total number of partitions in the mesh file
+
+	fint nelem;                    ///< Number of cells in this partition
+	std::vector<int> nnode;        ///< Number of nodes of each cell
+	std::vector<int> nfael;        ///< Number of faces of each cell
+	int maxnnode;                  ///< Maximum number of nodes per cell in this partition
+	int maxnfael;                  ///< Maximum number of faces per cell in this partition
+	int nnofa;                     ///< Number of nodes in a face
+	int nbtag;                     ///< Number of tags for each boundary face
+	int ndtag;                     ///< Number of tags for each element
+	amat::Array2d<fint> inpoel;    ///< Local point indices of the nodes of each cell
+	amat::Array2d<int> vol_regions;///< Volume tags of each cell
+
+	fint npoin;                    ///< Number of points in this partition
+	amat::Array2d<freal> coords;   ///< Coordinates of the points
+	std::vector<fint> pointtags;   ///< Global (zero-based) index of each point, in ascending order
+
+	/// For each point, an index into \ref interfacepartitions if the point lies on a partition
+	///  boundary, -1 otherwise
+	std::vector<int> pointinterface;
+	/// For each partition-boundary entity of the file touching this partition, the (zero-based)
+	///  indices of the other partitions that share it, in ascending order
+	std::vector<std::vector<int>> interfacepartitions;
+
+	fint nbface;                   ///< Number of physical boundary faces of this partition
+	amat::Array2d<fint> bface;     ///< Local point indices and tags of boundary faces
+};
+
+/// Reads one partition of a mesh file in the Gmsh 4.1 ASCII format, partitioned by Gmsh
+/** Only the entities belonging to the requested partition are parsed and stored; other blocks of
+ * nodes and elements are skipped over.
+ * The mesh can either be in one file or split into one file per partition
+ * (Mesh.PartitionSplitMeshFiles in Gmsh). In the latter case, if mfile is path/name.msh, the file
+ * for partition i (zero-based) is path/name_{i+1}.msh.
+ * The partition-boundary entities (Mesh.PartitionCreateTopology in Gmsh, on by default) are
+ * required.
+ * As with Gmsh 2 files, two tags are stored for each cell and boundary face: the physical tag and
+ * the elementary tag of the original (unpartitioned) model entity.
+ *
+ * \param mfile Path to the mesh file
+ * \param partition Index of the partition to read, starting from zero (one less than Gmsh's)
+ */
+MeshPartitionData readGmsh4Partition(const std::string mfile, const int partition);
+
 }
 
 #endif
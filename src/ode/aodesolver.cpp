@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <memory>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -328,6 +329,51 @@ StatusCode SteadyBackwardEulerSolver<nvars>::addPseudoTimeTerm(const freal cfl,
 	return ierr;
 }
 
+template <int nvars>
+StatusCode SteadyBackwardEulerSolver<nvars>::addPseudoTimeTerm(const freal cfl, Vec dtmvec,
+                                                              const BAIJJacobianLayout<nvars>& layout,
+                                                              Mat M)
+{
+	StatusCode ierr = 0;
+	const UMesh<freal,NDIM> *const m = space->mesh();
+
+	MutableVecHandler<PetscScalar> dth(dtmvec);
+	PetscScalar *const dtm = dth.getArray();
+
+	PetscScalar *ad, *ao;
+	ierr = layout.getArrays(M, &ad, &ao); CHKERRQ(ierr);
+
+	// Each cell owns its diagonal block, so no synchronization is needed
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m->gnelem(); iel++)
+	{
+		dtm[iel] = m->garea(iel) / (cfl*dtm[iel]);
+		PetscScalar *const db = ad + layout.diagonal(iel)*nvars*nvars;
+		for(int i = 0; i < nvars; i++)
+			db[i*nvars+i] += dtm[iel];
+	}
+
+	ierr = layout.restoreArrays(M, &ad, &ao); CHKERRQ(ierr);
+	return ierr;
+}
+
+template <int nvars>
+StatusCode SteadyBackwardEulerSolver<nvars>::addPseudoTimeTerm(const freal cfl, Vec dtmvec,
+                                                              FaceJacobian<nvars>& jac)
+{
+	const UMesh<freal,NDIM> *const m = space->mesh();
+
+	MutableVecHandler<PetscScalar> dth(dtmvec);
+	PetscScalar *const dtm = dth.getArray();
+
+#pragma omp parallel for simd default(shared)
+	for(fint iel = 0; iel < m->gnelem(); iel++)
+		dtm[iel] = m->garea(iel) / (cfl*dtm[iel]);
+
+	jac.add_to_diagonal(dtm);
+	return 0;
+}
+
 template <int nvars>
 StatusCode SteadyBackwardEulerSolver<nvars>::addPseudoTimeTerm_slow(const freal cfl, Vec dtmvec, Mat M)
 {
@@ -383,7 +429,9 @@ StatusCode SteadyBackwardEulerSolver<nvars>::solve(Vec uvec)
 	Mat M, A;
 	ierr = KSPGetOperators(solver, &A, &M); CHKERRQ(ierr);
 
-	const bool ismatrixfree = isMatrixFree(A);
+	// A Jacobian in face-based storage is a shell matrix too, but is assembled like a matrix
+	FaceJacobian<nvars> *const facejac = get_face_jacobian<nvars>(M);
+	const bool ismatrixfree = isMatrixFree(A) && A != M;
 	if(ismatrixfree) {
 		MatrixFreeSpatialJacobian<nvars>* mfA = nullptr;
 		ierr = MatShellGetContext(A, (void**)&mfA); CHKERRQ(ierr);
@@ -399,6 +447,9 @@ StatusCode SteadyBackwardEulerSolver<nvars>::solve(Vec uvec)
 
 	bool tocomputeamginterpolation = false;
 
+	// Block positions in the Jacobian matrix, set up after its first assembly
+	std::unique_ptr<BAIJJacobianLayout<nvars>> jaclayout;
+
 	freal curCFL=0;
 	int step = 0;
 	freal resi = 1.0, resiold = 1.0;
@@ -453,8 +504,21 @@ StatusCode SteadyBackwardEulerSolver<nvars>::solve(Vec uvec)
 
 		ierr = VecGhostUpdateBegin(rvec, ADD_VALUES, SCATTER_REVERSE); CHKERRQ(ierr);
 
-		ierr = MatZeroEntries(M); CHKERRQ(ierr);
-		ierr = space->assemble_jacobian(uvec, M); CHKERRQ(ierr);
+		const bool directassembly = jaclayout && jaclayout->describes(M);
+
+		if(facejac) {
+			facejac->set_zero();
+			ierr = space->assemble_jacobian(uvec, *facejac); CHKERRQ(ierr);
+		}
+		else {
+			ierr = MatZeroEntries(M); CHKERRQ(ierr);
+			if(directassembly) {
+				ierr = space->assemble_jacobian(uvec, *jaclayout, M); CHKERRQ(ierr);
+			}
+			else {
+				ierr = space->assemble_jacobian(uvec, M); CHKERRQ(ierr);
+			}
+		}
 
 		// curCFL = linearRamp(config.cflinit, config.cflfin,
 		//                     /*config.rampstart*/30, /*config.rampend*/100, step);
@@ -464,7 +528,15 @@ StatusCode SteadyBackwardEulerSolver<nvars>::solve(Vec uvec)
 		// Add pseudo-time terms to diagonal blocks
 		// NOTE: After the following function call, dtm will contain Vol/(CFL*dt),
 		//   since this is required in case of matrix-free solvers.
-		ierr = addPseudoTimeTerm(curCFL, dtmvec, M); CHKERRQ(ierr);
+		if(facejac) {
+			ierr = addPseudoTimeTerm(curCFL, dtmvec, *facejac); CHKERRQ(ierr);
+		}
+		else if(directassembly) {
+			ierr = addPseudoTimeTerm(curCFL, dtmvec, *jaclayout, M); CHKERRQ(ierr);
+		}
+		else {
+			ierr = addPseudoTimeTerm(curCFL, dtmvec, M); CHKERRQ(ierr);
+		}
 
 		ierr = VecGhostUpdateEnd(rvec, ADD_VALUES, SCATTER_REVERSE); CHKERRQ(ierr);
 
@@ -472,7 +544,13 @@ StatusCode SteadyBackwardEulerSolver<nvars>::solve(Vec uvec)
 		ierr = MatAssemblyEnd(M, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
 	
 		/// Freezes the non-zero structure for efficiency in subsequent time steps.
-		ierr = MatSetOption(M, MAT_NEW_NONZERO_LOCATIONS, PETSC_FALSE); CHKERRQ(ierr);
+		if(!facejac) {
+			ierr = MatSetOption(M, MAT_NEW_NONZERO_LOCATIONS, PETSC_FALSE); CHKERRQ(ierr);
+		}
+
+		// With the structure fixed, later Jacobians can be added directly into the matrix storage
+		if(!jaclayout && BAIJJacobianLayout<nvars>::is_compatible(M))
+			jaclayout.reset(new BAIJJacobianLayout<nvars>(*m, M));
 
 		// setup and solve linear system for the update du
 	
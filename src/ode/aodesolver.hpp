@@ -184,6 +184,15 @@ protected:
 	 */
 	StatusCode addPseudoTimeTerm(const freal cfl, Vec dtmvec, Mat M);
 
+	/// Same as \ref addPseudoTimeTerm but adds directly into the storage of a BAIJ matrix
+	/** \param layout Block positions in M
+	 */
+	StatusCode addPseudoTimeTerm(const freal cfl, Vec dtmvec, const BAIJJacobianLayout<nvars>& layout,
+	                             Mat M);
+
+	/// Same as \ref addPseudoTimeTerm but for a Jacobian in face-based storage
+	StatusCode addPseudoTimeTerm(const freal cfl, Vec dtmvec, FaceJacobian<nvars>& jac);
+
 	/// Same as \ref addPseudoTimeTerm but slower, using non-block assembly
 	StatusCode addPseudoTimeTerm_slow(const freal cfl, Vec dtmvec, Mat M);
 };
@@ -38,6 +38,26 @@ template <typename scalar, typename j_real>
 FlowBC<scalar,j_real>::~FlowBC()
 { }
 
+template <typename scalar, typename j_real>
+void FlowBC<scalar,j_real>::computeGhostStateBatch(const scalar uin[NVARS][FACE_BATCH],
+                                                   const scalar n[NDIM][FACE_BATCH],
+                                                   scalar ughost[NVARS][FACE_BATCH]) const
+{
+	for(int i = 0; i < FACE_BATCH; i++)
+	{
+		scalar ui[NVARS], ni[NDIM], ugi[NVARS];
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			ui[ivar] = uin[ivar][i];
+		for(int idim = 0; idim < NDIM; idim++)
+			ni[idim] = n[idim][i];
+
+		computeGhostState(ui, ni, ugi);
+
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			ughost[ivar][i] = ugi[ivar];
+	}
+}
+
 template <typename scalar, typename j_real>
 InOutFlow<scalar,j_real>::InOutFlow(const int bc_tag,
                                     const IdealGasPhysics<scalar>& gasphysics,
@@ -198,6 +218,17 @@ void Farfield<scalar,j_real>::computeGhostState(const scalar *const ins, const s
 		gs[i] = uinf[i];
 }
 
+template <typename scalar, typename j_real>
+void Farfield<scalar,j_real>::computeGhostStateBatch(const scalar uin[NVARS][FACE_BATCH],
+                                                     const scalar n[NDIM][FACE_BATCH],
+                                                     scalar gs[NVARS][FACE_BATCH]) const
+{
+	for(int ivar = 0; ivar < NVARS; ivar++)
+#pragma omp simd
+		for(int i = 0; i < FACE_BATCH; i++)
+			gs[ivar][i] = uinf[ivar];
+}
+
 template <typename scalar, typename j_real>
 void Farfield<scalar,j_real>::computeGhostStateAndJacobian(const j_real *const ins, const j_real *const n,
                                                            j_real *const __restrict gs,
@@ -225,6 +256,26 @@ void Slipwall<scalar,j_real>::computeGhostState(const scalar *const ins, const s
 	gs[NDIM+1] = ins[NDIM+1];
 }
 
+template <typename scalar, typename j_real>
+void Slipwall<scalar,j_real>::computeGhostStateBatch(const scalar ins[NVARS][FACE_BATCH],
+                                                     const scalar n[NDIM][FACE_BATCH],
+                                                     scalar gs[NVARS][FACE_BATCH]) const
+{
+#pragma omp simd
+	for(int i = 0; i < FACE_BATCH; i++)
+	{
+		scalar momn = 0;
+		for(int idim = 0; idim < NDIM; idim++)
+			momn += ins[idim+1][i]*n[idim][i];
+		const scalar vni = momn/ins[0][i];
+
+		gs[0][i] = ins[0][i];
+		for(int idim = 0; idim < NDIM; idim++)
+			gs[idim+1][i] = ins[idim+1][i] - 2.0*vni*n[idim][i]*ins[0][i];
+		gs[NDIM+1][i] = ins[NDIM+1][i];
+	}
+}
+
 template <typename scalar, typename j_real>
 void Slipwall<scalar,j_real>::computeGhostStateAndJacobian(const j_real *const ins, const j_real *const n,
                                                            j_real *const __restrict gs,
@@ -422,6 +473,17 @@ void Extrapolation<scalar,j_real>::computeGhostState(const scalar *const ins, co
 	}
 }
 
+template <typename scalar, typename j_real>
+void Extrapolation<scalar,j_real>::computeGhostStateBatch(const scalar ins[NVARS][FACE_BATCH],
+                                                          const scalar n[NDIM][FACE_BATCH],
+                                                          scalar gs[NVARS][FACE_BATCH]) const
+{
+	for(int ivar = 0; ivar < NVARS; ivar++)
+#pragma omp simd
+		for(int i = 0; i < FACE_BATCH; i++)
+			gs[ivar][i] = ins[ivar][i];
+}
+
 template <typename scalar, typename j_real>
 void Extrapolation<scalar,j_real>::computeGhostStateAndJacobian(const j_real *const ins,
                                                                 const j_real *const n,
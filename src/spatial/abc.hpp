@@ -72,6 +72,18 @@ public:
 	virtual void computeGhostState(const scalar *const uin, const scalar *const n,
 	                               scalar *const __restrict ughost) const = 0;
 
+	/// Computes the ghost states of a batch of \ref FACE_BATCH faces
+	/** Inputs and outputs are stored variable by variable, as for
+	 * \ref InviscidFlux::get_flux_batch. The default implementation calls
+	 * \ref computeGhostState for each face in turn.
+	 * \param uin Interior conserved states; uin[ivar][i] is variable ivar at face i of the batch
+	 * \param n Unit normal vectors; n[idim][i] is component idim of the normal of face i
+	 * \param ughost Ghost conserved states (on output)
+	 */
+	virtual void computeGhostStateBatch(const scalar uin[NVARS][FACE_BATCH],
+	                                    const scalar n[NDIM][FACE_BATCH],
+	                                    scalar ughost[NVARS][FACE_BATCH]) const;
+
 	/// Computes the Jacobian of the ghost state w.r.t. the interior state
 	/** \param uin Interior conserved state
 	 * \param n Unit normal vector
@@ -186,6 +198,11 @@ public:
 	void computeGhostState(const scalar *const uin, const scalar *const n,
 	                       scalar *const __restrict ughost) const;
 
+	/// Computes the ghost states of a batch of faces in SIMD lanes
+	void computeGhostStateBatch(const scalar uin[NVARS][FACE_BATCH],
+	                            const scalar n[NDIM][FACE_BATCH],
+	                            scalar ughost[NVARS][FACE_BATCH]) const;
+
 	/// Computes the Jacobian of the ghost state w.r.t. the interior state
 	void computeGhostStateAndJacobian(const j_real *const uin, const j_real *const n,
 	                                  j_real *const __restrict ug,
@@ -212,6 +229,11 @@ public:
 	void computeGhostState(const scalar *const uin, const scalar *const n,
 	                       scalar *const __restrict ughost) const;
 
+	/// Computes the ghost states of a batch of faces in SIMD lanes
+	void computeGhostStateBatch(const scalar uin[NVARS][FACE_BATCH],
+	                            const scalar n[NDIM][FACE_BATCH],
+	                            scalar ughost[NVARS][FACE_BATCH]) const;
+
 	/// Computes the Jacobian of the ghost state w.r.t. the interior state
 	void computeGhostStateAndJacobian(const j_real *const uin, const j_real *const n,
 	                                  j_real *const __restrict ug,
@@ -236,6 +258,11 @@ public:
 	void computeGhostState(const scalar *const uin, const scalar *const n,
 	                       scalar *const __restrict ughost) const;
 
+	/// Computes the ghost states of a batch of faces in SIMD lanes
+	void computeGhostStateBatch(const scalar uin[NVARS][FACE_BATCH],
+	                            const scalar n[NDIM][FACE_BATCH],
+	                            scalar ughost[NVARS][FACE_BATCH]) const;
+
 	/// Computes the Jacobian of the ghost state w.r.t. the interior state
 	void computeGhostStateAndJacobian(const j_real *const uin, const j_real *const n,
 	                                  j_real *const __restrict ug,
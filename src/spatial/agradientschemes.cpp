@@ -14,6 +14,19 @@
 namespace fvens
 {
 
+/// Converts a computed gradient entry to the type in which gradients are stored
+template <typename gscalar, typename scalar>
+static inline gscalar storedValue(const scalar x) {
+	return static_cast<gscalar>(x);
+}
+
+#ifdef USE_ADOLC
+template <>
+inline float storedValue<float,adouble>(const adouble x) {
+	return static_cast<float>(x.value());
+}
+#endif
+
 template<typename scalar, int nvars>
 GradientScheme<scalar,nvars>::GradientScheme(const UMesh<scalar,2> *const mesh,
                                              const scalar *const _rc,
@@ -26,6 +39,15 @@ template<typename scalar, int nvars>
 GradientScheme<scalar,nvars>::~GradientScheme()
 { }
 
+template<typename scalar, int nvars>
+void GradientScheme<scalar,nvars>::compute_gradients_single(const amat::Array2dView<scalar> u,
+                                                            const amat::Array2dView<scalar> ug,
+                                                            float *const grads) const
+{
+	throw std::logic_error("GradientScheme: This scheme cannot store gradients in single"
+	                       " precision!");
+}
+
 template<typename scalar, int nvars>
 ZeroGradients<scalar,nvars>::ZeroGradients(const UMesh<scalar,2> *const mesh,
                                            const scalar *const _rc,
@@ -38,8 +60,23 @@ void ZeroGradients<scalar,nvars>::compute_gradients(const amat::Array2dView<scal
                                                     const amat::Array2dView<scalar> ug,
                                                     scalar *const gradarray) const
 {
-	GradBlock_t<scalar,NDIM,nvars> *const grad
-		= reinterpret_cast<GradBlock_t<scalar,NDIM,nvars>*>(gradarray);
+	set_zero(gradarray);
+}
+
+template<typename scalar, int nvars>
+void ZeroGradients<scalar,nvars>::compute_gradients_single(const amat::Array2dView<scalar> u,
+                                                           const amat::Array2dView<scalar> ug,
+                                                           float *const gradarray) const
+{
+	set_zero(gradarray);
+}
+
+template<typename scalar, int nvars>
+template <typename gscalar>
+void ZeroGradients<scalar,nvars>::set_zero(gscalar *const gradarray) const
+{
+	GradBlock_t<gscalar,NDIM,nvars> *const grad
+		= reinterpret_cast<GradBlock_t<gscalar,NDIM,nvars>*>(gradarray);
 #pragma omp parallel for default(shared)
 	for(fint iel = 0; iel < m->gnelem(); iel++)
 	{
@@ -219,9 +256,16 @@ template<typename scalar, int nvars>
 WeightedLeastSquaresGradients<scalar,nvars>::WeightedLeastSquaresGradients(
 		const UMesh<scalar,2> *const mesh,
 		const scalar *const _rc,
-		const scalar *const _rcbp)
-	: GradientScheme<scalar,nvars>(mesh, _rc, _rcbp)
+		const scalar *const _rcbp,
+		const bool precompute_weights)
+	: GradientScheme<scalar,nvars>(mesh, _rc, _rcbp),
+	  precomputed {precompute_weights},
+	  maxnfael {static_cast<int>(mesh->gmaxnfael())},
+	  wsRHS {work.reserve<Eigen::Matrix<scalar,NDIM,nvars,Eigen::DontAlign>>
+	         (precompute_weights ? 0 : mesh->gnelem(), 1)}
 {
+	work.allocate();
+
 	Eigen::Map<const MVector<scalar>> rcm(rc, m->gnelem()+m->gnConnFace(), NDIM);
 	Eigen::Map<const MVector<scalar>> rcbpm(rcbp, m->gnbface(), NDIM);
 
@@ -314,22 +358,128 @@ WeightedLeastSquaresGradients<scalar,nvars>::WeightedLeastSquaresGradients(
 	{
 		V[ielem] = V[ielem].inverse().eval();
 	}
-}
 
-template <typename scalar, int nvars>
-using FMultiVectorArray = std::vector<Eigen::Matrix<scalar,NDIM,nvars,Eigen::DontAlign>>;
+	if(!precomputed)
+		return;
+
+	// The contribution of a face to the gradient of a cell c with neighbour n is
+	//  V_c^{-1} w2 (r_c - r_n) (u_c - u_n), for both cells of the face.
+	nbrs.resize(static_cast<size_t>(m->gnelem())*maxnfael);
+	weights.resize(static_cast<size_t>(m->gnelem())*maxnfael*NDIM);
+
+#pragma omp parallel for default(shared)
+	for(fint ielem = 0; ielem < m->gnelem(); ielem++)
+	{
+		for(EIndex ifael = 0; ifael < m->gnfael(ielem); ifael++)
+		{
+			const fint iface = m->gelemface(ielem,ifael);
+			fint nbr;
+			const scalar *rn;
+			if(iface < m->gPhyBFaceEnd()) {
+				const fint ibpface = iface - m->gPhyBFaceStart();
+				nbr = -1-ibpface;
+				rn = rcbp + ibpface*NDIM;
+			}
+			else {
+				nbr = m->gintfac(iface,0) == ielem ? m->gintfac(iface,1) : m->gintfac(iface,0);
+				rn = rc + nbr*NDIM;
+			}
+
+			Eigen::Matrix<scalar,NDIM,1> dr;
+			scalar w2 = 0;
+			for(int idim = 0; idim < NDIM; idim++) {
+				dr[idim] = rcm(ielem,idim) - rn[idim];
+				w2 += dr[idim]*dr[idim];
+			}
+			w2 = 1.0/w2;
+
+			const Eigen::Matrix<scalar,NDIM,1> wvec = V[ielem]*(w2*dr);
+
+			nbrs[ielem*maxnfael+ifael] = nbr;
+			for(int idim = 0; idim < NDIM; idim++)
+				weights[(ielem*maxnfael+ifael)*NDIM+idim] = wvec[idim];
+		}
+	}
+
+	V.clear();
+	V.shrink_to_fit();
+}
 
 template<typename scalar, int nvars>
 void WeightedLeastSquaresGradients<scalar,nvars>::compute_gradients(const amat::Array2dView<scalar> u,
                                                                     const amat::Array2dView<scalar> ug,
                                                                     scalar *const gradarray) const
+{
+	if(precomputed)
+		compute_gradients_precomputed(u, ug, gradarray);
+	else
+		compute_gradients_facewise(u, ug, gradarray);
+}
+
+template<typename scalar, int nvars>
+void WeightedLeastSquaresGradients<scalar,nvars>
+::compute_gradients_single(const amat::Array2dView<scalar> u,
+                           const amat::Array2dView<scalar> ug,
+                           float *const gradarray) const
+{
+	if(precomputed)
+		compute_gradients_precomputed(u, ug, gradarray);
+	else
+		compute_gradients_facewise(u, ug, gradarray);
+}
+
+template<typename scalar, int nvars>
+template <typename gscalar>
+void WeightedLeastSquaresGradients<scalar,nvars>
+::compute_gradients_precomputed(const amat::Array2dView<scalar> u,
+                                const amat::Array2dView<scalar> ug,
+                                gscalar *const gradarray) const
+{
+	GradBlock_t<gscalar,NDIM,nvars> *const grad
+		= reinterpret_cast<GradBlock_t<gscalar,NDIM,nvars>*>(gradarray);
+
+	// Each cell is visited by one thread only, so no synchronization is needed.
+#pragma omp parallel for default(shared)
+	for(fint ielem = 0; ielem < m->gnelem(); ielem++)
+	{
+		scalar g[NDIM][nvars];
+		for(int idim = 0; idim < NDIM; idim++)
+			for(int ivar = 0; ivar < nvars; ivar++)
+				g[idim][ivar] = 0;
+
+		for(EIndex ifael = 0; ifael < m->gnfael(ielem); ifael++)
+		{
+			const fint nbr = nbrs[ielem*maxnfael+ifael];
+			const scalar *const unbr = nbr >= 0 ? &u(nbr,0) : &ug(-1-nbr,0);
+			const scalar *const w = &weights[(ielem*maxnfael+ifael)*NDIM];
+
+			for(int ivar = 0; ivar < nvars; ivar++)
+			{
+				const scalar du = u(ielem,ivar) - unbr[ivar];
+				for(int idim = 0; idim < NDIM; idim++)
+					g[idim][ivar] += w[idim]*du;
+			}
+		}
+
+		for(int idim = 0; idim < NDIM; idim++)
+			for(int ivar = 0; ivar < nvars; ivar++)
+				grad[ielem](idim,ivar) = storedValue<gscalar>(g[idim][ivar]);
+	}
+}
+
+template<typename scalar, int nvars>
+template <typename gscalar>
+void WeightedLeastSquaresGradients<scalar,nvars>
+::compute_gradients_facewise(const amat::Array2dView<scalar> u,
+                             const amat::Array2dView<scalar> ug,
+                             gscalar *const gradarray) const
 {
 	Eigen::Map<const MVector<scalar>> rcm(rc, m->gnelem()+m->gnConnFace()+m->gnbface(), NDIM);
 	Eigen::Map<const MVector<scalar>> rcbpm(rcbp, m->gnbface(), NDIM);
-	GradBlock_t<scalar,NDIM,nvars> *const grad
-		= reinterpret_cast<GradBlock_t<scalar,NDIM,nvars>*>(gradarray);
-	FMultiVectorArray<scalar,nvars> f;
-	f.resize(m->gnelem());
+	GradBlock_t<gscalar,NDIM,nvars> *const grad
+		= reinterpret_cast<GradBlock_t<gscalar,NDIM,nvars>*>(gradarray);
+	Eigen::Matrix<scalar,NDIM,nvars,Eigen::DontAlign> *const f
+		= work.get<Eigen::Matrix<scalar,NDIM,nvars,Eigen::DontAlign>>(wsRHS);
 
 #pragma omp parallel for default(shared)
 	for(fint ielem = 0; ielem < m->gnelem(); ielem++)
@@ -434,7 +584,7 @@ void WeightedLeastSquaresGradients<scalar,nvars>::compute_gradients(const amat::
 		for(short ivar = 0; ivar < nvars; ivar++)
 		{
 			for(short idim = 0; idim < NDIM; idim++)
-				grad[ielem](idim,ivar) = d(idim,ivar);
+				grad[ielem](idim,ivar) = storedValue<gscalar>(d(idim,ivar));
 		}
 	}
 }
@@ -8,6 +8,7 @@
 #define AGRADIENTSCHEMES_H 1
 
 #include "mesh/mesh.hpp"
+#include "utilities/workspace.hpp"
 
 namespace fvens
 {
@@ -46,6 +47,16 @@ public:
 			const amat::Array2dView<scalar> unkg,    ///< [in] Ghost cell states 
 			scalar *const grads                      ///< [in,out] Gradients output (pre-allocated)
 	                               ) const = 0;
+
+	/// Computes gradients corresponding to a state vector and stores them in single precision
+	/** The gradient of each cell is computed in the precision of scalar and only rounded when it
+	 * is stored. Only available for schemes which compute the gradient of each cell at once, rather
+	 * than summing up contributions into the stored gradients; the default implementation throws.
+	 * The arguments are as in \ref compute_gradients.
+	 */
+	virtual void compute_gradients_single(const amat::Array2dView<scalar> unk,
+	                                      const amat::Array2dView<scalar> unkg,
+	                                      float *const grads) const;
 };
 
 /// Simply sets the gradient to zero
@@ -61,10 +72,18 @@ public:
 	                       const amat::Array2dView<scalar> unkg, 
 	                       scalar *const grads ) const;
 
+	void compute_gradients_single(const amat::Array2dView<scalar> unk,
+	                              const amat::Array2dView<scalar> unkg,
+	                              float *const grads) const;
+
 protected:
 	using GradientScheme<scalar,nvars>::m;
 	using GradientScheme<scalar,nvars>::rc;
 	using GradientScheme<scalar,nvars>::rcbp;
+
+	/// Sets the gradients of all cells to zero in an array of gscalar
+	template <typename gscalar>
+	void set_zero(gscalar *const grads) const;
 };
 
 /**
@@ -91,26 +110,79 @@ protected:
 };
 
 /// Class implementing linear weighted least-squares reconstruction
+/** Since the least-squares matrix of each cell depends only on the geometry, the gradient of a cell
+ * is a fixed linear combination of the differences between the states of its neighbours and its own
+ * state. By default, the coefficient (a vector of NDIM entries) of each face of each cell is
+ * computed once in the constructor, and the gradients are then computed cell by cell as a gather of
+ * state differences, with no synchronization between threads.
+ *
+ * Alternatively, the least-squares right hand side can be re-computed face by face in every call
+ * and multiplied by the inverse least-squares matrix of each cell, as was done before. This is kept
+ * for comparison.
+ */
 template<typename scalar, int nvars>
 class WeightedLeastSquaresGradients : public GradientScheme<scalar,nvars>
 {
 public:
+	/** \param precompute_weights If true, the gradient weights of the faces of each cell are
+	 *   computed once; otherwise, the face-based computation is used.
+	 */
 	WeightedLeastSquaresGradients(const UMesh<scalar,2> *const mesh, 
 	                              const scalar *const _rc,
-	                              const scalar *const _rcbp);
+	                              const scalar *const _rcbp,
+	                              const bool precompute_weights = true);
 
 	void compute_gradients(const amat::Array2dView<scalar> unk, 
 	                       const amat::Array2dView<scalar> unkg, 
 	                       scalar *const grads ) const;
 
+	void compute_gradients_single(const amat::Array2dView<scalar> unk,
+	                              const amat::Array2dView<scalar> unkg,
+	                              float *const grads) const;
+
 protected:
 	using GradientScheme<scalar,nvars>::m;
 	using GradientScheme<scalar,nvars>::rc;
 	using GradientScheme<scalar,nvars>::rcbp;
 
 private:
-	/// The least squares LHS matrix
+	/// Whether the gradient weights are precomputed
+	const bool precomputed;
+
+	/// The inverse of the least squares LHS matrix, only stored if weights are not precomputed
 	DimMatrixArray<scalar> V;
+
+	/// Maximum number of faces of any cell, the row length of \ref nbrs and \ref weights
+	const int maxnfael;
+
+	/// The neighbour across each face of each cell
+	/** For each cell and local face index, the row of the neighbouring subdomain or connectivity
+	 * ghost cell in the state array, or -1-(index of the ghost state) at physical boundary faces.
+	 */
+	std::vector<fint> nbrs;
+
+	/// Gradient weights: for each cell and local face index, NDIM coefficients of the difference
+	///  between the cell's state and its neighbour's state
+	std::vector<scalar> weights;
+
+	/// Computes gradients with precomputed weights and stores them as gscalar
+	template <typename gscalar>
+	void compute_gradients_precomputed(const amat::Array2dView<scalar> unk,
+	                                   const amat::Array2dView<scalar> unkg,
+	                                   gscalar *const grads) const;
+
+	/// Computes gradients by re-computing the least-squares RHS face by face and stores them
+	///  as gscalar
+	template <typename gscalar>
+	void compute_gradients_facewise(const amat::Array2dView<scalar> unk,
+	                                const amat::Array2dView<scalar> unkg,
+	                                gscalar *const grads) const;
+
+	/// Storage for the least-squares RHS of each cell, only used if weights are not precomputed
+	WorkspaceArena work;
+
+	/// Handle of the least-squares RHS in \ref work
+	const int wsRHS;
 };
 
 
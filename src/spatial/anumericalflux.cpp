@@ -31,6 +31,29 @@ InviscidFlux<scalar,j_real>::~InviscidFlux()
 	delete jphy;
 }
 
+template <typename scalar, typename j_real>
+void InviscidFlux<scalar,j_real>::get_flux_batch(const scalar ul[NVARS][FACE_BATCH],
+                                                 const scalar ur[NVARS][FACE_BATCH],
+                                                 const scalar n[NDIM][FACE_BATCH],
+                                                 scalar flux[NVARS][FACE_BATCH]) const
+{
+	for(int i = 0; i < FACE_BATCH; i++)
+	{
+		scalar uli[NVARS], uri[NVARS], ni[NDIM], fluxi[NVARS];
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			uli[ivar] = ul[ivar][i];
+			uri[ivar] = ur[ivar][i];
+		}
+		for(int idim = 0; idim < NDIM; idim++)
+			ni[idim] = n[idim][i];
+
+		get_flux(uli, uri, ni, fluxi);
+
+		for(int ivar = 0; ivar < NVARS; ivar++)
+			flux[ivar][i] = fluxi[ivar];
+	}
+}
+
 template <typename scalar, typename j_real>
 LocalLaxFriedrichsFlux<scalar,j_real>
 ::LocalLaxFriedrichsFlux(const IdealGasPhysics<scalar> *const analyticalflux)
@@ -665,8 +688,9 @@ RoeFlux<scalar,j_real>::RoeFlux(const IdealGasPhysics<scalar> *const analyticalf
 { }
 
 template <typename scalar, typename j_real>
-void RoeFlux<scalar,j_real>::get_flux(const scalar *const ul, const scalar *const ur,
-                                      const scalar *const n, scalar *const __restrict flux) const
+inline
+void RoeFlux<scalar,j_real>::computeFlux(const scalar *const ul, const scalar *const ur,
+                                         const scalar *const n, scalar *const __restrict flux) const
 {
 	scalar vi[NDIM], vj[NDIM], vni, vnj, pi, pj, Hi, Hj;
 	physics->getVarsFromConserved(ul, n, vi, vni, pi, Hi);
@@ -731,6 +755,79 @@ void RoeFlux<scalar,j_real>::get_flux(const scalar *const ul, const scalar *cons
 		flux[ivar] = 0.5*(fi[ivar]+fj[ivar] - adu[ivar]);
 }
 
+template <typename scalar, typename j_real>
+void RoeFlux<scalar,j_real>::get_flux(const scalar *const ul, const scalar *const ur,
+                                      const scalar *const n, scalar *const __restrict flux) const
+{
+	computeFlux(ul, ur, n, flux);
+}
+
+template <typename scalar, typename j_real>
+void RoeFlux<scalar,j_real>::get_flux_batch(const scalar ul[NVARS][FACE_BATCH],
+                                            const scalar ur[NVARS][FACE_BATCH],
+                                            const scalar n[NDIM][FACE_BATCH],
+                                            scalar flux[NVARS][FACE_BATCH]) const
+{
+/* The computation below is the same as in computeFlux, but written for one SIMD lane with
+	 * selects instead of branches, so that the loop can be vectorized. Both alternatives of each
+	 * select are computed beforehand, since the compiler does not otherwise speculate them.
+	 */
+#pragma omp simd
+	for(int i = 0; i < FACE_BATCH; i++)
+	{
+		const scalar nx = n[0][i], ny = n[1][i];
+		const scalar rhoi = ul[0][i], rhoj = ur[0][i];
+
+		const scalar vxi = ul[1][i]/rhoi, vyi = ul[2][i]/rhoi;
+		const scalar vni = vxi*nx + vyi*ny;
+		const scalar pi = (g-1.0)*(ul[3][i] - 0.5*rhoi*(vxi*vxi + vyi*vyi));
+		const scalar Hi = (ul[3][i] + pi)/rhoi;
+		const scalar vxj = ur[1][i]/rhoj, vyj = ur[2][i]/rhoj;
+		const scalar vnj = vxj*nx + vyj*ny;
+		const scalar pj = (g-1.0)*(ur[3][i] - 0.5*rhoj*(vxj*vxj + vyj*vyj));
+		const scalar Hj = (ur[3][i] + pj)/rhoj;
+
+		// Roe averages
+		const scalar Rij = sqrt(rhoj/rhoi);
+		const scalar rhoij = Rij*rhoi;
+		const scalar vxij = (Rij*vxj + vxi)/(Rij + 1.0), vyij = (Rij*vyj + vyi)/(Rij + 1.0);
+		const scalar Hij = (Rij*Hj + Hi)/(Rij + 1.0);
+		const scalar vm2ij = vxij*vxij + vyij*vyij;
+		const scalar vnij = vxij*nx + vyij*ny;
+		const scalar cij = sqrt( (g-1.0)*(Hij - vm2ij*0.5) );
+
+		// eigenvalues with Harten entropy fix
+		const scalar delta = fixeps*cij;
+		const scalar l0 = fabs(vnij-cij), l1 = fabs(vnij), l3 = fabs(vnij+cij);
+		const scalar l0fix = (l0*l0 + delta*delta)/(2.0*delta),
+		      l1fix = (l1*l1 + delta*delta)/(2.0*delta), l3fix = (l3*l3 + delta*delta)/(2.0*delta);
+		const scalar lf0 = l0 < delta ? l0fix : l0;
+		const scalar lf1 = l1 < delta ? l1fix : l1;
+		const scalar lf3 = l3 < delta ? l3fix : l3;
+
+		// products of eigenvalues and wave strengths
+		const scalar devn = vnj-vni, dep = pj-pi, derho = rhoj-rhoi;
+		const scalar la0 = lf0*(dep-rhoij*cij*devn)/(2.0*cij*cij);
+		const scalar la1 = lf1*(derho - dep/(cij*cij));
+		const scalar la2 = lf1*rhoij;
+		const scalar la3 = lf3*(dep+rhoij*cij*devn)/(2.0*cij*cij);
+
+		// A_Roe * dU
+		const scalar adu0 = la0 + la1 + la3;
+		const scalar adu1 = la0*(vxij-cij*nx) + la1*vxij + la2*(vxj-vxi - devn*nx)
+			+ la3*(vxij+cij*nx);
+		const scalar adu2 = la0*(vyij-cij*ny) + la1*vyij + la2*(vyj-vyi - devn*ny)
+			+ la3*(vyij+cij*ny);
+		const scalar adu3 = la0*(Hij-cij*vnij) + la1*vm2ij/2.0
+			+ la2*(vxij*(vxj-vxi) + vyij*(vyj-vyi) - vnij*devn) + la3*(Hij+cij*vnij);
+
+		flux[0][i] = 0.5*(vni*rhoi + vnj*rhoj - adu0);
+		flux[1][i] = 0.5*(vni*ul[1][i] + pi*nx + vnj*ur[1][i] + pj*nx - adu1);
+		flux[2][i] = 0.5*(vni*ul[2][i] + pi*ny + vnj*ur[2][i] + pj*ny - adu2);
+		flux[3][i] = 0.5*(vni*(ul[3][i] + pi) + vnj*(ur[3][i] + pj) - adu3);
+	}
+}
+
 /** \todo Works, but check correctness.
  */
 template <typename scalar, typename j_real>
@@ -1173,9 +1270,10 @@ void HLLCFlux<scalar,j_real>::getStarStateAndJacobian(const j_real u[NVARS], con
 /** \todo See if the implementation can be tweaked to reduce round-off errors.
  */
 template <typename scalar, typename j_real>
-void HLLCFlux<scalar,j_real>::get_flux(const scalar *const ul, const scalar *const ur,
-                                const scalar* const n,
-                                scalar *const __restrict flux) const
+inline
+void HLLCFlux<scalar,j_real>::computeFlux(const scalar *const ul, const scalar *const ur,
+                                          const scalar* const n,
+                                          scalar *const __restrict flux) const
 {
 	scalar vi[NDIM], vj[NDIM], vni, vnj, pi, pj, Hi, Hj, ci, cj;
 	physics->getVarsFromConserved(ul, n, vi, vni, pi, Hi);
@@ -1227,6 +1325,83 @@ void HLLCFlux<scalar,j_real>::get_flux(const scalar *const ul, const scalar *con
 		physics->getDirectionalFlux(ur,n,vnj,pj,flux);
 }
 
+template <typename scalar, typename j_real>
+void HLLCFlux<scalar,j_real>::get_flux(const scalar *const ul, const scalar *const ur,
+                                const scalar* const n,
+                                scalar *const __restrict flux) const
+{
+	computeFlux(ul, ur, n, flux);
+}
+
+template <typename scalar, typename j_real>
+void HLLCFlux<scalar,j_real>::get_flux_batch(const scalar ul[NVARS][FACE_BATCH],
+                                             const scalar ur[NVARS][FACE_BATCH],
+                                             const scalar n[NDIM][FACE_BATCH],
+                                             scalar flux[NVARS][FACE_BATCH]) const
+{
+/* The computation below is the same as in computeFlux, but written for one SIMD lane with
+	 * selects instead of branches, so that the loop can be vectorized. Both star states are
+	 * computed for every face.
+	 */
+#pragma omp simd
+	for(int i = 0; i < FACE_BATCH; i++)
+	{
+		const scalar nx = n[0][i], ny = n[1][i];
+		const scalar rhoi = ul[0][i], rhoj = ur[0][i];
+
+		const scalar vxi = ul[1][i]/rhoi, vyi = ul[2][i]/rhoi;
+		const scalar vni = vxi*nx + vyi*ny;
+		const scalar pi = (g-1.0)*(ul[3][i] - 0.5*rhoi*(vxi*vxi + vyi*vyi));
+		const scalar Hi = (ul[3][i] + pi)/rhoi;
+		const scalar ci = sqrt(g*pi/rhoi);
+		const scalar vxj = ur[1][i]/rhoj, vyj = ur[2][i]/rhoj;
+		const scalar vnj = vxj*nx + vyj*ny;
+		const scalar pj = (g-1.0)*(ur[3][i] - 0.5*rhoj*(vxj*vxj + vyj*vyj));
+		const scalar Hj = (ur[3][i] + pj)/rhoj;
+		const scalar cj = sqrt(g*pj/rhoj);
+
+		// Roe averages
+		const scalar Rij = sqrt(rhoj/rhoi);
+		const scalar vxij = (Rij*vxj + vxi)/(Rij + 1.0), vyij = (Rij*vyj + vyi)/(Rij + 1.0);
+		const scalar Hij = (Rij*Hj + Hi)/(Rij + 1.0);
+		const scalar vm2ij = vxij*vxij + vyij*vyij;
+		const scalar vnij = vxij*nx + vyij*ny;
+		const scalar cij = sqrt( (g-1.0)*(Hij - vm2ij*0.5) );
+
+		// signal speeds
+		const scalar sl = vni-ci > vnij-cij ? vnij-cij : vni-ci;
+		const scalar sr = vnj+cj < vnij+cij ? vnij+cij : vnj+cj;
+		const scalar sm = ( rhoj*vnj*(sr-vnj) - rhoi*vni*(sl-vni) + pi-pj )
+			/ ( rhoj*(sr-vnj) - rhoi*(sl-vni) );
+
+		// differences between the star states and the outer states
+		const scalar pstari = rhoi*(vni-sl)*(vni-sm) + pi;
+		const scalar dui[NVARS] = {
+			rhoi*(sl-vni)/(sl-sm) - rhoi,
+			((sl-vni)*ul[1][i] + (pstari-pi)*nx)/(sl-sm) - ul[1][i],
+			((sl-vni)*ul[2][i] + (pstari-pi)*ny)/(sl-sm) - ul[2][i],
+			((sl-vni)*ul[3][i] - pi*vni + pstari*sm)/(sl-sm) - ul[3][i] };
+		const scalar pstarj = rhoj*(vnj-sr)*(vnj-sm) + pj;
+		const scalar duj[NVARS] = {
+			rhoj*(sr-vnj)/(sr-sm) - rhoj,
+			((sr-vnj)*ur[1][i] + (pstarj-pj)*nx)/(sr-sm) - ur[1][i],
+			((sr-vnj)*ur[2][i] + (pstarj-pj)*ny)/(sr-sm) - ur[2][i],
+			((sr-vnj)*ur[3][i] - pj*vnj + pstarj*sm)/(sr-sm) - ur[3][i] };
+
+		const scalar fi[NVARS] = { vni*rhoi, vni*ul[1][i] + pi*nx, vni*ul[2][i] + pi*ny,
+		                           vni*(ul[3][i] + pi) };
+		const scalar fj[NVARS] = { vnj*rhoj, vnj*ur[1][i] + pj*nx, vnj*ur[2][i] + pj*ny,
+		                           vnj*(ur[3][i] + pj) };
+
+		const bool leftsuper = sl > 0, leftstar = sl <= 0 && sm > 0,
+		      rightstar = sm <= 0 && sr >= 0;
+		for(int ivar = 0; ivar < NVARS; ivar++) {
+			const scalar fstari = fi[ivar] + sl*dui[ivar], fstarj = fj[ivar] + sr*duj[ivar];
+			flux[ivar][i] = leftsuper ? fi[ivar] : leftstar ? fstari : rightstar ? fstarj : fj[ivar];
+		}
+	}
+}
+
 template <typename scalar, typename j_real>
 void HLLCFlux<scalar,j_real>::get_jacobian(const j_real *const ul, const j_real *const ur,
                                            const j_real* const n,
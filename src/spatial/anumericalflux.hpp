@@ -33,6 +33,27 @@ public:
 			const scalar* const n,
 			scalar *const flux) const = 0;
 
+	/// Computes fluxes across a batch of \ref FACE_BATCH faces
+	/** Inputs and outputs are stored variable by variable ("structure of arrays"), so that
+	 * implementations can process the faces of the batch in SIMD lanes. The default
+	 * implementation calls \ref get_flux for each face in turn.
+	 * All entries of the inputs must be valid states and normals, so partial batches must be
+	 * padded (eg. by repeating a face).
+	 * \param[in] ul Left states; ul[ivar][i] is variable ivar of face i of the batch
+	 * \param[in] ur Right states
+	 * \param[in] n Unit normals; n[idim][i] is component idim of the normal of face i
+	 * \param[out] flux Fluxes, stored like the states
+	 */
+	virtual void get_flux_batch(const scalar ul[NVARS][FACE_BATCH],
+	                            const scalar ur[NVARS][FACE_BATCH],
+	                            const scalar n[NDIM][FACE_BATCH],
+	                            scalar flux[NVARS][FACE_BATCH]) const;
+
+	/// Whether \ref get_flux_batch has a vectorized implementation
+	/** If not, it is cheaper to call \ref get_flux directly for each face.
+	 */
+	virtual bool vectorized_batch() const { return false; }
+
 	/// Computes the Jacobian of inviscid flux across a face w.r.t. both left and right states
 	/** dfdl is the `lower' block formed by the coupling between elements adjoining the face,
 	 * while dfdr is the `upper' block.
@@ -207,7 +228,7 @@ protected:
 /** From Blazek \cite{blazek}.
  */
 template <typename scalar, typename j_real = freal>
-class RoeFlux : public RoeAverageBasedFlux<scalar,j_real>
+class RoeFlux final : public RoeAverageBasedFlux<scalar,j_real>
 {
 public:
 	RoeFlux(const IdealGasPhysics<scalar> *const analyticalflux);
@@ -217,6 +238,12 @@ public:
 	void get_flux(const scalar *const ul, const scalar *const ur, const scalar* const n,
 	              scalar *const flux) const;
 
+	/// Computes the fluxes of a batch of faces in SIMD lanes \sa InviscidFlux::get_flux_batch
+	void get_flux_batch(const scalar ul[NVARS][FACE_BATCH], const scalar ur[NVARS][FACE_BATCH],
+	                    const scalar n[NDIM][FACE_BATCH], scalar flux[NVARS][FACE_BATCH]) const;
+
+	bool vectorized_batch() const { return true; }
+
 	/** \sa InviscidFlux::get_jacobian
 	 * \warning The output is *assigned* to the arrays dfdl and dfdr - any prior contents are lost!
 	 */
@@ -232,6 +259,10 @@ protected:
 
 	/// Entropy fix parameter
 	const freal fixeps;
+
+	/// Computes the flux across one face; shared by the single-face and batched versions
+	void computeFlux(const scalar *const ul, const scalar *const ur, const scalar* const n,
+	                 scalar *const __restrict flux) const __attribute((always_inline));
 };
 
 /// Harten Lax Van-Leer numerical flux
@@ -269,7 +300,7 @@ protected:
  * Good for both inviscid and viscous flows.
  */
 template <typename scalar, typename j_real = freal>
-class HLLCFlux : public RoeAverageBasedFlux<scalar,j_real>
+class HLLCFlux final : public RoeAverageBasedFlux<scalar,j_real>
 {
 public:
 	HLLCFlux(const IdealGasPhysics<scalar> *const analyticalflux);
@@ -279,6 +310,12 @@ public:
 	void get_flux(const scalar *const ul, const scalar *const ur, const scalar* const n,
 	              scalar *const flux) const;
 
+	/// Computes the fluxes of a batch of faces in SIMD lanes \sa InviscidFlux::get_flux_batch
+	void get_flux_batch(const scalar ul[NVARS][FACE_BATCH], const scalar ur[NVARS][FACE_BATCH],
+	                    const scalar n[NDIM][FACE_BATCH], scalar flux[NVARS][FACE_BATCH]) const;
+
+	bool vectorized_batch() const { return true; }
+
 	/** \sa InviscidFlux::get_jacobian
 	 * \warning The output is *assigned* to the arrays dfdl and dfdr - any prior contents are lost!
 	 */
@@ -292,6 +329,10 @@ protected:
 	using RoeAverageBasedFlux<scalar,j_real>::getRoeAverages;
 	using RoeAverageBasedFlux<scalar,j_real>::getJacobiansRoeAveragesWrtConserved;
 
+	/// Computes the flux across one face; shared by the single-face and batched versions
+	void computeFlux(const scalar *const ul, const scalar *const ur, const scalar* const n,
+	                 scalar *const __restrict flux) const __attribute((always_inline));
+
 	/// Computes the averaged state between the waves in the Riemann fan
 	/** \param[in] u The state outside the Riemann fan
 	 * \param[in] n Normal to the face
@@ -18,6 +18,7 @@
  */
 
 #include <iostream>
+#include <stdexcept>
 #include "mathutils.hpp"
 #include "areconstruction.hpp"
 #include "reconstruction_utils.hpp"
@@ -31,21 +32,39 @@ template <typename scalar, int nvars>
 SolutionReconstruction<scalar,nvars>::SolutionReconstruction (const UMesh<scalar,2> *const mesh,
                                                               const scalar *const c_centres,
                                                               const scalar *const c_centres_ghost,
-                                                              const amat::Array2d<scalar>& gauss_r)
-	: m{mesh}, ri{c_centres}, ribp{c_centres_ghost}, gr{gauss_r}
+                                                              const FaceGeometry<scalar> *const face_geom,
+                                                              const CellGeometry<scalar> *const cell_geom)
+	: m{mesh}, ri{c_centres}, ribp{c_centres_ghost}, fgeom{face_geom}, cgeom{cell_geom}
 { }
 
 template <typename scalar, int nvars>
 SolutionReconstruction<scalar,nvars>::~SolutionReconstruction()
 { }
 
+template <typename scalar, int nvars>
+void SolutionReconstruction<scalar,nvars>::compute_cell_limiters(const MVector<scalar>& u,
+                                                                 const scalar *const grads,
+                                                                 freal *const lims) const
+{
+	throw std::logic_error("SolutionReconstruction: This reconstruction has no cell limiters!");
+}
+
+template <typename scalar, int nvars>
+void SolutionReconstruction<scalar,nvars>::compute_cell_limiters_single(const MVector<scalar>& u,
+                                                                        const float *const grads,
+                                                                        freal *const lims) const
+{
+	throw std::logic_error("SolutionReconstruction: This reconstruction has no cell limiters!");
+}
+
 template <typename scalar, int nvars>
 LinearUnlimitedReconstruction<scalar,nvars>
 ::LinearUnlimitedReconstruction(const UMesh<scalar,2> *const mesh,
                                 const scalar *const c_centres,
                                 const scalar *const c_centres_ghost,
-                                const amat::Array2d<scalar>& gauss_r)
-	: SolutionReconstruction<scalar,nvars>(mesh, c_centres, c_centres_ghost, gauss_r)
+                                const FaceGeometry<scalar> *const face_geom,
+                                const CellGeometry<scalar> *const cell_geom)
+	: SolutionReconstruction<scalar,nvars>(mesh, c_centres, c_centres_ghost, face_geom, cell_geom)
 { }
 
 template <typename scalar, int nvars>
@@ -68,8 +87,7 @@ void LinearUnlimitedReconstruction<scalar,nvars>
 
 			for(int i = 0; i < nvars; i++)
 			{
-				ufl(ied,i) = linearExtrapolate(u(ielem,i), grads[ielem], i, 1.0,
-				                               &gr(ied,0), ri+ielem*NDIM);
+				ufl(ied,i) = linearExtrapolate(u(ielem,i), grads[ielem], i, 1.0, fgeom[ied].drl);
 			}
 		}
 
@@ -81,10 +99,8 @@ void LinearUnlimitedReconstruction<scalar,nvars>
 
 			for(int i = 0; i < nvars; i++)
 			{
-				ufl(ied,i) = linearExtrapolate(u(ielem,i), grads[ielem], i, 1.0,
-				                               &gr(ied,0), ri+ielem*NDIM);
-				ufr(ied,i) = linearExtrapolate(u(jelem,i), grads[jelem], i, 1.0,
-				                               &gr(ied,0), ri+jelem*NDIM);
+				ufl(ied,i) = linearExtrapolate(u(ielem,i), grads[ielem], i, 1.0, fgeom[ied].drl);
+				ufr(ied,i) = linearExtrapolate(u(jelem,i), grads[jelem], i, 1.0, fgeom[ied].drr);
 			}
 		}
 
@@ -95,13 +111,32 @@ void LinearUnlimitedReconstruction<scalar,nvars>
 
 			for(int i = 0; i < nvars; i++)
 			{
-				ufl(ied,i) = linearExtrapolate(u(ielem,i), grads[ielem], i, 1.0,
-				                               &gr(ied,0), ri+ielem*NDIM);
+				ufl(ied,i) = linearExtrapolate(u(ielem,i), grads[ielem], i, 1.0, fgeom[ied].drl);
 			}
 		}
 	}
 }
 
+template <typename scalar, int nvars>
+void LinearUnlimitedReconstruction<scalar,nvars>
+::compute_cell_limiters(const MVector<scalar>& u, const scalar *const gradarray,
+                        freal *const lims) const
+{
+#pragma omp parallel for simd default(shared)
+	for(fint i = 0; i < m->gnelem()*nvars; i++)
+		lims[i] = 1.0;
+}
+
+template <typename scalar, int nvars>
+void LinearUnlimitedReconstruction<scalar,nvars>
+::compute_cell_limiters_single(const MVector<scalar>& u, const float *const gradarray,
+                               freal *const lims) const
+{
+#pragma omp parallel for simd default(shared)
+	for(fint i = 0; i < m->gnelem()*nvars; i++)
+		lims[i] = 1.0;
+}
+
 template class SolutionReconstruction<freal,NVARS>;
 template class SolutionReconstruction<freal,1>;
 template class LinearUnlimitedReconstruction<freal,NVARS>;
@@ -9,6 +9,7 @@
 #include "aconstants.hpp"
 #include "utilities/aarray2d.hpp"
 #include "mesh/mesh.hpp"
+#include "facegeometry.hpp"
 
 namespace fvens {
 
@@ -25,14 +26,18 @@ protected:
 	const scalar *const ri;
 	/// Coords of cell-centres of physical boundary ghost cells
 	const scalar *const ribp;
-	/// Coords of Gauss quadrature points of each face
-	const amat::Array2d<scalar>& gr;
+	/// Packed geometric data of each face, including the position of the face centre (the
+	///  quadrature point) relative to the two adjacent cell centres
+	const FaceGeometry<scalar> *const fgeom;
+	/// Packed geometric data of each subdomain cell
+	const CellGeometry<scalar> *const cgeom;
 
 public:
 	SolutionReconstruction (const UMesh<scalar,2> *const  mesh,          ///< Mesh context
 	                        const scalar *const c_centres,                ///< Cell centres
 	                        const scalar *const c_centres_ghost,          ///< Ghost cell centres
-	                        const amat::Array2d<scalar>& gauss_r);        ///< Coords of Gauss points
+	                        const FaceGeometry<scalar> *const face_geom,  ///< Face geometric data
+	                        const CellGeometry<scalar> *const cell_geom); ///< Cell geometric data
 
 	virtual void compute_face_values(const MVector<scalar>& unknowns, 
 	                                 const amat::Array2dView<scalar> unknow_ghost,
@@ -40,6 +45,29 @@ public:
 	                                 amat::Array2dMutableView<scalar> uface_left,
 	                                 amat::Array2dMutableView<scalar> uface_right) const = 0;
 
+	/// Whether the reconstruction is a linear extrapolation from the cell centre with one limiter
+	///  value per cell and variable \sa compute_cell_limiters
+	virtual bool cell_limited() const { return false; }
+
+	/// Computes the limiter value of each variable at each subdomain cell
+	/** Only available if \ref cell_limited returns true. The value of variable ivar reconstructed
+	 * from cell iel at any of its faces is then given by \ref linearExtrapolate with the limiter
+	 * value lims[iel*nvars+ivar], which is exactly what \ref compute_face_values computes. This
+	 * lets face values be computed one face at a time when they are needed.
+	 * \param[in] unknowns Cell-centred values at subdomain and connectivity ghost cells
+	 * \param[in] grads Cell-centred gradients at subdomain cells
+	 * \param[out] lims Limiter values, an array of size number of subdomain cells x nvars
+	 */
+	virtual void compute_cell_limiters(const MVector<scalar>& unknowns, const scalar *const grads,
+	                                   freal *const lims) const;
+
+	/// Computes the limiter value of each variable at each subdomain cell from gradients stored
+	///  in single precision
+	/** As \ref compute_cell_limiters, with the limiters computed in the precision of scalar.
+	 */
+	virtual void compute_cell_limiters_single(const MVector<scalar>& unknowns,
+	                                          const float *const grads, freal *const lims) const;
+
 	virtual ~SolutionReconstruction();
 };
 
@@ -57,7 +85,8 @@ public:
 	LinearUnlimitedReconstruction(const UMesh<scalar,2> *const mesh,
 	                              const scalar *const c_centres, 
 	                              const scalar *const c_centres_ghost,
-	                              const amat::Array2d<scalar>& gauss_r);
+	                              const FaceGeometry<scalar> *const face_geom,
+	                              const CellGeometry<scalar> *const cell_geom);
 
 	void compute_face_values(const MVector<scalar>& unknowns, 
 	                         const amat::Array2dView<scalar> unknow_ghost, 
@@ -65,10 +94,19 @@ public:
 	                         amat::Array2dMutableView<scalar> uface_left,
 	                         amat::Array2dMutableView<scalar> uface_right) const;
 
+	bool cell_limited() const { return true; }
+
+	/// Sets all limiter values to one
+	void compute_cell_limiters(const MVector<scalar>& unknowns, const scalar *const grads,
+	                           freal *const lims) const;
+
+	/// Sets all limiter values to one
+	void compute_cell_limiters_single(const MVector<scalar>& unknowns, const float *const grads,
+	                                  freal *const lims) const;
+
 protected:
 	using SolutionReconstruction<scalar,nvars>::m;
-	using SolutionReconstruction<scalar,nvars>::ri;
-	using SolutionReconstruction<scalar,nvars>::gr;
+	using SolutionReconstruction<scalar,nvars>::fgeom;
 };
 
 } // end namespace
@@ -73,6 +73,9 @@ Spatial<scalar,nvars>::Spatial(const UMesh<scalar,NDIM> *const mesh) : m(mesh)
 		rcbptr = &rcbp(0,0);
 	else
 		rcbptr = nullptr;
+
+	facegeom = computeFaceGeometry(*m, rch.getArray(), rcbptr, gr);
+	cellgeom = computeCellGeometry(*m);
 }
 
 template<typename scalar, int nvars>
@@ -171,20 +174,12 @@ void Spatial<scalar,nvars>::compute_ghost_cell_coords_about_face(amat::Array2d<s
 
 template <typename scalar, int nvars>
 void Spatial<scalar,nvars>::
-getFaceGradient_modifiedAverage(const scalar *const rcl, const scalar *const rcr,
+getFaceGradient_modifiedAverage(const FaceGeometry<scalar>& fg,
                                 const scalar *const ucl, const scalar *const ucr,
                                 const scalar *const gradl, const scalar *const gradr,
                                 scalar grad[NDIM][nvars]) const
 {
-	scalar dr[NDIM], dist=0;
-	for(int i = 0; i < NDIM; i++) {
-		dr[i] = rcr[i]-rcl[i];
-		dist += dr[i]*dr[i];
-	}
-	dist = sqrt(dist);
-	for(int i = 0; i < NDIM; i++) {
-		dr[i] /= dist;
-	}
+	const scalar *const dr = fg.dr;
 
 	for(int i = 0; i < nvars; i++)
 	{
@@ -193,7 +188,7 @@ getFaceGradient_modifiedAverage(const scalar *const rcl, const scalar *const rcr
 		for(int j = 0; j < NDIM; j++)
 			davg[j] = 0.5*(gradl[j*nvars+i] + gradr[j*nvars+i]);
 
-		const scalar corr = (ucr[i]-ucl[i])/dist;
+		const scalar corr = (ucr[i]-ucl[i])*fg.invdist;
 
 		const scalar ddr = dimDotProduct(davg,dr);
 
@@ -206,34 +201,25 @@ getFaceGradient_modifiedAverage(const scalar *const rcl, const scalar *const rcr
 
 template <typename scalar, int nvars>
 void Spatial<scalar,nvars>
-::getFaceGradientAndJacobian_thinLayer(const scalar *const ccleft, const scalar *const ccright,
+::getFaceGradientAndJacobian_thinLayer(const FaceGeometry<scalar>& fg,
                                        const freal *const ucl, const freal *const ucr,
                                        const freal *const dul, const freal *const dur,
                                        scalar grad[NDIM][nvars], scalar dgradl[NDIM][nvars][nvars],
                                        scalar dgradr[NDIM][nvars][nvars]) const
 {
-	scalar dr[NDIM], dist=0;
-
-	for(int i = 0; i < NDIM; i++) {
-		dr[i] = ccright[i]-ccleft[i];
-		dist += dr[i]*dr[i];
-	}
-	dist = sqrt(dist);
-	for(int i = 0; i < NDIM; i++) {
-		dr[i] /= dist;
-	}
+	const scalar *const dr = fg.dr;
 
 	for(int i = 0; i < nvars; i++)
 	{
-		const scalar corr = (ucr[i]-ucl[i])/dist;        //< The thin layer gradient magnitude
+		const scalar corr = (ucr[i]-ucl[i])*fg.invdist;        //< The thin layer gradient magnitude
 
 		for(int j = 0; j < NDIM; j++)
 		{
 			grad[j][i] = corr*dr[j];
 
 			for(int k = 0; k < nvars; k++) {
-				dgradl[j][i][k] = -dul[i*nvars+k]/dist * dr[j];
-				dgradr[j][i][k] = dur[i*nvars+k]/dist * dr[j];
+				dgradl[j][i][k] = -dul[i*nvars+k]*fg.invdist * dr[j];
+				dgradr[j][i][k] = dur[i*nvars+k]*fg.invdist * dr[j];
 			}
 		}
 	}
@@ -339,6 +325,117 @@ StatusCode Spatial<scalar,nvars>::assemble_jacobian(const Vec uvec, Mat A) const
 	return ierr;
 }
 
+/// Adds a multiple of a row-major block to a block stored column-major, as in BAIJ matrices
+template <int nvars>
+static inline void addToBlock(const Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>& b,
+                              const freal factor, PetscScalar *const blk)
+{
+	for(int j = 0; j < nvars; j++)
+		for(int i = 0; i < nvars; i++)
+			blk[j*nvars+i] += factor*b(i,j);
+}
+
+template <typename scalar, int nvars>
+StatusCode Spatial<scalar,nvars>::assemble_jacobian(const Vec uvec,
+                                                    const BAIJJacobianLayout<nvars>& layout,
+                                                    Mat A) const
+{
+	using Eigen::Matrix; using Eigen::RowMajor;
+
+	StatusCode ierr = 0;
+	if(!layout.describes(A))
+		SETERRQ(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONGSTATE,
+		        "Jacobian layout does not describe the matrix!");
+
+	ConstGhostedVecHandler<PetscScalar> uvh(uvec);
+	const PetscScalar *const uarr = uvh.getArray();
+
+	PetscScalar *ad, *ao;
+	ierr = layout.getArrays(A, &ad, &ao); CHKERRQ(ierr);
+	constexpr int bs2 = nvars*nvars;
+
+	// No two faces of a colour share a subdomain cell, so each block is updated by one thread
+#pragma omp parallel default(shared)
+	for(int icol = 0; icol < layout.numColours(); icol++)
+	{
+#pragma omp for
+		for(fint i = layout.colourStart(icol); i < layout.colourEnd(icol); i++)
+		{
+			const fint iface = layout.colourFace(i);
+			const fint lelem = m->gintfac(iface,0);
+			const fint relem = m->gintfac(iface,1);
+
+			if(iface < m->gPhyBFaceEnd())
+			{
+				Matrix<freal,nvars,nvars,RowMajor> left;
+				compute_local_jacobian_boundary(iface, &uarr[lelem*nvars], left);
+				addToBlock<nvars>(left, -1.0, ad + layout.diagonal(lelem)*bs2);
+			}
+			else
+			{
+				Matrix<freal,nvars,nvars,RowMajor> L;
+				Matrix<freal,nvars,nvars,RowMajor> U;
+				compute_local_jacobian_interior(iface, &uarr[lelem*nvars], &uarr[relem*nvars], L, U);
+
+				addToBlock<nvars>(L, -1.0, ad + layout.diagonal(lelem)*bs2);
+				if(iface < m->gSubDomFaceEnd()) {
+					addToBlock<nvars>(L, 1.0, ad + layout.lower(iface)*bs2);
+					addToBlock<nvars>(U, 1.0, ad + layout.upper(iface)*bs2);
+					addToBlock<nvars>(U, -1.0, ad + layout.diagonal(relem)*bs2);
+				}
+				else
+					addToBlock<nvars>(U, 1.0, ao + layout.upper(iface)*bs2);
+			}
+		}
+	}
+
+	ierr = layout.restoreArrays(A, &ad, &ao); CHKERRQ(ierr);
+	return ierr;
+}
+
+template <typename scalar, int nvars>
+StatusCode Spatial<scalar,nvars>::assemble_jacobian(const Vec uvec, FaceJacobian<nvars>& jac) const
+{
+	using Eigen::Matrix; using Eigen::RowMajor;
+
+	ConstGhostedVecHandler<PetscScalar> uvh(uvec);
+	const PetscScalar *const uarr = uvh.getArray();
+
+	// No two faces of a colour share a subdomain cell, so each block is updated by one thread
+#pragma omp parallel default(shared)
+	for(int icol = 0; icol < jac.numColours(); icol++)
+	{
+#pragma omp for
+		for(fint i = jac.colourStart(icol); i < jac.colourEnd(icol); i++)
+		{
+			const fint iface = jac.colourFace(i);
+			const fint lelem = m->gintfac(iface,0);
+			const fint relem = m->gintfac(iface,1);
+
+			if(iface < m->gPhyBFaceEnd())
+			{
+				Matrix<freal,nvars,nvars,RowMajor> left;
+				compute_local_jacobian_boundary(iface, &uarr[lelem*nvars], left);
+				addToBlock<nvars>(left, -1.0, jac.diagonal(lelem));
+			}
+			else
+			{
+				Matrix<freal,nvars,nvars,RowMajor> L;
+				Matrix<freal,nvars,nvars,RowMajor> U;
+				compute_local_jacobian_interior(iface, &uarr[lelem*nvars], &uarr[relem*nvars], L, U);
+
+				addToBlock<nvars>(L, -1.0, jac.diagonal(lelem));
+				addToBlock<nvars>(U, 1.0, jac.upper(iface));
+				if(iface >= m->gSubDomFaceStart() && iface < m->gSubDomFaceEnd()) {
+					addToBlock<nvars>(L, 1.0, jac.lower(iface));
+					addToBlock<nvars>(U, -1.0, jac.diagonal(relem));
+				}
+			}
+		}
+	}
+
+	return 0;
+}
 
 template class Spatial<freal,NVARS>;
 template class Spatial<freal,1>;
@@ -27,9 +27,13 @@
 
 #include "aconstants.hpp"
 #include "utilities/aarray2d.hpp"
+#include "utilities/workspace.hpp"
 #include "linalg/petscutils.hpp"
+#include "linalg/jacobianlayout.hpp"
+#include "linalg/facejacobian.hpp"
 
 #include "mesh/mesh.hpp"
+#include "facegeometry.hpp"
 
 namespace fvens {
 
@@ -39,8 +43,8 @@ class Spatial
 {
 public:
 	/// Common setup required for finite volume discretizations
-	/** Computes and stores cell centre coordinates, ghost cells' centres, and
-	 * quadrature point coordinates.
+	/** Computes and stores cell centre coordinates, ghost cells' centres,
+	 * quadrature point coordinates and the packed face and cell geometric data.
 	 */
 	Spatial(const UMesh<scalar,NDIM> *const mesh);
 
@@ -65,6 +69,24 @@ public:
 	/// Computes and assembles the residual Jacobian
 	StatusCode assemble_jacobian(const Vec uvec, Mat A) const;
 
+	/// Computes the residual Jacobian and adds it directly into the storage of a BAIJ matrix
+	/** Gives the same matrix as \ref assemble_jacobian, but without MatSetValuesBlocked or any
+	 * synchronization between threads; faces are processed colour by colour.
+	 * \param uvec The state at which to compute the Jacobian
+	 * \param layout Block positions and face colouring for the matrix
+	 * \param A The matrix, which must be described by the layout
+	 */
+	StatusCode assemble_jacobian(const Vec uvec, const BAIJJacobianLayout<nvars>& layout, Mat A)
+		const;
+
+	/// Computes the residual Jacobian into face-based storage
+	/** The blocks L and U of each face are stored with the face, and their negatives are added to
+	 * the diagonal blocks; faces are processed colour by colour, without synchronization.
+	 * \param uvec The state at which to compute the Jacobian
+	 * \param jac The Jacobian to add to; it is not zeroed first
+	 */
+	StatusCode assemble_jacobian(const Vec uvec, FaceJacobian<nvars>& jac) const;
+
 	/// Computes the blocks of the Jacobian matrix for the flux across an interior face
 	/** It is supposed to be a point-block in dr/du when we want to solve [M du/dt +] r(u) = 0.
 	 * The convention is that L and U should go into the two off-diagonal blocks
@@ -123,6 +145,18 @@ protected:
 	/// naface x nguass x ndim (in that order)
 	amat::Array2d<scalar> gr;
 
+	/// Packed geometric data of each face, in the order of the faces in the mesh
+	std::vector<FaceGeometry<scalar>> facegeom;
+
+	/// Packed geometric data of each subdomain cell
+	std::vector<CellGeometry<scalar>> cellgeom;
+
+	/// Temporary arrays needed by residual computation and related functions
+	/** Derived classes reserve their arrays in their constructors; the most derived class
+	 * allocates the arena at the end of its constructor.
+	 */
+	WorkspaceArena work;
+
 	/// Computes cell-centres of subdomain cells into \ref rcvec
 	void update_subdomain_cell_centres();
 
@@ -133,15 +167,14 @@ protected:
 	void compute_ghost_cell_coords_about_face(amat::Array2d<scalar>& rchg);
 
 	/// Computes a unique face gradient from cell-centred gradients using the modified average method
-	/** \param ccleft Coordinates of left cell centre
-	 * \param ccright Coordinates of right cell centre
+	/** \param fg Geometric data of the face
 	 * \param ucl The left cell-centred state
 	 * \param ucr The right cell-centred state
 	 * \param gradl Left cell-centred gradients (ndim x nvars flattened array)
 	 * \param gradr Right cell-centred gradients (ndim x nvars flattened array)
 	 * \param[out] grad Face gradient
 	 */
-	void getFaceGradient_modifiedAverage(const scalar *const ccleft, const scalar *const ccright,
+	void getFaceGradient_modifiedAverage(const FaceGeometry<scalar>& fg,
 	                                     const scalar *const ucl, const scalar *const ucr,
 	                                     const scalar *const gradl, const scalar *const gradr,
 	                                     scalar grad[NDIM][nvars]) const;
@@ -149,7 +182,7 @@ protected:
 	/// Computes the thin-layer face gradient and its Jacobian w.r.t. the left and right states
 	/** The Jacobians are computed w.r.t. whatever variables
 	 * the derivatives dul and dur are computed with respect to.
-	 * \param iface The \ref intfac index of the face at which the gradient Jacobian is to be computed
+	 * \param fg Geometric data of the face at which the gradient Jacobian is to be computed
 	 * \param ucl The left state
 	 * \param ucr The right state
 	 * \param dul The Jacobian of the left state w.r.t. the cell-centred conserved variables
@@ -158,7 +191,7 @@ protected:
 	 * \param[out] dgradl Jacobian of left cell-centred gradients
 	 * \param[out] dgradr Jacobian of right cell-centred gradients
 	 */
-	void getFaceGradientAndJacobian_thinLayer(const scalar *const ccleft, const scalar *const ccright,
+	void getFaceGradientAndJacobian_thinLayer(const FaceGeometry<scalar>& fg,
 	                                          const freal *const ucl, const freal *const ucr,
 	                                          const freal *const dul, const freal *const dur,
 	                                          scalar grad[NDIM][nvars],
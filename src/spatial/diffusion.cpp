@@ -72,14 +72,13 @@ DiffusionMA<nvars>::~DiffusionMA()
 
 template<int nvars>
 inline void DiffusionMA<nvars>::compute_flux_interior(const fint iface,
-                                                      const amat::Array2dView<freal>& rc,
                                                       const freal *const uarr,
                                                       const GradBlock_t<freal,NDIM,nvars> *const grads,
                                                       amat::Array2dMutableView<freal>& residual) const
 {
 	const fint lelem = m->gintfac(iface,0);
 	const fint relem = m->gintfac(iface,1);
-	const freal len = m->gfacemetric(iface,2);
+	const FaceGeometry<freal>& fg = facegeom[iface];
 
 	freal gradl[NDIM*nvars], gradr[NDIM*nvars];
 	for(int ivar = 0; ivar < nvars; ivar++) {
@@ -90,17 +89,15 @@ inline void DiffusionMA<nvars>::compute_flux_interior(const fint iface,
 	}
 
 	freal gradf[NDIM][nvars];
-	getFaceGradient_modifiedAverage
-		(&rc(lelem,0), &rc(relem,0), &uarr[lelem*nvars], &uarr[relem*nvars],
-		 gradl, gradr, gradf);
+	getFaceGradient_modifiedAverage(fg, &uarr[lelem*nvars], &uarr[relem*nvars], gradl, gradr, gradf);
 
 	for(int ivar = 0; ivar < nvars; ivar++)
 	{
 		// compute nu*(-grad u . n) * l
 		freal flux = 0;
 		for(int idim = 0; idim < NDIM; idim++)
-			flux += gradf[idim][ivar]*m->gfacemetric(iface,idim);
-		flux *= (-diffusivity*len);
+			flux += gradf[idim][ivar]*fg.normal[idim];
+		flux *= (-diffusivity*fg.len);
 
 		/// We assemble the negative of the residual r in 'M du/dt + r(u) = 0'
 #pragma omp atomic
@@ -176,7 +173,7 @@ StatusCode DiffusionMA<nvars>::compute_residual(const Vec uvec, Vec rvec,
 		{
 			const fint lelem = m->gintfac(iface,0);
 			const fint ibpface = iface - m->gPhyBFaceStart();
-			const freal len = m->gfacemetric(iface,2);
+			const FaceGeometry<freal>& fg = facegeom[iface];
 
 			freal gradl[NDIM*nvars], gradr[NDIM*nvars];
 			for(int ivar = 0; ivar < nvars; ivar++) {
@@ -187,16 +184,15 @@ StatusCode DiffusionMA<nvars>::compute_residual(const Vec uvec, Vec rvec,
 			}
 
 			freal gradf[NDIM][nvars];
-			getFaceGradient_modifiedAverage(&rc(lelem,0), &rcbp(ibpface,0),
-			                                &uarr[lelem*nvars], &ug(ibpface,0), gradl, gradr, gradf);
+			getFaceGradient_modifiedAverage(fg, &uarr[lelem*nvars], &ug(ibpface,0), gradl, gradr, gradf);
 
 			for(int ivar = 0; ivar < nvars; ivar++)
 			{
 				// compute nu*(-grad u . n) * l
 				freal flux = 0;
 				for(int idim = 0; idim < NDIM; idim++)
-					flux += gradf[idim][ivar]*m->gfacemetric(iface,idim);
-				flux *= (-diffusivity*len);
+					flux += gradf[idim][ivar]*fg.normal[idim];
+				flux *= (-diffusivity*fg.len);
 
 				/// NOTE: we assemble the negative of the residual r in 'M du/dt + r(u) = 0'
 #pragma omp atomic
@@ -219,7 +215,7 @@ StatusCode DiffusionMA<nvars>::compute_residual(const Vec uvec, Vec rvec,
 #pragma omp parallel for default(shared)
 		for(fint iface = m->gDomFaceStart(); iface < m->gDomFaceEnd(); iface++)
 		{
-			compute_flux_interior(iface, rc, uarr, grads, residual);
+			compute_flux_interior(iface, uarr, grads, residual);
 		}
 	}
 
@@ -256,10 +252,7 @@ void DiffusionMA<nvars>
                                   Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>& L,
                                   Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>& U) const
 {
-	const amat::Array2dView<freal> rc(rch.getArray(), m->gnelem()+m->gnConnFace(), NDIM);
-	const fint lelem = m->gintfac(iface,0);
-	const fint relem = m->gintfac(iface,1);
-	const freal len = m->gfacemetric(iface,2);
+	const FaceGeometry<freal>& fg = facegeom[iface];
 
 	freal du[nvars*nvars];
 	for(int i = 0; i < nvars; i++) {
@@ -271,7 +264,7 @@ void DiffusionMA<nvars>
 	freal grad[NDIM][nvars], dgradl[NDIM][nvars][nvars], dgradr[NDIM][nvars][nvars];
 
 	// Compute the face gradient Jacobian; we don't actually need the gradient, however..
-	getFaceGradientAndJacobian_thinLayer(&rc(lelem), &rc(relem), ul, ur, du, du, grad, dgradl, dgradr);
+	getFaceGradientAndJacobian_thinLayer(fg, ul, ur, du, du, grad, dgradl, dgradr);
 
 	L = Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>::Zero();
 	U = Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>::Zero();
@@ -279,8 +272,8 @@ void DiffusionMA<nvars>
 	{
 		// compute nu*(d(-grad u)/du_l . n) * l
 		for(int idim = 0; idim < NDIM; idim++)
-			L[ivar*nvars+ivar] += dgradl[idim][ivar][ivar]*m->gfacemetric(iface,idim);
-		L[ivar*nvars+ivar] *= (diffusivity*len);
+			L[ivar*nvars+ivar] += dgradl[idim][ivar][ivar]*fg.normal[idim];
+		L[ivar*nvars+ivar] *= (diffusivity*fg.len);
 	}
 
 	// The Jacobian is symmetric
@@ -293,10 +286,7 @@ void DiffusionMA<nvars>
                                   const freal *const ul,
                                   Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>& L) const
 {
-	const amat::Array2dView<freal> rc(rch.getArray(), m->gnelem()+m->gnConnFace(), NDIM);
-	const fint lelem = m->gintfac(iface,0);
-	const fint ibpface = iface - m->gPhyBFaceStart();
-	const freal len = m->gfacemetric(iface,2);
+	const FaceGeometry<freal>& fg = facegeom[iface];
 
 	freal du[nvars*nvars];
 	for(int i = 0; i < nvars; i++) {
@@ -308,16 +298,15 @@ void DiffusionMA<nvars>
 	freal grad[NDIM][nvars], dgradl[NDIM][nvars][nvars], dgradr[NDIM][nvars][nvars];
 
 	// Compute the face gradient and its Jacobian; we don't actually need the gradient, however
-	getFaceGradientAndJacobian_thinLayer(&rc(lelem), &rcbp(ibpface), ul, ul, du, du,
-	                                     grad, dgradl, dgradr);
+	getFaceGradientAndJacobian_thinLayer(fg, ul, ul, du, du, grad, dgradl, dgradr);
 
 	L = Eigen::Matrix<freal,nvars,nvars,Eigen::RowMajor>::Zero();
 	for(int ivar = 0; ivar < nvars; ivar++)
 	{
 		// compute nu*(d(-grad u)/du_l . n) * l
 		for(int idim = 0; idim < NDIM; idim++)
-			L(ivar,ivar) += dgradl[idim][ivar][ivar]*m->gfacemetric(iface,idim);
-		L(ivar,ivar) *= (diffusivity*len);
+			L(ivar,ivar) += dgradl[idim][ivar][ivar]*fg.normal[idim];
+		L(ivar,ivar) *= (diffusivity*fg.len);
 	}
 }
 
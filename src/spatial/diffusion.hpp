@@ -32,6 +32,7 @@ protected:
 	using Spatial<freal,nvars>::rcvec;
 	using Spatial<freal,nvars>::rcbp;
 	using Spatial<freal,nvars>::gr;
+	using Spatial<freal,nvars>::facegeom;
 	using Spatial<freal,nvars>::getFaceGradient_modifiedAverage;
 
 	const freal diffusivity;		///< Diffusion coefficient (eg. kinematic viscosity)
@@ -92,6 +93,7 @@ protected:
 	using Spatial<freal,nvars>::rcbp;
 	using Spatial<freal,nvars>::rcbptr;
 	using Spatial<freal,nvars>::gr;
+	using Spatial<freal,nvars>::facegeom;
 	using Spatial<freal,nvars>::getFaceGradient_modifiedAverage;
 	using Spatial<freal,nvars>::getFaceGradientAndJacobian_thinLayer;
 
@@ -106,7 +108,6 @@ protected:
 	const GradientScheme<freal,nvars> *const gradcomp;
 
 	void compute_flux_interior(const fint iface,
-	                           const amat::Array2dView<freal>& rc,
 	                           const freal *const uarr,
 	                           const GradBlock_t<freal,NDIM,nvars> *const grads,
 	                           amat::Array2dMutableView<freal>& residual) const;
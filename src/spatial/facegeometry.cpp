@@ -0,0 +1,86 @@
+/** \file
+ * \brief Computation of packed face and cell geometric data
+ */
+
+#include <cmath>
+#include "facegeometry.hpp"
+
+namespace fvens {
+
+template <typename scalar>
+std::vector<FaceGeometry<scalar>> computeFaceGeometry(const UMesh<scalar,NDIM>& m,
+                                                      const scalar *const rc,
+                                                      const scalar *const rcbp,
+                                                      const amat::Array2d<scalar>& gr)
+{
+	std::vector<FaceGeometry<scalar>> fg(m.gnaface());
+
+#pragma omp parallel for default(shared)
+	for(fint iface = m.gFaceStart(); iface < m.gFaceEnd(); iface++)
+	{
+		FaceGeometry<scalar>& f = fg[iface];
+		const fint lelem = m.gintfac(iface,0);
+		const scalar *const rcl = rc + lelem*NDIM;
+		const scalar *const rcr
+			= (iface >= m.gPhyBFaceStart() && iface < m.gPhyBFaceEnd())
+			? rcbp + (iface-m.gPhyBFaceStart())*NDIM
+			: rc + m.gintfac(iface,1)*NDIM;
+
+		for(int idim = 0; idim < NDIM; idim++)
+			f.normal[idim] = m.gfacemetric(iface,idim);
+		f.len = m.gfacemetric(iface,NDIM);
+
+		scalar dist = 0;
+		for(int idim = 0; idim < NDIM; idim++) {
+			f.drl[idim] = gr(iface,idim) - rcl[idim];
+			f.drr[idim] = gr(iface,idim) - rcr[idim];
+			f.dr[idim] = rcr[idim] - rcl[idim];
+			dist += f.dr[idim]*f.dr[idim];
+		}
+		dist = std::sqrt(dist);
+
+		f.invdist = 1.0/dist;
+		for(int idim = 0; idim < NDIM; idim++)
+			f.dr[idim] *= f.invdist;
+	}
+
+	return fg;
+}
+
+template <typename scalar>
+std::vector<CellGeometry<scalar>> computeCellGeometry(const UMesh<scalar,NDIM>& m)
+{
+	static_assert(NDIM == 2, "Works only in 2D for now");
+	std::vector<CellGeometry<scalar>> cg(m.gnelem());
+
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+	{
+		cg[iel].area = m.garea(iel);
+		cg[iel].invarea = 1.0/m.garea(iel);
+
+		// the maximum edge length
+		scalar maxlen2 = 0;
+		for(int inode = 0; inode < m.gnnode(iel); inode++)
+		{
+			const int jnode = (inode+1) % m.gnnode(iel);
+			scalar len2 = 0;
+			for(int idim = 0; idim < NDIM; idim++)
+				len2 += std::pow(m.gcoords(m.ginpoel(iel,inode),idim)
+				                 - m.gcoords(m.ginpoel(iel,jnode),idim), 2);
+			if(maxlen2 < len2)
+				maxlen2 = len2;
+		}
+		cg[iel].venklength = std::sqrt(maxlen2);
+	}
+
+	return cg;
+}
+
+template std::vector<FaceGeometry<freal>>
+computeFaceGeometry(const UMesh<freal,NDIM>& m, const freal *const rc, const freal *const rcbp,
+                    const amat::Array2d<freal>& gr);
+
+template std::vector<CellGeometry<freal>> computeCellGeometry(const UMesh<freal,NDIM>& m);
+
+}
@@ -0,0 +1,63 @@
+/** \file
+ * \brief Packed per-face and per-cell geometric data used by the residual's face and cell loops
+ */
+
+#ifndef FVENS_FACEGEOMETRY_H
+#define FVENS_FACEGEOMETRY_H
+
+#include <vector>
+#include "aconstants.hpp"
+#include "utilities/aarray2d.hpp"
+#include "mesh/mesh.hpp"
+
+namespace fvens {
+
+/// Geometric data of a face needed by the face loops, packed into one record
+/** The records of all faces are stored contiguously in the order of the faces in the mesh
+ * (\ref UMesh::gintfac), so that a face loop streams through one array instead of gathering the
+ * face metric, the face centre and the centres of the two adjacent cells from separate arrays and
+ * recomputing the distance between the cell centres.
+ *
+ * The 'right' cell of a physical boundary face is its ghost cell.
+ */
+template <typename scalar>
+struct alignas(16) FaceGeometry
+{
+	scalar normal[NDIM];     ///< Unit normal vector, pointing from the left cell to the right cell
+	scalar len;              ///< Length (area in 3D) of the face
+	scalar drl[NDIM];        ///< Position of the face centre relative to the left cell centre
+	scalar drr[NDIM];        ///< Position of the face centre relative to the right cell centre
+	scalar dr[NDIM];         ///< Unit vector from the left cell centre to the right cell centre
+	scalar invdist;          ///< Inverse of the distance between the left and right cell centres
+};
+
+/// Geometric data of a subdomain cell needed by the cell loops
+template <typename scalar>
+struct alignas(16) CellGeometry
+{
+	scalar area;             ///< Area (volume in 3D) of the cell
+	scalar invarea;          ///< Inverse of the area
+	scalar venklength;       ///< Length of the longest edge, used by the Venkatakrishnan limiter
+};
+
+/// Computes the geometric data of all faces of a mesh
+/** \param m The mesh, whose face data (\ref UMesh::compute_face_data) must be available
+ * \param rc Centres of subdomain cells followed by those of connectivity ghost cells
+ * \param rcbp Centres of physical boundary ghost cells, in the order of the boundary faces
+ * \param gr Face centres
+ */
+template <typename scalar>
+std::vector<FaceGeometry<scalar>> computeFaceGeometry(const UMesh<scalar,NDIM>& m,
+                                                      const scalar *const rc,
+                                                      const scalar *const rcbp,
+                                                      const amat::Array2d<scalar>& gr);
+
+/// Computes the geometric data of all subdomain cells of a mesh
+/** The areas of the cells (\ref UMesh::compute_areas) must be available.
+ */
+template <typename scalar>
+std::vector<CellGeometry<scalar>> computeCellGeometry(const UMesh<scalar,NDIM>& m);
+
+}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include "physics/aphysics_defs.hpp"
 #include "physics/viscousphysics.hpp"
 #include "abctypemap.hpp"
@@ -28,6 +29,7 @@
 #include "linalg/petscutils.hpp"
 #include "linalg/tracevector.hpp"
 #include "flow_spatial.hpp"
+#include "reconstruction_utils.hpp"
 
 namespace fvens {
 
@@ -47,11 +49,18 @@ FlowFV_base<scalar>::FlowFV_base(const UMesh<scalar,NDIM> *const mesh,
 	gradcomp {create_const_gradientscheme<scalar,NVARS>(nconfig.gradientscheme, m, rch.getArray(),
 	                                                    rcbptr)},
 	lim {create_const_reconstruction<scalar,NVARS>(nconfig.reconstruction, m, rch.getArray(), rcbptr,
-	                                               gr, nconfig.limiter_param)},
+	                                               facegeom.data(), cellgeom.data(),
+	                                               nconfig.limiter_param)},
 
-	bcs {create_const_flowBCs<scalar>(pconf.bcconf, physics,uinf)}
+	bcs {create_const_flowBCs<scalar>(pconf.bcconf, physics,uinf)},
 
+	bfacebcs(m->gnbface()),
+
+	wsGradientGhostStates {work.template reserve<scalar>(m->gnbface(), NVARS)}
 {
+	for(fint ied = m->gPhyBFaceStart(); ied < m->gPhyBFaceEnd(); ied++)
+		bfacebcs[ied-m->gPhyBFaceStart()] = bcs.at(m->gbtags(ied,0));
+
 	std::cout << " FlowFV_base: Boundary conditions:\n";
 	for(auto it = pconfig.bcconf.begin(); it != pconfig.bcconf.end(); it++) {
 		std::cout << "  " << bcTypeMap.left.find(it->bc_type)->second << '\n';
@@ -70,15 +79,45 @@ FlowFV_base<scalar>::~FlowFV_base()
 	}
 }
 
+/** Boundary faces are processed in batches of consecutive faces. A batch whose faces all have the
+ * same boundary tag is handed to the BC at once; otherwise, its faces are processed one by one.
+ */
 template <typename scalar>
 void FlowFV_base<scalar>::compute_boundary_states(const scalar *const ins, scalar *const gs) const
 {
+	const fint bstart = m->gPhyBFaceStart(), bend = m->gPhyBFaceEnd();
+
 #pragma omp parallel for default(shared)
-	for(fint ied = m->gPhyBFaceStart(); ied < m->gPhyBFaceEnd(); ied++)
+	for(fint ibeg = bstart; ibeg < bend; ibeg += FACE_BATCH)
 	{
-		compute_boundary_state(ied,
-		                       ins + (ied-m->gPhyBFaceStart())*NVARS,
-		                       gs  + (ied-m->gPhyBFaceStart())*NVARS);
+		const int nb = std::min(FACE_BATCH, bend-ibeg);
+		bool sametag = true;
+		for(int i = 1; i < nb; i++)
+			if(m->gbtags(ibeg+i,0) != m->gbtags(ibeg,0))
+				sametag = false;
+
+		if(!sametag) {
+			for(fint ied = ibeg; ied < ibeg+nb; ied++)
+				compute_boundary_state(ied, ins + (ied-bstart)*NVARS, gs + (ied-bstart)*NVARS);
+			continue;
+		}
+
+		// the last batch is padded with copies of its last face
+		scalar bins[NVARS][FACE_BATCH], bn[NDIM][FACE_BATCH], bgs[NVARS][FACE_BATCH];
+		for(int i = 0; i < FACE_BATCH; i++) {
+			const fint ied = ibeg + std::min(i,nb-1);
+			const std::array<scalar,NDIM> n = m->gnormal(ied);
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				bins[ivar][i] = ins[(ied-bstart)*NVARS+ivar];
+			for(int idim = 0; idim < NDIM; idim++)
+				bn[idim][i] = n[idim];
+		}
+
+		bfacebcs[ibeg-bstart]->computeGhostStateBatch(bins, bn, bgs);
+
+		for(int i = 0; i < nb; i++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				gs[(ibeg+i-bstart)*NVARS+ivar] = bgs[ivar][i];
 	}
 }
 
@@ -89,14 +128,15 @@ void FlowFV_base<scalar>::compute_boundary_state(const int ied,
                                                  ) const
 {
 	const std::array<scalar,NDIM> n = m->gnormal(ied);
-	bcs.at(m->gbtags(ied,0))->computeGhostState(ins, &n[0], gs);
+	bfacebcs[ied-m->gPhyBFaceStart()]->computeGhostState(ins, &n[0], gs);
 }
 
 template <typename scalar>
 void FlowFV_base<scalar>::getGradients(const Vec uvec,
                                        GradBlock_t<scalar,NDIM,NVARS> *const grads) const
 {
-	amat::Array2d<scalar> ug(m->gnbface(),NVARS);
+	amat::Array2dMutableView<scalar> ug(work.template get<scalar>(wsGradientGhostStates),
+	                                    m->gnbface(), NVARS);
 	ConstGhostedVecHandler<scalar> uh(uvec);
 	const amat::Array2dView<scalar> u(uh.getArray(), m->gnelem()+m->gnConnFace(), NVARS);
 
@@ -314,16 +354,56 @@ FlowFV<scalar,secondOrderRequested,constVisc>::FlowFV(const UMesh<scalar,NDIM> *
                                                       const FlowPhysicsConfig& pconf,
                                                       const FlowNumericsConfig& nconf)
 	: FlowFV_base<scalar>(mesh, pconf, nconf),
-	  uface(*m),
 	  gradvec{NULL},
 	  jphy(pconfig.gamma, pconfig.Minf, pconfig.Tinf, pconfig.Reinf, pconfig.Pr),
-	  jiflux {create_const_inviscidflux<scalar>(nconfig.conv_numflux_jac, &jphy)}
+	  jiflux {create_const_inviscidflux<scalar>(nconfig.conv_numflux_jac, &jphy)},
+	  cellAssembly {nconfig.residual_assembly == "CELL"},
+	  fusedResidual {nconfig.fused_residual && (!secondOrderRequested || lim->cell_limited())},
+	  singleStorage {secondOrderRequested && nconfig.single_precision_storage},
+	  wsGhostStates {work.template reserve<scalar>(m->gnbface(), NVARS)},
+	  wsBoundaryStates {work.template reserve<scalar>(fusedResidual ? m->gnbface() : 0, NVARS)},
+	  wsGhostPrimitive {work.template reserve<scalar>(fusedResidual && secondOrderRequested ?
+	                                                  m->gnbface() : 0, NVARS)},
+	  wsLimiters {work.template reserve<freal>(fusedResidual && secondOrderRequested ?
+	                                           m->gnelem() : 0, NVARS)},
+	  wsSpectralRadii {work.template reserve<freal>(m->gnelem(), 1)},
+	  wsSingleGradients {work.template reserve<float>(singleStorage ?
+	                                                  m->gnelem()+m->gnConnFace() : 0, NDIM*NVARS)},
+	  wsSingleLeftStates {work.template reserve<float>(singleStorage ? m->gnConnFace() : 0, NVARS)},
+	  wsSingleRightStates {work.template reserve<float>(singleStorage ? m->gnConnFace() : 0,NVARS)},
+	  stateGradHalo {secondOrderRequested && !singleStorage
+	                 && (fusedResidual ? pconfig.viscous_sim : nconfig.reconstruction != "WENO") ?
+	                 new HaloExchange(*m, {{HALO_TRACE, NVARS}, {HALO_CELL, NDIM*NVARS}}) : nullptr},
+	  singleHalo {!singleStorage ? nullptr
+	              : pconfig.viscous_sim ?
+	              new HaloExchange(*m, {{HALO_CONNFACE, NVARS, HALO_FLOAT},
+	                                    {HALO_CELL, NDIM*NVARS, HALO_FLOAT}})
+	              : new HaloExchange(*m, {{HALO_CONNFACE, NVARS, HALO_FLOAT}})},
+	  weno {secondOrderRequested && !fusedResidual && nconfig.second_ghost_layer ?
+	        dynamic_cast<const WENOReconstruction<scalar,NVARS>*>(lim) : nullptr},
+	  ghostLayer {weno ? new SecondGhostLayer(*m, MPI_COMM_WORLD) : nullptr},
+	  ghostGradExchange {weno ? new GhostLayerExchange(*ghostLayer, NDIM*NVARS) : nullptr},
+	  faceBatchKernel {select_face_batch_kernel<scalar>()},
+	  singleFaceBatchKernel {select_face_batch_kernel<float>()}
 {
 #ifdef DEBUG
 	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
 	std::cout << "RAnk " << mpirank << ": Starting constructing flow spatial.." << std::endl;
 #endif
-	if(secondOrderRequested) {
+	if(singleStorage) {
+		if(!fusedResidual)
+			throw UnsupportedOptionError("FlowFV: Single precision storage is only supported with"
+			                             " the fused residual!");
+		if(nconfig.gradientscheme == "GREENGAUSS")
+			throw UnsupportedOptionError("FlowFV: Single precision storage is not supported with"
+			                             " Green-Gauss gradients!");
+		std::cout << " FlowFV: Storing gradients and connectivity face states in single"
+		          << " precision.\n";
+	}
+	else
+		uface = std::make_unique<L2TraceVector<scalar,NVARS>>(*m);
+
+	if(secondOrderRequested && !singleStorage) {
 		std::cout << " FlowFV: Second order solution requested.\n";
 		// for storing cell-centred gradients at interior cells and ghost cells
 		int ierr = createGhostedSystemVector(m, NVARS*NDIM, &gradvec);
@@ -334,11 +414,47 @@ FlowFV<scalar,secondOrderRequested,constVisc>::FlowFV(const UMesh<scalar,NDIM> *
 
 	std::cout << " FlowFV: Using " << nconfig.conv_numflux << " for inviscid flux and "
 	          << nconfig.conv_numflux_jac << " for inviscid flux Jacobian.\n";
+
+	if(cellAssembly) {
+		std::cout << " FlowFV: Using cell-based residual assembly.\n";
+		faceflux.resize(m->gnaface()*NVARS);
+		facespecrad.resize(2*m->gnaface());
+	}
+	else if(nconfig.residual_assembly != "FACE" && !nconfig.residual_assembly.empty())
+		throw UnsupportedOptionError("FlowFV: Unknown residual assembly "
+		                             + nconfig.residual_assembly);
+
+	if(fusedResidual)
+		std::cout << " FlowFV: Computing the residual in a single pass over faces.\n";
+	else if(nconfig.fused_residual)
+		std::cout << " FlowFV: Fused residual not available with " << nconfig.reconstruction
+		          << " reconstruction; computing the residual in separate passes.\n";
+
+	if(weno)
+		std::cout << " FlowFV: Using a second ghost layer for WENO reconstruction.\n";
+	else if(nconfig.second_ghost_layer && secondOrderRequested)
+		throw UnsupportedOptionError("FlowFV: The second ghost layer is only supported for WENO"
+		                             " reconstruction without the fused residual!");
+
+	if(secondOrderRequested) {
+		uprim.resize(m->gnelem()+m->gnConnFace(), NVARS);
+		// first touch in the same pattern as the conversion to primitive variables
+#pragma omp parallel for default(shared)
+		for(fint iel = 0; iel < m->gnelem()+m->gnConnFace(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				uprim(iel,ivar) = 0;
+	}
+
+	work.allocate();
 }
 
 template<typename scalar, bool secondOrderRequested, bool constVisc>
 FlowFV<scalar,secondOrderRequested,constVisc>::~FlowFV()
 {
+	delete stateGradHalo;
+	delete singleHalo;
+	delete ghostGradExchange;
+	delete ghostLayer;
 	int ierr = VecDestroy(&gradvec);
 	if(ierr) {
 		std::cout << "Gradient vector could not be destroyed!" << std::endl;
@@ -346,12 +462,60 @@ FlowFV<scalar,secondOrderRequested,constVisc>::~FlowFV()
 }
 
 template<typename scalar, bool secondOrderRequested, bool constVisc>
+StatusCode FlowFV<scalar,secondOrderRequested,constVisc>::beginHaloExchange(const bool gradients)
+	const
+{
+	StatusCode ierr = 0;
+	if(singleHalo) {
+		const void *const sources[] = {work.template get<float>(wsSingleLeftStates),
+		                               work.template get<float>(wsSingleGradients)};
+		singleHalo->begin(sources);
+	}
+	else if(gradients && stateGradHalo) {
+		const ConstGhostedVecHandler<scalar> gradh(gradvec);
+		const void *const sources[] = {uface->getLocalArrayLeft(), gradh.getArray()};
+		stateGradHalo->begin(sources);
+	}
+	else {
+		if(gradients) {
+			ierr = VecGhostUpdateBegin(gradvec, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		}
+		uface->updateSharedFacesBegin();
+	}
+	return ierr;
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+StatusCode FlowFV<scalar,secondOrderRequested,constVisc>::endHaloExchange(const bool gradients)
+	const
+{
+	StatusCode ierr = 0;
+	if(singleHalo) {
+		void *const targets[] = {work.template get<float>(wsSingleRightStates),
+		                         work.template get<float>(wsSingleGradients)};
+		singleHalo->end(targets);
+	}
+	else if(gradients && stateGradHalo) {
+		MutableGhostedVecHandler<scalar> gradh(gradvec);
+		void *const targets[] = {uface->getLocalArrayRight(), gradh.getArray()};
+		stateGradHalo->end(targets);
+	}
+	else {
+		uface->updateSharedFacesEnd();
+		if(gradients) {
+			ierr = VecGhostUpdateEnd(gradvec, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+		}
+	}
+	return ierr;
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+template <typename gscalar>
 void FlowFV<scalar,secondOrderRequested,constVisc>
-::compute_viscous_flux(const scalar *const normal,
-                       const scalar *const rcl, const scalar *const rcr,
+::compute_viscous_flux(const FaceGeometry<scalar>& fg,
                        const scalar *const ucell_l, const scalar *const ucell_r,
-                       const GradBlock_t<scalar,NDIM,NVARS>& gradsl,
-                       const GradBlock_t<scalar,NDIM,NVARS>& gradsr,
+                       const GradBlock_t<gscalar,NDIM,NVARS>& gradsl,
+                       const GradBlock_t<gscalar,NDIM,NVARS>& gradsr,
                        const scalar *const ul, const scalar *const ur,
                        scalar *const __restrict vflux) const
 {
@@ -389,9 +553,9 @@ void FlowFV<scalar,secondOrderRequested,constVisc>
 	}
 
 	scalar grad[NDIM][NVARS];
-	getFaceGradient_modifiedAverage(rcl, rcr, uctl, uctr, gradl, gradr, grad);
+	getFaceGradient_modifiedAverage(fg, uctl, uctr, gradl, gradr, grad);
 
-	computeViscousFlux<scalar,NDIM,NVARS,constVisc>(physics, normal, grad, ul, ur, vflux);
+	computeViscousFlux<scalar,NDIM,NVARS,constVisc>(physics, fg.normal, grad, ul, ur, vflux);
 }
 
 template<typename scalar, bool secondOrder, bool constVisc>
@@ -400,8 +564,6 @@ void FlowFV<scalar,secondOrder,constVisc>
                                 const freal *const ul, const freal *const ur,
                                 freal *const __restrict dvfi, freal *const __restrict dvfj) const
 {
-	const amat::Array2dView<freal> rc(rch.getArray(), m->gnelem()+m->gnConnFace(), NDIM);
-
 	freal upr[NVARS], upl[NVARS];
 
 	freal dupr[NVARS*NVARS], dupl[NVARS*NVARS];
@@ -429,20 +591,12 @@ void FlowFV<scalar,secondOrder,constVisc>
 	 */
 	freal dgradr[NDIM][NVARS][NVARS];
 
-	const fint lelem = m->gintfac(iface,0);
-	const fint relem = m->gintfac(iface,1);
+	const FaceGeometry<freal>& fg = facegeom[iface];
 
-	if(iface >= m->gPhyBFaceStart() && iface < m->gPhyBFaceEnd())
-		getFaceGradientAndJacobian_thinLayer(&rc(lelem,0), &rcbp(iface-m->gPhyBFaceStart()),
-		                                     upl, upr, dupl, dupr, grad,
-		                                     dgradl, dgradr);
-	else
-		getFaceGradientAndJacobian_thinLayer(&rc(lelem,0), &rc(relem,0), upl, upr, dupl, dupr, grad,
-		                                     dgradl, dgradr);
+	getFaceGradientAndJacobian_thinLayer(fg, upl, upr, dupl, dupr, grad, dgradl, dgradr);
 
-	const std::array<scalar,NDIM> n = m->gnormal(iface);
-	computeViscousFluxJacobian<scalar,NDIM,NVARS,constVisc>(jphy, &n[0], ul, ur, grad, dgradl, dgradr,
-	                                                        dvfi, dvfj);
+	computeViscousFluxJacobian<scalar,NDIM,NVARS,constVisc>(jphy, fg.normal, ul, ur, grad,
+	                                                        dgradl, dgradr, dvfi, dvfj);
 }
 
 template<typename scalar, bool secondOrder, bool constVisc>
@@ -452,8 +606,6 @@ void FlowFV<scalar,secondOrder,constVisc>
                                             freal *const __restrict dvfi,
                                             freal *const __restrict dvfj) const
 {
-	const amat::Array2dView<freal> rc(rch.getArray(), m->gnelem()+m->gnConnFace(), NDIM);
-
 	// compute non-dimensional viscosity and thermal conductivity
 	const freal muRe = constVisc ?
 			jphy.getConstantViscosityCoeff()
@@ -463,36 +615,24 @@ void FlowFV<scalar,secondOrder,constVisc>
 
 	const freal rho = 0.5*(ul[0]+ur[0]);
 
-	// the vector from the left cell-centre to the right, and its magnitude
-	freal dr[NDIM], dist=0;
-
-	const fint lelem = m->gintfac(iface,0);
-	const fint relem = m->gintfac(iface,1);
-	for(int i = 0; i < NDIM; i++) {
-		dr[i] = rc(relem,i)-rc(lelem,i);
-		dist += dr[i]*dr[i];
-	}
-
-	dist = sqrt(dist);
-	for(int i = 0; i < NDIM; i++) {
-		dr[i] /= dist;
-	}
+	// inverse of the distance between the left and right cell-centres
+	const freal invdist = facegeom[iface].invdist;
 
 	for(int i = 0; i < NVARS; i++)
 	{
-		dvfi[i*NVARS+i] -= muRe/(rho*dist);
-		dvfj[i*NVARS+i] -= muRe/(rho*dist);
+		dvfi[i*NVARS+i] -= muRe*invdist/rho;
+		dvfj[i*NVARS+i] -= muRe*invdist/rho;
 	}
 }
 
 template<typename scalar, bool secondOrderRequested, bool constVisc>
 void FlowFV<scalar,secondOrderRequested,constVisc>
-::compute_fluxes(const scalar *const u, const scalar *const gradients,
+::compute_fluxes(const fint fstart, const fint fend,
+                 const scalar *const u, const scalar *const gradients,
                  const scalar *const uleft, const scalar *const uright,
                  const scalar *const ug,
                  scalar *const res) const
 {
-	const amat::Array2dView<freal> rc(rch.getArray(), m->gnelem()+m->gnConnFace(), NDIM);
 	const GradBlock_t<scalar,NDIM,NVARS> *const grads
 		= reinterpret_cast<const GradBlock_t<scalar,NDIM,NVARS>*>(gradients);
 
@@ -500,7 +640,6 @@ void FlowFV<scalar,secondOrderRequested,constVisc>
 	 * responsible only for residuals in its own cells while fluxes across connectivity faces are
 	 * computed twice - once by each subdomain.
 	 */
-	Eigen::Map<MVector<scalar>> residual(res, m->gnelem(), NVARS);
 
 	// Compute fluxes.
 	/**
@@ -516,38 +655,137 @@ void FlowFV<scalar,secondOrderRequested,constVisc>
 	 */
 
 #pragma omp parallel for default(shared)
-	for(fint ied = m->gFaceStart(); ied < m->gFaceEnd(); ied++)
+	for(fint ibeg = fstart; ibeg < fend; ibeg += FACE_BATCH)
 	{
-		const std::array<scalar,NDIM> n = m->gnormal(ied);
-		const scalar len = m->gfacemetric(ied,NDIM);
+		const int nb = std::min(FACE_BATCH, fend-ibeg);
+		add_face_batch_fluxes(ibeg, nb, reinterpret_cast<const scalar(*)[NVARS]>(uleft+ibeg*NVARS),
+		                      reinterpret_cast<const scalar(*)[NVARS]>(uright+ibeg*NVARS),
+		                      u, grads, ug, res);
+	}
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::add_face_batch_fluxes(const fint ibeg, const int nb,
+                        const scalar (*const uleft)[NVARS], const scalar (*const uright)[NVARS],
+                        const scalar *const u, const GradBlock_t<scalar,NDIM,NVARS> *const grads,
+                        const scalar *const ug, scalar *const res) const
+{
+	(this->*faceBatchKernel)(ibeg, nb, uleft, uright, u, grads, ug, res);
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::add_face_batch_fluxes(const fint ibeg, const int nb,
+                        const scalar (*const uleft)[NVARS], const scalar (*const uright)[NVARS],
+                        const scalar *const u, const GradBlock_t<float,NDIM,NVARS> *const grads,
+                        const scalar *const ug, scalar *const res) const
+{
+	(this->*singleFaceBatchKernel)(ibeg, nb, uleft, uright, u, grads, ug, res);
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+template <typename sscalar>
+typename FlowFV<scalar,secondOrderRequested,constVisc>::template FaceBatchKernel<sscalar>
+FlowFV<scalar,secondOrderRequested,constVisc>::select_face_batch_kernel() const
+{
+	const bool visc = pconfig.viscous_sim;
+	if(nconfig.specialized_kernels)
+	{
+		// the factory creates the inviscid flux from the same name
+		if(nconfig.conv_numflux == "ROE") {
+			assert(dynamic_cast<const RoeFlux<scalar>*>(inviflux));
+			return visc ? &FlowFV::add_face_batch_fluxes_kernel<RoeFlux<scalar>,true,sscalar>
+				: &FlowFV::add_face_batch_fluxes_kernel<RoeFlux<scalar>,false,sscalar>;
+		}
+		else if(nconfig.conv_numflux == "HLLC") {
+			assert(dynamic_cast<const HLLCFlux<scalar>*>(inviflux));
+			return visc ? &FlowFV::add_face_batch_fluxes_kernel<HLLCFlux<scalar>,true,sscalar>
+				: &FlowFV::add_face_batch_fluxes_kernel<HLLCFlux<scalar>,false,sscalar>;
+		}
+	}
+	return visc ? &FlowFV::add_face_batch_fluxes_kernel<InviscidFlux<scalar>,true,sscalar>
+		: &FlowFV::add_face_batch_fluxes_kernel<InviscidFlux<scalar>,false,sscalar>;
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+template <typename Flux, bool viscous, typename sscalar>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::add_face_batch_fluxes_kernel(const fint ibeg, const int nb,
+                               const scalar (*const uleft)[NVARS],
+                               const scalar (*const uright)[NVARS],
+                               const scalar *const u,
+                               const GradBlock_t<sscalar,NDIM,NVARS> *const grads,
+                               const scalar *const ug, scalar *const res) const
+{
+	const Flux *const flux = static_cast<const Flux*>(inviflux);
+	Eigen::Map<MVector<scalar>> residual(res, m->gnelem(), NVARS);
+	scalar bfluxes[FACE_BATCH][NVARS];
+
+	/* If the inviscid flux has a vectorized batched implementation, the states and normals of
+	 * the batch are gathered into the variable-by-variable layout it needs.
+	 */
+	if(flux->vectorized_batch())
+	{
+		// the last batch is padded with copies of its last face
+		scalar bul[NVARS][FACE_BATCH], bur[NVARS][FACE_BATCH], bn[NDIM][FACE_BATCH],
+			bflux[NVARS][FACE_BATCH];
+		for(int i = 0; i < FACE_BATCH; i++) {
+			const int j = std::min(i,nb-1);
+			for(int ivar = 0; ivar < NVARS; ivar++) {
+				bul[ivar][i] = uleft[j][ivar];
+				bur[ivar][i] = uright[j][ivar];
+			}
+			for(int idim = 0; idim < NDIM; idim++)
+				bn[idim][i] = facegeom[ibeg+j].normal[idim];
+		}
+
+		flux->get_flux_batch(bul, bur, bn, bflux);
+
+		for(int i = 0; i < nb; i++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				bfluxes[i][ivar] = bflux[ivar][i];
+	}
+	else
+		for(int i = 0; i < nb; i++)
+			flux->get_flux(uleft[i], uright[i], facegeom[ibeg+i].normal, bfluxes[i]);
+
+	for(int i = 0; i < nb; i++)
+	{
+		const fint ied = ibeg+i;
+		const FaceGeometry<scalar>& fg = facegeom[ied];
+		const scalar len = fg.len;
 		const fint lelem = m->gintfac(ied,0);
 		const fint relem = m->gintfac(ied,1);
-		scalar fluxes[NVARS];
-
-		inviflux->get_flux(&uleft[ied*NVARS], &uright[ied*NVARS], &n[0], fluxes);
+		scalar *const fluxes = bfluxes[i];
 
 		// integrate over the face
 		for(int ivar = 0; ivar < NVARS; ivar++)
 			fluxes[ivar] *= len;
 
-		if(pconfig.viscous_sim)
+		if(viscous)
 		{
 			const fint ibpface = ied - m->gPhyBFaceStart();
 			const bool isPhyBoun = (ied >= m->gPhyBFaceStart() && ied < m->gPhyBFaceEnd());
-			const scalar *const rcr = isPhyBoun ? &rcbp(ibpface,0) : &rc(relem,0);
 			const scalar *const ucellright
 				= isPhyBoun ? &ug[ibpface*NVARS] : &u[relem*NVARS];
-			const GradBlock_t<scalar,NDIM,NVARS>& gradright = isPhyBoun ? grads[lelem] : grads[relem];
+			const GradBlock_t<sscalar,NDIM,NVARS>& gradright
+				= isPhyBoun ? grads[lelem] : grads[relem];
 
 			scalar vflux[NVARS];
-			compute_viscous_flux(&n[0], &rc(lelem,0), rcr,
-			                     &u[lelem*NVARS], ucellright, grads[lelem], gradright,
-			                     &uleft[ied*NVARS], &uright[ied*NVARS], vflux);
+			compute_viscous_flux(fg, &u[lelem*NVARS], ucellright, grads[lelem], gradright,
+			                     uleft[i], uright[i], vflux);
 
 			for(int ivar = 0; ivar < NVARS; ivar++)
 				fluxes[ivar] += vflux[ivar]*len;
 		}
 
+		if(cellAssembly) {
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				faceflux[ied*NVARS+ivar] = fluxes[ivar];
+			continue;
+		}
+
 		/// We assemble the negative of the residual ( M du/dt + r(u) = 0).
 		for(int ivar = 0; ivar < NVARS; ivar++) {
 #pragma omp atomic update
@@ -562,6 +800,30 @@ void FlowFV<scalar,secondOrderRequested,constVisc>
 	}
 }
 
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+void FlowFV<scalar,secondOrderRequested,constVisc>::gatherFaceFluxes(scalar *const res) const
+{
+	Eigen::Map<MVector<scalar>> residual(res, m->gnelem(), NVARS);
+
+	// Each cell is visited by one thread only, so no synchronization is needed.
+	// As in the face-based assembly, we assemble the negative of the residual.
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m->gnelem(); iel++)
+	{
+		for(EIndex ifael = 0; ifael < m->gnfael(iel); ifael++)
+		{
+			const fint iface = m->gelemface(iel,ifael);
+			const scalar *const flux = &faceflux[iface*NVARS];
+			if(m->gintfac(iface,0) == iel)
+				for(int ivar = 0; ivar < NVARS; ivar++)
+					residual(iel,ivar) -= flux[ivar];
+			else
+				for(int ivar = 0; ivar < NVARS; ivar++)
+					residual(iel,ivar) += flux[ivar];
+		}
+	}
+}
+
 // compute max allowable time steps
 template<typename scalar, bool secondOrderRequested, bool constVisc>
 void FlowFV<scalar,secondOrderRequested,constVisc>
@@ -569,7 +831,7 @@ void FlowFV<scalar,secondOrderRequested,constVisc>
                        const amat::Array2dView<scalar> uright,
                        freal *const timesteps) const
 {
-	amat::Array2d<freal> integ(m->gnelem(),1);
+	amat::Array2dMutableView<freal> integ(work.template get<freal>(wsSpectralRadii), m->gnelem(), 1);
 #pragma omp parallel for simd default(shared)
 	for(fint iel = 0; iel < m->gnelem(); iel++)
 	{
@@ -579,57 +841,85 @@ void FlowFV<scalar,secondOrderRequested,constVisc>
 #pragma omp parallel for default(shared)
 	for(fint ied = m->gFaceStart(); ied < m->gFaceEnd(); ied++)
 	{
-		const std::array<scalar,NDIM> n = m->gnormal(ied);
-		// scalar n[NDIM];
-		// n[0] = m->gfacemetric(ied,0);
-		// n[1] = m->gfacemetric(ied,1);
-		const scalar len = m->gfacemetric(ied,NDIM);
-		const int lelem = m->gintfac(ied,0);
-		const int relem = m->gintfac(ied,1);
-		//calculate speeds of sound
-		const scalar ci = physics.getSoundSpeedFromConserved(&uleft(ied,0));
-		const scalar cj = physics.getSoundSpeedFromConserved(&uright(ied,0));
-		//calculate normal velocities
-		// const scalar vni = (uleft(ied,1)*n[0] +uleft(ied,2)*n[1])/uleft(ied,0);
-		// const scalar vnj = (uright(ied,1)*n[0] + uright(ied,2)*n[1])/uright(ied,0);
-		const scalar vni = dimDotProduct(&uleft(ied,1),&n[0])/uleft(ied,0);
-		const scalar vnj = dimDotProduct(&uright(ied,1),&n[0])/uright(ied,0);
-
-		scalar specradi = (fabs(vni)+ci)*len;
-		scalar specradj = (fabs(vnj)+cj)*len;
-
-		if(pconfig.viscous_sim)
-		{
-			scalar mui, muj;
-			if(constVisc) {
-				mui = physics.getConstantViscosityCoeff();
-				muj = physics.getConstantViscosityCoeff();
-			}
-			else {
-				mui = physics.getViscosityCoeffFromConserved(&uleft(ied,0));
-				muj = physics.getViscosityCoeffFromConserved(&uright(ied,0));
-			}
-			const scalar coi = std::max(4.0/(3*uleft(ied,0)), physics.g/uleft(ied,0));
-			const scalar coj = std::max(4.0/(3*uright(ied,0)), physics.g/uright(ied,0));
+		add_face_spectral_radii(ied, &uleft(ied,0), &uright(ied,0), &integ(0));
+	}
 
-			specradi += coi*mui/physics.Pr * len*len/m->garea(lelem);
-			if(relem < m->gnelem())
-				specradj += coj*muj/physics.Pr * len*len/m->garea(relem);
+	compute_timesteps_from_integrals(&integ(0), timesteps);
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::add_face_spectral_radii(const fint ied, const scalar *const ul, const scalar *const ur,
+                          freal *const integ) const
+{
+	const scalar *const n = facegeom[ied].normal;
+	const scalar len = facegeom[ied].len;
+	const int lelem = m->gintfac(ied,0);
+	const int relem = m->gintfac(ied,1);
+	//calculate speeds of sound
+	const scalar ci = physics.getSoundSpeedFromConserved(ul);
+	const scalar cj = physics.getSoundSpeedFromConserved(ur);
+	//calculate normal velocities
+	const scalar vni = dimDotProduct(&ul[1],n)/ul[0];
+	const scalar vnj = dimDotProduct(&ur[1],n)/ur[0];
+
+	scalar specradi = (fabs(vni)+ci)*len;
+	scalar specradj = (fabs(vnj)+cj)*len;
+
+	if(pconfig.viscous_sim)
+	{
+		scalar mui, muj;
+		if(constVisc) {
+			mui = physics.getConstantViscosityCoeff();
+			muj = physics.getConstantViscosityCoeff();
 		}
+		else {
+			mui = physics.getViscosityCoeffFromConserved(ul);
+			muj = physics.getViscosityCoeffFromConserved(ur);
+		}
+		const scalar coi = std::max(4.0/(3*ul[0]), physics.g/ul[0]);
+		const scalar coj = std::max(4.0/(3*ur[0]), physics.g/ur[0]);
+
+		specradi += coi*mui/physics.Pr * len*len*cellgeom[lelem].invarea;
+		if(relem < m->gnelem())
+			specradj += coj*muj/physics.Pr * len*len*cellgeom[relem].invarea;
+	}
+
+	if(cellAssembly) {
+		facespecrad[2*ied] = specradi;
+		facespecrad[2*ied+1] = specradj;
+		return;
+	}
 
 #pragma omp atomic update
-		integ(lelem) += specradi;
+	integ[lelem] += specradi;
 
-		if(relem < m->gnelem()) {
+	if(relem < m->gnelem()) {
 #pragma omp atomic update
-			integ(relem) += specradj;
-		}
+		integ[relem] += specradj;
+	}
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::compute_timesteps_from_integrals(freal *const integ, freal *const timesteps) const
+{
+	if(cellAssembly)
+	{
+#pragma omp parallel for default(shared)
+		for(fint iel = 0; iel < m->gnelem(); iel++)
+			for(EIndex ifael = 0; ifael < m->gnfael(iel); ifael++)
+			{
+				const fint iface = m->gelemface(iel,ifael);
+				integ[iel] += m->gintfac(iface,0) == iel ? facespecrad[2*iface]
+					: facespecrad[2*iface+1];
+			}
 	}
 
 #pragma omp parallel for simd default(shared)
 	for(fint iel = 0; iel < m->gnelem(); iel++)
 	{
-		timesteps[iel] = m->garea(iel)/integ(iel);
+		timesteps[iel] = m->garea(iel)/integ[iel];
 	}
 }
 
@@ -643,6 +933,9 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 	StatusCode ierr = 0;
 	//const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
 
+	if(fusedResidual)
+		return compute_residual_fused(uvec, rvec, gettimesteps, timesteps);
+
 	PetscInt locnelem;
 	ierr = VecGetLocalSize(uvec, &locnelem); CHKERRQ(ierr);
 	assert(locnelem % NVARS == 0);
@@ -654,7 +947,7 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 	Eigen::Map<const MVector<scalar>> u(uarr, m->gnelem()+m->gnConnFace(), NVARS);
 
 	{
-		amat::Array2dMutableView<scalar> uleft(uface.getLocalArrayLeft(), m->gnaface(),NVARS);
+		amat::Array2dMutableView<scalar> uleft(uface->getLocalArrayLeft(), m->gnaface(),NVARS);
 		// first, set cell-centered values of boundary cells as left-side values of boundary faces
 #pragma omp parallel for default(shared)
 		for(fint ied = m->gPhyBFaceStart(); ied < m->gPhyBFaceEnd(); ied++)
@@ -666,19 +959,17 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 	}
 
 	// cell-centred ghost cell values corresponding to physical boundaries
-	scalar *ubcell = nullptr;
-	if(m->gnbface() > 0)
-		ubcell = new scalar[m->gnbface()*NVARS];
+	scalar *const ubcell = work.template get<scalar>(wsGhostStates);
 
 	if(secondOrderRequested)
 	{
-		amat::Array2dMutableView<scalar> uleft(uface.getLocalArrayLeft(), m->gnaface(),NVARS);
-		amat::Array2dMutableView<scalar> uright(uface.getLocalArrayRight(), m->gnaface(),NVARS);
+		amat::Array2dMutableView<scalar> uleft(uface->getLocalArrayLeft(), m->gnaface(),NVARS);
+		amat::Array2dMutableView<scalar> uright(uface->getLocalArrayRight(), m->gnaface(),NVARS);
 
 		// get cell average values at ghost cells using BCs for reconstruction
 		compute_boundary_states(&uleft(m->gPhyBFaceStart(),0), &uright(m->gPhyBFaceStart(),0));
 
-		MVector<scalar> up(m->gnelem()+m->gnConnFace(), NVARS);
+		MVector<scalar>& up = uprim;
 
 		// convert cell-centered state vectors to primitive variables
 #pragma omp parallel default(shared)
@@ -708,7 +999,25 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 		}
 
 		// In case of WENO reconstruction, we need gradients at conn ghost cells immediately
-		if(nconfig.reconstruction == "WENO")
+		if(weno)
+		{
+			// Gradients at the second ghost layer, which includes the conn ghost cells
+			{
+				const ConstGhostedVecHandler<scalar> gradh(gradvec);
+				ghostGradExchange->begin(gradh.getArray());
+			}
+			ghostGradExchange->end();
+
+			MutableGhostedVecHandler<scalar> gradh(gradvec);
+			scalar *const grads = gradh.getArray();
+			const scalar *const layergrads = ghostGradExchange->received();
+#pragma omp parallel for default(shared)
+			for(fint icface = 0; icface < m->gnConnFace(); icface++)
+				for(int j = 0; j < NDIM*NVARS; j++)
+					grads[(m->gnelem()+icface)*NDIM*NVARS+j]
+						= layergrads[ghostLayer->connSlot(icface)*NDIM*NVARS+j];
+		}
+		else if(nconfig.reconstruction == "WENO")
 		{
 			ierr = VecGhostUpdateBegin(gradvec, INSERT_VALUES, SCATTER_FORWARD);
 			CHKERRQ(ierr);
@@ -722,10 +1031,12 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 			lim->compute_face_values(up, ug, gradh.getArray(), uleft, uright);
 		}
 
-		if(nconfig.reconstruction != "WENO")
-		{
-			ierr = VecGhostUpdateBegin(gradvec, INSERT_VALUES, SCATTER_FORWARD);
-			CHKERRQ(ierr);
+		// The other side of connectivity faces, computed here rather than received
+		if(weno) {
+			const ConstGhostedVecHandler<scalar> gradh(gradvec);
+			weno->compute_connectivity_ghost_values(up, gradh.getArray(),
+			                                        ghostGradExchange->received(), *ghostLayer,
+			                                        uright);
 		}
 
 		// Convert face values back to conserved variables - gradients stay primitive.
@@ -733,9 +1044,14 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 		for(fint iface = m->gConnBFaceStart(); iface < m->gConnBFaceEnd(); iface++)
 		{
 			physics.getConservedFromPrimitive(&uleft(iface,0), &uleft(iface,0));
+			if(weno)
+				physics.getConservedFromPrimitive(&uright(iface,0), &uright(iface,0));
 		}
 
-		uface.updateSharedFacesBegin();
+		// In case of WENO reconstruction, gradients have already been exchanged
+		if(!weno) {
+			ierr = beginHaloExchange(nconfig.reconstruction != "WENO"); CHKERRQ(ierr);
+		}
 
 #pragma omp parallel default(shared)
 		{
@@ -748,8 +1064,8 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 #pragma omp for
 			for(fint iface = m->gPhyBFaceStart(); iface < m->gPhyBFaceEnd(); iface++)
 			{
-				physics.getConservedFromPrimitive(uface.getLocalArrayLeft()+iface*NVARS,
-				                                  uface.getLocalArrayLeft()+iface*NVARS);
+				physics.getConservedFromPrimitive(uface->getLocalArrayLeft()+iface*NVARS,
+				                                  uface->getLocalArrayLeft()+iface*NVARS);
 			}
 		}
 	}
@@ -758,8 +1074,8 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 		// if order is 1, set the face data same as cell-centred data for all faces
 
 		// set both left and right states for all interior and connectivity faces
-		amat::Array2dMutableView<scalar> uleft(uface.getLocalArrayLeft(), m->gnaface(),NVARS);
-		amat::Array2dMutableView<scalar> uright(uface.getLocalArrayRight(), m->gnaface(),NVARS);
+		amat::Array2dMutableView<scalar> uleft(uface->getLocalArrayLeft(), m->gnaface(),NVARS);
+		amat::Array2dMutableView<scalar> uright(uface->getLocalArrayRight(), m->gnaface(),NVARS);
 #pragma omp parallel for default(shared)
 		for(fint ied = m->gDomFaceStart(); ied < m->gDomFaceEnd(); ied++)
 		{
@@ -774,47 +1090,307 @@ FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual(const Vec uvec,
 	}
 
 	// get right (ghost) state at boundary faces for computing fluxes
-	compute_boundary_states(uface.getLocalArrayLeft()+m->gPhyBFaceStart()*NVARS,
-	                        uface.getLocalArrayRight()+m->gPhyBFaceStart()*NVARS);
+	compute_boundary_states(uface->getLocalArrayLeft()+m->gPhyBFaceStart()*NVARS,
+	                        uface->getLocalArrayRight()+m->gPhyBFaceStart()*NVARS);
+
+	MutableVecHandler<scalar> rvh(rvec);
+	scalar *const rarr = rvh.getArray();
+	// Depending on whether we want a 2nd order solution, we use the correct array for phy. boun.
+	//  ghost cells
+	const scalar *const ug_pb = secondOrderRequested ?
+		ubcell : uface->getLocalArrayRight()+m->gPhyBFaceStart()*NVARS;
+
+	/* Fluxes across physical boundary and subdomain faces need neither the states at connectivity
+	 * faces nor the gradients at connectivity ghost cells, so they are computed while those are
+	 * being exchanged. Only connectivity faces are left for after the exchange.
+	 */
+	const fint overlapend = secondOrderRequested && nconfig.overlap_communication ?
+		m->gSubDomFaceEnd() : m->gFaceStart();
+
+	{
+		ConstGhostedVecHandler<scalar> gradh;
+		if(secondOrderRequested)
+			gradh.setVec(gradvec);
+		const scalar *const gradarray = secondOrderRequested ? gradh.getArray() : nullptr;
+
+		compute_fluxes(m->gFaceStart(), overlapend, uarr, gradarray,
+		               uface->getLocalArrayLeft(), uface->getLocalArrayRight(), ug_pb, rarr);
+	}
+
+	if(secondOrderRequested && !weno) {
+		ierr = endHaloExchange(nconfig.reconstruction != "WENO"); CHKERRQ(ierr);
+	}
 
-	if(secondOrderRequested)
 	{
-		uface.updateSharedFacesEnd();
+		ConstGhostedVecHandler<scalar> gradh;
+		if(secondOrderRequested)
+			gradh.setVec(gradvec);
+		const scalar *const gradarray = secondOrderRequested ? gradh.getArray() : nullptr;
 
-		if(nconfig.reconstruction != "WENO")
+		compute_fluxes(overlapend, m->gFaceEnd(), uarr, gradarray,
+		               uface->getLocalArrayLeft(), uface->getLocalArrayRight(), ug_pb, rarr);
+	}
+
+	if(cellAssembly)
+		gatherFaceFluxes(rarr);
+
+	if(gettimesteps)
+	{
+		MutableVecHandler<freal> dtvh(timesteps);
+		freal *const dtm = dtvh.getArray();
+		compute_max_timestep(amat::Array2dView<scalar>(uface->getLocalArrayLeft(), m->gnaface(),
+		                                               NVARS),
+		                     amat::Array2dView<scalar>(uface->getLocalArrayRight(), m->gnaface(),
+		                                               NVARS),
+		                     dtm);
+	}
+
+	return ierr;
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+StatusCode
+FlowFV<scalar,secondOrderRequested,constVisc>::compute_residual_fused(const Vec uvec, Vec rvec,
+                                                                      const bool gettimesteps,
+                                                                      Vec timesteps) const
+{
+	StatusCode ierr = 0;
+
+	const ConstGhostedVecHandler<scalar> uvh(uvec);
+	const scalar *const uarr = uvh.getArray();
+	Eigen::Map<const MVector<scalar>> u(uarr, m->gnelem()+m->gnConnFace(), NVARS);
+
+	// cell-centred ghost cell values corresponding to physical boundaries
+	scalar *const ubcell = work.template get<scalar>(wsGhostStates);
+	{
+		scalar *const ubin = work.template get<scalar>(wsBoundaryStates);
+#pragma omp parallel for default(shared)
+		for(fint ied = m->gPhyBFaceStart(); ied < m->gPhyBFaceEnd(); ied++)
 		{
-			ierr = VecGhostUpdateEnd(gradvec, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+			const fint ielem = m->gintfac(ied,0);
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				ubin[(ied-m->gPhyBFaceStart())*NVARS+ivar] = u(ielem,ivar);
 		}
+		compute_boundary_states(ubin, ubcell);
 	}
 
-	ConstGhostedVecHandler<scalar> gradh;
+	// primitive cell-centred variables and limiters, only needed for second order
+	const MVector<scalar>& up = uprim;
+	freal *const lims = work.template get<freal>(wsLimiters);
+
 	if(secondOrderRequested)
-		gradh.setVec(gradvec);
-	const scalar *const gradarray = secondOrderRequested ? gradh.getArray() : nullptr;
+	{
+		scalar *const ugp = work.template get<scalar>(wsGhostPrimitive);
+
+#pragma omp parallel default(shared)
+		{
+#pragma omp for nowait
+			for(fint i = 0; i < m->gnbface(); i++)
+				physics.getPrimitiveFromConserved(&ubcell[i*NVARS], &ugp[i*NVARS]);
+
+#pragma omp for
+			for(fint iel = 0; iel < m->gnelem()+m->gnConnFace(); iel++)
+				physics.getPrimitiveFromConserved(&uarr[iel*NVARS], &uprim(iel,0));
+		}
+
+		const amat::Array2dView<scalar> upa(&up(0,0), m->gnelem()+m->gnConnFace(),NVARS);
+		const amat::Array2dView<scalar> ug(ugp, m->gnbface(), NVARS);
+
+		if(singleStorage)
+		{
+			float *const sgrads = work.template get<float>(wsSingleGradients);
+			gradcomp->compute_gradients_single(upa, ug, sgrads);
+			lim->compute_cell_limiters_single(up, sgrads, lims);
+
+			const GradBlock_t<float,NDIM,NVARS> *const grads
+				= reinterpret_cast<const GradBlock_t<float,NDIM,NVARS>*>(sgrads);
+
+			// Left states at connectivity faces are rounded only after reconstruction
+			float *const uleft = work.template get<float>(wsSingleLeftStates);
+#pragma omp parallel for default(shared)
+			for(fint icface = 0; icface < m->gnConnFace(); icface++)
+			{
+				scalar uf[NVARS];
+				reconstruct_face_state(m->gConnBFaceStart()+icface, 0, up, grads, lims, uf);
+				for(int ivar = 0; ivar < NVARS; ivar++)
+					uleft[icface*NVARS+ivar] = static_cast<float>(uf[ivar]);
+			}
+		}
+		else
+		{
+			{
+				MutableGhostedVecHandler<scalar> gradh(gradvec);
+				gradcomp->compute_gradients(upa, ug, gradh.getArray());
+			}
+
+			const ConstGhostedVecHandler<scalar> gradh(gradvec);
+			const GradBlock_t<scalar,NDIM,NVARS> *const grads
+				= reinterpret_cast<const GradBlock_t<scalar,NDIM,NVARS>*>(gradh.getArray());
+
+			lim->compute_cell_limiters(up, gradh.getArray(), lims);
+
+			// Left states at connectivity faces are needed by the neighbouring subdomains
+			scalar *const uleft = uface->getLocalArrayLeft();
+#pragma omp parallel for default(shared)
+			for(fint ied = m->gConnBFaceStart(); ied < m->gConnBFaceEnd(); ied++)
+				reconstruct_face_state(ied, 0, up, grads, lims, &uleft[ied*NVARS]);
+		}
+
+		// Gradients at connectivity ghost cells are only needed for viscous fluxes
+		ierr = beginHaloExchange(pconfig.viscous_sim); CHKERRQ(ierr);
+	}
 
 	MutableVecHandler<scalar> rvh(rvec);
 	scalar *const rarr = rvh.getArray();
-	// Depending on whether we want a 2nd order solution, we use the correct array for phy. boun.
-	//  ghost cells
-	const scalar *const ug_pb = secondOrderRequested ?
-		ubcell : uface.getLocalArrayRight()+m->gPhyBFaceStart()*NVARS;
 
-	compute_fluxes(uarr, gradarray, uface.getLocalArrayLeft(), uface.getLocalArrayRight(),
-	               ug_pb, rarr);
+	freal *const integarr = gettimesteps ? work.template get<freal>(wsSpectralRadii) : nullptr;
+	if(gettimesteps) {
+#pragma omp parallel for simd default(shared)
+		for(fint iel = 0; iel < m->gnelem(); iel++)
+			integarr[iel] = 0;
+	}
+
+	/* Physical boundary and subdomain faces are processed while the states at connectivity faces
+	 * are being exchanged, as they only need gradients at subdomain cells.
+	 */
+	const fint overlapend = secondOrderRequested && nconfig.overlap_communication ?
+		m->gSubDomFaceEnd() : m->gFaceStart();
+	{
+		ConstGhostedVecHandler<scalar> gradh;
+		if(secondOrderRequested && !singleStorage)
+			gradh.setVec(gradvec);
+		const scalar *const gradarray = secondOrderRequested && !singleStorage ?
+			gradh.getArray() : nullptr;
+
+		compute_fused_faces(m->gFaceStart(), overlapend, uarr, up, gradarray,
+		                    lims, ubcell, rarr, integarr);
+	}
+
+	if(secondOrderRequested) {
+		ierr = endHaloExchange(pconfig.viscous_sim); CHKERRQ(ierr);
+	}
+
+	{
+		ConstGhostedVecHandler<scalar> gradh;
+		if(secondOrderRequested && !singleStorage)
+			gradh.setVec(gradvec);
+		const scalar *const gradarray = secondOrderRequested && !singleStorage ?
+			gradh.getArray() : nullptr;
+
+		compute_fused_faces(overlapend, m->gFaceEnd(), uarr, up, gradarray,
+		                    lims, ubcell, rarr, integarr);
+	}
+
+	if(cellAssembly)
+		gatherFaceFluxes(rarr);
 
 	if(gettimesteps)
 	{
 		MutableVecHandler<freal> dtvh(timesteps);
-		freal *const dtm = dtvh.getArray();
-		compute_max_timestep(amat::Array2dView<scalar>(uface.getLocalArrayLeft(),m->gnaface(),NVARS),
-		                     amat::Array2dView<scalar>(uface.getLocalArrayRight(),m->gnaface(),NVARS),
-		                     dtm);
+		compute_timesteps_from_integrals(integarr, dtvh.getArray());
 	}
 
-	delete [] ubcell;
 	return ierr;
 }
 
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::compute_fused_faces(const fint fstart, const fint fend,
+                      const scalar *const u, const MVector<scalar>& up,
+                      const scalar *const gradarray,
+                      const freal *const lims, const scalar *const ubcell,
+                      scalar *const res, freal *const integ) const
+{
+	if(singleStorage)
+		compute_fused_face_range(fstart, fend, u, up,
+		                         reinterpret_cast<const GradBlock_t<float,NDIM,NVARS>*>
+		                         (work.template get<float>(wsSingleGradients)),
+		                         work.template get<float>(wsSingleLeftStates),
+		                         work.template get<float>(wsSingleRightStates),
+		                         lims, ubcell, res, integ);
+	else
+		compute_fused_face_range(fstart, fend, u, up,
+		                         reinterpret_cast<const GradBlock_t<scalar,NDIM,NVARS>*>(gradarray),
+		                         uface->getLocalArrayLeft()+m->gConnBFaceStart()*NVARS,
+		                         uface->getLocalArrayRight()+m->gConnBFaceStart()*NVARS,
+		                         lims, ubcell, res, integ);
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+template <typename sscalar>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::compute_fused_face_range(const fint fstart, const fint fend,
+                           const scalar *const u, const MVector<scalar>& up,
+                           const GradBlock_t<sscalar,NDIM,NVARS> *const grads,
+                           const sscalar *const connleft, const sscalar *const connright,
+                           const freal *const lims, const scalar *const ubcell,
+                           scalar *const res, freal *const integ) const
+{
+#pragma omp parallel for default(shared)
+	for(fint ibeg = fstart; ibeg < fend; ibeg += FACE_BATCH)
+	{
+		const int nb = std::min(FACE_BATCH, fend-ibeg);
+		scalar ul[FACE_BATCH][NVARS], ur[FACE_BATCH][NVARS];
+
+		for(int i = 0; i < nb; i++)
+		{
+			const fint ied = ibeg+i;
+			const bool isPhyBoun = (ied >= m->gPhyBFaceStart() && ied < m->gPhyBFaceEnd());
+
+			if(secondOrderRequested && ied >= m->gConnBFaceStart() && ied < m->gConnBFaceEnd())
+			{
+				// left state reconstructed earlier, right state received from the neighbour
+				const fint icface = ied - m->gConnBFaceStart();
+				for(int ivar = 0; ivar < NVARS; ivar++) {
+					ul[i][ivar] = connleft[icface*NVARS+ivar];
+					ur[i][ivar] = connright[icface*NVARS+ivar];
+				}
+				continue;
+			}
+
+			if(secondOrderRequested) {
+				reconstruct_face_state(ied, 0, up, grads, lims, ul[i]);
+				if(!isPhyBoun)
+					reconstruct_face_state(ied, 1, up, grads, lims, ur[i]);
+			}
+			else {
+				const fint lelem = m->gintfac(ied,0), relem = m->gintfac(ied,1);
+				for(int ivar = 0; ivar < NVARS; ivar++) {
+					ul[i][ivar] = u[lelem*NVARS+ivar];
+					if(!isPhyBoun)
+						ur[i][ivar] = u[relem*NVARS+ivar];
+				}
+			}
+
+			if(isPhyBoun)
+				compute_boundary_state(ied, ul[i], ur[i]);
+		}
+
+		add_face_batch_fluxes(ibeg, nb, ul, ur, u, grads, ubcell, res);
+
+		if(integ)
+			for(int i = 0; i < nb; i++)
+				add_face_spectral_radii(ibeg+i, ul[i], ur[i], integ);
+	}
+}
+
+template<typename scalar, bool secondOrderRequested, bool constVisc>
+template <typename sscalar>
+void FlowFV<scalar,secondOrderRequested,constVisc>
+::reconstruct_face_state(const fint ied, const int side, const MVector<scalar>& up,
+                         const GradBlock_t<sscalar,NDIM,NVARS> *const grads,
+                         const freal *const lims, scalar *const uf) const
+{
+	const fint iel = m->gintfac(ied,side);
+	const scalar *const dr = side == 0 ? facegeom[ied].drl : facegeom[ied].drr;
+
+	scalar upf[NVARS];
+	for(int ivar = 0; ivar < NVARS; ivar++)
+		upf[ivar] = linearExtrapolate(up(iel,ivar), grads[iel], ivar, lims[iel*NVARS+ivar], dr);
+
+	physics.getConservedFromPrimitive(upf, uf);
+}
+
 template<typename scalar, bool order2, bool constVisc>
 void FlowFV<scalar,order2,constVisc>
 ::compute_local_jacobian_interior(const fint iface,
@@ -825,11 +1401,11 @@ void FlowFV<scalar,order2,constVisc>
 	assert(iface >= m->gDomFaceStart());
 	assert(iface < m->gDomFaceEnd());
 
-	const std::array<freal,NDIM> n = m->gnormal(iface);
-	const freal len = m->gfacemetric(iface,NDIM);
+	const freal *const n = facegeom[iface].normal;
+	const freal len = facegeom[iface].len;
 
 	// NOTE: the values of L and U get REPLACED here, not added to
-	jiflux->get_jacobian(ul, ur, &n[0], &L(0,0), &U(0,0));
+	jiflux->get_jacobian(ul, ur, n, &L(0,0), &U(0,0));
 
 	if(pconfig.viscous_sim) {
 		compute_viscous_flux_jacobian(iface, ul, ur, &L(0,0), &U(0,0));
@@ -847,16 +1423,16 @@ void FlowFV<scalar,order2,constVisc>
 	assert(iface >= m->gPhyBFaceStart());
 	assert(iface < m->gPhyBFaceEnd());
 
-	const std::array<freal,NDIM> n = m->gnormal(iface);
-	const freal len = m->gfacemetric(iface,NDIM);
+	const freal *const n = facegeom[iface].normal;
+	const freal len = facegeom[iface].len;
 
 	freal uface[NVARS];
 	Eigen::Matrix<freal,NVARS,NVARS,Eigen::RowMajor> drdl;
 	Eigen::Matrix<freal,NVARS,NVARS,Eigen::RowMajor> right;
 
-	bcs.at(m->gbtags(iface,0))->computeGhostStateAndJacobian(ul, &n[0], uface, &drdl(0,0));
+	bcs.at(m->gbtags(iface,0))->computeGhostStateAndJacobian(ul, n, uface, &drdl(0,0));
 
-	jiflux->get_jacobian(ul, uface, &n[0], &left(0,0), &right(0,0));
+	jiflux->get_jacobian(ul, uface, n, &left(0,0), &right(0,0));
 
 	if(pconfig.viscous_sim) {
 		//compute_viscous_flux_approximate_jacobian(iface, &uarr[lelem*NVARS], uface,
@@ -20,10 +20,12 @@
 #ifndef FVENS_FLOW_SPATIAL_H
 #define FVENS_FLOW_SPATIAL_H
 
+#include <memory>
 #include "aspatial.hpp"
 #include "anumericalflux.hpp"
 #include "agradientschemes.hpp"
 #include "areconstruction.hpp"
+#include "limitedlinearreconstruction.hpp"
 #include "abc.hpp"
 #include "linalg/tracevector.hpp"
 
@@ -52,6 +54,51 @@ struct FlowNumericsConfig
 	std::string reconstruction;       ///< Method to use to reconstruct the solution
 	freal limiter_param;             ///< Parameter that is required for some limiters
 	bool order2;                      ///< Whether to compute a second-order solution
+	/// How face fluxes are accumulated into the residuals of cells - FACE or CELL
+	/** FACE: each face adds its flux to its two cells, using atomic updates with OpenMP.
+	 * CELL: the fluxes of all faces are stored, then each cell sums up the fluxes of its faces.
+	 * The latter needs storage for the fluxes of all faces but no atomic updates, and gives
+	 * results that do not depend on the number of threads.
+	 */
+	std::string residual_assembly;
+	/// Whether to compute the residual in a single pass over faces
+	/** Face states are then reconstructed, converted to conserved variables and used for the
+	 * numerical flux and the time step of each block of faces in turn, instead of being stored for
+	 * all faces in between separate passes. Needs a reconstruction which is
+	 * \ref SolutionReconstruction::cell_limited "cell-limited".
+	 */
+	bool fused_residual;
+	/// Whether to use residual kernels specialized at compile time for the inviscid flux and
+	///  viscous terms in use, where available
+	/** Otherwise, the numerical flux is always called through its virtual interface.
+	 */
+	bool specialized_kernels;
+	/// Whether to compute fluxes across faces which do not need data from other subdomains while
+	///  that data is being exchanged
+	/** Otherwise, the exchange of face states and gradients is completed before any flux is
+	 * computed.
+	 */
+	bool overlap_communication;
+	/// Whether to compute WENO states at connectivity faces from both sides locally, using a
+	///  second layer of ghost cells
+	/** WENO reconstruction needs the gradients at the neighbours of connectivity ghost cells.
+	 * These are then exchanged once, directly from the subdomains that own them, instead of
+	 * exchanging gradients at connectivity ghost cells and then face states.
+	 * Only supported for second-order WENO reconstruction with the residual computed in separate
+	 * passes; requesting it for any other second-order discretization is an error.
+	 */
+	bool second_ghost_layer;
+	/// Whether to store gradients and the states at connectivity faces in single precision
+	/** Gradients are rounded to float as they are stored, and connectivity face states as they are
+	 * stored and exchanged with the neighbouring subdomains; everything else, including the
+	 * reconstruction, the fluxes and the accumulation of the residual, stays in double precision.
+	 * This halves the memory traffic of the gradients and the size of the halo messages, but limits
+	 * the residual drop that can be reached.
+	 * Only supported for the fused residual with a gradient scheme that computes each cell's
+	 * gradient at once (not GREENGAUSS); requesting it for any other second-order discretization
+	 * is an error.
+	 */
+	bool single_precision_storage;
 };
 
 /// Abstract base class for finite volume discretization of flow problems
@@ -114,7 +161,10 @@ protected:
 	using Spatial<freal,NVARS>::rcbp;
 	using Spatial<freal,NVARS>::rcbptr;
 	using Spatial<scalar,NVARS>::gr;
+	using Spatial<scalar,NVARS>::facegeom;
+	using Spatial<scalar,NVARS>::cellgeom;
 	using Spatial<scalar,NVARS>::getFaceGradient_modifiedAverage;
+	using Spatial<scalar,NVARS>::work;
 
 	/// Problem specification
 	const FlowPhysicsConfig pconfig;
@@ -142,6 +192,14 @@ protected:
 	/// The different boundary conditions required for all the boundaries
 	const std::map<int,const FlowBC<scalar>*> bcs;
 
+	/// The boundary condition of each physical boundary face, so that \ref bcs need not be
+	///  searched for each face
+	std::vector<const FlowBC<scalar>*> bfacebcs;
+
+	/// Handle of the ghost cell states of physical boundary faces for \ref getGradients,
+	///  in \ref work
+	const int wsGradientGhostStates;
+
 	/// Computes flow variables at all boundaries (either Gauss points or ghost cell centers)
 	/// using the interior state provided
 	/** \param[in] instates provides the left (interior state) for each boundary face
@@ -199,8 +257,14 @@ public:
 	StatusCode compute_residual(const Vec u, Vec residual,
 	                            const bool gettimesteps, Vec timesteps) const;
 
-	/// Computes fluxes into the residual vector
-	void compute_fluxes(const scalar *const u, const scalar *const gradients,
+	/// Computes fluxes across a range of faces into the residual vector
+	/** For cell-based assembly, the fluxes are only stored; \ref gatherFaceFluxes must be called
+	 * once the fluxes of all faces are available.
+	 * \param fstart First face of the range
+	 * \param fend One past the last face of the range
+	 */
+	void compute_fluxes(const fint fstart, const fint fend,
+	                    const scalar *const u, const scalar *const gradients,
 	                    const scalar *const uleft, const scalar *const uright,
 	                    const scalar *const ug,
 	                    scalar *const res) const;
@@ -234,8 +298,11 @@ protected:
 	using Spatial<scalar,NVARS>::rch;
 	using Spatial<freal,NVARS>::rcbp;
 	using Spatial<scalar,NVARS>::gr;
+	using Spatial<scalar,NVARS>::facegeom;
+	using Spatial<scalar,NVARS>::cellgeom;
 	using Spatial<scalar,NVARS>::getFaceGradient_modifiedAverage;
 	using Spatial<scalar,NVARS>::getFaceGradientAndJacobian_thinLayer;
+	using Spatial<scalar,NVARS>::work;
 	using FlowFV_base<scalar>::pconfig;
 	using FlowFV_base<scalar>::nconfig;
 	using FlowFV_base<scalar>::physics;
@@ -244,6 +311,7 @@ protected:
 	using FlowFV_base<scalar>::lim;
 	using FlowFV_base<scalar>::bcs;
 	using FlowFV_base<scalar>::compute_boundary_states;
+	using FlowFV_base<scalar>::compute_boundary_state;
 
 	/// Reconstructed states at all faces
 	/** Ideally, this would be local inside compute_residual. However, its setup is non-trivial and
@@ -252,10 +320,11 @@ protected:
 	 * \note If memory for implicit solves is an issue, this can be moved inside \ref compute_residual
 	 *  in order to free up space during the implicit solve.
 	 */
-	mutable L2TraceVector<scalar,NVARS> uface;
+	mutable std::unique_ptr<L2TraceVector<scalar,NVARS>> uface;
 
 	/// Gradients at cell centres
 	/** This could be local to compute_residual, but same reason as for \ref uface applies here as well.
+	 * Neither this nor \ref uface is set up if \ref singleStorage is true.
 	 */
 	mutable Vec gradvec;
 
@@ -269,11 +338,224 @@ protected:
 	/// Numerical flux used for building Jacobian
 	const InviscidFlux<scalar> *const jiflux;
 
+	/// Whether face fluxes are gathered by cells rather than scattered by faces
+	/** \sa FlowNumericsConfig::residual_assembly
+	 */
+	const bool cellAssembly;
+
+	/// Integrated fluxes across all faces, used only for cell-based assembly
+	mutable std::vector<scalar> faceflux;
+
+	/// Integrated spectral radii of the left and right states of all faces,
+	///  used only for cell-based assembly
+	mutable std::vector<scalar> facespecrad;
+
+	/// Whether the residual is computed in a single pass over faces
+	/** \sa FlowNumericsConfig::fused_residual
+	 */
+	const bool fusedResidual;
+
+	/// Whether gradients and connectivity face states are stored in single precision
+	/** \sa FlowNumericsConfig::single_precision_storage
+	 */
+	const bool singleStorage;
+
+	/// Cell-centred primitive variables at subdomain and connectivity ghost cells,
+	///  used only for second order
+	/** Like \ref uface, it is allocated once in the constructor. It is not part of \ref work because
+	 * reconstruction schemes need it as a matrix.
+	 */
+	mutable MVector<scalar> uprim;
+
+	/// Handles of temporary arrays of the residual computation in \ref work
+	/// @{
+	const int wsGhostStates;         ///< Conserved ghost cell states at physical boundary faces
+	const int wsBoundaryStates;      ///< Interior cell states at physical boundary faces
+	const int wsGhostPrimitive;      ///< Primitive ghost cell states at physical boundary faces
+	const int wsLimiters;            ///< Limiter values of each cell, only for the fused residual
+	const int wsSpectralRadii;       ///< Integrated spectral radii of the faces of each cell
+	const int wsSingleGradients;     ///< Gradients at subdomain and connectivity ghost cells,
+	                                 ///<  only for single precision storage
+	const int wsSingleLeftStates;    ///< Left states of connectivity faces, only for single
+	                                 ///<  precision storage
+	const int wsSingleRightStates;   ///< Right states of connectivity faces, only for single
+	                                 ///<  precision storage
+	/// @}
+
+	/// Exchange of face states at connectivity faces together with gradients at connectivity
+	///  ghost cells, in one message per neighbouring subdomain
+	/** Only set up when the residual computation needs both at the same time; otherwise null,
+	 * in which case the states are exchanged by \ref uface and the gradients by PETSc.
+	 */
+	HaloExchange *const stateGradHalo;
+
+	/// Exchange of the single precision connectivity face states, and of the single precision
+	///  gradients at connectivity ghost cells for viscous flow
+	/** Only set up if \ref singleStorage is true, in which case it replaces all other exchanges.
+	 */
+	HaloExchange *const singleHalo;
+
+	/// The WENO reconstruction in use, if the second ghost layer is used; otherwise null
+	/** \sa FlowNumericsConfig::second_ghost_layer
+	 */
+	const WENOReconstruction<scalar,NVARS> *const weno;
+
+	/// Second layer of ghost cells, set up only if \ref weno is not null
+	const SecondGhostLayer *const ghostLayer;
+
+	/// Exchange of gradients into the slots of \ref ghostLayer, set up only if \ref weno is
+	///  not null
+	/** Replaces both the exchange of gradients at connectivity ghost cells and that of face
+	 * states at connectivity faces.
+	 */
+	GhostLayerExchange *const ghostGradExchange;
+
+	/// Starts the exchange of face states at connectivity faces, and of gradients if asked
+	StatusCode beginHaloExchange(const bool gradients) const;
+
+	/// Finishes the exchange started by \ref beginHaloExchange with the same argument
+	StatusCode endHaloExchange(const bool gradients) const;
+
+	/// Computes the residual and time steps in a single pass over faces
+	/** Unlike \ref compute_residual, the reconstructed states are not stored for all faces.
+	 * Instead, after gradients and limiters are computed at cells, the states of each block of
+	 * faces are reconstructed, converted to conserved variables and used right away to compute
+	 * fluxes and spectral radii. Only the left states of connectivity faces are stored, as they
+	 * must be sent to the neighbouring subdomains.
+	 */
+	StatusCode compute_residual_fused(const Vec u, Vec residual,
+	                                  const bool gettimesteps, Vec timesteps) const;
+
+	/// Computes and assembles the integrated fluxes across a batch of faces
+	/** The inviscid flux is used as an object of type Flux, so that its functions are called
+	 * without virtual dispatch when Flux is a final class. Viscous fluxes are computed if and only
+	 * if viscous is true. The gradients are stored as sscalar.
+	 * The arguments are as in \ref add_face_batch_fluxes.
+	 */
+	template <typename Flux, bool viscous, typename sscalar>
+	void add_face_batch_fluxes_kernel(const fint ibeg, const int nb,
+	                                  const scalar (*const ul)[NVARS],
+	                                  const scalar (*const ur)[NVARS],
+	                                  const scalar *const u,
+	                                  const GradBlock_t<sscalar,NDIM,NVARS> *const grads,
+	                                  const scalar *const ug, scalar *const res) const;
+
+	/// Type of the instantiations of \ref add_face_batch_fluxes_kernel for gradients stored
+	///  as sscalar
+	template <typename sscalar>
+	using FaceBatchKernel = void (FlowFV::*)(const fint, const int,
+	                                         const scalar (*const)[NVARS],
+	                                         const scalar (*const)[NVARS],
+	                                         const scalar *const,
+	                                         const GradBlock_t<sscalar,NDIM,NVARS> *const,
+	                                         const scalar *const, scalar *const) const;
+
+	/// Returns the flux kernel specialized for the inviscid flux and viscous terms in use
+	/** If there is no specialized kernel for the inviscid flux, or if specialized kernels are
+	 * disabled (\ref FlowNumericsConfig::specialized_kernels), a kernel calling the inviscid flux
+	 * through its virtual interface is returned.
+	 */
+	template <typename sscalar>
+	FaceBatchKernel<sscalar> select_face_batch_kernel() const;
+
+	/// The kernel used by \ref add_face_batch_fluxes
+	const FaceBatchKernel<scalar> faceBatchKernel;
+
+	/// The kernel used by \ref add_face_batch_fluxes for single precision gradients
+	const FaceBatchKernel<float> singleFaceBatchKernel;
+
+	/// Computes fluxes and, optionally, spectral radii for a range of faces in the fused residual
+	/** \param[in] fstart First face of the range
+	 * \param[in] fend One past the last face of the range
+	 * \param[in] u Cell-centred conserved variables, including connectivity ghost cells
+	 * \param[in] up Cell-centred primitive variables, only used for second order
+	 * \param[in] grads Cell-centred gradients of primitive variables, only used for second order
+	 * \param[in] connleft Conserved left states of connectivity faces, one row per connectivity
+	 *   face, only used for second order
+	 * \param[in] connright Conserved right states of connectivity faces received from the
+	 *   neighbouring subdomains, laid out as connleft
+	 * \param[in] lims Limiter values at subdomain cells, only used for second order
+	 * \param[in] ubcell Ghost cell-centred conserved variables at physical boundaries
+	 * \param[in,out] res Residual vector
+	 * \param[in,out] integ Integrals of spectral radii over cell boundaries, or null if time steps
+	 *   are not needed
+	 * The gradients and connectivity face states are stored as sscalar.
+	 */
+	template <typename sscalar>
+	void compute_fused_face_range(const fint fstart, const fint fend,
+	                              const scalar *const u, const MVector<scalar>& up,
+	                              const GradBlock_t<sscalar,NDIM,NVARS> *const grads,
+	                              const sscalar *const connleft, const sscalar *const connright,
+	                              const freal *const lims, const scalar *const ubcell,
+	                              scalar *const res, freal *const integ) const;
+
+	/// Calls \ref compute_fused_face_range with the gradients and connectivity face states in
+	///  the storage in use
+	/** \param[in] gradarray Gradients in \ref gradvec, if it is used; otherwise ignored
+	 * The other arguments are as in \ref compute_fused_face_range.
+	 */
+	void compute_fused_faces(const fint fstart, const fint fend,
+	                         const scalar *const u, const MVector<scalar>& up,
+	                         const scalar *const gradarray,
+	                         const freal *const lims, const scalar *const ubcell,
+	                         scalar *const res, freal *const integ) const;
+
+	/// Computes the conserved state at a face reconstructed from one of its cells
+	/** \param[in] side 0 to reconstruct from the left cell of the face, 1 from the right cell
+	 * \param[out] uf Reconstructed conserved variables
+	 * The other arguments are as in \ref compute_fused_face_range.
+	 */
+	template <typename sscalar>
+	void reconstruct_face_state(const fint ied, const int side, const MVector<scalar>& up,
+	                            const GradBlock_t<sscalar,NDIM,NVARS> *const grads,
+	                            const freal *const lims, scalar *const uf) const;
+
+	/// Adds the integrated fluxes across a batch of consecutive faces to the residual
+	/** For cell-based assembly, the fluxes are stored in \ref faceflux instead.
+	 * Calls \ref faceBatchKernel.
+	 * \param[in] ibeg The first face of the batch
+	 * \param[in] nb The number of faces in the batch, at most FACE_BATCH
+	 * \param[in] ul Left states of the faces of the batch (conserved variables)
+	 * \param[in] ur Right states of the faces of the batch (conserved variables)
+	 * The other arguments are as in \ref compute_fluxes.
+	 */
+	void add_face_batch_fluxes(const fint ibeg, const int nb,
+	                           const scalar (*const ul)[NVARS], const scalar (*const ur)[NVARS],
+	                           const scalar *const u,
+	                           const GradBlock_t<scalar,NDIM,NVARS> *const grads,
+	                           const scalar *const ug, scalar *const res) const;
+
+	/// Adds the integrated fluxes across a batch of faces using single precision gradients
+	/** Calls \ref singleFaceBatchKernel; otherwise as the above.
+	 */
+	void add_face_batch_fluxes(const fint ibeg, const int nb,
+	                           const scalar (*const ul)[NVARS], const scalar (*const ur)[NVARS],
+	                           const scalar *const u,
+	                           const GradBlock_t<float,NDIM,NVARS> *const grads,
+	                           const scalar *const ug, scalar *const res) const;
+
+	/// Adds the integrated spectral radii of the flux Jacobian at the two states of a face to the
+	///  integrals over the boundaries of the adjoining cells
+	/** For cell-based assembly, the spectral radii are stored in \ref facespecrad instead.
+	 */
+	void add_face_spectral_radii(const fint ied, const scalar *const ul, const scalar *const ur,
+	                             freal *const integ) const;
+
+	/// Computes time steps from the integrals of spectral radii over cell boundaries
+	/** For cell-based assembly, the stored spectral radii of faces are first added to integ.
+	 */
+	void compute_timesteps_from_integrals(freal *const integ, freal *const timesteps) const;
+
+	/// Adds the fluxes of each cell's faces to the cell's residual, for cell-based assembly
+	/** The flux of a face is subtracted from its left cell's residual and added to its right
+	 * cell's residual.
+	 * \param[in,out] residual Residuals of cells
+	 */
+	void gatherFaceFluxes(scalar *const residual) const;
+
 	/// Computes viscous flux across a face at one point
 	/** The output vflux still needs to be integrated on the face.
-	 * \param[in] normals
-	 * \param[in] ccleft
-	 * \param[in] ccright
+	 * \param[in] fg Geometric data of the face
 	 * \param[in] ucell_l Cell-centred conserved variables on left side of the face
 	 * \param[in] ucell_r Cell-centred conserved variables on right side of the face
 	 * \param[in] gradsLeft Cell-centred gradients ("optional", see below)
@@ -283,13 +565,13 @@ protected:
 	 * \param[in,out] vflux On output, contains the viscous flux across the face
 	 *
 	 * Note that grads can be unallocated if only first-order fluxes are being computed,
-	 * but ul and ur are always used.
+	 * but ul and ur are always used. The gradients may be stored in a lower precision gscalar.
 	 */
-	void compute_viscous_flux(const scalar *const normal,
-	                          const scalar *const ccleft, const scalar *const ccright,
+	template <typename gscalar>
+	void compute_viscous_flux(const FaceGeometry<scalar>& fg,
 	                          const scalar *const ucell_l, const scalar *const ucell_r,
-	                          const GradBlock_t<scalar,NDIM,NVARS>& gradsLeft,
-	                          const GradBlock_t<scalar,NDIM,NVARS>& gradsRight,
+	                          const GradBlock_t<gscalar,NDIM,NVARS>& gradsLeft,
+	                          const GradBlock_t<gscalar,NDIM,NVARS>& gradsRight,
 	                          const scalar *const ul, const scalar *const ur,
 	                          scalar *const vflux) const;
 
@@ -28,9 +28,10 @@ template <typename scalar, int nvars>
 WENOReconstruction<scalar,nvars>::WENOReconstruction(const UMesh<scalar,2> *const mesh,
                                                      const scalar *const c_centres, 
                                                      const scalar *const c_centres_ghost,
-                                                     const amat::Array2d<scalar>& gauss_r,
+                                                     const FaceGeometry<scalar> *const face_geom,
+                                                     const CellGeometry<scalar> *const cell_geom,
                                                      const freal l)
-	: SolutionReconstruction<scalar,nvars>(mesh, c_centres, c_centres_ghost, gauss_r),
+	: SolutionReconstruction<scalar,nvars>(mesh, c_centres, c_centres_ghost, face_geom, cell_geom),
 	  gamma{4.0}, lambda{l}, epsilon{1.0e-5}
 {
 }
@@ -92,25 +93,119 @@ void WENOReconstruction<scalar,nvars>
 				if(ielem < jelem) {
 					ufl(face,ivar) = u(ielem,ivar);
 					for(int j = 0; j < NDIM; j++)
-						ufl(face,ivar) += lgrad[j]*(gr(face,j) - ri[ielem*NDIM+j]);
+						ufl(face,ivar) += lgrad[j]*fgeom[face].drl[j];
 				}
 				else {
 					ufr(face,ivar) = u(ielem,ivar);
 					for(int j = 0; j < NDIM; j++)
-						ufr(face,ivar) += lgrad[j]*(gr(face,j) - ri[ielem*NDIM+j]);
+						ufr(face,ivar) += lgrad[j]*fgeom[face].drr[j];
 				}
 			}
 		}
 	}
 }
 
+template <typename scalar, int nvars>
+void WENOReconstruction<scalar,nvars>
+::compute_connectivity_ghost_values(const MVector<scalar>& u, const scalar *const gradarray,
+                                    const scalar *const layergradarray,
+                                    const SecondGhostLayer& layer,
+                                    amat::Array2dMutableView<scalar> ufr) const
+{
+	const GradBlock_t<scalar,NDIM,nvars> *const grads
+		= reinterpret_cast<const GradBlock_t<scalar,NDIM,nvars>*>(gradarray);
+	const GradBlock_t<scalar,NDIM,nvars> *const layergrads
+		= reinterpret_cast<const GradBlock_t<scalar,NDIM,nvars>*>(layergradarray);
+
+#pragma omp parallel for default(shared)
+	for(fint icface = 0; icface < m->gnConnFace(); icface++)
+	{
+		const fint face = m->gConnBFaceStart()+icface;
+		const fint ghost = m->gnelem()+icface;
+		const GradBlock_t<scalar,NDIM,nvars>& cgrad = layergrads[layer.connSlot(icface)];
+
+		for(int ivar = 0; ivar < nvars; ivar++)
+		{
+			scalar wsum = 0;
+			scalar lgrad[NDIM];
+			zeros(lgrad, NDIM);
+
+			// Central stencil
+			{
+				const scalar denom = pow( gradientMagnitude2(cgrad,ivar) + epsilon , gamma );
+				const scalar w = lambda / denom;
+				wsum += w;
+				for(int j = 0; j < NDIM; j++)
+					lgrad[j] += w*cgrad(j,ivar);
+			}
+
+			// Biased stencils, in the order of the owning subdomain
+			for(int jel = 0; jel < layer.stencilSize(icface); jel++)
+			{
+				const fint jelem = layer.stencil(icface,jel);
+				const GradBlock_t<scalar,NDIM,nvars>& ngrad
+					= jelem >= 0 ? grads[jelem] : layergrads[-1-jelem];
+
+				const scalar denom = pow( gradientMagnitude2(ngrad,ivar) + epsilon , gamma );
+				const scalar w = 1.0 / denom;
+				wsum += w;
+				for(int j = 0; j < NDIM; j++)
+					lgrad[j] += w*ngrad(j,ivar);
+			}
+
+			ufr(face,ivar) = u(ghost,ivar);
+			for(int j = 0; j < NDIM; j++)
+				ufr(face,ivar) += lgrad[j]/wsum*fgeom[face].drr[j];
+		}
+	}
+}
+
 template <typename scalar, int nvars>
 BarthJespersenLimiter<scalar,nvars>::BarthJespersenLimiter(const UMesh<scalar,2> *const mesh, 
                                                            const scalar *const r_centres, 
                                                            const scalar *const r_centres_ghost,
-                                                     const amat::Array2d<scalar>& gauss_r)
-	: SolutionReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, gauss_r)
+                                                           const FaceGeometry<scalar> *const face_geom,
+                                                           const CellGeometry<scalar> *const cell_geom)
+	: SolutionReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, face_geom, cell_geom)
+{
+}
+
+template <typename scalar, int nvars>
+template <typename gscalar>
+scalar BarthJespersenLimiter<scalar,nvars>
+::cellLimiter(const MVector<scalar>& u, const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+              const fint iel, const int ivar) const
 {
+	scalar duimin=0, duimax=0;
+	for(int j = 0; j < m->gnfael(iel); j++)
+	{
+		const fint jel = m->gesuel(iel,j);
+		const scalar dui = u(jel,ivar)-u(iel,ivar);
+		if(dui > duimax) duimax = dui;
+		if(dui < duimin) duimin = dui;
+	}
+
+	scalar lim = 1.0;
+	for(int j = 0; j < m->gnfael(iel); j++)
+	{
+		const fint face = m->gelemface(iel,j);
+
+		const scalar uface = linearExtrapolate(u(iel,ivar), grads[iel], ivar, 1.0,
+				iel < m->gesuel(iel,j) ? fgeom[face].drl : fgeom[face].drr);
+
+		scalar phiik;
+		const scalar diff = uface - u(iel,ivar);
+		if(diff>0)
+			phiik = 1 < duimax/diff ? 1 : duimax/diff;
+		else if(diff < 0)
+			phiik = 1 < duimin/diff ? 1 : duimin/diff;
+		else
+			phiik = 1;
+
+		if(phiik < lim)
+			lim = phiik;
+	}
+	return lim;
 }
 
 template <typename scalar, int nvars>
@@ -128,35 +223,7 @@ void BarthJespersenLimiter<scalar,nvars>::compute_face_values(const MVector<scal
 	{
 		for(int ivar = 0; ivar < nvars; ivar++)
 		{
-			scalar duimin=0, duimax=0;
-			for(int j = 0; j < m->gnfael(iel); j++)
-			{
-				const fint jel = m->gesuel(iel,j);
-				const scalar dui = u(jel,ivar)-u(iel,ivar);
-				if(dui > duimax) duimax = dui;
-				if(dui < duimin) duimin = dui;
-			}
-			
-			scalar lim = 1.0;
-			for(int j = 0; j < m->gnfael(iel); j++)
-			{
-				const fint face = m->gelemface(iel,j);
-				
-				const scalar uface = linearExtrapolate(u(iel,ivar), grads[iel], ivar, 1.0,
-						&gr(face,0), ri+iel*NDIM);
-				
-				scalar phiik;
-				const scalar diff = uface - u(iel,ivar);
-				if(diff>0)
-					phiik = 1 < duimax/diff ? 1 : duimax/diff;
-				else if(diff < 0)
-					phiik = 1 < duimin/diff ? 1 : duimin/diff;
-				else
-					phiik = 1;
-
-				if(phiik < lim)
-					lim = phiik;
-			}
+			const scalar lim = cellLimiter(u, grads, iel, ivar);
 			
 			for(int j = 0; j < m->gnfael(iel); j++)
 			{
@@ -165,44 +232,94 @@ void BarthJespersenLimiter<scalar,nvars>::compute_face_values(const MVector<scal
 				
 				if(iel < jel)
 					ufl(face,ivar) = linearExtrapolate(u(iel,ivar), grads[iel], ivar, lim,
-						&gr(face,0), ri+iel*NDIM);
+						fgeom[face].drl);
 				else
 					ufr(face,ivar) = linearExtrapolate(u(iel,ivar), grads[iel], ivar, lim,
-						&gr(face,0), ri+iel*NDIM);
+						fgeom[face].drr);
 			}
 
 		}
 	}
 }
 
+template <typename scalar, int nvars>
+void BarthJespersenLimiter<scalar,nvars>
+::compute_cell_limiters(const MVector<scalar>& u, const scalar *const gradarray,
+                        freal *const lims) const
+{
+	compute_all_cell_limiters(u, reinterpret_cast<const GradBlock_t<scalar,NDIM,nvars>*>(gradarray),
+	                          lims);
+}
+
+template <typename scalar, int nvars>
+void BarthJespersenLimiter<scalar,nvars>
+::compute_cell_limiters_single(const MVector<scalar>& u, const float *const gradarray,
+                               freal *const lims) const
+{
+	compute_all_cell_limiters(u, reinterpret_cast<const GradBlock_t<float,NDIM,nvars>*>(gradarray),
+	                          lims);
+}
+
+template <typename scalar, int nvars>
+template <typename gscalar>
+void BarthJespersenLimiter<scalar,nvars>
+::compute_all_cell_limiters(const MVector<scalar>& u,
+                            const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+                            freal *const lims) const
+{
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m->gnelem(); iel++)
+		for(int ivar = 0; ivar < nvars; ivar++)
+			lims[iel*nvars+ivar] = cellLimiter(u, grads, iel, ivar);
+}
+
 template <typename scalar, int nvars>
 VenkatakrishnanLimiter<scalar,nvars>
 ::VenkatakrishnanLimiter(const UMesh<scalar,2> *const mesh,
                          const scalar *const r_centres, 
                          const scalar *const r_centres_ghost,
-                         const amat::Array2d<scalar>& gauss_r,
+                         const FaceGeometry<scalar> *const face_geom,
+                         const CellGeometry<scalar> *const cell_geom,
                          const freal k_param)
-	: SolutionReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, gauss_r), K{k_param}
+	: SolutionReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, face_geom, cell_geom),
+	  K{k_param}
 {
 	std::cout << "  Venkatakrishnan Limiter: Constant K = " << K << std::endl;
-	// compute characteristic length, currently the maximum edge length, of all cells
-	clength.resize(m->gnelem());
-	static_assert(NDIM == 2, "Works only in 2D for now");
-#pragma omp parallel for default(shared)
-	for(fint iel = 0; iel < m->gnelem(); iel++)
+}
+
+template <typename scalar, int nvars>
+template <typename gscalar>
+scalar VenkatakrishnanLimiter<scalar,nvars>
+::cellLimiter(const MVector<scalar>& u, const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+              const fint iel, const int ivar, const scalar eps2) const
+{
+	scalar duimin=0, duimax=0;
+	for(int j = 0; j < m->gnfael(iel); j++)
 	{
-		for(int ifa = 0; ifa < m->gnnode(iel); ifa++)
-		{
-			scalar llen = 0;
-			const int inode = ifa, jnode = (ifa+1) % m->gnnode(iel);
-			for(int idim = 0; idim < NDIM; idim++)
-				llen += std::pow(m->gcoords(m->ginpoel(iel,inode),idim) 
-						- m->gcoords(m->ginpoel(iel,jnode),idim), 2);
+		const fint jel = m->gesuel(iel,j);
+		const scalar dui = u(jel,ivar)-u(iel,ivar);
+		if(dui > duimax) duimax = dui;
+		if(dui < duimin) duimin = dui;
+	}
 
-			if(clength[iel] < llen) clength[iel] = llen;
-		}
-		clength[iel] = std::sqrt(clength[iel]);
+	scalar lim = 1.0;
+	for(int j = 0; j < m->gnfael(iel); j++)
+	{
+		const fint face = m->gelemface(iel,j);
+
+		const scalar uface = linearExtrapolate(u(iel,ivar), grads[iel], ivar, 1.0,
+				iel < m->gesuel(iel,j) ? fgeom[face].drl : fgeom[face].drr);
+
+		const scalar dm = uface - u(iel,ivar);
+
+		// Venkatakrishnan modification
+		const scalar dp = dm < 0 ? duimin : duimax;
+		const scalar phiik = (dp*dp + 2*dp*dm + eps2)/(dp*dp + dp*dm + 2*dm*dm + eps2);
+
+		if(phiik < lim)
+			lim = phiik;
 	}
+	return lim;
 }
 
 template <typename scalar, int nvars>
@@ -219,36 +336,12 @@ void VenkatakrishnanLimiter<scalar,nvars>
 #pragma omp parallel for default(shared)
 	for(fint iel = 0; iel < m->gnelem(); iel++)
 	{
-		const scalar eps2 = std::pow(K*clength[iel], 3);
+		// the characteristic length of the cell is its maximum edge length
+		const scalar eps2 = std::pow(K*cgeom[iel].venklength, 3);
 
 		for(int ivar = 0; ivar < nvars; ivar++)
 		{
-			scalar duimin=0, duimax=0;
-			for(int j = 0; j < m->gnfael(iel); j++)
-			{
-				const fint jel = m->gesuel(iel,j);
-				const scalar dui = u(jel,ivar)-u(iel,ivar);
-				if(dui > duimax) duimax = dui;
-				if(dui < duimin) duimin = dui;
-			}
-			
-			scalar lim = 1.0;
-			for(int j = 0; j < m->gnfael(iel); j++)
-			{
-				const fint face = m->gelemface(iel,j);
-				
-				const scalar uface = linearExtrapolate(u(iel,ivar), grads[iel], ivar, 1.0,
-						&gr(face,0), ri+iel*NDIM);
-				
-				const scalar dm = uface - u(iel,ivar);
-
-				// Venkatakrishnan modification
-				const scalar dp = dm < 0 ? duimin : duimax;
-				const scalar phiik = (dp*dp + 2*dp*dm + eps2)/(dp*dp + dp*dm + 2*dm*dm + eps2);
-
-				if(phiik < lim)
-					lim = phiik;
-			}
+			const scalar lim = cellLimiter(u, grads, iel, ivar, eps2);
 			
 			for(int j = 0; j < m->gnfael(iel); j++)
 			{
@@ -257,16 +350,50 @@ void VenkatakrishnanLimiter<scalar,nvars>
 				
 				if(iel < jel)
 					ufl(face,ivar) = linearExtrapolate(u(iel,ivar), grads[iel], ivar, lim,
-						&gr(face,0), ri+iel*NDIM);
+						fgeom[face].drl);
 				else
 					ufr(face,ivar) = linearExtrapolate(u(iel,ivar), grads[iel], ivar, lim,
-						&gr(face,0), ri+iel*NDIM);
+						fgeom[face].drr);
 			}
 
 		}
 	}
 }
 
+template <typename scalar, int nvars>
+void VenkatakrishnanLimiter<scalar,nvars>
+::compute_cell_limiters(const MVector<scalar>& u, const scalar *const gradarray,
+                        freal *const lims) const
+{
+	compute_all_cell_limiters(u, reinterpret_cast<const GradBlock_t<scalar,NDIM,nvars>*>(gradarray),
+	                          lims);
+}
+
+template <typename scalar, int nvars>
+void VenkatakrishnanLimiter<scalar,nvars>
+::compute_cell_limiters_single(const MVector<scalar>& u, const float *const gradarray,
+                               freal *const lims) const
+{
+	compute_all_cell_limiters(u, reinterpret_cast<const GradBlock_t<float,NDIM,nvars>*>(gradarray),
+	                          lims);
+}
+
+template <typename scalar, int nvars>
+template <typename gscalar>
+void VenkatakrishnanLimiter<scalar,nvars>
+::compute_all_cell_limiters(const MVector<scalar>& u,
+                            const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+                            freal *const lims) const
+{
+#pragma omp parallel for default(shared)
+	for(fint iel = 0; iel < m->gnelem(); iel++)
+	{
+		const scalar eps2 = std::pow(K*cgeom[iel].venklength, 3);
+		for(int ivar = 0; ivar < nvars; ivar++)
+			lims[iel*nvars+ivar] = cellLimiter(u, grads, iel, ivar, eps2);
+	}
+}
+
 template class WENOReconstruction<freal,NVARS>;
 template class BarthJespersenLimiter<freal,NVARS>;
 template class VenkatakrishnanLimiter<freal,NVARS>;
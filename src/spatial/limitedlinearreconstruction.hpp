@@ -7,6 +7,7 @@
 #define FVENS_LIMITEDLINEARRECONSTRUCTION_H
 
 #include "areconstruction.hpp"
+#include "mesh/ghostlayer.hpp"
 
 namespace fvens {
 
@@ -38,7 +39,8 @@ public:
 	WENOReconstruction(const UMesh<scalar,2> *const mesh,
 	                   const scalar *const c_centres,
 	                   const scalar *const c_centres_ghost,
-	                   const amat::Array2d<scalar>& gauss_r,
+	                   const FaceGeometry<scalar> *const face_geom,
+	                   const CellGeometry<scalar> *const cell_geom,
 	                   const freal central_weight);
 
 	void compute_face_values(const MVector<scalar>& unknowns, 
@@ -46,10 +48,25 @@ public:
 	                         const scalar *const grads,
 	                         amat::Array2dMutableView<scalar> uface_left,
 	                         amat::Array2dMutableView<scalar> uface_right) const;
+
+	/// Computes the states at the ghost side of connectivity faces locally
+	/** The WENO-limited gradient of each connectivity ghost cell is computed here exactly as in
+	 * its own subdomain, from the gradients at the cells of its stencil. The face value then needs
+	 * no exchange of reconstructed states.
+	 * \param unknowns Cell-centred values at subdomain and connectivity ghost cells
+	 * \param grads Gradients at subdomain cells
+	 * \param layergrads Gradients at the slots of the second ghost layer
+	 * \param layer The second ghost layer
+	 * \param uface_right Right states at all faces; only connectivity faces are written
+	 */
+	void compute_connectivity_ghost_values(const MVector<scalar>& unknowns,
+	                                       const scalar *const grads,
+	                                       const scalar *const layergrads,
+	                                       const SecondGhostLayer& layer,
+	                                       amat::Array2dMutableView<scalar> uface_right) const;
 protected:
 	using SolutionReconstruction<scalar,nvars>::m;
-	using SolutionReconstruction<scalar,nvars>::ri;
-	using SolutionReconstruction<scalar,nvars>::gr;
+	using SolutionReconstruction<scalar,nvars>::fgeom;
 };
 
 /// Non-differentiable multidimensional slope limiter for linear reconstruction
@@ -63,17 +80,37 @@ public:
 	BarthJespersenLimiter(const UMesh<scalar,2> *const mesh,
 	                      const scalar *const c_centres,
 	                      const scalar *const c_centres_ghost,
-	                      const amat::Array2d<scalar>& gauss_r);
+	                      const FaceGeometry<scalar> *const face_geom,
+	                      const CellGeometry<scalar> *const cell_geom);
  
 	void compute_face_values(const MVector<scalar>& unknowns,
 	                         const amat::Array2dView<scalar> unknow_ghost,
 	                         const scalar *const grads,
 	                         amat::Array2dMutableView<scalar> uface_left,
 	                         amat::Array2dMutableView<scalar> uface_right) const;
+
+	bool cell_limited() const { return true; }
+
+	void compute_cell_limiters(const MVector<scalar>& unknowns, const scalar *const grads,
+	                           freal *const lims) const;
+
+	void compute_cell_limiters_single(const MVector<scalar>& unknowns, const float *const grads,
+	                                  freal *const lims) const;
+
 protected:
 	using SolutionReconstruction<scalar,nvars>::m;
-	using SolutionReconstruction<scalar,nvars>::ri;
-	using SolutionReconstruction<scalar,nvars>::gr;
+	using SolutionReconstruction<scalar,nvars>::fgeom;
+
+	/// Computes the limiter value of one variable at one cell from gradients stored as gscalar
+	template <typename gscalar>
+	scalar cellLimiter(const MVector<scalar>& u, const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+	                   const fint iel, const int ivar) const;
+
+	/// Computes the limiter values of all subdomain cells from gradients stored as gscalar
+	template <typename gscalar>
+	void compute_all_cell_limiters(const MVector<scalar>& u,
+	                               const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+	                               freal *const lims) const;
 };
 
 /// Differentiable modification of Barth-Jespersen limiter
@@ -86,9 +123,6 @@ class VenkatakrishnanLimiter: public SolutionReconstruction<scalar,nvars>
 	/// Parameter for adjusting limiting vs convergence
 	const freal K;
 
-	/// List of characteristic length of cells
-	std::vector<scalar> clength;
-
 public:
 	/** \param[in] k_param Smaller values lead to better limiting at the expense of convergence,
 	 *    higher values improve convergence at the expense of some oscillations in the solution.
@@ -96,17 +130,40 @@ public:
 	VenkatakrishnanLimiter(const UMesh<scalar,2> *const mesh,
 	                       const scalar *const c_centres,
 	                       const scalar *const c_centres_ghost,
-	                       const amat::Array2d<scalar>& gauss_r, const freal k_param);
+	                       const FaceGeometry<scalar> *const face_geom,
+	                       const CellGeometry<scalar> *const cell_geom, const freal k_param);
  
 	void compute_face_values(const MVector<scalar>& unknowns,
 	                         const amat::Array2dView<scalar> unknow_ghost,
 	                         const scalar *const grads,
 	                         amat::Array2dMutableView<scalar> uface_left,
 	                         amat::Array2dMutableView<scalar> uface_right) const;
+
+	bool cell_limited() const { return true; }
+
+	void compute_cell_limiters(const MVector<scalar>& unknowns, const scalar *const grads,
+	                           freal *const lims) const;
+
+	void compute_cell_limiters_single(const MVector<scalar>& unknowns, const float *const grads,
+	                                  freal *const lims) const;
+
 protected:
 	using SolutionReconstruction<scalar,nvars>::m;
-	using SolutionReconstruction<scalar,nvars>::ri;
-	using SolutionReconstruction<scalar,nvars>::gr;
+	using SolutionReconstruction<scalar,nvars>::fgeom;
+	using SolutionReconstruction<scalar,nvars>::cgeom;
+
+	/// Computes the limiter value of one variable at one cell from gradients stored as gscalar
+	/** \param eps2 The cube of K times the characteristic length of the cell
+	 */
+	template <typename gscalar>
+	scalar cellLimiter(const MVector<scalar>& u, const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+	                   const fint iel, const int ivar, const scalar eps2) const;
+
+	/// Computes the limiter values of all subdomain cells from gradients stored as gscalar
+	template <typename gscalar>
+	void compute_all_cell_limiters(const MVector<scalar>& u,
+	                               const GradBlock_t<gscalar,NDIM,nvars> *const grads,
+	                               freal *const lims) const;
 };
 
 }
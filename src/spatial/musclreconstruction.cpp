@@ -25,19 +25,21 @@ template <typename scalar, int nvars>
 MUSCLReconstruction<scalar,nvars>::MUSCLReconstruction(const UMesh<scalar,2> *const mesh,
                                                        const scalar *const r_centres, 
                                                        const scalar *const r_centres_ghost,
-                                                       const amat::Array2d<scalar>& gauss_r)
-	: SolutionReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, gauss_r),
+                                                       const FaceGeometry<scalar> *const face_geom,
+                                                       const CellGeometry<scalar> *const cell_geom)
+	: SolutionReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, face_geom, cell_geom),
 	eps{1e-8}, k{1.0/3.0}
 { }
 
 template <typename scalar, int nvars>
 inline scalar MUSCLReconstruction<scalar,nvars>::
-computeBiasedDifference(const scalar *const ri, const scalar *const rj,
+computeBiasedDifference(const FaceGeometry<scalar>& fg,
                         const scalar ui, const scalar uj, const scalar *const grads) const
 {
+	// rj - ri is the difference of the positions of the face centre relative to the two cells
 	scalar del = 0;
 	for(int idim = 0; idim < NDIM; idim++)
-		del += grads[idim]*(rj[idim]-ri[idim]);
+		del += grads[idim]*(fg.drl[idim]-fg.drr[idim]);
 
 	return 2.0*del - (uj-ui);
 }
@@ -62,8 +64,9 @@ template <typename scalar, int nvars>
 MUSCLVanAlbada<scalar,nvars>::MUSCLVanAlbada(const UMesh<scalar,2> *const mesh,
                                              const scalar *const r_centres,
                                              const scalar *const r_centres_ghost,
-                                             const amat::Array2d<scalar>& gauss_r)
-	: MUSCLReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, gauss_r)
+                                             const FaceGeometry<scalar> *const face_geom,
+                                             const CellGeometry<scalar> *const cell_geom)
+	: MUSCLReconstruction<scalar,nvars>(mesh, r_centres, r_centres_ghost, face_geom, cell_geom)
 { }
 
 template <typename scalar, int nvars>
@@ -84,8 +87,8 @@ void MUSCLVanAlbada<scalar,nvars>
 
 		for(int i = 0; i < nvars; i++)
 		{
-			const scalar deltam = computeBiasedDifference(ri+ielem*NDIM, ribp+ibface*NDIM,
-			                                              u(ielem,i), ug(ibface,i), &grads[ielem](0,i));
+			const scalar deltam = computeBiasedDifference(fgeom[ied], u(ielem,i), ug(ibface,i),
+			                                              &grads[ielem](0,i));
 
 			scalar phi_l = (2.0*deltam * (ug(ibface,i) - u(ielem,i)) + eps) 
 				/ (deltam*deltam + (ug(ibface,i) - u(ielem,i))*(ug(ibface,i) - u(ielem,i)) + eps);
@@ -108,10 +111,10 @@ void MUSCLVanAlbada<scalar,nvars>
 
 		for(int i = 0; i < nvars; i++)
 		{
-			const scalar deltam = computeBiasedDifference(ri+ielem*NDIM, ri+jelem*NDIM,
-			                                              u(ielem,i), u(jelem,i), &grads[ielem](0,i));
-			const scalar deltap = computeBiasedDifference(ri+ielem*NDIM, ri+jelem*NDIM,
-			                                              u(ielem,i), u(jelem,i), &grads[jelem](0,i));
+			const scalar deltam = computeBiasedDifference(fgeom[ied], u(ielem,i), u(jelem,i),
+			                                              &grads[ielem](0,i));
+			const scalar deltap = computeBiasedDifference(fgeom[ied], u(ielem,i), u(jelem,i),
+			                                              &grads[jelem](0,i));
 			
 			scalar phi_l = (2.0*deltam * (u(jelem,i) - u(ielem,i)) + eps) 
 				/ (deltam*deltam + (u(jelem,i) - u(ielem,i))*(u(jelem,i) - u(ielem,i)) + eps);
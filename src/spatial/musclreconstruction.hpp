@@ -20,7 +20,8 @@ public:
 	MUSCLReconstruction(const UMesh<scalar,2> *const mesh,
 	                    const scalar *const c_centres, 
 	                    const scalar *const c_centres_ghost,
-	                    const amat::Array2d<scalar>& gauss_r);
+	                    const FaceGeometry<scalar> *const face_geom,
+	                    const CellGeometry<scalar> *const cell_geom);
     
 	virtual void compute_face_values(const MVector<scalar>& unknowns, 
 	                                 const amat::Array2dView<scalar> unknow_ghost, 
@@ -30,9 +31,7 @@ public:
 
 protected:
 	using SolutionReconstruction<scalar,nvars>::m;
-	using SolutionReconstruction<scalar,nvars>::ri;
-	using SolutionReconstruction<scalar,nvars>::ribp;
-	using SolutionReconstruction<scalar,nvars>::gr;
+	using SolutionReconstruction<scalar,nvars>::fgeom;
 
 	const freal eps;                       ///< Small number
 	const freal k;                         ///< MUSCL order parameter
@@ -41,8 +40,9 @@ protected:
 	/** The direction of biasing depends on the gradients supplied in the last parameter.
 	 * If the gradient of the left cell is given, the backward-biased difference is computed;
 	 * if the gradient of the right cell is given, the forward-biased difference is computed.
+	 * \param fg Geometric data of the face, used for the vector between the two cell centres
 	 */
-	scalar computeBiasedDifference(const scalar *const ri, const scalar *const rj,
+	scalar computeBiasedDifference(const FaceGeometry<scalar>& fg,
 	                               const scalar ui, const scalar uj,
 	                               const scalar *const grads) const;
 
@@ -75,7 +75,8 @@ public:
 	MUSCLVanAlbada(const UMesh<scalar,2> *const mesh,
 	               const scalar *const c_centres, 
 	               const scalar *const c_centres_ghost,
-	               const amat::Array2d<scalar>& gauss_r);
+	               const FaceGeometry<scalar> *const face_geom,
+	               const CellGeometry<scalar> *const cell_geom);
     
 	void compute_face_values(const MVector<scalar>& unknowns, 
 	                         const amat::Array2dView<scalar> unknow_ghost, 
@@ -84,9 +85,7 @@ public:
 	                         amat::Array2dMutableView<scalar> uface_right) const;
 protected:
 	using SolutionReconstruction<scalar,nvars>::m;
-	using SolutionReconstruction<scalar,nvars>::ri;
-	using SolutionReconstruction<scalar,nvars>::ribp;
-	using SolutionReconstruction<scalar,nvars>::gr;
+	using SolutionReconstruction<scalar,nvars>::fgeom;
 	using MUSCLReconstruction<scalar,nvars>::computeBiasedDifference;
 	using MUSCLReconstruction<scalar,nvars>::musclReconstructLeft;
 	using MUSCLReconstruction<scalar,nvars>::musclReconstructRight;
@@ -12,22 +12,23 @@
 namespace fvens {
 
 /// Reconstructs a face value by a "limited linear" extrapolation
-/** Note that depending on the limiter, this could be nonlinear.
+/** Note that depending on the limiter, this could be nonlinear. The gradients may be stored in a
+ * lower precision gscalar; the extrapolation is carried out in the precision of scalar.
  */
-template <typename scalar, int nvars>
+template <typename scalar, typename gscalar, int nvars>
 static inline scalar
 linearExtrapolate(const scalar ucell,                          ///< Relevant cell centred value
-                  const GradBlock_t<scalar,NDIM,nvars>& grad,  ///< Gradients
+                  const GradBlock_t<gscalar,NDIM,nvars>& grad, ///< Gradients
                   const int ivar,                              ///< Index of physical variable to be
                   ///<  reconstructed
                   const freal lim,                            ///< Limiter value
-                  const scalar *const gp,                      ///< Quadrature point coords
-                  const scalar *const rc                       ///< Cell centre coords
+                  const scalar *const dr                       ///< Position of the quadrature
+                  ///<  point relative to the cell centre
                   )
 {
 	scalar uface = ucell;
 	for(int idim = 0; idim < NDIM; idim++)
-		uface += lim*grad(idim,ivar)*(gp[idim] - rc[idim]);
+		uface += lim*grad(idim,ivar)*dr[idim];
 	return uface;
 }
 
@@ -169,7 +169,8 @@ SolutionReconstruction<scalar,nvars>* create_mutable_reconstruction(const std::s
                                                                     const UMesh<scalar,NDIM> *const m,
                                                                     const scalar *const rc,
                                                                     const scalar *const rcbp,
-                                                                    const amat::Array2d<scalar>& gr,
+                                                                    const FaceGeometry<scalar> *const fgeom,
+                                                                    const CellGeometry<scalar> *const cgeom,
                                                                     const freal param)
 {
 	const int mpirank = get_mpi_rank(MPI_COMM_WORLD);
@@ -177,31 +178,31 @@ SolutionReconstruction<scalar,nvars>* create_mutable_reconstruction(const std::s
 
 	if(type == "NONE")
 	{
-		reconst = new LinearUnlimitedReconstruction<scalar,nvars>(m, rc, rcbp, gr);
+		reconst = new LinearUnlimitedReconstruction<scalar,nvars>(m, rc, rcbp, fgeom, cgeom);
 		if(mpirank == 0)
 			std::cout << " ReconstructionFactory: Unlimited linear reconstruction selected.\n";
 	}
 	else if(type == "WENO")
 	{
-		reconst = new WENOReconstruction<scalar,nvars>(m, rc, rcbp, gr, param);
+		reconst = new WENOReconstruction<scalar,nvars>(m, rc, rcbp, fgeom, cgeom, param);
 		if(mpirank == 0)
 			std::cout << " ReconstructionFactory: WENO reconstruction selected.\n";
 	}
 	else if(type == "VANALBADA")
 	{
-		reconst = new MUSCLVanAlbada<scalar,nvars>(m, rc, rcbp, gr);
+		reconst = new MUSCLVanAlbada<scalar,nvars>(m, rc, rcbp, fgeom, cgeom);
 		if(mpirank == 0)
 			std::cout << " ReconstructionFactory: Van Albada MUSCL reconstruction selected.\n";
 	}
 	else if(type == "BARTHJESPERSEN")
 	{
-		reconst = new BarthJespersenLimiter<scalar,nvars>(m, rc, rcbp, gr);
+		reconst = new BarthJespersenLimiter<scalar,nvars>(m, rc, rcbp, fgeom, cgeom);
 		if(mpirank == 0)
 			std::cout << " ReconstructionFactory: Barth-Jespersen linear reconstruction selected.\n";
 	}
 	else if(type == "VENKATAKRISHNAN")
 	{
-		reconst = new VenkatakrishnanLimiter<scalar,nvars>(m, rc, rcbp, gr, param);
+		reconst = new VenkatakrishnanLimiter<scalar,nvars>(m, rc, rcbp, fgeom, cgeom, param);
 		if(mpirank == 0)
 			std::cout << " ReconstructionFactory: Venkatakrishnan linear reconstruction selected.\n";
 	}
@@ -218,10 +219,11 @@ const SolutionReconstruction<scalar,nvars>*
 create_const_reconstruction(const std::string& type, const UMesh<scalar,NDIM> *const m,
                             const scalar *const rc,
                             const scalar *const rcbp,
-                            const amat::Array2d<scalar>& gr,
+                            const FaceGeometry<scalar> *const fgeom,
+                            const CellGeometry<scalar> *const cgeom,
                             const freal param)
 {
-	return create_mutable_reconstruction<scalar,nvars>(type, m, rc, rcbp, gr, param);
+	return create_mutable_reconstruction<scalar,nvars>(type, m, rc, rcbp, fgeom, cgeom, param);
 }
 
 // template instantiations
@@ -229,23 +231,27 @@ template SolutionReconstruction<freal,NVARS>*
 create_mutable_reconstruction(const std::string& type,
                               const UMesh<freal,NDIM> *const m, const freal *const rc,
                               const freal *const rcbp,
-                              const amat::Array2d<freal>& gr, const freal param);
+                              const FaceGeometry<freal> *const fgeom,
+                              const CellGeometry<freal> *const cgeom, const freal param);
 template const SolutionReconstruction<freal,NVARS>*
 create_const_reconstruction(const std::string& type,
                             const UMesh<freal,NDIM> *const m, const freal *const rc,
                             const freal *const rcbp,
-                            const amat::Array2d<freal>& gr, const freal param);
+                            const FaceGeometry<freal> *const fgeom,
+                            const CellGeometry<freal> *const cgeom, const freal param);
 
 template SolutionReconstruction<freal,1>*
 create_mutable_reconstruction(const std::string& type,
                               const UMesh<freal,NDIM> *const m, const freal *const rc,
                               const freal *const rcbp,
-                              const amat::Array2d<freal>& gr, const freal param);
+                              const FaceGeometry<freal> *const fgeom,
+                              const CellGeometry<freal> *const cgeom, const freal param);
 template const SolutionReconstruction<freal,1>*
 create_const_reconstruction(const std::string& type,
                             const UMesh<freal,NDIM> *const m, const freal *const rc,
                             const freal *const rcbp,
-                            const amat::Array2d<freal>& gr, const freal param);
+                            const FaceGeometry<freal> *const fgeom,
+                            const CellGeometry<freal> *const cgeom, const freal param);
 
 
 template <typename scalar>
@@ -73,7 +73,9 @@ const GradientScheme<scalar,nvars>* create_const_gradientscheme(const std::strin
  * \param rc Array of cell centres all cells (including connectivity ghost cells);
  *   this must also currently have the same scalar type as the gradients.
  * \param rcbp Array of cell centres of physical boundary ghost cells
- * \param gr Coordinates of quadrature points at each face. They're generally the face centres.
+ * \param fgeom Geometric data of each face, including the position of its quadrature point
+ *   (the face centre) relative to the adjacent cell centres \sa FaceGeometry
+ * \param cgeom Geometric data of each subdomain cell \sa CellGeometry
  * \param param A parameter that controls the behaviour of some limiters.
  */
 template <typename scalar, int nvars>
@@ -82,7 +84,8 @@ create_mutable_reconstruction(const std::string& type,
                               const UMesh<scalar,NDIM> *const m,
                               const scalar *const rc,
                               const scalar *const rcbp,
-                              const amat::Array2d<scalar>& gr,
+                              const FaceGeometry<scalar> *const fgeom,
+                              const CellGeometry<scalar> *const cgeom,
                               const freal param);
 
 /// Returns an immutable solution reconstruction context \sa create_mutable_reconstruction
@@ -92,7 +95,8 @@ create_const_reconstruction(const std::string& type,
                             const UMesh<scalar,NDIM> *const m,
                             const scalar *const rc,
                             const scalar *const rcbp,
-                            const amat::Array2d<scalar>& gr, const freal param);
+                            const FaceGeometry<scalar> *const fgeom,
+                            const CellGeometry<scalar> *const cgeom, const freal param);
 
 /// Creates the appropriate flow solver class
 /** This function is needed to instantiate the appropriate class from the \ref FlowFV template.
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <iomanip>
 #include <tuple>
+#include <stdexcept>
 
 #include "casesolvers.hpp"
 #include "utilities/afactory.hpp"
@@ -14,6 +15,10 @@
 #include "spatial/aoutput.hpp"
 #include "mesh/ameshutils.hpp"
 #include "mpiutils.hpp"
+#include "linalg/blocksgs.hpp"
+#include "linalg/blocksparsematrix.hpp"
+#include "linalg/threadedblockpc.hpp"
+#include "linalg/linepc.hpp"
 
 #ifdef USE_BLASTED
 #include <blasted_petsc.h>
@@ -26,7 +31,7 @@ UMesh<freal,NDIM> constructMeshFlow(const FlowParserOptions& opts, const std::st
 {
 	// Set up mesh
 	const std::string meshfile = opts.meshfile + mesh_suffix;
-	UMesh<freal,NDIM> m(constructMesh(meshfile));
+	UMesh<freal,NDIM> m(constructMesh(meshfile, opts.partconf));
 
 	// check if there are any periodic boundaries
 	for(auto it = opts.bcconf.begin(); it != opts.bcconf.end(); it++) {
@@ -163,7 +168,8 @@ FlowSolutionFunctionals FlowCase::run_output(const bool surface_file_needed,
 			std::get<0>(fnls), std::get<1>(fnls), std::get<2>(fnls)};
 }
 
-void FlowCase::setupKSP(LinearProblemLHS& solver, const bool use_mfjac) {
+void FlowCase::setupKSP(LinearProblemLHS& solver, const UMesh<freal,NDIM>& mesh,
+                        const bool use_mfjac) {
 	// initialize solver
 	int ierr = KSPCreate(PETSC_COMM_WORLD, &solver.ksp); petsc_throw(ierr, "KSP Create");
 	if(use_mfjac) {
@@ -176,6 +182,38 @@ void FlowCase::setupKSP(LinearProblemLHS& solver, const bool use_mfjac) {
 	}
 
 	ierr = KSPSetFromOptions(solver.ksp); petsc_throw(ierr, "KSP set from options");
+
+	// The in-tree preconditioners are selected by a single option, so that at most one is asked for
+	const std::string pctype = parsePetscCmd_isDefined("-fvens_pc_type") ?
+		parsePetscCmd_string("-fvens_pc_type", 20) : "";
+
+	if(solver.facejac) {
+		// Only preconditioners built on the face-based storage can use it
+		if(!pctype.empty())
+			throw std::invalid_argument("-fvens_pc_type cannot be used with -face_jacobian;"
+			                            " use -face_jacobian_pc instead!");
+		const std::string type = parsePetscCmd_isDefined("-face_jacobian_pc") ?
+			parsePetscCmd_string("-face_jacobian_pc", 10) : "sgs";
+		PC pc;
+		ierr = KSPGetPC(solver.ksp, &pc); petsc_throw(ierr, "KSP get PC");
+		ierr = setup_face_jacobian_pc<NVARS>(pc, type);
+		petsc_throw(ierr, "Setup face Jacobian preconditioner");
+	}
+	else if(!pctype.empty()) {
+		PC pc;
+		ierr = KSPGetPC(solver.ksp, &pc); petsc_throw(ierr, "KSP get PC");
+		if(pctype == "block_jacobi")
+			ierr = setup_block_sparse_pc<NVARS>(pc, mesh, "jacobi");
+		else if(pctype == "block_sgs")
+			ierr = setup_block_sgs<NVARS>(pc, mesh);
+		else if(pctype == "threaded")
+			ierr = setup_threaded_block_pc<NVARS>(pc, mesh);
+		else if(pctype == "line")
+			ierr = setup_line_pc<NVARS>(pc, mesh);
+		else
+			throw std::invalid_argument("Unknown -fvens_pc_type " + pctype + "!");
+		petsc_throw(ierr, "Setup " + pctype + " preconditioner");
+	}
 }
 
 FlowCase::LinearProblemLHS FlowCase::setupImplicitSolver(const Spatial<freal,NVARS> *const space,
@@ -185,7 +223,15 @@ FlowCase::LinearProblemLHS FlowCase::setupImplicitSolver(const Spatial<freal,NVA
 	const UMesh<freal,NDIM> *const mesh = space->mesh();
 
 	// Initialize Jacobian for implicit schemes
-	int ierr = setupSystemMatrix<NVARS>(mesh, &solver.M); fvens_throw(ierr, "Setup system matrix");
+	int ierr = 0;
+	if(parsePetscCmd_isDefined("-face_jacobian")) {
+		solver.facejac = new FaceJacobian<NVARS>(*mesh);
+		ierr = create_face_jacobian_shell_matrix(solver.facejac, &solver.M);
+		fvens_throw(ierr, "Setup face-based system matrix");
+	}
+	else {
+		ierr = setupSystemMatrix<NVARS>(mesh, &solver.M); fvens_throw(ierr, "Setup system matrix");
+	}
 
 	// setup matrix-free Jacobian if requested
 	if(use_mfjac) {
@@ -194,7 +240,7 @@ FlowCase::LinearProblemLHS FlowCase::setupImplicitSolver(const Spatial<freal,NVA
 		fvens_throw(ierr, "Setup matrix-free Jacobian");
 	}
 
-	setupKSP(solver, use_mfjac);
+	setupKSP(solver, *mesh, use_mfjac);
 	solver.mf_flg = use_mfjac;
 
 	return solver;
@@ -377,6 +423,19 @@ TimingData SteadyFlowCase::execute_main(const Spatial<freal,NVARS> *const prob,
 	tdata.precapply_walltime = bctx.applywalltime;
 	tdata.prec_cputime = bctx.factorcputime + bctx.applycputime;
 #endif
+	{
+		PC pc;
+		ierr = KSPGetPC(isol.ksp, &pc); petsc_throw(ierr, "KSP get PC");
+		bool isthreaded = false;
+		double setupwtime, applywtime, cputime;
+		ierr = get_threaded_block_pc_times<NVARS>(pc, &isthreaded, &setupwtime, &applywtime, &cputime);
+		petsc_throw(ierr, "Could not get preconditioner times");
+		if(isthreaded) {
+			tdata.precsetup_walltime = setupwtime;
+			tdata.precapply_walltime = applywtime;
+			tdata.prec_cputime = cputime;
+		}
+	}
 
 	delete time;
 	delete nlupdate;
@@ -128,12 +128,16 @@ protected:
 		Mat M;                                  ///< System preconditioning matrix
 		KSP ksp;                                ///< Linear solver context
 		bool mf_flg;                            ///< Whether matrix-free Jacobian has been requested
+		/// Face-based storage of the Jacobian, if requested, which M then applies
+		FaceJacobian<NVARS> *facejac = nullptr;
 
 		/// Destroy all components of linear problem LHS
 		int destroy() {
 			int ierr = 0;
 			ierr = KSPDestroy(&ksp); CHKERRQ(ierr);
 			ierr = MatDestroy(&M); CHKERRQ(ierr);
+			delete facejac;
+			facejac = nullptr;
 			if(mf_flg) {
 				ierr = MatDestroy(&A); CHKERRQ(ierr);
 			}
@@ -150,7 +154,11 @@ protected:
 	static LinearProblemLHS setupImplicitSolver(const Spatial<freal,NVARS> *const s, const bool use_mfjac);
 
 	/// Sets up only the KSP context, assuming the Mats have been set up
-	static void setupKSP(LinearProblemLHS& solver, const bool use_matrix_free);
+	/** \param mesh The mesh from which the system matrix is assembled, needed by some in-tree
+	 *   preconditioners
+	 */
+	static void setupKSP(LinearProblemLHS& solver, const UMesh<freal,NDIM>& mesh,
+	                     const bool use_matrix_free);
 };
 
 /// Solution procedure for a steady-state case
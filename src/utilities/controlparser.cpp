@@ -84,6 +84,7 @@ FlowParserOptions parse_flow_controlfile(const int argc, const char *const argv[
 	const std::string c_phy_time = "time";
 	const std::string c_spatial = "spatial_discretization";
 	const std::string c_pseudotime = "pseudotime";
+	const std::string c_mesh = "mesh";
 
 	// options that possibly repeat
 	// Pseudotime settings
@@ -139,6 +140,59 @@ FlowParserOptions parse_flow_controlfile(const int argc, const char *const argv[
 
 	opts.bcconf = parse_BC_options(infopts, c_bcs);
 
+	// Mesh partitioning; the whole section is optional
+	opts.partconf.partitioner = boost::to_lower_copy<std::string>(
+		infopts.get(c_mesh+".partitioner", opts.partconf.partitioner));
+	const std::string c_weights = c_mesh+".partition_weights";
+	opts.partconf.triangle_weight = infopts.get(c_weights+".triangle",
+	                                            opts.partconf.triangle_weight);
+	opts.partconf.quadrilateral_weight = infopts.get(c_weights+".quadrilateral",
+	                                                 opts.partconf.quadrilateral_weight);
+	opts.partconf.boundary_face_weight = infopts.get(c_weights+".boundary_face",
+	                                                 opts.partconf.boundary_face_weight);
+	opts.partconf.viscous_face_weight = infopts.get(c_weights+".viscous_face",
+	                                                opts.partconf.viscous_face_weight);
+	opts.partconf.interface_weight = infopts.get(c_weights+".interface",
+	                                             opts.partconf.interface_weight);
+	opts.partconf.viscous_interface_weight = infopts.get(c_weights+".viscous_interface",
+	                                                     opts.partconf.viscous_interface_weight);
+	opts.partconf.viscous = opts.viscsim;
+	opts.partconf.report_per_rank = infopts.get(c_mesh+".partition_report_per_rank", false);
+
+	// The cell ordering is applied during mesh preprocessing, which reads it from the PETSc options
+	//  database; options given to PETSc directly take precedence.
+	const auto ordering = infopts.get_optional<std::string>(c_mesh+".ordering");
+	if(ordering) {
+		PetscBool set = PETSC_FALSE;
+		int ierr = PetscOptionsHasName(NULL, NULL, "-mesh_reorder", &set);
+		petsc_throw(ierr, "Could not query option -mesh_reorder");
+		if(!set) {
+			ierr = PetscOptionsSetValue(NULL, "-mesh_reorder", ordering->c_str());
+			petsc_throw(ierr, "Could not set option -mesh_reorder");
+		}
+	}
+	const auto anisothreshold = infopts.get_optional<std::string>(c_mesh+".anisotropy_threshold");
+	if(anisothreshold) {
+		PetscBool set = PETSC_FALSE;
+		int ierr = PetscOptionsHasName(NULL, NULL, "-mesh_anisotropy_threshold", &set);
+		petsc_throw(ierr, "Could not query option -mesh_anisotropy_threshold");
+		if(!set) {
+			ierr = PetscOptionsSetValue(NULL, "-mesh_anisotropy_threshold",
+			                            anisothreshold->c_str());
+			petsc_throw(ierr, "Could not set option -mesh_anisotropy_threshold");
+		}
+	}
+	const auto cachedir = infopts.get_optional<std::string>(c_mesh+".cache_directory");
+	if(cachedir) {
+		PetscBool set = PETSC_FALSE;
+		int ierr = PetscOptionsHasName(NULL, NULL, "-mesh_cache_dir", &set);
+		petsc_throw(ierr, "Could not query option -mesh_cache_dir");
+		if(!set) {
+			ierr = PetscOptionsSetValue(NULL, "-mesh_cache_dir", cachedir->c_str());
+			petsc_throw(ierr, "Could not set option -mesh_cache_dir");
+		}
+	}
+
 	auto optlwalls = infopts.get_optional<std::string>(c_bcs+".listof_output_wall_boundaries");
 	if(optlwalls)
 		opts.lwalls = parseStringToVector<int>(*optlwalls);
@@ -180,6 +234,13 @@ FlowParserOptions parse_flow_controlfile(const int argc, const char *const argv[
 	if(opts.gradientmethod == "NONE")
 		opts.order2 = false;
 	opts.limiter = get_upperCaseString(infopts, c_spatial+".limiter");
+	opts.residual_assembly = boost::to_upper_copy<std::string>(
+		infopts.get<std::string>(c_spatial+".residual_assembly", "FACE"));
+	opts.fused_residual = infopts.get<bool>(c_spatial+".fused_residual", false);
+	opts.specialized_kernels = infopts.get<bool>(c_spatial+".specialized_kernels", true);
+	opts.overlap_communication = infopts.get<bool>(c_spatial+".overlap_communication", true);
+	opts.second_ghost_layer = infopts.get<bool>(c_spatial+".second_ghost_layer", false);
+	opts.single_precision_storage = infopts.get<bool>(c_spatial+".single_precision_storage", false);
 
 	opts.pseudotimetype = get_upperCaseString(infopts, c_pseudotime+".pseudotime_stepping_type");
 
@@ -227,14 +288,18 @@ FlowPhysicsConfig extract_spatial_physics_config(const FlowParserOptions& opts)
 FlowNumericsConfig extract_spatial_numerics_config(const FlowParserOptions& opts)
 {
 	const FlowNumericsConfig nconf {opts.invflux, opts.invfluxjac, 
-		opts.gradientmethod, opts.limiter, opts.limiter_param, opts.order2};
+		opts.gradientmethod, opts.limiter, opts.limiter_param, opts.order2, opts.residual_assembly,
+		opts.fused_residual, opts.specialized_kernels, opts.overlap_communication,
+		opts.second_ghost_layer, opts.single_precision_storage};
 	return nconf;
 }
 
 FlowNumericsConfig firstorder_spatial_numerics_config(const FlowParserOptions& opts)
 {
 	const FlowNumericsConfig nconf {opts.invflux, opts.invfluxjac, 
-		"NONE", "NONE", 1.0 , false};
+		"NONE", "NONE", 1.0 , false, opts.residual_assembly, opts.fused_residual,
+		opts.specialized_kernels, opts.overlap_communication, opts.second_ghost_layer,
+		opts.single_precision_storage};
 	return nconf;
 }
 
@@ -12,6 +12,7 @@
 #include <boost/program_options/variables_map.hpp>
 #include "aconstants.hpp"
 #include "spatial/flow_spatial.hpp"
+#include "mesh/meshpartitioning.hpp"
 
 namespace fvens {
 
@@ -24,6 +25,7 @@ struct FlowParserOptions
 		init_soln_file,                    ///< File to read initial solution from (not implemented)
 		invflux, invfluxjac,               ///< Inviscid numerical flux
 		gradientmethod, limiter,           ///< Reconstruction type
+		residual_assembly,                 ///< FACE or CELL \sa FlowNumericsConfig::residual_assembly
 		pseudotimetype,                      ///< Explicit or implicit time stepping
 		constvisc,                         ///< NO for Sutherland viscosity
 		surfnameprefix, volnameprefix,     ///< Filename prefixes for output files
@@ -56,6 +58,8 @@ struct FlowParserOptions
 
 	std::vector<FlowBCConfig> bcconf;     ///< All info about boundary conditions
 
+	MeshPartitionConfig partconf;         ///< Settings for distributing the mesh among processes
+
 	short soln_init_type,
 		  usestarter;                     ///< Whether to start with a first-order solver initially
 
@@ -63,7 +67,12 @@ struct FlowParserOptions
 		write_final_lin_sys,        ///< Whether to write out the last solved linear system to files
 		useconstvisc,               ///< Whether to use constant viscosity instead of Sutherland
 		viscsim,                    ///< Whether to carry out a viscous flow simulation
-		order2;                     ///< Whether 2nd order in space is required
+		order2,                     ///< Whether 2nd order in space is required
+		fused_residual,             ///< \sa FlowNumericsConfig::fused_residual
+		specialized_kernels,        ///< \sa FlowNumericsConfig::specialized_kernels
+		overlap_communication,      ///< \sa FlowNumericsConfig::overlap_communication
+		second_ghost_layer,         ///< \sa FlowNumericsConfig::second_ghost_layer
+		single_precision_storage;   ///< \sa FlowNumericsConfig::single_precision_storage
 
 	std::vector<int> lwalls,         ///< List of wall boundary markers for output
 		lothers;                     ///< List of other boundary markers for output
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <string>
+#include <vector>
 #include "mesh/mesh.hpp"
+#include "mesh/binarymesh.hpp"
 #include "spatial/aoutput.hpp"
 
 using namespace fvens;
@@ -9,7 +11,10 @@ using namespace std;
 int main(int argc, char* argv[])
 {
 	if(argc < 4) {
-		cout << "Need: 1. Input mesh file, 2. Output mesh file 3. Output format.\n" << endl;
+		cout << "Need: 1. Input mesh file, 2. Output mesh file 3. Output format.\n";
+		cout << "Output format can be msh, vtu, fvm (binary) or fvmtopo (binary with precomputed\n"
+			<< " elements surrounding elements and face structure).\n" << endl;
+		return -1;
 	}
 	string confilename(argv[1]);
 	string inmesh = argv[1], outmesh = argv[2], outformat = argv[3];
@@ -17,12 +22,19 @@ int main(int argc, char* argv[])
 	//cout << "Input file is of type " << informat << ". Writing as " << outformat << ".\n";
 
 	const MeshData md = readMesh(inmesh);
-	const UMesh<freal,NDIM> m(md);
+	UMesh<freal,NDIM> m(md);
 
 	if(outformat == "msh")	
 		m.writeGmsh2(outmesh);
 	else if(outformat == "vtu")
 		writeMeshToVtu(outmesh, m);
+	else if(outformat == "fvm")
+		writeBinaryMesh(outmesh, md);
+	else if(outformat == "fvmtopo") {
+		m.correctBoundaryFaceOrientation();
+		m.compute_topological();
+		writeBinaryMeshWithTopology(outmesh, md, m);
+	}
 	else {
 		cout << "Invalid format. Exiting." << endl;
 		return -1;
@@ -21,24 +21,64 @@
 #define FVENS_HELPER_ALGORITHMS_H
 
 #include <algorithm>
-#include "helper_algorithms.hpp"
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace fvens {
 
+/// In-place inclusive prefix sum of an array
+/** With OpenMP, each thread scans a contiguous block, the block totals are scanned and then added
+ * to the blocks. The result is identical to that of a serial scan, as long as the sums do not
+ * overflow.
+ */
 template <typename index>
-inline void inclusive_scan(std::vector<index>& v)
+inline void inclusive_scan(index *const v, const size_t n)
 {
-	// serial
-	for(size_t i = 1; i < v.size(); i++)
+#ifdef _OPENMP
+	// Not worth starting threads for short arrays
+	if(n >= 16384 && omp_get_max_threads() > 1)
+	{
+		std::vector<index> blocksums(omp_get_max_threads()+1, 0);
+
+#pragma omp parallel default(shared)
+		{
+			const size_t nthreads = static_cast<size_t>(omp_get_num_threads());
+			const size_t ithread = static_cast<size_t>(omp_get_thread_num());
+			const size_t start = n*ithread/nthreads, end = n*(ithread+1)/nthreads;
+
+			for(size_t i = start+1; i < end; i++)
+				v[i] += v[i-1];
+			blocksums[ithread+1] = end > start ? v[end-1] : 0;
+
+#pragma omp barrier
+#pragma omp single
+			for(size_t i = 1; i <= nthreads; i++)
+				blocksums[i] += blocksums[i-1];
+
+			for(size_t i = start; i < end; i++)
+				v[i] += blocksums[ithread];
+		}
+		return;
+	}
+#endif
+
+	for(size_t i = 1; i < n; i++)
 		v[i] += v[i-1];
 }
 
+template <typename index>
+inline void inclusive_scan(std::vector<index>& v)
+{
+	inclusive_scan(v.data(), v.size());
+}
+
 template <typename index, typename allocator>
 inline void inclusive_scan(std::vector<index,allocator>& v)
 {
-	// serial
-	for(size_t i = 1; i < v.size(); i++)
-		v[i] += v[i-1];
+	inclusive_scan(v.data(), v.size());
 }
 
 template <typename index>
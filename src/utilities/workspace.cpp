@@ -0,0 +1,38 @@
+/** \file
+ * \brief Implementation of the workspace arena
+ */
+
+#include "workspace.hpp"
+#include <cstdint>
+
+namespace fvens {
+
+WorkspaceArena::WorkspaceArena() : totalbytes{0}, raw{nullptr}, base{nullptr}
+{ }
+
+WorkspaceArena::~WorkspaceArena()
+{
+	if(!raw)
+		return;
+	for(const ArrayInfo& info : arrays)
+		info.destroy(base+info.offset, info.nrows*info.ncols);
+	delete [] raw;
+}
+
+void WorkspaceArena::allocate()
+{
+	assert(!allocated());
+	raw = new char[totalbytes+alignment];
+	const std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw);
+	base = raw + (alignment - addr % alignment) % alignment;
+
+	for(const ArrayInfo& info : arrays)
+	{
+		const size_t rowbytes = info.ncols*info.entrysize;
+#pragma omp parallel for default(shared) schedule(static)
+		for(fint irow = 0; irow < info.nrows; irow++)
+			info.construct(base + info.offset + irow*rowbytes, info.ncols);
+	}
+}
+
+}
@@ -0,0 +1,121 @@
+/** \file
+ * \brief Persistent storage for temporary arrays of repeated computations
+ */
+
+#ifndef FVENS_WORKSPACE_H
+#define FVENS_WORKSPACE_H
+
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <vector>
+#include "aconstants.hpp"
+
+namespace fvens {
+
+/// A single block of memory holding a set of temporary arrays that are re-used across calls
+/** Typical use is for arrays needed by each residual evaluation whose sizes only depend on the
+ * mesh. All arrays are first registered with \ref reserve, usually in a constructor, after which
+ * \ref allocate gets the memory for all of them at once. Pointers to the arrays are then obtained
+ * with \ref get as often as needed, without any further heap allocation.
+ *
+ * Each array is viewed as a number of rows, such as one per cell or face. When allocated, the rows
+ * are constructed by an OpenMP loop with static schedule. Loops over the rows of an array which use
+ * the same schedule (the default) therefore mostly touch memory that was first touched by the same
+ * thread, which on NUMA systems is local to that thread.
+ *
+ * The contents of the arrays are not preserved between uses in any meaningful way; each user must
+ * initialize whatever it reads.
+ */
+class WorkspaceArena
+{
+public:
+	WorkspaceArena();
+
+	~WorkspaceArena();
+
+	WorkspaceArena(const WorkspaceArena&) = delete;
+	WorkspaceArena& operator=(const WorkspaceArena&) = delete;
+
+	/// Registers an array of nrows x ncols entries of type T and returns its handle
+	/** May only be called before \ref allocate.
+	 */
+	template <typename T>
+	int reserve(const fint nrows, const int ncols);
+
+	/// Allocates and first-touches memory for all registered arrays
+	void allocate();
+
+	/// Returns the array corresponding to a handle returned by \ref reserve
+	/** The arena must have been allocated. If the array has no entries, the returned pointer
+	 * should not be dereferenced.
+	 */
+	template <typename T>
+	T *get(const int handle) const
+	{
+		return reinterpret_cast<T*>(base + arrays[handle].offset);
+	}
+
+	/// Total size of the arrays in bytes, including padding for alignment
+	size_t size() const { return totalbytes; }
+
+	/// Whether \ref allocate has been called
+	bool allocated() const { return raw != nullptr; }
+
+private:
+	/// Location and layout of one array in the arena
+	struct ArrayInfo {
+		size_t offset;                                 ///< Offset from the start of the arena
+		fint nrows;                                    ///< Number of rows
+		int ncols;                                     ///< Number of entries in each row
+		size_t entrysize;                              ///< Size of one entry in bytes
+		void (*construct)(char*, fint);                ///< Constructs a number of entries
+		void (*destroy)(char*, fint);                  ///< Destroys a number of entries
+	};
+
+	/// Alignment in bytes of each array, suitable for the widest SIMD instructions
+	static constexpr size_t alignment = 64;
+
+	std::vector<ArrayInfo> arrays;
+	size_t totalbytes;
+	char *raw;                  ///< Memory as allocated
+	char *base;                 ///< Aligned start of the arena within \ref raw
+
+	template <typename T>
+	static void constructEntries(char *const start, const fint nentries)
+	{
+		T *const arr = reinterpret_cast<T*>(start);
+		for(fint i = 0; i < nentries; i++)
+			new(arr+i) T();
+	}
+
+	template <typename T>
+	static void destroyEntries(char *const start, const fint nentries)
+	{
+		T *const arr = reinterpret_cast<T*>(start);
+		for(fint i = 0; i < nentries; i++)
+			arr[i].~T();
+	}
+};
+
+template <typename T>
+int WorkspaceArena::reserve(const fint nrows, const int ncols)
+{
+	static_assert(alignof(T) <= alignment, "Type is over-aligned for the workspace arena!");
+	assert(!allocated());
+	ArrayInfo info;
+	info.offset = totalbytes;
+	info.nrows = nrows;
+	info.ncols = ncols;
+	info.entrysize = sizeof(T);
+	info.construct = &constructEntries<T>;
+	info.destroy = &destroyEntries<T>;
+	arrays.push_back(info);
+
+	const size_t bytes = static_cast<size_t>(nrows)*ncols*sizeof(T);
+	totalbytes += (bytes + alignment-1)/alignment*alignment;
+	return static_cast<int>(arrays.size())-1;
+}
+
+}
+#endif
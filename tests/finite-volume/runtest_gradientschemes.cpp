@@ -28,6 +28,8 @@ int main(int argc, char *argv[])
 		const std::string testtype = argv[3];
 		if(testtype == "1exact")
 			ierr = ts.test_oneExact(argv[2]);
+		else if(testtype == "precomputed")
+			ierr = ts.test_precomputedLeastSquares();
 		else {
 			std::cout << "Invalid test!\n";
 			std::exit(-2);
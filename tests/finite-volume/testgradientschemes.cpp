@@ -55,7 +55,8 @@ int TestSpatial::test_oneExact(const std::string reconst_type) const
 	wls->compute_gradients(amat::Array2dView<freal>(&u(0,0),m->gnelem()+m->gnConnFace(),1),
 	                       amat::Array2dView<freal>(&ug(0,0),m->gnbface(),1), &grads[0](0,0));
 
-	LinearUnlimitedReconstruction<freal,1> lur(m, &rc(0,0), &rcbp(0,0), gr);
+	LinearUnlimitedReconstruction<freal,1> lur(m, &rc(0,0), &rcbp(0,0), facegeom.data(),
+	                                           cellgeom.data());
 	lur.compute_face_values(u, amat::Array2dView<freal>(&ug(0,0),m->gnbface(),1), &grads[0](0,0),
 	                        amat::Array2dMutableView<freal>(&uleft(0,0),m->gnaface(),1),
 	                        amat::Array2dMutableView<freal>(&uright(0,0),m->gnaface(),1));
@@ -89,4 +90,37 @@ int TestSpatial::test_oneExact(const std::string reconst_type) const
 	return 0;
 }
 
+int TestSpatial::test_precomputedLeastSquares() const
+{
+	const amat::Array2dView<freal> rc(rch.getArray(), m->gnelem()+m->gnConnFace(), NDIM);
+	const WeightedLeastSquaresGradients<freal,1> precomp(m, &rc(0,0), &rcbp(0,0), true);
+	const WeightedLeastSquaresGradients<freal,1> facewise(m, &rc(0,0), &rcbp(0,0), false);
+
+	std::vector<GradBlock_t<freal,NDIM,1>> grads(m->gnelem()), refgrads(m->gnelem());
+	MVector<freal> u(m->gnelem(),1);
+	amat::Array2d<freal> ug(m->gnbface(),1);
+
+	for(fint i = 0; i < m->gnelem(); i++)
+		u(i,0) = std::sin(rc(i,0))*std::exp(rc(i,1));
+	for(fint i = 0; i < m->gnbface(); i++)
+		ug(i,0) = std::sin(rcbp(i,0))*std::exp(rcbp(i,1));
+
+	const amat::Array2dView<freal> uv(&u(0,0),m->gnelem()+m->gnConnFace(),1);
+	const amat::Array2dView<freal> ugv(&ug(0,0),m->gnbface(),1);
+	precomp.compute_gradients(uv, ugv, &grads[0](0,0));
+	facewise.compute_gradients(uv, ugv, &refgrads[0](0,0));
+
+	freal errnorm = 0, refnorm = 0;
+	for(fint iel = 0; iel < m->gnelem(); iel++)
+		for(int idim = 0; idim < NDIM; idim++) {
+			errnorm += std::pow(grads[iel](idim,0) - refgrads[iel](idim,0), 2);
+			refnorm += std::pow(refgrads[iel](idim,0), 2);
+		}
+	errnorm = std::sqrt(errnorm/refnorm);
+
+	std::cout << "Relative difference = " << errnorm << std::endl;
+	assert(errnorm < 1e-12);
+	return 0;
+}
+
 }
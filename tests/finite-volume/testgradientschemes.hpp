@@ -44,6 +44,10 @@ public:
 	/// Test if weighted least-squares reconstruction is '1-exact'
 	int test_oneExact(const std::string reconst_type) const;
 
+	/// Test if least-squares gradients with precomputed weights agree with the face-based
+	///  computation for a non-linear field
+	int test_precomputedLeastSquares() const;
+
 protected:
 	using fvens::Spatial<freal,1>::m;
 	using fvens::Spatial<freal,1>::rch;
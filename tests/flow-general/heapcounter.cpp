@@ -0,0 +1,64 @@
+/** \file
+ * \brief Replacement global allocation functions which count heap allocations in debug builds
+ */
+
+#include "heapcounter.hpp"
+
+#ifdef DEBUG
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace fvens {
+
+static std::atomic<long long> heapallocationcount {0};
+
+long long get_heap_allocation_count()
+{
+	return heapallocationcount.load();
+}
+
+/// Allocates memory and counts the allocation
+static void *countedAllocate(const std::size_t size)
+{
+	heapallocationcount++;
+	void *const ptr = std::malloc(size > 0 ? size : 1);
+	if(!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+}
+
+void *operator new(const std::size_t size)
+{
+	return fvens::countedAllocate(size);
+}
+
+void *operator new[](const std::size_t size)
+{
+	return fvens::countedAllocate(size);
+}
+
+void operator delete(void *const ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *const ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *const ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void *const ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+#endif
@@ -0,0 +1,20 @@
+/** \file
+ * \brief Counting of heap allocations in debug builds
+ */
+
+#ifndef FVENS_HEAPCOUNTER_H
+#define FVENS_HEAPCOUNTER_H
+
+namespace fvens {
+
+#ifdef DEBUG
+/// Returns the number of heap allocations made through the global operator new so far
+/** Calls from all threads are counted. Only available in debug builds, where the global
+ * allocation functions are replaced by counting versions in executables linked to this library.
+ * Memory obtained directly with malloc, as by PETSc and MPI, is not counted.
+ */
+long long get_heap_allocation_count();
+#endif
+
+}
+#endif
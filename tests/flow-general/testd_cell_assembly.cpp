@@ -0,0 +1,127 @@
+/** \file testd_cell_assembly.cpp
+ * \brief Tests whether cell-based residual assembly agrees with face-based assembly
+ *
+ * The first command line argument is the control file. The second is the limiter to test, or
+ * 'FIRSTORDER' to test the first-order discretization.
+ * The residual and time steps are computed at a perturbed free-stream state, once with FACE and
+ * once with CELL \ref FlowNumericsConfig::residual_assembly, and compared. Only the order of
+ * summation differs between the two, so they must agree up to round-off.
+ */
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <petscvec.h>
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+using namespace std::literals::string_literals;
+
+/// Computes the residual and time steps with a given residual assembly
+static StatusCode computeResidual(FlowParserOptions opts, const UMesh<freal,NDIM>& m,
+                                  const std::string assembly, const Vec u, Vec res, Vec dtm)
+{
+	StatusCode ierr = 0;
+	opts.residual_assembly = assembly;
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+	ierr = VecSet(res, 0.0); CHKERRQ(ierr);
+	ierr = spatial->compute_residual(u, res, true, dtm); CHKERRQ(ierr);
+	delete spatial;
+	return ierr;
+}
+
+/// Returns the norm of the difference of two vectors relative to the norm of the second
+static PetscReal relativeDifference(const Vec a, const Vec b)
+{
+	Vec diff;
+	VecDuplicate(a, &diff);
+	VecWAXPY(diff, -1.0, b, a);
+	PetscReal diffnorm, bnorm;
+	VecNorm(diff, NORM_2, &diffnorm);
+	VecNorm(b, NORM_2, &bnorm);
+	VecDestroy(&diff);
+	return diffnorm/bnorm;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Not enough command-line arguments!\n";
+		return -2;
+	}
+
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		("FVENS cell-based residual assembly test.\n"s
+		 + " The first argument is the input control file name,\n"
+		 + " the second is the limiter or FIRSTORDER.\n"
+		 + "Further options");
+
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const std::string testchoice = argv[2];
+	if(testchoice == "FIRSTORDER") {
+		opts.order2 = false;
+		opts.gradientmethod = "NONE";
+		opts.limiter = "NONE";
+	}
+	else
+		opts.limiter = testchoice;
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	Vec u, res, cres, dtm, cdtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &cres); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+	ierr = VecDuplicate(dtm, &cdtm); CHKERRQ(ierr);
+
+	// Scale the free-stream state differently in each cell so that the residual is not zero
+	{
+		MutableVecHandler<freal> uh(u);
+		freal *const uarr = uh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				uarr[iel*NVARS+ivar] *= 1.0 + 0.1*std::sin(m.gcoords(m.ginpoel(iel,0),0)
+				                                           + 2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+	ierr = VecGhostUpdateBegin(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecGhostUpdateEnd(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+	ierr = computeResidual(opts, m, "FACE", u, res, dtm); CHKERRQ(ierr);
+	ierr = computeResidual(opts, m, "CELL", u, cres, cdtm); CHKERRQ(ierr);
+
+	const PetscReal resdiff = relativeDifference(cres, res);
+	const PetscReal dtdiff = relativeDifference(cdtm, dtm);
+
+	int finerr = 0;
+	if(resdiff > 1e-12 || dtdiff > 1e-12) {
+		finerr = 1;
+		if(mpirank == 0)
+			std::cerr << "! Cell-based assembly differs: relative difference in residual " << resdiff
+			          << ", in time steps " << dtdiff << std::endl;
+	}
+
+	ierr = VecDestroy(&cdtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&cres); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
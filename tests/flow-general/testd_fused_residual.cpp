@@ -0,0 +1,194 @@
+/** \file testd_fused_residual.cpp
+ * \brief Tests whether the fused residual computation, the specialized flux kernels, the
+ *  overlap of communication with flux computation, the second ghost layer and cell-based assembly
+ *  agree with the plain multi-pass computation
+ *
+ * The first command line argument is the control file. The second is the limiter to test, or
+ * 'FIRSTORDER' to test the first-order discretization.
+ * The residual and time steps are computed at a perturbed free-stream state with
+ * \ref FlowNumericsConfig::fused_residual, \ref FlowNumericsConfig::specialized_kernels,
+ * \ref FlowNumericsConfig::overlap_communication and \ref FlowNumericsConfig::second_ghost_layer
+ * off and FACE \ref FlowNumericsConfig::residual_assembly, and compared to those computed with each
+ * of them on, and with CELL assembly in both the multi-pass and the fused computation.
+ * The fused computation with \ref FlowNumericsConfig::single_precision_storage is also compared,
+ * with a tolerance that allows for the rounding of gradients and connectivity face states.
+ *
+ * In debug builds, it is also checked that, after the first one, residual computations with either
+ * assembly do not allocate any heap memory.
+ */
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <petscvec.h>
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "heapcounter.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+using namespace std::literals::string_literals;
+
+/// Sets the options of the variant to test; all variants are off for an empty variant name
+static FlowParserOptions variantOptions(FlowParserOptions opts, const std::string variant)
+{
+	opts.fused_residual = (variant == "Fused residual" || variant == "Fused cell assembly"
+	                       || variant == "Single precision storage");
+	opts.specialized_kernels = (variant == "Specialized kernels");
+	opts.overlap_communication = (variant == "Overlap");
+	opts.second_ghost_layer = (variant == "Second ghost layer");
+	opts.single_precision_storage = (variant == "Single precision storage");
+	opts.residual_assembly = (variant == "Cell assembly" || variant == "Fused cell assembly")
+		? "CELL" : "FACE";
+	return opts;
+}
+
+/// Computes the residual and time steps
+static StatusCode computeResidual(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                                  const Vec u, Vec res, Vec dtm)
+{
+	StatusCode ierr = 0;
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+	ierr = VecSet(res, 0.0); CHKERRQ(ierr);
+	ierr = spatial->compute_residual(u, res, true, dtm); CHKERRQ(ierr);
+	delete spatial;
+	return ierr;
+}
+
+#ifdef DEBUG
+/// Returns the number of heap allocations made by a residual computation after the first one
+static long long countResidualAllocations(const FlowParserOptions& opts,
+                                          const UMesh<freal,NDIM>& m,
+                                          const Vec u, Vec res, Vec dtm)
+{
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+	spatial->compute_residual(u, res, true, dtm);
+	const long long startcount = get_heap_allocation_count();
+	spatial->compute_residual(u, res, true, dtm);
+	const long long count = get_heap_allocation_count() - startcount;
+	delete spatial;
+	return count;
+}
+#endif
+
+/// Returns the norm of the difference of two vectors relative to the norm of the second
+static PetscReal relativeDifference(const Vec a, const Vec b)
+{
+	Vec diff;
+	VecDuplicate(a, &diff);
+	VecWAXPY(diff, -1.0, b, a);
+	PetscReal diffnorm, bnorm;
+	VecNorm(diff, NORM_2, &diffnorm);
+	VecNorm(b, NORM_2, &bnorm);
+	VecDestroy(&diff);
+	return diffnorm/bnorm;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Not enough command-line arguments!\n";
+		return -2;
+	}
+
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		("FVENS fused residual test.\n"s
+		 + " The first argument is the input control file name,\n"
+		 + " the second is the limiter or FIRSTORDER.\n"
+		 + "Further options");
+
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const std::string testchoice = argv[2];
+	if(testchoice == "FIRSTORDER") {
+		opts.order2 = false;
+		opts.gradientmethod = "NONE";
+		opts.limiter = "NONE";
+	}
+	else
+		opts.limiter = testchoice;
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+
+	Vec u, res, fres, dtm, fdtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &fres); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+	ierr = VecDuplicate(dtm, &fdtm); CHKERRQ(ierr);
+
+	// Scale the free-stream state differently in each cell so that the residual is not zero
+	{
+		MutableVecHandler<freal> uh(u);
+		freal *const uarr = uh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				uarr[iel*NVARS+ivar] *= 1.0 + 0.1*std::sin(m.gcoords(m.ginpoel(iel,0),0)
+				                                           + 2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+	ierr = VecGhostUpdateBegin(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecGhostUpdateEnd(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+	ierr = computeResidual(variantOptions(opts, ""), m, u, res, dtm); CHKERRQ(ierr);
+
+	int finerr = 0;
+	for(const std::string variant : {"Fused residual", "Specialized kernels", "Overlap",
+				"Second ghost layer", "Cell assembly", "Fused cell assembly",
+				"Single precision storage"})
+	{
+		// The second ghost layer is an error for reconstructions other than WENO
+		if(variant == "Second ghost layer" && opts.limiter != "WENO")
+			continue;
+		// Single precision storage is an error without the fused residual, unavailable for WENO
+		if(variant == "Single precision storage" && opts.limiter == "WENO")
+			continue;
+
+		ierr = computeResidual(variantOptions(opts, variant), m, u, fres, fdtm); CHKERRQ(ierr);
+
+		const PetscReal resdiff = relativeDifference(fres, res);
+		const PetscReal dtdiff = relativeDifference(fdtm, dtm);
+
+		const PetscReal tol = variant == "Single precision storage" ? 1e-5 : 1e-12;
+		if(resdiff > tol || dtdiff > tol) {
+			finerr = 1;
+			if(mpirank == 0)
+				std::cerr << "! " << variant << ": relative difference in residual " << resdiff
+				          << ", in time steps " << dtdiff << std::endl;
+		}
+	}
+
+#ifdef DEBUG
+	for(const std::string variant : {"", "Fused residual", "Cell assembly", "Fused cell assembly"})
+	{
+		const long long nallocs = countResidualAllocations(variantOptions(opts, variant), m,
+		                                                   u, fres, fdtm);
+		if(nallocs != 0) {
+			finerr = 1;
+			std::cerr << "! Rank " << mpirank << ": " << nallocs << " heap allocations in "
+			          << (variant.empty() ? "multi-pass" : variant) << " residual computation"
+			          << std::endl;
+		}
+	}
+#endif
+
+	ierr = VecDestroy(&fdtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&fres); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
@@ -0,0 +1,105 @@
+/** \file testd_jacobian_layout.cpp
+ * \brief Tests whether assembling the Jacobian directly into BAIJ storage through a
+ *  \ref BAIJJacobianLayout gives the same matrix as assembly through MatSetValuesBlocked
+ *
+ * The first command line argument is the control file.
+ * The Jacobian is computed at a perturbed free-stream state, first through the generic assembly
+ * into a freshly set up matrix and then, after zeroing, directly into the storage of that matrix.
+ */
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <petscmat.h>
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/jacobianlayout.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+using namespace std::literals::string_literals;
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "Not enough command-line arguments!\n";
+		return -2;
+	}
+
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		("FVENS Jacobian layout test.\n"s
+		 + " The first argument is the input control file name.\n"
+		 + "Further options");
+
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	{
+		MutableVecHandler<freal> uh(u);
+		freal *const uarr = uh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				uarr[iel*NVARS+ivar] *= 1.0 + 0.1*std::sin(m.gcoords(m.ginpoel(iel,0),0)
+				                                           + 2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+	ierr = VecGhostUpdateBegin(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecGhostUpdateEnd(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+	Mat A, Aref;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatDuplicate(A, MAT_COPY_VALUES, &Aref); CHKERRQ(ierr);
+
+	int finerr = 0;
+	if(!BAIJJacobianLayout<NVARS>::is_compatible(A)) {
+		if(mpirank == 0)
+			std::cerr << "! Jacobian matrix is not compatible with direct assembly!" << std::endl;
+		finerr = 1;
+	}
+	else
+	{
+		const BAIJJacobianLayout<NVARS> layout(m, A);
+		ierr = MatZeroEntries(A); CHKERRQ(ierr);
+		ierr = spatial->assemble_jacobian(u, layout, A); CHKERRQ(ierr);
+		ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+		ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+		PetscReal refnorm, diffnorm;
+		ierr = MatNorm(Aref, NORM_FROBENIUS, &refnorm); CHKERRQ(ierr);
+		ierr = MatAXPY(A, -1.0, Aref, SAME_NONZERO_PATTERN); CHKERRQ(ierr);
+		ierr = MatNorm(A, NORM_FROBENIUS, &diffnorm); CHKERRQ(ierr);
+
+		if(diffnorm/refnorm > 1e-12) {
+			finerr = 1;
+			if(mpirank == 0)
+				std::cerr << "! Relative difference between directly and generically assembled "
+				          << "Jacobians: " << diffnorm/refnorm << std::endl;
+		}
+	}
+
+	ierr = MatDestroy(&Aref); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
@@ -0,0 +1,133 @@
+/** \file testd_partition_invariance.cpp
+ * \brief Tests whether the residual and Jacobian do not depend on the mesh partitioner
+ *
+ * The first command line argument is the control file. The second is the partitioner to compare
+ * against the trivial partitioner.
+ * For each partitioner, the mesh is constructed, the global indices of the cells of each rank are
+ * checked to be the contiguous range owned by that rank in distributed vectors, and the residual,
+ * time steps and Jacobian are computed at a perturbed free-stream state. The cells are numbered
+ * differently for different partitions, so the permutation-invariant norms of these are compared.
+ */
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <array>
+#include <petscmat.h>
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+using namespace std::literals::string_literals;
+
+/// Computes the norms of the residual, time steps and Jacobian with a given partitioner
+/** \param[out] norms The 2-norm of the residual, the 1-norm of the time steps and the Frobenius
+ *   norm of the Jacobian
+ * \param[out] contiguous Whether the cells of this rank have the global indices owned by it
+ */
+static StatusCode computeNorms(FlowParserOptions opts, const std::string partitioner,
+                               std::array<PetscReal,3>& norms, bool& contiguous)
+{
+	StatusCode ierr = 0;
+	opts.partconf.partitioner = partitioner;
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u, res, dtm;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+	ierr = VecDuplicate(u, &res); CHKERRQ(ierr);
+	ierr = createSystemVector(&m, 1, &dtm); CHKERRQ(ierr);
+
+	PetscInt start, end;
+	ierr = VecGetOwnershipRange(dtm, &start, &end); CHKERRQ(ierr);
+	contiguous = (end-start == m.gnelem());
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		if(m.gglobalElemIndex(iel) != start+iel)
+			contiguous = false;
+
+	{
+		MutableVecHandler<freal> uh(u);
+		freal *const uarr = uh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				uarr[iel*NVARS+ivar] *= 1.0 + 0.1*std::sin(m.gcoords(m.ginpoel(iel,0),0)
+				                                           + 2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+	ierr = VecGhostUpdateBegin(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+	ierr = VecGhostUpdateEnd(u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+	ierr = VecSet(res, 0.0); CHKERRQ(ierr);
+	ierr = spatial->compute_residual(u, res, true, dtm); CHKERRQ(ierr);
+	ierr = VecNorm(res, NORM_2, &norms[0]); CHKERRQ(ierr);
+	ierr = VecNorm(dtm, NORM_1, &norms[1]); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatNorm(A, NORM_FROBENIUS, &norms[2]); CHKERRQ(ierr);
+
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&dtm); CHKERRQ(ierr);
+	ierr = VecDestroy(&res); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+	return ierr;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 3) {
+		std::cout << "Not enough command-line arguments!\n";
+		return -2;
+	}
+
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc
+		("FVENS partition invariance test.\n"s
+		 + " The first argument is the input control file name,\n"
+		 + " the second is the partitioner to compare against the trivial one.\n"
+		 + "Further options");
+
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const std::string partitioner = argv[2];
+
+	std::array<PetscReal,3> refnorms, norms;
+	bool refcontiguous, contiguous;
+	ierr = computeNorms(opts, "trivial", refnorms, refcontiguous); CHKERRQ(ierr);
+	ierr = computeNorms(opts, partitioner, norms, contiguous); CHKERRQ(ierr);
+
+	int finerr = 0;
+	if(!refcontiguous || !contiguous) {
+		finerr = 1;
+		std::cerr << "! Rank " << mpirank << ": global cell indices are not contiguous with the "
+		          << (contiguous ? "trivial" : partitioner) << " partitioner!" << std::endl;
+	}
+
+	const char *const names[] = {"residual", "time steps", "Jacobian"};
+	for(int i = 0; i < 3; i++)
+		if(std::abs(norms[i]-refnorms[i]) > 1e-12*refnorms[i]) {
+			finerr = 1;
+			if(mpirank == 0)
+				std::cerr << "! Norm of the " << names[i] << " with the " << partitioner
+				          << " partitioner is " << norms[i] << ", with the trivial partitioner "
+				          << refnorms[i] << std::endl;
+		}
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
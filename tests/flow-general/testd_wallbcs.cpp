@@ -14,6 +14,9 @@ using namespace std::literals::string_literals;
  * Currently avaiable:
  * - 'wall_boundaries': Tests whether certain components of the numerical inviscid flux
  *     are zero for the 3 types of solid walls - adiabatic, isothermal and slip.
+ * - 'numerical_flux <flux>': The same as above for a given numerical flux.
+ * - 'batched_flux <flux>': Tests whether the batched ghost states and numerical fluxes are the
+ *     same as those computed one face at a time.
  */
 int main(int argc, char *argv[])
 {
@@ -81,6 +84,21 @@ int main(int argc, char *argv[])
 		finerr = finerr || err;
 	}
 
+	if(testchoice == "batched_flux")
+	{
+		if(argc < 4) {
+			std::cerr << "Not enough command-line arguments!\n";
+			return -2;
+		}
+		nconf.conv_numflux = argv[3];
+		nconf.conv_numflux_jac = argv[3];
+		TestFlowFV testfv(&m, pconf, nconf);
+
+		const std::array<freal,NVARS> u = get_test_state();
+		int err = testfv.testBatchedFlux(&u[0]);
+		finerr = finerr || err;
+	}
+
 	ierr = PetscFinalize(); CHKERRQ(ierr);
 	return finerr;
 }
@@ -4,6 +4,7 @@
  * \date 2017-10
  */
 #include <iostream>
+#include <algorithm>
 #include "testwallbcs.hpp"
 
 #define FLUX_TOL 10*ZERO_TOL
@@ -70,6 +71,58 @@ int TestFlowFV::testWalls(const freal *const u) const
 	return ierr;
 }
 
+int TestFlowFV::testBatchedFlux(const freal *const u) const
+{
+	int ierr = 0;
+
+	for(int ibeg = m->gPhyBFaceStart(); ibeg < m->gPhyBFaceEnd(); ibeg += FACE_BATCH)
+	{
+		const FlowBC<freal> *const bc = bcs.at(m->gbtags(ibeg,0));
+
+		freal bu[NVARS][FACE_BATCH], bn[NDIM][FACE_BATCH], bug[NVARS][FACE_BATCH],
+			bflux[NVARS][FACE_BATCH];
+		for(int i = 0; i < FACE_BATCH; i++) {
+			const int iface = std::min(ibeg+i, m->gPhyBFaceEnd()-1);
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				bu[ivar][i] = u[ivar]*(1.0 + 0.05*i);
+			for(int idim = 0; idim < NDIM; idim++)
+				bn[idim][i] = m->gfacemetric(iface,idim);
+		}
+
+		bc->computeGhostStateBatch(bu, bn, bug);
+		inviflux->get_flux_batch(bu, bug, bn, bflux);
+
+		for(int i = 0; i < FACE_BATCH; i++)
+		{
+			freal ui[NVARS], ni[NDIM], ug[NVARS], flux[NVARS];
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				ui[ivar] = bu[ivar][i];
+			for(int idim = 0; idim < NDIM; idim++)
+				ni[idim] = bn[idim][i];
+
+			bc->computeGhostState(ui, ni, ug);
+			inviflux->get_flux(ui, ug, ni, flux);
+
+			for(int ivar = 0; ivar < NVARS; ivar++)
+			{
+				if(std::fabs(bug[ivar][i]-ug[ivar]) > FLUX_TOL*std::max(std::fabs(ug[ivar]),1.0)) {
+					ierr = 1;
+					std::cerr << "! Batched ghost state differs at face " << ibeg+i << ": "
+					          << bug[ivar][i] << " vs " << ug[ivar] << "\n";
+				}
+				if(std::fabs(bflux[ivar][i]-flux[ivar]) > 1e-12*std::max(std::fabs(flux[ivar]),1.0))
+				{
+					ierr = 1;
+					std::cerr << "! Batched flux differs at face " << ibeg+i << ": "
+					          << bflux[ivar][i] << " vs " << flux[ivar] << "\n";
+				}
+			}
+		}
+	}
+
+	return ierr;
+}
+
 std::array<freal,NVARS> get_test_state()
 {
 	const freal p_nondim = 10.0;
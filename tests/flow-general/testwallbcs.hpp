@@ -29,6 +29,13 @@ public:
 	 */
 	int testWalls(const freal *const u) const;
 
+	/// Tests whether batched ghost states and numerical fluxes agree with those of single faces
+	/** The boundary faces are taken in batches, each with the BC of its first face. Interior
+	 * states are obtained by scaling u differently for each face.
+	 * \param u Interior state for boundary cells
+	 */
+	int testBatchedFlux(const freal *const u) const;
+
 protected:
 	using FlowFV_base<freal>::bcs;
 	using FlowFV<freal,true,false>::compute_boundary_state;
@@ -8,10 +8,13 @@
 #include <string>
 #include <vector>
 #include <cstdlib>
+#include <cstdio>
 #include <memory>
 #include "utilities/mpiutils.hpp"
 #include "mesh/meshpartitioning.hpp"
+#include "mesh/distributedmeshbuilder.hpp"
 #include "mesh/ameshutils.hpp"
+#include "mesh/meshcache.hpp"
 
 using namespace fvens;
 
@@ -43,20 +46,38 @@ amat::Array2d<fint> getConnMatrix(const fint nconnface, std::ifstream& fin)
 
 // Checks a trivial distribution in which the cells are uniformly divided according to their index
 //  in the mesh file
+// If distributed is true, the local mesh is built by the parallel reader instead of being
+//  restricted from the replicated global mesh.
+// If partitioned is true, globalmeshfile must be a Gmsh 4 file partitioned in the same way and the
+//  local mesh is built by reading only this rank's partition. The elementary tags of boundary faces
+//  are not compared in that case, because Gmsh 4 entity tags cannot be zero.
 void checkTrivial(const std::string globalmeshfile, const std::vector<std::string>& localmeshfiles,
-                  const std::vector<std::string>& distfiles)
+                  const std::vector<std::string>& distfiles, const bool distributed,
+                  const bool partitioned)
 {
 	const int rank = get_mpi_rank(MPI_COMM_WORLD);
 	const int nranks = get_mpi_size(MPI_COMM_WORLD);
 
-	UMesh<freal,NDIM> gm(readMesh(globalmeshfile));
-	gm.compute_topological();
+	const UMesh<freal,NDIM> lm = [&]() {
+		if(partitioned) {
+			const PartitionedMeshReader reader(globalmeshfile, MPI_COMM_WORLD);
+			return reader.build();
+		}
+		else if(distributed) {
+			DistributedMeshBuilder builder(globalmeshfile, "trivial", MPI_COMM_WORLD);
+			return builder.build();
+		}
+		else {
+			UMesh<freal,NDIM> gm(readMesh(globalmeshfile));
+			gm.compute_topological();
 
-	std::shared_ptr<ReplicatedGlobalMeshPartitioner> p;
-	p = std::make_shared<TrivialReplicatedGlobalMeshPartitioner>(gm);
+			std::shared_ptr<ReplicatedGlobalMeshPartitioner> p;
+			p = std::make_shared<TrivialReplicatedGlobalMeshPartitioner>(gm);
 
-	p->compute_partition();
-	const UMesh<freal,NDIM> lm = p->restrictMeshToPartitions();
+			p->compute_partition();
+			return p->restrictMeshToPartitions();
+		}
+	}();
 
 	// Read solution to check against
 	const UMesh<freal,NDIM> reflm(readMesh(localmeshfiles[rank]));
@@ -83,7 +104,16 @@ void checkTrivial(const std::string globalmeshfile, const std::vector<std::strin
 			assert(isequal[3]);
 			assert(isequal[4]);
 			assert(isequal[5]);
-			assert(isequal[6]);
+			if(partitioned) {
+				assert(lm.gnbface() == reflm.gnbface());
+				for(fint i = 0; i < lm.gnbface(); i++) {
+					for(int j = 0; j < lm.gnnofa(i); j++)
+						assert(lm.gbface(i,j) == reflm.gbface(i,j));
+					assert(lm.gbface(i,lm.gnnofa(i)) == reflm.gbface(i,reflm.gnnofa(i)));
+				}
+			}
+			else
+				assert(isequal[6]);
 			assert(isequal[7]);
 
 			for(fint i = 0; i < lm.gnelem(); i++) {
@@ -118,6 +148,180 @@ void checkConnectedness(const UMesh<freal,NDIM>& gm, const std::string algo)
 	lm.compute_face_data();
 }
 
+/* Checks the partition quality report against the local meshes and the global mesh
+ * The total load must be the same as that of the global mesh computed serially.
+ */
+void checkPartitionQuality(const std::string globalmeshfile, const std::string algo)
+{
+	const int rank = get_mpi_rank(MPI_COMM_WORLD);
+	const int nranks = get_mpi_size(MPI_COMM_WORLD);
+
+	MeshPartitionConfig pconf;
+	pconf.partitioner = algo;
+	pconf.viscous = true;
+
+	UMesh<freal,NDIM> gm(readMesh(globalmeshfile));
+	gm.compute_topological();
+
+	std::shared_ptr<ReplicatedGlobalMeshPartitioner> p;
+	if(algo == "scotch")
+		p = std::make_shared<ScotchRGMPartitioner>(gm, pconf);
+	else
+		p = std::make_shared<TrivialReplicatedGlobalMeshPartitioner>(gm);
+	p->compute_partition();
+
+	UMesh<freal,NDIM> lm = p->restrictMeshToPartitions();
+	lm.compute_topological();
+
+	const PartitionQuality pq = computePartitionQuality(lm, pconf, MPI_COMM_WORLD);
+	const PartitionQuality gpq = computePartitionQuality(gm, pconf, MPI_COMM_SELF);
+	if(rank == 0)
+		printPartitionQuality(pq, true, std::cout);
+
+	assert(pq.nelem.size() == static_cast<size_t>(nranks));
+	assert(pq.nelem[rank] == lm.gnelem());
+	assert(pq.nconnface[rank] == lm.gnConnFace());
+
+	fint totelem = 0, totload = 0, totconnface = 0;
+	for(int irank = 0; irank < nranks; irank++) {
+		totelem += pq.nelem[irank];
+		totload += pq.load[irank];
+		totconnface += pq.nconnface[irank];
+		if(nranks > 1)
+			assert(pq.nnbrranks[irank] >= 1);
+		assert(pq.nnbrranks[irank] < nranks);
+	}
+	assert(totelem == gm.gnelem());
+	assert(totload == gpq.load[0]);
+	assert(2*pq.edgecut == totconnface);
+	assert(gpq.edgecut == 0);
+	assert(pq.elem_imbalance >= 1.0);
+	assert(pq.load_imbalance >= 1.0);
+}
+
+/* Reorders the cells of each subdomain of a trivial partition locally (in reverse) and checks that
+ * the global indices of each subdomain's cells remain contiguous and that the connectivity faces
+ * still point to the correct global index of the cell across them.
+ */
+void checkDistributedReordering(const std::string globalmeshfile)
+{
+	UMesh<freal,NDIM> gm(readMesh(globalmeshfile));
+	gm.compute_topological();
+
+	TrivialReplicatedGlobalMeshPartitioner p(gm);
+	p.compute_partition();
+	UMesh<freal,NDIM> lm = p.restrictMeshToPartitions();
+	lm.compute_topological();
+
+	std::vector<fint> origglobal(lm.gnelem());
+	for(fint iel = 0; iel < lm.gnelem(); iel++)
+		origglobal[iel] = lm.gglobalElemIndex(iel);
+
+	std::vector<PetscInt> perm(lm.gnelem());
+	for(fint iel = 0; iel < lm.gnelem(); iel++)
+		perm[iel] = lm.gnelem()-1-iel;
+
+	lm.reorder_cells(&perm[0]);
+	lm.renumber_global_cells(MPI_COMM_WORLD);
+	lm.compute_topological();
+
+	// New global index of every cell of the global mesh
+	std::vector<fint> newglobal(gm.gnelem(), -1);
+	for(fint iel = 0; iel < lm.gnelem(); iel++)
+	{
+		assert(lm.gglobalElemIndex(iel) == origglobal[0] + iel);
+		const fint origcell = origglobal[perm[iel]];
+		for(int j = 0; j < lm.gnnode(iel); j++)
+			assert(lm.gcoords(lm.ginpoel(iel,j),0) == gm.gcoords(gm.ginpoel(origcell,j),0));
+		newglobal[origcell] = lm.gglobalElemIndex(iel);
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &newglobal[0], gm.gnelem(), FVENS_MPI_INT, MPI_MAX,
+	              MPI_COMM_WORLD);
+
+	for(fint icface = 0; icface < lm.gnConnFace(); icface++)
+	{
+		const fint origcell = origglobal[perm[lm.gconnface(icface,0)]];
+		const fint orignbr = gm.gesuel(origcell, lm.gconnface(icface,1));
+		assert(lm.gconnface(icface,3) == newglobal[orignbr]);
+	}
+
+	const std::vector<fint> ghosts = lm.getConnectivityGlobalIndices();
+	for(fint icface = 0; icface < lm.gnConnFace(); icface++)
+		assert(ghosts[icface] == lm.gconnface(icface,3));
+}
+
+/* Writes the preprocessed subdomain meshes of a trivial partition to a mesh cache, reads them back
+ * and checks that the loaded meshes are identical to the original ones. Also checks that the cache
+ * entry is not found for different options, and that hashing the contents of the mesh file gives
+ * a key of its own that is the same every time.
+ */
+void checkMeshCache(const std::string globalmeshfile)
+{
+	UMesh<freal,NDIM> gm(readMesh(globalmeshfile));
+	gm.compute_topological();
+
+	TrivialReplicatedGlobalMeshPartitioner p(gm);
+	p.compute_partition();
+	UMesh<freal,NDIM> lm = p.restrictMeshToPartitions();
+	lm.compute_topological();
+	lm.compute_areas();
+	lm.compute_face_data();
+
+	const MeshCache cache("meshcache", globalmeshfile, "testoptions", MPI_COMM_WORLD);
+	std::remove(cache.filename().c_str());
+	MPI_Barrier(MPI_COMM_WORLD);
+	assert(!cache.available());
+
+	cache.store(lm);
+	MPI_Barrier(MPI_COMM_WORLD);
+	assert(cache.available());
+
+	const MeshCache othercache("meshcache", globalmeshfile, "otheroptions", MPI_COMM_WORLD);
+	assert(othercache.key() != cache.key());
+	assert(!othercache.available());
+
+	const MeshCache contentcache("meshcache", globalmeshfile, "testoptions", MPI_COMM_WORLD, true);
+	const MeshCache samecontentcache("meshcache", globalmeshfile, "testoptions", MPI_COMM_WORLD,
+	                                 true);
+	assert(contentcache.key() == samecontentcache.key());
+	assert(contentcache.key() != cache.key());
+
+	const UMesh<freal,NDIM> cm = cache.load();
+
+	const std::array<bool,8> chk = compareMeshes(lm, cm);
+	for(int i = 0; i < 8; i++)
+		assert(chk[i]);
+
+	assert(cm.gnelemglobal() == lm.gnelemglobal());
+	assert(cm.gnaface() == lm.gnaface());
+	assert(cm.gnConnFace() == lm.gnConnFace());
+	assert(cm.gPhyBFaceStart() == lm.gPhyBFaceStart());
+	assert(cm.gConnBFaceStart() == lm.gConnBFaceStart());
+	assert(cm.gSubDomFaceStart() == lm.gSubDomFaceStart());
+	assert(cm.gSubDomFaceEnd() == lm.gSubDomFaceEnd());
+
+	for(fint iel = 0; iel < lm.gnelem(); iel++) {
+		assert(cm.gglobalElemIndex(iel) == lm.gglobalElemIndex(iel));
+		assert(cm.garea(iel) == lm.garea(iel));
+		for(EIndex ifael = 0; ifael < lm.gnfael(iel); ifael++) {
+			assert(cm.gesuel(iel,ifael) == lm.gesuel(iel,ifael));
+			assert(cm.gelemface(iel,ifael) == lm.gelemface(iel,ifael));
+		}
+	}
+	for(fint iface = 0; iface < lm.gnaface(); iface++)
+		for(int j = 0; j < 4; j++) {
+			assert(cm.gintfac(iface,j) == lm.gintfac(iface,j));
+			if(j < NDIM+1)
+				assert(cm.gfacemetric(iface,j) == lm.gfacemetric(iface,j));
+		}
+	for(fint ibface = 0; ibface < lm.gnbface(); ibface++)
+		assert(cm.gPhyBFaceIndex(ibface) == lm.gPhyBFaceIndex(ibface));
+	for(fint icface = 0; icface < lm.gnConnFace(); icface++)
+		for(int j = 0; j < 5; j++)
+			assert(cm.gconnface(icface,j) == lm.gconnface(icface,j));
+	assert(cm.getConnectivityGlobalIndices() == lm.getConnectivityGlobalIndices());
+}
+
 int main(int argc, char *argv[])
 {
 	MPI_Init(&argc, &argv);
@@ -133,7 +337,8 @@ int main(int argc, char *argv[])
 	const std::string testtype = argv[1];
 	std::cout << "Test type is " << testtype << std::endl;
 
-	if(testtype == "checktrivial") {
+	if(testtype == "checktrivial" || testtype == "checktrivialdistributed"
+	   || testtype == "checktrivialpartitioned") {
 
 		if(argc < 2*nranks+3) {
 			std::cout << "Not enough arguments!\n";
@@ -152,7 +357,8 @@ int main(int argc, char *argv[])
 		assert(localmeshfiles.size() == static_cast<size_t>(nranks));
 		assert(distfiles.size() == static_cast<size_t>(nranks));
 
-		checkTrivial(globalmeshfile, localmeshfiles, distfiles);
+		checkTrivial(globalmeshfile, localmeshfiles, distfiles,
+		             testtype == "checktrivialdistributed", testtype == "checktrivialpartitioned");
 	}
 	else if (testtype == "sanity")
 	{
@@ -165,6 +371,22 @@ int main(int argc, char *argv[])
 
 		checkConnectedness(gm, algo);
 	}
+	else if (testtype == "reorder")
+	{
+		const std::string globalmeshfile = argv[3];
+		checkDistributedReordering(globalmeshfile);
+	}
+	else if (testtype == "cache")
+	{
+		const std::string globalmeshfile = argv[3];
+		checkMeshCache(globalmeshfile);
+	}
+	else if (testtype == "quality")
+	{
+		const std::string algo = argv[2];
+		const std::string globalmeshfile = argv[3];
+		checkPartitionQuality(globalmeshfile, algo);
+	}
 
 	MPI_Finalize();
 	return 0;
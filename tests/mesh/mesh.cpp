@@ -5,9 +5,15 @@
 #include <string>
 #include "mesh/mesh.hpp"
 #include "mesh/ameshutils.hpp"
+#include "mesh/binarymesh.hpp"
+#include "mesh/meshordering.hpp"
 
 #include <cassert>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace fvens;
 
 /// For each element in the esup list of a point, check if that point is actually part of each
@@ -64,6 +70,43 @@ int test_topology_internalconsistency_intfac(const UMesh<scalar,NDIM>& m)
 	return 0;
 }
 
+/// Checks that the faces in each block are sorted by their cells and that elemface agrees
+template<typename scalar>
+int test_face_ordering(const UMesh<scalar,NDIM>& m)
+{
+	for(fint iface = m.gPhyBFaceStart()+1; iface < m.gPhyBFaceEnd(); iface++)
+		TASSERT(m.gintfac(iface-1,0) <= m.gintfac(iface,0));
+	for(fint iface = m.gSubDomFaceStart()+1; iface < m.gSubDomFaceEnd(); iface++) {
+		TASSERT(m.gintfac(iface,0) < m.gintfac(iface,1));
+		TASSERT(m.gintfac(iface-1,0) < m.gintfac(iface,0)
+		        || (m.gintfac(iface-1,0) == m.gintfac(iface,0)
+		            && m.gintfac(iface-1,1) < m.gintfac(iface,1)));
+	}
+	for(fint iface = m.gConnBFaceStart()+1; iface < m.gConnBFaceEnd(); iface++)
+		TASSERT(m.gintfac(iface-1,0) <= m.gintfac(iface,0));
+
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(EIndex ifael = 0; ifael < m.gnfael(iel); ifael++) {
+			const fint iface = m.gelemface(iel,ifael);
+			TASSERT(m.gintfac(iface,0) == iel || m.gintfac(iface,1) == iel);
+			TASSERT(m.getFaceEIndex(false, iface, iel) == ifael);
+		}
+
+	// Each row of bface must map to a physical boundary face with the same points and tags
+	std::vector<bool> found(m.gnbface(), false);
+	for(fint ibface = 0; ibface < m.gnbface(); ibface++) {
+		const fint iface = m.gPhyBFaceIndex(ibface);
+		TASSERT(iface >= m.gPhyBFaceStart() && iface < m.gPhyBFaceEnd());
+		TASSERT(!found[iface-m.gPhyBFaceStart()]);
+		found[iface-m.gPhyBFaceStart()] = true;
+		for(int j = 0; j < m.gnnofa(ibface); j++)
+			TASSERT(m.gintfac(iface,2+j) == m.gbface(ibface,j));
+		for(int j = 0; j < m.gnbtag(); j++)
+			TASSERT(m.gbtags(iface,j) == m.gbface(ibface,m.gnnofa(ibface)+j));
+	}
+	return 0;
+}
+
 template<typename scalar>
 int test_periodic_map(UMesh<scalar,NDIM>& m, const int bcm, const int axis)
 {
@@ -77,8 +120,9 @@ int test_periodic_map(UMesh<scalar,NDIM>& m, const int bcm, const int axis)
 	int ierr = 0;
 
 	for(int i = 0; i < numfaces; i++) {
-		assert(m.gintfac(m.gPhyBFaceStart()+faces1[i],1) == m.gintfac(m.gPhyBFaceStart()+faces2[i],0));
-		assert(m.gintfac(m.gPhyBFaceStart()+faces1[i],0) == m.gintfac(m.gPhyBFaceStart()+faces2[i],1));
+		const fint iface = m.gPhyBFaceIndex(faces1[i]), jface = m.gPhyBFaceIndex(faces2[i]);
+		assert(m.gintfac(iface,1) == m.gintfac(jface,0));
+		assert(m.gintfac(iface,0) == m.gintfac(jface,1));
 	}
 
 	return ierr;
@@ -146,6 +190,207 @@ int test_levelscheduling_internalconsistency(const UMesh<scalar,NDIM>& m)
 	return 0;
 }
 
+/// Writes the mesh with its topology in the binary format, reads it back and compares
+/** The topology computed from the stored arrays must be the same as when computed from scratch.
+ */
+int test_binary_roundtrip(const MeshData& md, const std::string binfile)
+{
+	UMesh<freal,NDIM> m(md);
+	m.correctBoundaryFaceOrientation();
+	m.compute_topological();
+	writeBinaryMeshWithTopology(binfile, md, m);
+	const int nfacecols = md.nnofa+2;
+
+	const MeshData bmd = readMesh(binfile);
+	TASSERT(bmd.npoin == md.npoin);
+	TASSERT(bmd.nelem == md.nelem);
+	TASSERT(bmd.nbface == md.nbface);
+	TASSERT(bmd.maxnnode == md.maxnnode);
+	TASSERT(bmd.maxnfael == md.maxnfael);
+	TASSERT(bmd.nnofa == md.nnofa);
+	TASSERT(bmd.nbtag == md.nbtag);
+	TASSERT(bmd.ndtag == md.ndtag);
+	TASSERT(bmd.nnode == md.nnode);
+	TASSERT(bmd.nfael == md.nfael);
+	for(fint i = 0; i < md.npoin; i++)
+		for(int j = 0; j < NDIM; j++)
+			TASSERT(bmd.coords(i,j) == md.coords(i,j));
+	for(fint i = 0; i < md.nelem; i++) {
+		for(int j = 0; j < md.maxnnode; j++)
+			TASSERT(bmd.inpoel(i,j) == md.inpoel(i,j));
+		for(int j = 0; j < md.ndtag; j++)
+			TASSERT(bmd.vol_regions(i,j) == md.vol_regions(i,j));
+	}
+	// boundary faces are stored in the order of the faces
+	for(fint i = 0; i < md.nbface; i++) {
+		for(int j = 0; j < md.nnofa; j++)
+			TASSERT(bmd.bface(i,j) == m.gintfac(m.gPhyBFaceStart()+i,2+j));
+		for(int j = 0; j < md.nbtag; j++)
+			TASSERT(bmd.bface(i,md.nnofa+j) == m.gbtags(m.gPhyBFaceStart()+i,j));
+	}
+	TASSERT(bmd.esuel.rows() == md.nelem);
+	TASSERT(bmd.intfac.rows() == m.gnaface());
+
+	UMesh<freal,NDIM> pm(bmd);
+	pm.correctBoundaryFaceOrientation();
+	pm.compute_topological();
+	MeshData cmd = bmd;
+	cmd.esuel = amat::Array2d<fint>();
+	cmd.intfac = amat::Array2d<fint>();
+	UMesh<freal,NDIM> cm(cmd);
+	cm.correctBoundaryFaceOrientation();
+	cm.compute_topological();
+
+	TASSERT(pm.gnaface() == cm.gnaface());
+	TASSERT(pm.gninface() == cm.gninface());
+	TASSERT(pm.gPhyBFaceStart() == cm.gPhyBFaceStart());
+	TASSERT(pm.gPhyBFaceEnd() == cm.gPhyBFaceEnd());
+	TASSERT(pm.gSubDomFaceStart() == cm.gSubDomFaceStart());
+	TASSERT(pm.gSubDomFaceEnd() == cm.gSubDomFaceEnd());
+	TASSERT(pm.gDomFaceStart() == cm.gDomFaceStart());
+	TASSERT(pm.gDomFaceEnd() == cm.gDomFaceEnd());
+	for(fint iel = 0; iel < cm.gnelem(); iel++)
+		for(EIndex j = 0; j < cm.gnfael(iel); j++) {
+			TASSERT(pm.gesuel(iel,j) == cm.gesuel(iel,j));
+			TASSERT(pm.gelemface(iel,j) == cm.gelemface(iel,j));
+		}
+	for(fint iface = 0; iface < cm.gnaface(); iface++)
+		for(int j = 0; j < nfacecols; j++)
+			TASSERT(pm.gintfac(iface,j) == cm.gintfac(iface,j));
+	for(fint iface = cm.gPhyBFaceStart(); iface < cm.gPhyBFaceEnd(); iface++)
+		for(int j = 0; j < md.nbtag; j++)
+			TASSERT(pm.gbtags(iface,j) == cm.gbtags(iface,j));
+	for(fint ibface = 0; ibface < cm.gnbface(); ibface++)
+		TASSERT(pm.gPhyBFaceIndex(ibface) == cm.gPhyBFaceIndex(ibface));
+
+	const MappedMeshFile mf(binfile);
+	TASSERT(mf.hasTopology());
+	TASSERT(mf.header().naface == m.gnaface());
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(int j = 0; j < m.gmaxnfael(); j++)
+			TASSERT(mf.esuel()(iel,j) == m.gesuel(iel,j));
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+		for(int j = 0; j < nfacecols; j++)
+			TASSERT(mf.intfac()(iface,j) == m.gintfac(iface,j));
+
+	// slices should tile the mesh
+	const int nranks = 3;
+	fint elemcount = 0, poincount = 0, bfacecount = 0;
+	for(int rank = 0; rank < nranks; rank++) {
+		const MeshSlice sl = mf.getMeshSlice(nranks, rank);
+		TASSERT(sl.elemstart == elemcount);
+		TASSERT(sl.poinstart == poincount);
+		TASSERT(sl.bfacestart == bfacecount);
+		for(fint i = 0; i < sl.nelem; i++)
+			for(int j = 0; j < md.maxnnode; j++)
+				TASSERT(sl.inpoel(i,j) == md.inpoel(sl.elemstart+i,j));
+		for(fint i = 0; i < sl.npoin; i++)
+			for(int j = 0; j < NDIM; j++)
+				TASSERT(sl.coords(i,j) == md.coords(sl.poinstart+i,j));
+		for(fint i = 0; i < sl.nbface; i++)
+			for(int j = 0; j < md.nnofa+md.nbtag; j++)
+				TASSERT(sl.bface(i,j) == md.bface(sl.bfacestart+i,j));
+		elemcount += sl.nelem;
+		poincount += sl.npoin;
+		bfacecount += sl.nbface;
+	}
+	TASSERT(elemcount == md.nelem);
+	TASSERT(poincount == md.npoin);
+	TASSERT(bfacecount == md.nbface);
+
+	return 0;
+}
+
+/// Checks that ordering along a space-filling curve gives a valid mesh with the same entities
+int test_sfc_ordering(const MeshData& md, const UMesh<freal,NDIM>& m, const std::string curve)
+{
+	const std::vector<fint> ordering = getSpaceFillingCurveOrdering(m, curve);
+	TASSERT(ordering.size() == static_cast<size_t>(m.gnelem()));
+	std::vector<bool> found(m.gnelem(), false);
+	for(fint i = 0; i < m.gnelem(); i++) {
+		TASSERT(ordering[i] >= 0 && ordering[i] < m.gnelem());
+		TASSERT(!found[ordering[i]]);
+		found[ordering[i]] = true;
+	}
+
+	UMesh<freal,NDIM> rm(md);
+	spaceFillingCurveReorder(rm, curve);
+	rm.compute_topological();
+	rm.compute_areas();
+	TASSERT(rm.gnelem() == m.gnelem());
+	TASSERT(rm.gnbface() == m.gnbface());
+	TASSERT(rm.gninface() == m.gninface());
+	TASSERT(test_topology_internalconsistency_intfac(rm) == 0);
+
+	for(fint i = 0; i < m.gnelem(); i++) {
+		TASSERT(rm.gnnode(i) == m.gnnode(ordering[i]));
+		for(int j = 0; j < m.gnnode(i); j++)
+			TASSERT(rm.ginpoel(i,j) == m.ginpoel(ordering[i],j));
+	}
+
+	// Every boundary face should still be present once, with the same tags
+	std::vector<std::vector<fint>> bfaces, rbfaces;
+	for(fint i = 0; i < m.gnbface(); i++) {
+		bfaces.push_back(std::vector<fint>(m.gnnofa(i)+m.gnbtag()));
+		rbfaces.push_back(std::vector<fint>(m.gnnofa(i)+m.gnbtag()));
+		for(int j = 0; j < m.gnnofa(i)+m.gnbtag(); j++) {
+			bfaces[i][j] = m.gbface(i,j);
+			rbfaces[i][j] = rm.gbface(i,j);
+		}
+	}
+	std::sort(bfaces.begin(), bfaces.end());
+	std::sort(rbfaces.begin(), rbfaces.end());
+	TASSERT(bfaces == rbfaces);
+
+	// Neighbouring cells should be closer in the new ordering on average
+	double avgdist = 0, ravgdist = 0;
+	for(fint iface = m.gSubDomFaceStart(); iface < m.gSubDomFaceEnd(); iface++) {
+		avgdist += std::abs(m.gintfac(iface,1) - m.gintfac(iface,0));
+		ravgdist += std::abs(rm.gintfac(iface,1) - rm.gintfac(iface,0));
+	}
+	std::cout << " Average index distance between neighbours: original " << avgdist/m.gninface()
+		<< ", " << curve << ' ' << ravgdist/m.gninface() << std::endl;
+	TASSERT(ravgdist < avgdist);
+
+	return 0;
+}
+
+/// Checks that the topology computed with all available threads is identical to that computed by
+///  one thread
+int test_topology_threads(const MeshData& md, const UMesh<freal,NDIM>& m)
+{
+	UMesh<freal,NDIM> sm(md);
+#ifdef _OPENMP
+	const int nthreads = omp_get_max_threads();
+	std::cout << " Comparing topology computed with " << nthreads << " threads to that with 1\n";
+	omp_set_num_threads(1);
+	sm.compute_topological();
+	omp_set_num_threads(nthreads);
+#else
+	sm.compute_topological();
+#endif
+
+	for(fint ipoin = 0; ipoin <= m.gnpoin(); ipoin++)
+		TASSERT(sm.gesup_p(ipoin) == m.gesup_p(ipoin));
+	for(fint i = 0; i < m.gesup_p(m.gnpoin()); i++)
+		TASSERT(sm.gesup(i) == m.gesup(i));
+
+	TASSERT(sm.gnaface() == m.gnaface());
+	TASSERT(sm.gninface() == m.gninface());
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(EIndex ifael = 0; ifael < m.gnfael(iel); ifael++) {
+			TASSERT(sm.gesuel(iel,ifael) == m.gesuel(iel,ifael));
+			TASSERT(sm.gelemface(iel,ifael) == m.gelemface(iel,ifael));
+		}
+	for(fint iface = 0; iface < m.gnaface(); iface++)
+		for(int j = 0; j < m.gnnofa(iface)+2; j++)
+			TASSERT(sm.gintfac(iface,j) == m.gintfac(iface,j));
+	for(fint ibface = 0; ibface < m.gnbface(); ibface++)
+		TASSERT(sm.gPhyBFaceIndex(ibface) == m.gPhyBFaceIndex(ibface));
+
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	if(argc < 3) {
@@ -169,6 +414,9 @@ int main(int argc, char *argv[])
 	else if(whichtest == "intfac") {
 		err = test_topology_internalconsistency_intfac(m);
 	}
+	else if(whichtest == "faceordering") {
+		err = test_face_ordering(m);
+	}
 	else if(whichtest == "periodic") {
 		err = test_periodic_map(m, 4, 0);
 		if(err) std::cerr << " Periodic map test failed!\n";
@@ -183,6 +431,15 @@ int main(int argc, char *argv[])
 	else if(whichtest == "levelscheduleInternal") {
 		err = test_levelscheduling_internalconsistency(m);
 	}
+	else if(whichtest == "binaryroundtrip") {
+		err = test_binary_roundtrip(md, "testmesh_roundtrip.fvm");
+	}
+	else if(whichtest == "topologythreads") {
+		err = test_topology_threads(md, m);
+	}
+	else if(whichtest == "hilbert" || whichtest == "morton") {
+		err = test_sfc_ordering(md, m, whichtest);
+	}
 	else
 		throw "Invalid test";
 
@@ -0,0 +1,74 @@
+#undef NDEBUG
+
+#include <iostream>
+#include <string>
+#include <petscvec.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Solves the case with the block SGS preconditioner and returns the timing data
+static TimingData solveCase(const FlowParserOptions& opts, const UMesh<freal,NDIM>& m,
+                            const FlowFV_base<freal> *const spatial)
+{
+	Vec u;
+	StatusCode ierr = initializeSystemVector(opts, m, &u); petsc_throw(ierr, "Initialize");
+
+	SteadyFlowCase scase(opts);
+	const TimingData td = scase.execute_main(spatial, u);
+	if(!td.converged)
+		throw Tolerance_error("Solve did not converge to specified tolerance!");
+
+	ierr = VecDestroy(&u); petsc_throw(ierr, "Destroy");
+	return td;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = 0;
+	const char help[] = "Finite volume solver for Euler or Navier-Stokes equations.\n\
+		Arguments needed: FVENS control file and PETSc options file with -options_file.\n";
+
+	ierr = PetscInitialize(&argc,&argv,NULL,help); CHKERRQ(ierr);
+
+	po::options_description desc ("Test for single-precision storage of the preconditioner");
+
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	ierr = PetscOptionsSetValue(NULL, "-fvens_pc_type", "block_sgs"); CHKERRQ(ierr);
+	const TimingData td1 = solveCase(opts, m, spatial);
+
+	ierr = PetscOptionsSetValue(NULL, "-block_sgs_single_precision", ""); CHKERRQ(ierr);
+	const TimingData td2 = solveCase(opts, m, spatial);
+
+	delete spatial;
+
+	std::cout << "Double-precision storage: nonlinear iterations = " << td1.num_timesteps
+		<< ", linear iterations = " << td1.total_lin_iters << std::endl;
+	std::cout << "Single-precision storage: nonlinear iterations = " << td2.num_timesteps
+		<< ", linear iterations = " << td2.total_lin_iters << std::endl;
+
+	// Rounding the preconditioner must not affect the nonlinear convergence
+	assert(abs(td1.num_timesteps-td2.num_timesteps) <= 1);
+
+	std::cout << '\n';
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	std::cout << "\n--------------- End --------------------- \n\n";
+	return ierr;
+}
@@ -0,0 +1,124 @@
+/** \file testblocksparse.cpp
+ * \brief Tests the mesh-structured block sparse matrix against the BAIJ matrix it is copied from
+ *
+ * The first command line argument is the control file.
+ * The Jacobian is assembled at the initial state and copied into a \ref BlockSparseMatrix. Its
+ * product with a vector, through a shell matrix, is compared to MatMult of the BAIJ matrix, and
+ * its block SGS application to one local symmetric sweep of PETSc's MatSOR.
+ */
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <petscksp.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/blocksparsematrix.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Returns |a - b| / |b| in the 2-norm
+static freal relativeDifference(Vec a, Vec b)
+{
+	Vec diff;
+	StatusCode ierr = VecDuplicate(a, &diff); petsc_throw(ierr, "Duplicate");
+	ierr = VecWAXPY(diff, -1.0, b, a); petsc_throw(ierr, "WAXPY");
+	PetscReal diffnorm, refnorm;
+	ierr = VecNorm(diff, NORM_2, &diffnorm); petsc_throw(ierr, "Norm");
+	ierr = VecNorm(b, NORM_2, &refnorm); petsc_throw(ierr, "Norm");
+	ierr = VecDestroy(&diff); petsc_throw(ierr, "Destroy");
+	return diffnorm/refnorm;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc ("Test for the block sparse matrix");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+	const BAIJJacobianLayout<NVARS> layout(m, A);
+	BlockSparseMatrix<freal,NVARS> bsm(m);
+	ierr = bsm.copy_from(A, layout); CHKERRQ(ierr);
+	bsm.invert_diagonal_blocks();
+
+	Mat Ashell;
+	ierr = create_block_sparse_shell_matrix(&bsm, &Ashell); CHKERRQ(ierr);
+
+	Vec x, yref, y;
+	ierr = MatCreateVecs(A, &x, &yref); CHKERRQ(ierr);
+	ierr = VecDuplicate(yref, &y); CHKERRQ(ierr);
+	{
+		MutableVecHandler<freal> xh(x);
+		freal *const xarr = xh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				xarr[iel*NVARS+ivar] = 1.0 + std::sin(m.gcoords(m.ginpoel(iel,0),0) + ivar)
+					* std::cos(2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+
+	int finerr = 0;
+
+	ierr = MatMult(A, x, yref); CHKERRQ(ierr);
+	ierr = MatMult(Ashell, x, y); CHKERRQ(ierr);
+	const freal multdiff = relativeDifference(y, yref);
+	if(multdiff > 1e-12) {
+		finerr = 1;
+		if(mpirank == 0)
+			std::cerr << "! Relative difference in products: " << multdiff << std::endl;
+	}
+
+	// One forward and one backward sweep from zero is the same as (D+U)^{-1} D (D+L)^{-1}
+	ierr = MatSOR(A, x, 1.0, (MatSORType)(SOR_LOCAL_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),
+	              0.0, 1, 1, yref);
+	CHKERRQ(ierr);
+	{
+		std::vector<freal> work(m.gnelem()*NVARS);
+		ConstVecHandler<freal> xh(x);
+		MutableVecHandler<freal> yh(y);
+		bsm.apply_sgs(xh.getArray(), work.data(), yh.getArray());
+	}
+	const freal sgsdiff = relativeDifference(y, yref);
+	if(sgsdiff > 1e-12) {
+		finerr = 1;
+		if(mpirank == 0)
+			std::cerr << "! Relative difference in SGS applications: " << sgsdiff << std::endl;
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = VecDestroy(&yref); CHKERRQ(ierr);
+	ierr = MatDestroy(&Ashell); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
@@ -0,0 +1,160 @@
+/** \file testfacejacobian.cpp
+ * \brief Tests the face-based Jacobian against the BAIJ Jacobian
+ *
+ * The first command line argument is the control file.
+ * The Jacobian is assembled at the initial state both into a BAIJ matrix and into a
+ * \ref FaceJacobian. The product with a vector through the face Jacobian's shell matrix is compared
+ * to MatMult of the BAIJ matrix, and its block Jacobi and block SGS preconditioners, applied through
+ * the shell PC, to the block sparse matrix's block diagonal inverse and to the multicolour SGS of the
+ * \ref ThreadedBlockPreconditioner respectively.
+ */
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <petscksp.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/blocksparsematrix.hpp"
+#include "linalg/threadedblockpc.hpp"
+#include "linalg/facejacobian.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Returns |a - b| / |b| in the 2-norm
+static freal relativeDifference(Vec a, Vec b)
+{
+	Vec diff;
+	StatusCode ierr = VecDuplicate(a, &diff); petsc_throw(ierr, "Duplicate");
+	ierr = VecWAXPY(diff, -1.0, b, a); petsc_throw(ierr, "WAXPY");
+	PetscReal diffnorm, refnorm;
+	ierr = VecNorm(diff, NORM_2, &diffnorm); petsc_throw(ierr, "Norm");
+	ierr = VecNorm(b, NORM_2, &refnorm); petsc_throw(ierr, "Norm");
+	ierr = VecDestroy(&diff); petsc_throw(ierr, "Destroy");
+	return diffnorm/refnorm;
+}
+
+/// Applies the face Jacobian shell PC of a given type to x
+static void applyFacePC(Mat Aface, const std::string type, Vec x, Vec y)
+{
+	PC pc;
+	StatusCode ierr = PCCreate(PETSC_COMM_WORLD, &pc); petsc_throw(ierr, "PC create");
+	ierr = PCSetOperators(pc, Aface, Aface); petsc_throw(ierr, "PC set operators");
+	ierr = setup_face_jacobian_pc<NVARS>(pc, type); petsc_throw(ierr, "Face Jacobian PC");
+	ierr = PCSetUp(pc); petsc_throw(ierr, "PC setup");
+	ierr = PCApply(pc, x, y); petsc_throw(ierr, "PC apply");
+	ierr = PCDestroy(&pc); petsc_throw(ierr, "PC destroy");
+}
+
+/// Checks a relative difference against a tolerance and reports failure
+static int check(const freal diff, const freal tol, const std::string what, const int mpirank)
+{
+	if(diff > tol || std::isnan(diff)) {
+		if(mpirank == 0)
+			std::cerr << "! " << what << ": relative difference " << diff << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc ("Test for the face-based Jacobian");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+	FaceJacobian<NVARS> facejac(m);
+	ierr = spatial->assemble_jacobian(u, facejac); CHKERRQ(ierr);
+	Mat Aface;
+	ierr = create_face_jacobian_shell_matrix(&facejac, &Aface); CHKERRQ(ierr);
+	if(get_face_jacobian<NVARS>(Aface) != &facejac || get_face_jacobian<NVARS>(A) != nullptr) {
+		std::cerr << "! Face Jacobian shell matrix not recognized\n";
+		return 1;
+	}
+
+	Vec x, yref, y;
+	ierr = MatCreateVecs(A, &x, &yref); CHKERRQ(ierr);
+	ierr = VecDuplicate(yref, &y); CHKERRQ(ierr);
+	{
+		MutableVecHandler<freal> xh(x);
+		freal *const xarr = xh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				xarr[iel*NVARS+ivar] = 1.0 + std::sin(m.gcoords(m.ginpoel(iel,0),0) + ivar)
+					* std::cos(2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+
+	int finerr = 0;
+
+	ierr = MatMult(A, x, yref); CHKERRQ(ierr);
+	ierr = MatMult(Aface, x, y); CHKERRQ(ierr);
+	finerr += check(relativeDifference(y, yref), 1e-12, "Products", mpirank);
+
+	// Block Jacobi
+	{
+		const BAIJJacobianLayout<NVARS> layout(m, A);
+		BlockSparseMatrix<freal,NVARS> bsm(m);
+		ierr = bsm.copy_from(A, layout); CHKERRQ(ierr);
+		bsm.invert_diagonal_blocks();
+		{
+			ConstVecHandler<freal> xh(x);
+			MutableVecHandler<freal> yh(yref);
+			bsm.apply_block_diagonal_inverse(xh.getArray(), yh.getArray());
+		}
+		applyFacePC(Aface, "jacobi", x, y);
+		finerr += check(relativeDifference(y, yref), 1e-12, "Block Jacobi", mpirank);
+	}
+
+	// Both use the cell colouring of colourCells, in which one forward and one backward sweep from
+	//  zero is the same as (D+U)^{-1} D (D+L)^{-1}
+	{
+		const BAIJJacobianLayout<NVARS> layout(m, A);
+		ThreadedBlockPreconditioner<NVARS> sgs(m, THREADED_SGS, SCHEDULE_COLOURS, 1, 1);
+		ierr = sgs.setup(A, layout); CHKERRQ(ierr);
+		{
+			ConstVecHandler<freal> xh(x);
+			MutableVecHandler<freal> yh(yref);
+			sgs.apply(xh.getArray(), yh.getArray());
+		}
+		applyFacePC(Aface, "sgs", x, y);
+		finerr += check(relativeDifference(y, yref), 1e-12, "Block SGS", mpirank);
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = VecDestroy(&yref); CHKERRQ(ierr);
+	ierr = MatDestroy(&Aface); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
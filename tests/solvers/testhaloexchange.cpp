@@ -0,0 +1,102 @@
+/** \file
+ * \brief Test for the exchange of several fields at once across connectivity faces
+ *
+ * A cell field is exchanged together with a trace field. The ghost values of the cell field are
+ * compared with those obtained by a PETSc ghost update, and the trace field is checked as in the
+ * trace vector test.
+ */
+
+#undef NDEBUG
+
+#include <iostream>
+#include <vector>
+#include "utilities/mpiutils.hpp"
+#include "mesh/ameshutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/haloexchange.hpp"
+
+using namespace fvens;
+
+int test(const std::string meshpath)
+{
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	const UMesh<freal,NDIM> m = constructMesh(meshpath);
+
+	constexpr int cellwidth = NDIM*NVARS;
+	HaloExchange halo(m, {{HALO_TRACE, NVARS}, {HALO_CELL, cellwidth}});
+
+	// Fill some cell data and get the reference ghost values from PETSc
+	Vec cellvec;
+	int ierr = createGhostedSystemVector(&m, cellwidth, &cellvec);
+	assert(ierr == 0);
+	std::vector<freal> cells((m.gnelem()+m.gnConnFace())*cellwidth, -1.0);
+	{
+		MutableVecHandler<freal> ch(cellvec);
+		freal *const carr = ch.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int j = 0; j < cellwidth; j++) {
+				carr[iel*cellwidth+j] = mpirank*100000 + iel*100 + j;
+				cells[iel*cellwidth+j] = carr[iel*cellwidth+j];
+			}
+	}
+	VecGhostUpdateBegin(cellvec, INSERT_VALUES, SCATTER_FORWARD);
+	VecGhostUpdateEnd(cellvec, INSERT_VALUES, SCATTER_FORWARD);
+
+	// Fill some trace data
+	std::vector<freal> left(m.gnaface()*NVARS), right(m.gnaface()*NVARS, -1.0);
+	for(fint iface = m.gConnBFaceStart(); iface < m.gConnBFaceEnd(); iface++)
+	{
+		const fint icface = iface - m.gConnBFaceStart();
+		for(int j = 0; j < NVARS; j++)
+			left[iface*NVARS+j] = mpirank*1000+m.gconnface(icface,4)*10+j;
+	}
+
+	// exchange twice to check that the persistent requests can be re-used
+	for(int irep = 0; irep < 2; irep++)
+	{
+		const void *const sources[] = {left.data(), cells.data()};
+		halo.begin(sources);
+		void *const targets[] = {right.data(), cells.data()};
+		halo.end(targets);
+	}
+
+	for(fint iface = m.gConnBFaceStart(); iface < m.gConnBFaceEnd(); iface++)
+	{
+		const fint icface = iface - m.gConnBFaceStart();
+		const int nbdrank = m.gconnface(icface,2);
+		for(int j = 0; j < NVARS; j++) {
+			assert(right[iface*NVARS+j] == nbdrank*1000+m.gconnface(icface,4)*10+j);
+		}
+	}
+
+	{
+		ConstGhostedVecHandler<freal> ch(cellvec);
+		const freal *const carr = ch.getArray();
+		for(fint i = m.gnelem()*cellwidth; i < (m.gnelem()+m.gnConnFace())*cellwidth; i++)
+			assert(cells[i] == carr[i]);
+	}
+
+	VecDestroy(&cellvec);
+	std::cout << "Rank " << mpirank << ": exchanged " << halo.num_values_sent() << " values with "
+	          << halo.num_neighbours() << " neighbours." << std::endl;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2) {
+		std::cout << "A mesh path is required!" << std::endl;
+		return -1;
+	}
+
+	const std::string mesh = argv[1];
+
+	PetscInitialize(&argc, &argv, NULL, NULL);
+
+	test(mesh);
+
+	PetscFinalize();
+	return 0;
+}
@@ -0,0 +1,212 @@
+/** \file testlinepc.cpp
+ * \brief Tests the line-implicit preconditioners
+ *
+ * The first command line argument is the control file; the mesh should have regions of high
+ * anisotropy so that lines are found. Only for serial runs.
+ * The Jacobian is assembled at the initial state, and the preconditioners are applied to one
+ * vector. The following are checked:
+ *  - line Jacobi solves exactly the block-tridiagonal part of the Jacobian along the lines
+ *  - multicolour line SGS on one thread against that on the maximum number of threads
+ *  - line SGS without any lines against the multicolour threaded block SGS
+ */
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <vector>
+#include <petscksp.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/linepc.hpp"
+#include "linalg/threadedblockpc.hpp"
+#include "mesh/details_lineordering.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Anisotropy threshold for finding lines
+static const freal line_threshold = 10.0;
+
+/// Returns |a - b| / |b| in the 2-norm
+static freal relativeDifference(Vec a, Vec b)
+{
+	Vec diff;
+	StatusCode ierr = VecDuplicate(a, &diff); petsc_throw(ierr, "Duplicate");
+	ierr = VecWAXPY(diff, -1.0, b, a); petsc_throw(ierr, "WAXPY");
+	PetscReal diffnorm, refnorm;
+	ierr = VecNorm(diff, NORM_2, &diffnorm); petsc_throw(ierr, "Norm");
+	ierr = VecNorm(b, NORM_2, &refnorm); petsc_throw(ierr, "Norm");
+	ierr = VecDestroy(&diff); petsc_throw(ierr, "Destroy");
+	return diffnorm/refnorm;
+}
+
+/// Sets up a line preconditioner and applies it to x with a given number of threads
+static void applyLine(const UMesh<freal,NDIM>& m, Mat A, const BAIJJacobianLayout<NVARS>& layout,
+                      const LinePCType type, const freal threshold, const int nthreads, Vec x, Vec y)
+{
+#ifdef _OPENMP
+	const int maxthreads = omp_get_max_threads();
+	omp_set_num_threads(nthreads);
+#endif
+
+	LinePreconditioner<NVARS> prec(m, type, threshold);
+	StatusCode ierr = prec.setup(A, layout); petsc_throw(ierr, "Line PC setup");
+	{
+		ConstVecHandler<freal> xh(x);
+		MutableVecHandler<freal> yh(y);
+		prec.apply(xh.getArray(), yh.getArray());
+	}
+
+#ifdef _OPENMP
+	omp_set_num_threads(maxthreads);
+#endif
+}
+
+/// Copies A and zeroes all off-diagonal blocks that do not couple consecutive cells of a line
+static Mat extractLineTridiagonal(const UMesh<freal,NDIM>& m, Mat A, const LineConfig& lc)
+{
+	Mat T;
+	StatusCode ierr = MatDuplicate(A, MAT_COPY_VALUES, &T); petsc_throw(ierr, "Duplicate");
+
+	// position of each cell in its line
+	std::vector<fint> linepos(m.gnelem(), -1);
+	for(size_t iline = 0; iline < lc.lines.size(); iline++)
+		for(size_t k = 0; k < lc.lines[iline].size(); k++)
+			linepos[lc.lines[iline][k]] = static_cast<fint>(k);
+
+	const std::vector<PetscScalar> zeros(NVARS*NVARS, 0);
+	for(fint iel = 0; iel < m.gnelem(); iel++)
+		for(int ifael = 0; ifael < m.gnfael(iel); ifael++)
+		{
+			const fint jel = m.gesuel(iel,ifael);
+			if(jel >= m.gnelem())
+				continue;
+			if(lc.celline[iel] >= 0 && lc.celline[iel] == lc.celline[jel]
+			   && std::abs(linepos[iel]-linepos[jel]) == 1)
+				continue;
+			const PetscInt row = iel, col = jel;
+			ierr = MatSetValuesBlocked(T, 1, &row, 1, &col, &zeros[0], INSERT_VALUES);
+			petsc_throw(ierr, "Set values");
+		}
+
+	ierr = MatAssemblyBegin(T, MAT_FINAL_ASSEMBLY); petsc_throw(ierr, "Assembly");
+	ierr = MatAssemblyEnd(T, MAT_FINAL_ASSEMBLY); petsc_throw(ierr, "Assembly");
+	return T;
+}
+
+/// Checks a relative difference against a tolerance and reports failure
+static int check(const freal diff, const freal tol, const std::string what)
+{
+	if(diff > tol || std::isnan(diff)) {
+		std::cerr << "! " << what << ": relative difference " << diff << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	if(get_mpi_size(PETSC_COMM_WORLD) != 1) {
+		std::cerr << "The line preconditioner test is for serial runs only!\n";
+		return -1;
+	}
+
+	po::options_description desc ("Test for the line-implicit preconditioners");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	const BAIJJacobianLayout<NVARS> layout(m, A);
+
+	Vec x, yref, y;
+	ierr = MatCreateVecs(A, &x, &yref); CHKERRQ(ierr);
+	ierr = VecDuplicate(yref, &y); CHKERRQ(ierr);
+	{
+		MutableVecHandler<freal> xh(x);
+		freal *const xarr = xh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				xarr[iel*NVARS+ivar] = 1.0 + std::sin(m.gcoords(m.ginpoel(iel,0),0) + ivar)
+					* std::cos(2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+
+#ifdef _OPENMP
+	const int maxthreads = omp_get_max_threads();
+#else
+	const int maxthreads = 1;
+#endif
+	int finerr = 0;
+
+	const LineConfig lc = findLines(m, line_threshold);
+	std::cout << "Found " << lc.lines.size() << " lines." << std::endl;
+	if(lc.lines.size() == 0) {
+		std::cerr << "! No lines found in the mesh\n";
+		finerr++;
+	}
+
+	// Line Jacobi: T y = x where T is the block-tridiagonal part along the lines
+	{
+		applyLine(m, A, layout, LINE_JACOBI, line_threshold, maxthreads, x, y);
+		Mat T = extractLineTridiagonal(m, A, lc);
+		ierr = MatMult(T, y, yref); CHKERRQ(ierr);
+		finerr += check(relativeDifference(yref, x), 1e-12, "Line Jacobi");
+		ierr = MatDestroy(&T); CHKERRQ(ierr);
+	}
+
+	// Line SGS
+	{
+		applyLine(m, A, layout, LINE_SGS, line_threshold, 1, x, yref);
+		applyLine(m, A, layout, LINE_SGS, line_threshold, maxthreads, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-14, "Multicolour line SGS");
+	}
+
+	// Without lines, line SGS is point-block SGS in the same multicolour ordering
+	{
+		ThreadedBlockPreconditioner<NVARS> prec(m, THREADED_SGS, SCHEDULE_COLOURS, 1, 1);
+		ierr = prec.setup(A, layout); CHKERRQ(ierr);
+		{
+			ConstVecHandler<freal> xh(x);
+			MutableVecHandler<freal> yh(yref);
+			prec.apply(xh.getArray(), yh.getArray());
+		}
+
+		applyLine(m, A, layout, LINE_SGS, 1e30, maxthreads, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-12, "Point SGS");
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = VecDestroy(&yref); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}
@@ -0,0 +1,185 @@
+/** \file testthreadedpc.cpp
+ * \brief Tests the threaded block ILU(0) and SGS preconditioners against sequential references
+ *
+ * The first command line argument is the control file.
+ * The Jacobian is assembled at the initial state, and the preconditioners are applied to one
+ * vector. The following are checked:
+ *  - level-scheduled SGS against one sweep of the \ref BlockSGSPreconditioner
+ *  - level-scheduled ILU(0) against PETSc's block Jacobi with ILU(0) in the natural ordering
+ *  - asynchronous SGS and ILU(0) on one thread with one sweep against the level-scheduled ones
+ *  - the multicolour preconditioners on one thread against those on the maximum number of threads
+ */
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <vector>
+#include <petscksp.h>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "utilities/aoptionparser.hpp"
+#include "utilities/controlparser.hpp"
+#include "utilities/casesolvers.hpp"
+#include "utilities/mpiutils.hpp"
+#include "linalg/alinalg.hpp"
+#include "linalg/petscutils.hpp"
+#include "linalg/blocksgs.hpp"
+#include "linalg/threadedblockpc.hpp"
+
+using namespace fvens;
+namespace po = boost::program_options;
+
+/// Returns |a - b| / |b| in the 2-norm
+static freal relativeDifference(Vec a, Vec b)
+{
+	Vec diff;
+	StatusCode ierr = VecDuplicate(a, &diff); petsc_throw(ierr, "Duplicate");
+	ierr = VecWAXPY(diff, -1.0, b, a); petsc_throw(ierr, "WAXPY");
+	PetscReal diffnorm, refnorm;
+	ierr = VecNorm(diff, NORM_2, &diffnorm); petsc_throw(ierr, "Norm");
+	ierr = VecNorm(b, NORM_2, &refnorm); petsc_throw(ierr, "Norm");
+	ierr = VecDestroy(&diff); petsc_throw(ierr, "Destroy");
+	return diffnorm/refnorm;
+}
+
+/// Sets up a threaded preconditioner and applies it to x with a given number of threads
+static void applyThreaded(const UMesh<freal,NDIM>& m, Mat A, const BAIJJacobianLayout<NVARS>& layout,
+                          const ThreadedPCType type, const ThreadedPCSchedule schedule,
+                          const int nthreads, Vec x, Vec y)
+{
+#ifdef _OPENMP
+	const int maxthreads = omp_get_max_threads();
+	omp_set_num_threads(nthreads);
+#endif
+
+	ThreadedBlockPreconditioner<NVARS> prec(m, type, schedule, 1, 1);
+	StatusCode ierr = prec.setup(A, layout); petsc_throw(ierr, "Threaded PC setup");
+	{
+		ConstVecHandler<freal> xh(x);
+		MutableVecHandler<freal> yh(y);
+		prec.apply(xh.getArray(), yh.getArray());
+	}
+
+#ifdef _OPENMP
+	omp_set_num_threads(maxthreads);
+#endif
+}
+
+/// Checks a relative difference against a tolerance and reports failure
+static int check(const freal diff, const freal tol, const std::string what, const int mpirank)
+{
+	if(diff > tol || std::isnan(diff)) {
+		if(mpirank == 0)
+			std::cerr << "! " << what << ": relative difference " << diff << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	StatusCode ierr = PetscInitialize(&argc, &argv, NULL, NULL); CHKERRQ(ierr);
+	const int mpirank = get_mpi_rank(PETSC_COMM_WORLD);
+
+	po::options_description desc ("Test for the threaded block preconditioners");
+	const po::variables_map cmdvars = parse_cmd_options(argc, argv, desc);
+	if(cmdvars.count("help")) {
+		std::cout << desc << std::endl;
+		std::exit(0);
+	}
+
+	const FlowParserOptions opts = parse_flow_controlfile(argc, argv, cmdvars);
+	const UMesh<freal,NDIM> m = constructMeshFlow(opts, "");
+	const FlowFV_base<freal> *const spatial = createFlowSpatial(opts, m);
+
+	Vec u;
+	ierr = initializeSystemVector(opts, m, &u); CHKERRQ(ierr);
+
+	Mat A;
+	ierr = setupSystemMatrix<NVARS>(&m, &A); CHKERRQ(ierr);
+	ierr = spatial->assemble_jacobian(u, A); CHKERRQ(ierr);
+	ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+	const BAIJJacobianLayout<NVARS> layout(m, A);
+
+	Vec x, yref, y;
+	ierr = MatCreateVecs(A, &x, &yref); CHKERRQ(ierr);
+	ierr = VecDuplicate(yref, &y); CHKERRQ(ierr);
+	{
+		MutableVecHandler<freal> xh(x);
+		freal *const xarr = xh.getArray();
+		for(fint iel = 0; iel < m.gnelem(); iel++)
+			for(int ivar = 0; ivar < NVARS; ivar++)
+				xarr[iel*NVARS+ivar] = 1.0 + std::sin(m.gcoords(m.ginpoel(iel,0),0) + ivar)
+					* std::cos(2.0*m.gcoords(m.ginpoel(iel,0),1));
+	}
+
+#ifdef _OPENMP
+	const int maxthreads = omp_get_max_threads();
+#else
+	const int maxthreads = 1;
+#endif
+	int finerr = 0;
+
+	// SGS
+	{
+		BlockSGSPreconditioner<double,NVARS> sgs(m, 1);
+		ierr = sgs.setup(A, layout); CHKERRQ(ierr);
+		{
+			ConstVecHandler<freal> xh(x);
+			MutableVecHandler<freal> yh(yref);
+			sgs.apply(xh.getArray(), yh.getArray());
+		}
+
+		applyThreaded(m, A, layout, THREADED_SGS, SCHEDULE_LEVELS, maxthreads, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-12, "Level-scheduled SGS", mpirank);
+
+		applyThreaded(m, A, layout, THREADED_SGS, SCHEDULE_ASYNC, 1, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-12, "Async SGS on one thread", mpirank);
+
+		applyThreaded(m, A, layout, THREADED_SGS, SCHEDULE_COLOURS, 1, x, yref);
+		applyThreaded(m, A, layout, THREADED_SGS, SCHEDULE_COLOURS, maxthreads, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-14, "Multicolour SGS", mpirank);
+	}
+
+	// ILU(0)
+	{
+		PC pc;
+		ierr = PCCreate(PETSC_COMM_WORLD, &pc); CHKERRQ(ierr);
+		ierr = PCSetOperators(pc, A, A); CHKERRQ(ierr);
+		ierr = PCSetType(pc, PCBJACOBI); CHKERRQ(ierr);
+		ierr = PetscOptionsSetValue(NULL, "-sub_pc_type", "ilu"); CHKERRQ(ierr);
+		ierr = PetscOptionsSetValue(NULL, "-sub_pc_factor_mat_ordering_type", "natural");
+		CHKERRQ(ierr);
+		ierr = PCSetFromOptions(pc); CHKERRQ(ierr);
+		ierr = PCSetUp(pc); CHKERRQ(ierr);
+		ierr = PCApply(pc, x, yref); CHKERRQ(ierr);
+		ierr = PCDestroy(&pc); CHKERRQ(ierr);
+
+		applyThreaded(m, A, layout, THREADED_ILU0, SCHEDULE_LEVELS, maxthreads, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-10, "Level-scheduled ILU(0)", mpirank);
+
+		ierr = VecCopy(y, yref); CHKERRQ(ierr);
+		applyThreaded(m, A, layout, THREADED_ILU0, SCHEDULE_ASYNC, 1, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-12, "Async ILU(0) on one thread", mpirank);
+
+		applyThreaded(m, A, layout, THREADED_ILU0, SCHEDULE_COLOURS, 1, x, yref);
+		applyThreaded(m, A, layout, THREADED_ILU0, SCHEDULE_COLOURS, maxthreads, x, y);
+		finerr += check(relativeDifference(y, yref), 1e-14, "Multicolour ILU(0)", mpirank);
+	}
+
+	ierr = VecDestroy(&x); CHKERRQ(ierr);
+	ierr = VecDestroy(&y); CHKERRQ(ierr);
+	ierr = VecDestroy(&yref); CHKERRQ(ierr);
+	ierr = MatDestroy(&A); CHKERRQ(ierr);
+	ierr = VecDestroy(&u); CHKERRQ(ierr);
+	delete spatial;
+
+	ierr = PetscFinalize(); CHKERRQ(ierr);
+	return finerr;
+}